@@ -33,12 +33,14 @@
 #include <stdint.h>
 #include <bstrlib.h>
 #include <test_types.h>
+#include <allocator_types.h>
 
 #define LLU_CAST (unsigned long long)
 
-extern void allocator_init(int numVectors);
+extern void allocator_init(int numVectors, int parallelInit);
 extern void allocator_finalize();
 extern size_t allocator_dataTypeLength(DataType type);
+extern int allocator_pageType(const_bstring str, PageType* pages);
 extern void allocator_allocateVector(void** ptr,
                 int alignment,
                 uint64_t size,
@@ -46,6 +48,17 @@ extern void allocator_allocateVector(void** ptr,
                 DataType type,
                 int stride,
                 bstring domain,
-                int init_per_thread);
+                int init_per_thread,
+                PageType pages,
+                const_bstring interleave);
+extern void allocator_printPlacement(void);
+extern int allocator_indexPattern(const_bstring str, IndexPattern* pattern, int* param);
+extern const char* allocator_indexPatternName(IndexPattern pattern);
+extern void allocator_initIndices(void* ptr,
+                uint64_t size,
+                DataType type,
+                IndexPattern pattern,
+                int param,
+                unsigned int seed);
 
 #endif /*ALLOCATOR_H*/
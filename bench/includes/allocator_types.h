@@ -32,13 +32,31 @@
 #define ALLOCATOR_TYPES_H
 
 #include <stdint.h>
+#include <bstrlib.h>
 #include <test_types.h>
 
+typedef enum {
+    PAGES_DEFAULT = 0,
+    PAGES_THP,
+    PAGES_HUGE_2MB,
+    PAGES_HUGE_1GB,
+} PageType;
+
+typedef enum {
+    INDEX_LINEAR = 0,
+    INDEX_RANDOM,
+    INDEX_BLOCKED,
+    INDEX_STRIDED,
+} IndexPattern;
+
 typedef struct {
     void* ptr;
     size_t size;
     off_t offset;
     DataType type;
+    PageType pages;
+    size_t mapsize;
+    bstring domain;
 } allocation;
 
 #endif
@@ -0,0 +1,44 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  ecm.h
+ *
+ *      Description:  Header File of the Execution-Cache-Memory (ECM) model module.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+#ifndef ECM_H
+#define ECM_H
+
+#include <stdint.h>
+#include <test_types.h>
+#include <ecm_types.h>
+
+extern int ecm_init(const char* memBandwidth);
+extern int ecm_enabled(void);
+extern void ecm_getModel(const TestCase* test, int clsize, double cyclesClock, EcmModel* model);
+extern void ecm_printPrediction(const TestCase* test, int* threadIds, int numberOfThreads,
+                uint64_t cyclesClock, int clsize, double measuredCycPerCL);
+
+#endif /*ECM_H*/
@@ -0,0 +1,56 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  ecm_types.h
+ *
+ *      Description:  Types of the Execution-Cache-Memory (ECM) model module.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+#ifndef ECM_TYPES_H
+#define ECM_TYPES_H
+
+/* Nominal machine parameters of the ECM model. The transfer rates between
+ * the caches are given in bytes per cycle. */
+typedef struct {
+    const char* name;
+    int issueWidth;
+    int loadPorts;
+    int storePorts;
+    int fpPorts;
+    int l1l2Bytes;
+    int l2l3Bytes;
+} EcmMachine;
+
+/* Model contributions in cycles per cache line of work, i.e. for the number
+ * of elements that fit into one cache line of each stream */
+typedef struct {
+    double tOL;
+    double tnOL;
+    double tL1L2;
+    double tL2L3;
+    double tL3Mem;
+} EcmModel;
+
+#endif /*ECM_TYPES_H*/
@@ -39,6 +39,7 @@
 #include <likwid.h>
 
 #include <test_types.h>
+#include <allocator_types.h>
 
 typedef struct {
     bstring domain;
@@ -52,9 +53,14 @@ typedef struct {
     uint64_t size;
     int init_per_thread;
     Stream* streams;
+    const TestCase* test;
+    PageType pages;
+    bstring interleave;
+    IndexPattern indexPattern;
+    int indexParam;
 } Workgroup;
 
 extern int bstr_to_workgroup(Workgroup* group, const_bstring str, DataType type, int numberOfStreams);
-extern void workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStreams);
+extern void workgroups_destroy(Workgroup** groupList, int numberOfGroups);
 
 #endif
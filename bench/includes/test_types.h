@@ -97,6 +97,7 @@ typedef struct {
     int instr_const;
     int instr_loop;
     int uops;
+    int indexStream;
     int loadstores;
     void* dlhandle;
 } TestCase;
@@ -109,6 +110,8 @@ typedef struct {
     uint64_t   cycles;
     uint32_t numberOfThreads;
     int    init_per_thread;
+    int    indexPattern;
+    int    indexParam;
     int* processors;
     void** streams;
 } ThreadUserData;
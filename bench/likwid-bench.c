@@ -49,6 +49,7 @@
 #include <strUtil.h>
 #include <allocator.h>
 #include <ptt2asm.h>
+#include <ecm.h>
 
 #include <likwid.h>
 #include <likwid-marker.h>
@@ -74,15 +75,27 @@ extern void* getIterSingle(void* arg);
     printf("-i <ITERS>\t Specify the number of iterations per thread manually. \n"); \
     printf("-l <TEST>\t list properties of benchmark \n"); \
     printf("-t <TEST>\t type of test \n"); \
+    printf("\t\t Can be given multiple times. Each workgroup uses the kernel of the last -t\n"); \
+    printf("\t\t before it, workgroups in front of the first -t use the first kernel.\n"); \
     printf("-w\t\t <thread_domain>:<size>[:<num_threads>[:<chunk size>:<stride>]-<streamId>:<domain_id>[:<offset>]\n"); \
     printf("-W\t\t <thread_domain>:<size>[:<num_threads>[:<chunk size>:<stride>]]\n"); \
     printf("\t\t <size> in kB, MB or GB (mandatory)\n"); \
+    printf("-H <PAGES>\t Page type for the streams of the following workgroups:\n"); \
+    printf("\t\t default, THP (transparent huge pages), 2MB or 1GB (hugetlbfs pages)\n"); \
+    printf("-M <DOMAINS>\t Interleave the streams of the following workgroups over the comma-separated\n"); \
+    printf("\t\t list of domains, e.g. M0,M1. Use -M none to switch off interleaving again\n"); \
+    printf("-I <PATTERN>\t Index pattern for kernels with an index stream for the following workgroups:\n"); \
+    printf("\t\t linear (default), random, blocked:<elements> or strided:<elements>\n"); \
+    printf("-S\t\t Initialize the streams of -w workgroups serially by the first hwthread in the domain\n"); \
+    printf("\t\t instead of all hwthreads in the domain\n"); \
+    printf("-e <MEMBW>\t Print the Execution-Cache-Memory (ECM) model prediction next to the results.\n"); \
+    printf("\t\t MEMBW is the saturated memory bandwidth of a socket in GB/s, 0 skips the memory level\n"); \
     printf("For dynamically loaded benchmarks\n"); \
     printf("-f <PATH>\t Specify a folder for the temporary files. default: /tmp\n"); \
     printf("-o <FILE>\t Save generated assembly to file\n"); \
     printf("\n"); \
     printf("Difference between -w and -W :\n"); \
-    printf("-w allocates the streams in the thread_domain with one thread and support placement of streams\n"); \
+    printf("-w allocates the streams in the thread_domain with all threads of the domain and support placement of streams\n"); \
     printf("-W allocates the streams chunk-wise by each thread in the thread_domain\n"); \
     printf("\n"); \
     printf("Usage: \n"); \
@@ -92,6 +105,14 @@ extern void* getIterSingle(void* arg);
     printf("likwid-bench -t copy -w S0:100kB:1\n"); \
     printf("# Run the copy benchmark on one CPU at CPU socket 0 with a vector size of 100MB but place one stream on CPU socket 1\n"); \
     printf("likwid-bench -t copy -w S0:100MB:1-0:S0,1:S1\n"); \
+    printf("# Run the load benchmark on socket 0 while the copy_mem_avx512 benchmark runs on socket 1\n"); \
+    printf("likwid-bench -t load -w S0:1GB -t copy_mem_avx512 -w S1:1GB\n"); \
+    printf("# Run the copy benchmark on socket 0 with 2MB huge pages interleaved over NUMA domains 0 and 1\n"); \
+    printf("likwid-bench -t copy -H 2MB -M M0,M1 -w S0:4GB\n"); \
+    printf("# Run the gather benchmark on socket 0 with randomly permuted blocks of 8 elements\n"); \
+    printf("likwid-bench -t gather_avx512 -I blocked:8 -w S0:1GB\n"); \
+    printf("# Compare the triad benchmark on 4 CPUs with the ECM model for 100 GB/s memory bandwidth\n"); \
+    printf("likwid-bench -t triad_avx -e 100 -W S0:1GB:4\n"); \
 /*    printf("-c <COMP_LIST>\t Specify a list of compilers that should be searched for. default: gcc,icc,pgcc\n"); \*/
 /*    printf("-f <COMP_FLAGS>\t Specify compiler flags. Use \". default: \"-shared -fPIC\"\n"); \*/
 
@@ -121,6 +142,148 @@ copyThreadData(ThreadUserData* src,ThreadUserData* dst)
 }
 
 
+static TestCase*
+getTestcase(TestCase** tests, int numberOfTests, const char* name)
+{
+    for (int i = 0; i < numberOfTests; i++)
+    {
+        if (strcmp(tests[i]->name, name) == 0)
+        {
+            return tests[i];
+        }
+    }
+    return NULL;
+}
+
+static double
+printResults(const TestCase* test, int* threadIds, int numberOfThreads, uint64_t cyclesClock, double walltime, int clsize)
+{
+    uint32_t i;
+    double time;
+    double cycPerCL = 0.0;
+    uint64_t realSize = 0;
+    uint64_t realIter = 0;
+    uint64_t maxCycles = 0;
+    uint64_t minCycles = UINT64_MAX;
+    ThreadData* first = &threads_data[threadIds[0]];
+
+    for (i=0; i<numberOfThreads; i++)
+    {
+        ThreadData* t = &threads_data[threadIds[i]];
+        realSize += t->data.size;
+        realIter += t->data.iter;
+        if (t->cycles > maxCycles)
+        {
+            maxCycles = t->cycles;
+        }
+        if (t->cycles < minCycles)
+        {
+            minCycles = t->cycles;
+        }
+    }
+
+    if (cyclesClock > 0)
+    {
+        time = (double) maxCycles / (double) cyclesClock;
+    }
+    else
+    {
+        time = walltime;
+    }
+
+    int datatypesize = allocator_dataTypeLength(test->type);
+    uint64_t size_per_thread = first->data.size;
+    uint64_t iters_per_thread = first->data.iter;
+    uint64_t datavol = iters_per_thread * realSize * test->bytes;
+    printf("Cycles:\t\t\t%" PRIu64 "\n", maxCycles);
+    printf("CPU Clock:\t\t%" PRIu64 "\n", timer_getCpuClock());
+    printf("Cycle Clock:\t\t%" PRIu64 "\n", cyclesClock);
+    printf("Time:\t\t\t%e sec\n", time);
+    printf("Iterations:\t\t%" PRIu64 "\n", realIter);
+    printf("Iterations per thread:\t%" PRIu64 "\n",iters_per_thread);
+    printf("Inner loop executions:\t%d\n", (int)(((double)realSize)/((double)test->stride*numberOfThreads)));
+    printf("Size (Byte):\t\t%" PRIu64 "\n",  realSize * datatypesize * test->streams);
+    printf("Size per thread:\t%" PRIu64 "\n", size_per_thread * datatypesize * test->streams);
+    printf("Number of Flops:\t%" PRIu64 "\n", (iters_per_thread * realSize *  test->flops));
+    printf("MFlops/s:\t\t%.2f\n",
+            1.0E-06 * ((double) (iters_per_thread * realSize *  test->flops) /  time));
+    printf("Data volume (Byte):\t%llu\n",
+            LLU_CAST (datavol));
+    printf("MByte/s:\t\t%.2f\n",
+            1.0E-06 * ( (double) (iters_per_thread * realSize * test->bytes) / time));
+    if (test->indexStream >= 0)
+    {
+        /* The index stream is not part of the useful data volume */
+        printf("Index pattern:\t\t%s", allocator_indexPatternName(first->data.indexPattern));
+        if (first->data.indexPattern == INDEX_BLOCKED || first->data.indexPattern == INDEX_STRIDED)
+        {
+            printf(":%d", first->data.indexParam);
+        }
+        printf("\n");
+        printf("Effective MByte/s:\t%.2f\n",
+                1.0E-06 * ( (double) (iters_per_thread * realSize * (test->bytes - datatypesize)) / time));
+        printf("MElements/s:\t\t%.2f\n",
+                1.0E-06 * ( (double) (iters_per_thread * realSize) / time));
+    }
+
+    size_t datasize = 0;
+    double perUpFactor = 0.0;
+    switch (test->type)
+    {
+        case INT:
+            datasize = test->bytes/sizeof(int);
+            perUpFactor = (clsize/sizeof(int));
+            break;
+        case SINGLE:
+            datasize = test->bytes/sizeof(float);
+            perUpFactor = (clsize/sizeof(float));
+            break;
+        case DOUBLE:
+            datasize = test->bytes/sizeof(double);
+            perUpFactor = (clsize/sizeof(double));
+            break;
+    }
+
+    cycPerCL = (double) maxCycles/((double)datavol/(clsize*datasize));
+    printf("Cycles per update:\t%f\n", cycPerCL/perUpFactor);
+    printf("Cycles per cacheline:\t%f\n", cycPerCL);
+    printf("Loads per update:\t%ld\n", test->loads );
+    printf("Stores per update:\t%ld\n", test->stores );
+    if (test->loads > 0 && test->stores > 0)
+    {
+        double ratio = (double)test->loads/(double)(test->stores+test->loads);
+        double load_bytes = ((double)test->bytes) * ratio;
+        printf("Load bytes per element:\t%.0f\n", load_bytes);
+        printf("Store bytes per elem.:\t%.0f\n",((double)test->bytes) - load_bytes);
+    }
+    else if (test->loads >= 0 && test->stores == 0)
+    {
+        printf("Load bytes per element:\t%d\n",test->bytes);
+        printf("Store bytes per elem.:\t0\n");
+    }
+    else if (test->loads == 0 && test->stores > 0)
+    {
+        printf("Load bytes per element:\t0\n");
+        printf("Store bytes per elem.:\t%d\n",test->bytes);
+    }
+    if ((test->loads > 0) && (test->stores > 0))
+    {
+        printf("Load/store ratio:\t%.2f\n", ((double)test->loads)/((double)test->stores) );
+    }
+    if ((test->instr_loop > 0) && (test->instr_const > 0))
+    {
+        printf("Instructions:\t\t%" PRIu64 "\n",
+                LLU_CAST ((double)realSize/test->stride)*test->instr_loop*first->data.iter + test->instr_const );
+    }
+    if (test->uops > 0)
+    {
+        printf("UOPs:\t\t\t%" PRIu64 "\n",
+                LLU_CAST ((double)realSize/test->stride)*test->uops*first->data.iter);
+    }
+    return cycPerCL;
+}
+
+
 void illhandler(int signum, siginfo_t *info, void *ptr)
 {
     fprintf(stderr, "ERROR: Illegal instruction\n");
@@ -146,13 +309,15 @@ int main(int argc, char** argv)
     uint64_t numberOfWorkgroups = 0;
     int tmp = 0;
     double time;
-    double cycPerUp = 0.0;
-    double cycPerCL = 0.0;
     TestCase* test = NULL;
-    uint64_t realSize = 0;
-    uint64_t realIter = 0;
-    uint64_t maxCycles = 0;
-    uint64_t minCycles = UINT64_MAX;
+    TestCase** tests = NULL;
+    int numberOfTests = 0;
+    TestCase* currentTest = NULL;
+    PageType currentPages = PAGES_DEFAULT;
+    IndexPattern currentIndexPattern = INDEX_LINEAR;
+    int currentIndexParam = 1;
+    bstring currentInterleave = NULL;
+    int parallelInit = 1;
     uint64_t cyclesClock = 0;
     uint64_t demandIter = 0;
     TimerData itertime;
@@ -182,7 +347,7 @@ int main(int argc, char** argv)
         exit(EXIT_SUCCESS);
     }
 
-    while ((c = getopt (argc, argv, "W:w:t:s:l:aphvi:f:o:")) != -1) {
+    while ((c = getopt (argc, argv, "W:w:t:s:l:aphvi:f:o:H:M:SI:e:")) != -1) {
         switch (c)
         {
             case 'f':
@@ -203,7 +368,7 @@ int main(int argc, char** argv)
     }
     optind = 0;
 
-    while ((c = getopt (argc, argv, "W:w:t:s:l:aphvi:f:o:")) != -1) {
+    while ((c = getopt (argc, argv, "W:w:t:s:l:aphvi:f:o:H:M:SI:e:")) != -1) {
         switch (c)
         {
             case 'h':
@@ -242,6 +407,13 @@ int main(int argc, char** argv)
             case 's':
                 min_runtime = atoi(optarg);
                 break;
+            case 'e':
+                if (ecm_init(optarg) < 0)
+                {
+                    fprintf (stderr, "Error: Option -e requires the memory bandwidth in GB/s\n");
+                    return EXIT_FAILURE;
+                }
+                break;
             case 'i':
                 demandIter = strtoul(optarg, NULL, 10);
                 if (demandIter <= 0)
@@ -333,6 +505,10 @@ int main(int argc, char** argv)
                     {
                         ownprintf("Loop micro Ops (\u03BCOPs): %d\n",test->uops);
                     }
+                    if (test->indexStream >= 0)
+                    {
+                        ownprintf("Index stream: %d\n",test->indexStream);
+                    }
                 }
                 bdestroy(testcase);
                 if (!builtin)
@@ -352,6 +528,11 @@ int main(int argc, char** argv)
 
                 break;
             case 't':
+                test = getTestcase(tests, numberOfTests, optarg);
+                if (test != NULL)
+                {
+                    break;
+                }
                 bdestroy(testcase);
                 testcase = bfromcstr(optarg);
 
@@ -389,10 +570,19 @@ int main(int argc, char** argv)
                     fprintf (stderr, "Error: Unknown test case %s\n",optarg);
                     return EXIT_FAILURE;
                 }
+                tests = (TestCase**) realloc(tests, (numberOfTests+1) * sizeof(TestCase*));
+                tests[numberOfTests++] = test;
                 bdestroy(testcase);
+                testcase = NULL;
                 break;
             case 'o':
             case 'f':
+            case 'H':
+            case 'M':
+            case 'I':
+                break;
+            case 'S':
+                parallelInit = 0;
                 break;
             case '?':
                 if (isprint (optopt))
@@ -418,6 +608,10 @@ int main(int argc, char** argv)
         exit(EXIT_FAILURE);
     }
 
+    if (numberOfTests > 0)
+    {
+        test = tests[0];
+    }
     if ((test == NULL) && (!optPrintDomains))
     {
         fprintf(stderr, "Unknown test case. Please check likwid-bench -a for available tests\n");
@@ -453,19 +647,58 @@ int main(int argc, char** argv)
         exit (EXIT_SUCCESS);
     }
 
-    allocator_init(numberOfWorkgroups * MAX_STREAMS);
+    allocator_init(numberOfWorkgroups * MAX_STREAMS, parallelInit);
     groups = (Workgroup*) malloc(numberOfWorkgroups*sizeof(Workgroup));
     memset(groups, 0, numberOfWorkgroups*sizeof(Workgroup));
     tmp = 0;
 
     optind = 0;
-    while ((c = getopt (argc, argv, "W:w:t:s:l:i:aphvf:o:")) != -1)
+    while ((c = getopt (argc, argv, "W:w:t:s:l:i:aphvf:o:H:M:SI:e:")) != -1)
     {
         switch (c)
         {
+            case 't':
+                currentTest = getTestcase(tests, numberOfTests, optarg);
+                break;
+            case 'H':
+                {
+                    bstring pagestr = bfromcstr(optarg);
+                    if (allocator_pageType(pagestr, &currentPages) != 0)
+                    {
+                        bdestroy(pagestr);
+                        exit(EXIT_FAILURE);
+                    }
+                    bdestroy(pagestr);
+                }
+                break;
+            case 'I':
+                {
+                    bstring patternstr = bfromcstr(optarg);
+                    if (allocator_indexPattern(patternstr, &currentIndexPattern, &currentIndexParam) != 0)
+                    {
+                        bdestroy(patternstr);
+                        exit(EXIT_FAILURE);
+                    }
+                    bdestroy(patternstr);
+                }
+                break;
+            case 'M':
+                bdestroy(currentInterleave);
+                currentInterleave = NULL;
+                if (strcmp(optarg, "none") != 0)
+                {
+                    currentInterleave = bfromcstr(optarg);
+                }
+                break;
             case 'w':
             case 'W':
                 currentWorkgroup = groups+tmp;
+                test = (currentTest ? currentTest : tests[0]);
+                currentWorkgroup->test = test;
+                currentWorkgroup->pages = currentPages;
+                currentWorkgroup->indexPattern = currentIndexPattern;
+                currentWorkgroup->indexParam = currentIndexParam;
+                currentWorkgroup->interleave = (currentInterleave ? bstrcpy(currentInterleave) : NULL);
                 bstring groupstr = bfromcstr(optarg);
                 if (c == 'W')
                 {
@@ -509,7 +742,7 @@ int main(int argc, char** argv)
                                 }
                                 fprintf(stderr, "Error: The given vector length of %dB is too small to fit %d threads because each loop iteration of kernel '%s' requires %d Bytes (%d x %dB = %dB). So the minimal selectable size for the kernel is %dB.\n", given, nrThreads, test->name, each_iter, nrThreads, each_iter, each_iter*nrThreads, each_iter*nrThreads);
                                 allocator_finalize();
-                                workgroups_destroy(&groups, numberOfWorkgroups, test->streams);
+                                workgroups_destroy(&groups, numberOfWorkgroups);
                                 exit(EXIT_FAILURE);
                             }
                         }
@@ -524,7 +757,23 @@ int main(int argc, char** argv)
                                                     test->type,
                                                     test->stride,
                                                     currentWorkgroup->streams[i].domain,
-                                                    currentWorkgroup->init_per_thread && nrThreads > 1);
+                                                    currentWorkgroup->init_per_thread && nrThreads > 1,
+                                                    currentWorkgroup->pages,
+                                                    currentWorkgroup->interleave);
+                        if ((i == test->indexStream) && !(currentWorkgroup->init_per_thread && nrThreads > 1))
+                        {
+                            size_t chunk = newsize / nrThreads;
+                            chunk -= (chunk % stride);
+                            for (int t = 0; t < nrThreads; t++)
+                            {
+                                allocator_initIndices(((char*)currentWorkgroup->streams[i].ptr) + (t * chunk * allocator_dataTypeLength(test->type)),
+                                                      chunk,
+                                                      test->type,
+                                                      currentWorkgroup->indexPattern,
+                                                      currentWorkgroup->indexParam,
+                                                      tmp + t + 1);
+                            }
+                        }
                     }
                     tmp++;
                 }
@@ -542,6 +791,10 @@ int main(int argc, char** argv)
                     {
                         fprintf (stdout, "Initialization: Each thread in domain initializes its own stream chunks\n");
                     }
+                    else if (parallelInit)
+                    {
+                        fprintf (stdout, "Initialization: All threads in stream domain initialize the whole stream\n");
+                    }
                     else
                     {
                         fprintf (stdout, "Initialization: First thread in domain initializes the whole stream\n");
@@ -553,6 +806,8 @@ int main(int argc, char** argv)
                 break;
         }
     }
+    bdestroy(currentInterleave);
+    test = tests[0];
     if (numberOfWorkgroups > 1)
     {
         int g0_numberOfThreads = groups[0].numberOfThreads;
@@ -582,7 +837,12 @@ int main(int argc, char** argv)
 
     ownprintf(bdata(HLINE));
     ownprintf("LIKWID MICRO BENCHMARK\n");
-    ownprintf("Test: %s\n",test->name);
+    ownprintf("Test: %s",tests[0]->name);
+    for (i=1; i<numberOfTests; i++)
+    {
+        ownprintf(", %s", tests[i]->name);
+    }
+    ownprintf("\n");
     ownprintf(bdata(HLINE));
     ownprintf("Using %" PRIu64 " work groups\n",numberOfWorkgroups);
     ownprintf("Using %d threads\n",globalNumberOfThreads);
@@ -592,9 +852,13 @@ int main(int argc, char** argv)
     threads_init(globalNumberOfThreads);
     threads_createGroups(numberOfWorkgroups, groups);
 
-    /* we configure global barriers only */
-    barrier_init(1);
+    /* one global barrier for the common start and one barrier per workgroup */
+    barrier_init(numberOfWorkgroups + 1);
     barrier_registerGroup(globalNumberOfThreads);
+    for (i=0; i<numberOfWorkgroups; i++)
+    {
+        barrier_registerGroup(groups[i].numberOfThreads);
+    }
     cyclesClock = timer_getCycleClock();
 
 #ifdef LIKWID_PERFMON
@@ -617,19 +881,21 @@ int main(int argc, char** argv)
         }
         myData.min_runtime = min_runtime;
         myData.size = groups[i].size;
-        myData.test = test;
+        myData.test = groups[i].test;
         myData.cycles = 0;
         myData.numberOfThreads = groups[i].numberOfThreads;
         myData.init_per_thread = groups[i].init_per_thread;
+        myData.indexPattern = groups[i].indexPattern;
+        myData.indexParam = groups[i].indexParam;
         myData.processors = (int*) malloc(myData.numberOfThreads * sizeof(int));
-        myData.streams = (void**) malloc(test->streams * sizeof(void*));
+        myData.streams = (void**) malloc(groups[i].test->streams * sizeof(void*));
 
         for (j=0; j<groups[i].numberOfThreads; j++)
         {
             myData.processors[j] = groups[i].processorIds[j];
         }
 
-        for (j=0; j<  test->streams; j++)
+        for (j=0; j<  groups[i].test->streams; j++)
         {
             myData.streams[j] = groups[i].streams[j].ptr;
         }
@@ -645,6 +911,17 @@ int main(int argc, char** argv)
         getIterSingle((void*) &threads_data[0]);
         for (i=0; i<numberOfWorkgroups; i++)
         {
+            ThreadData* first = &threads_data[threads_groups[i].threadIds[0]];
+            /* Workgroups with a different kernel get their own iteration
+             * count so that all workgroups run for about the same time */
+            if (i > 0 && groups[i].test != groups[0].test)
+            {
+                getIterSingle((void*) first);
+            }
+            else
+            {
+                first->data.iter = threads_data[0].data.iter;
+            }
             iter = threads_updateIterations(i, demandIter);
         }
     }
@@ -660,28 +937,10 @@ int main(int argc, char** argv)
     threads_join();
     timer_stop(&itertime);
 
-    for (int i=0; i<globalNumberOfThreads; i++)
-    {
-        realSize += threads_data[i].data.size;
-        realIter += threads_data[i].data.iter;
-        if (threads_data[i].cycles > maxCycles)
-        {
-            maxCycles = threads_data[i].cycles;
-        }
-        if (threads_data[i].cycles < minCycles)
-        {
-            minCycles = threads_data[i].cycles;
-        }
-    }
+    time = timer_print(&itertime);
 
-    if (cyclesClock > 0)
-    {
-        time = (double) maxCycles / (double) cyclesClock;
-    }
-    else
-    {
-        time = timer_print(&itertime);
-    }
+    ownprintf(bdata(HLINE));
+    allocator_printPlacement();
 
 /*#if defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_8A)*/
 /*    if (maxCycles > 0)*/
@@ -695,92 +954,43 @@ int main(int argc, char** argv)
 /*        ownprintf("WARNING: The cycle count cannot be calculated because the clock frequency is not fixed.\n");*/
 /*    }*/
 /*#endif*/
-    int datatypesize = allocator_dataTypeLength(test->type);
-    uint64_t size_per_thread = threads_data[0].data.size;
-    uint64_t iters_per_thread = threads_data[0].data.iter;
-    uint64_t datavol = iters_per_thread * realSize * test->bytes;
-    uint64_t allIters = realIter * (int)(((double)realSize)/((double)test->stride*globalNumberOfThreads));
-    ownprintf(bdata(HLINE));
-    ownprintf("Cycles:\t\t\t%" PRIu64 "\n", maxCycles);
-    ownprintf("CPU Clock:\t\t%" PRIu64 "\n", timer_getCpuClock());
-    ownprintf("Cycle Clock:\t\t%" PRIu64 "\n", cyclesClock);
-    ownprintf("Time:\t\t\t%e sec\n", time);
-    ownprintf("Iterations:\t\t%" PRIu64 "\n", realIter);
-    ownprintf("Iterations per thread:\t%" PRIu64 "\n",iters_per_thread);
-    ownprintf("Inner loop executions:\t%d\n", (int)(((double)realSize)/((double)test->stride*globalNumberOfThreads)));
-    ownprintf("Size (Byte):\t\t%" PRIu64 "\n",  realSize * datatypesize * test->streams);
-    ownprintf("Size per thread:\t%" PRIu64 "\n", size_per_thread * datatypesize * test->streams);
-    ownprintf("Number of Flops:\t%" PRIu64 "\n", (iters_per_thread * realSize *  test->flops));
-    ownprintf("MFlops/s:\t\t%.2f\n",
-            1.0E-06 * ((double) (iters_per_thread * realSize *  test->flops) /  time));
-    ownprintf("Data volume (Byte):\t%llu\n",
-            LLU_CAST (datavol));
-    ownprintf("MByte/s:\t\t%.2f\n",
-            1.0E-06 * ( (double) (iters_per_thread * realSize * test->bytes) / time));
-
-    size_t destsize = 0;
-    size_t datasize = 0;
-    double perUpFactor = 0.0;
-    switch (test->type)
-    {
-        case INT:
-            datasize = test->bytes/sizeof(int);
-            destsize = test->bytes/test->streams;
-            perUpFactor = (clsize/sizeof(int));
-            break;
-        case SINGLE:
-            datasize = test->bytes/sizeof(float);
-            destsize = test->bytes/test->streams;
-            perUpFactor = (clsize/sizeof(float));
-            break;
-        case DOUBLE:
-            datasize = test->bytes/sizeof(double);
-            destsize = test->bytes/test->streams;
-            perUpFactor = (clsize/sizeof(double));
-            break;
-    }
-
-    cycPerCL = (double) maxCycles/((double)datavol/(clsize*datasize));
-    ownprintf("Cycles per update:\t%f\n", cycPerCL/perUpFactor);
-    ownprintf("Cycles per cacheline:\t%f\n", cycPerCL);
-    ownprintf("Loads per update:\t%ld\n", test->loads );
-    ownprintf("Stores per update:\t%ld\n", test->stores );
-    if (test->loads > 0 && test->stores > 0)
-    {
-        double ratio = (double)test->loads/(double)(test->stores+test->loads);
-        double load_bytes = ((double)test->bytes) * ratio;
-        ownprintf("Load bytes per element:\t%.0f\n", load_bytes);
-        ownprintf("Store bytes per elem.:\t%.0f\n",((double)test->bytes) - load_bytes);
-    }
-    else if (test->loads >= 0 && test->stores == 0)
-    {
-        ownprintf("Load bytes per element:\t%d\n",test->bytes);
-        ownprintf("Store bytes per elem.:\t0\n");
-    }
-    else if (test->loads == 0 && test->stores > 0)
-    {
-        ownprintf("Load bytes per element:\t0\n");
-        ownprintf("Store bytes per elem.:\t%d\n",test->bytes);
-    }
-    if ((test->loads > 0) && (test->stores > 0))
-    {
-        ownprintf("Load/store ratio:\t%.2f\n", ((double)test->loads)/((double)test->stores) );
-    }
-    if ((test->instr_loop > 0) && (test->instr_const > 0))
+    if (numberOfWorkgroups > 1)
     {
-        ownprintf("Instructions:\t\t%" PRIu64 "\n",
-                LLU_CAST ((double)realSize/test->stride)*test->instr_loop*threads_data[0].data.iter + test->instr_const );
+        for (i=0; i<numberOfWorkgroups; i++)
+        {
+            ownprintf(bdata(HLINE));
+            ownprintf("Workgroup %d: Test %s, %d threads\n", i, groups[i].test->name, groups[i].numberOfThreads);
+            double cycPerCL = printResults(groups[i].test, threads_groups[i].threadIds, threads_groups[i].numberOfThreads, cyclesClock, time, clsize);
+            if (ecm_enabled())
+            {
+                ecm_printPrediction(groups[i].test, threads_groups[i].threadIds, threads_groups[i].numberOfThreads, cyclesClock, clsize, cycPerCL);
+            }
+        }
     }
-    if (test->uops > 0)
+    if (numberOfTests == 1)
     {
-        ownprintf("UOPs:\t\t\t%" PRIu64 "\n",
-                LLU_CAST ((double)realSize/test->stride)*test->uops*threads_data[0].data.iter);
+        int* allThreads = (int*) malloc(globalNumberOfThreads * sizeof(int));
+        for (i=0; i<globalNumberOfThreads; i++)
+        {
+            allThreads[i] = i;
+        }
+        ownprintf(bdata(HLINE));
+        if (numberOfWorkgroups > 1)
+        {
+            ownprintf("All workgroups: Test %s, %d threads\n", test->name, globalNumberOfThreads);
+        }
+        double cycPerCL = printResults(test, allThreads, globalNumberOfThreads, cyclesClock, time, clsize);
+        if (ecm_enabled())
+        {
+            ecm_printPrediction(test, allThreads, globalNumberOfThreads, cyclesClock, clsize, cycPerCL);
+        }
+        free(allThreads);
     }
 
     ownprintf(bdata(HLINE));
     threads_destroy(numberOfWorkgroups, test->streams);
     allocator_finalize();
-    workgroups_destroy(&groups, numberOfWorkgroups, test->streams);
+    workgroups_destroy(&groups, numberOfWorkgroups);
 
 #ifdef LIKWID_PERFMON
     if (getenv("LIKWID_FILEPATH") != NULL)
@@ -790,10 +1000,14 @@ int main(int argc, char** argv)
     LIKWID_MARKER_CLOSE;
 #endif
 
-    if (test->dlhandle != NULL)
+    for (i=0; i<numberOfTests; i++)
     {
-        dynbench_close(test, compilepath);
+        if (tests[i]->dlhandle != NULL)
+        {
+            dynbench_close(tests[i], compilepath);
+        }
     }
+    free(tests);
 
     bdestroy(HLINE);
     bdestroy(asmFile);
@@ -129,6 +129,7 @@ while (defined(my $file = readdir(DIR))) {
         my $instr=-1;
         my $loop_instr=-1;
         my $uops = -1;
+        my $index = -1;
         open FILE, "<$BenchRoot/$file";
         while (<FILE>) {
             my $line = $_;
@@ -156,6 +157,8 @@ while (defined(my $file = readdir(DIR))) {
                 $loop_instr = $1;
             } elsif ($line =~ /UOPS[ ]+([0-9]+)/) {
                 $uops = $1;
+            } elsif ($line =~ /INDEX[ ]+([0-9]+)/) {
+                $index = $1;
             } elsif ($line =~ /DESC[ ]+([0-9a-zA-z ,.\-_\(\)\+\*\/=]+)/) {
                 $desc = $1;
             } elsif ($line =~ /INC[ ]+([0-9]+)/) {
@@ -212,7 +215,8 @@ while (defined(my $file = readdir(DIR))) {
                 branches    => $branches,
                 instr_const    => $instr,
                 instr_loop    => $loop_instr,
-                uops    => $uops});
+                uops    => $uops,
+                index    => $index});
     }
 }
 #print Dumper(@Testcases);
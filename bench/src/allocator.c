@@ -32,24 +32,370 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef HAS_MEMPOLICY
+#include <linux/mempolicy.h>
+#endif
 
 #include <allocator_types.h>
 #include <allocator.h>
 #include <likwid.h>
 
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define HUGEPAGE_2MB (2UL*1024*1024)
+#define HUGEPAGE_1GB (1024UL*1024*1024)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#ifdef HAS_MEMPOLICY
+#define mbind(start, len, mode, nmask, maxnode, flags) syscall(SYS_mbind,(start),len,mode,(nmask),maxnode,flags)
+#endif
+
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
 static int numberOfAllocatedVectors = 0;
 static allocation* allocList;
 static AffinityDomains_t domains = NULL;
+static int parallel_init = 1;
+
+typedef struct {
+    void* ptr;
+    uint64_t start;
+    uint64_t end;
+    DataType type;
+    int cpu;
+} InitChunk;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE  ################## */
+
+static const AffinityDomain*
+getDomain(const_bstring domainString)
+{
+    for (int i=0;i<domains->numberOfAffinityDomains;i++)
+    {
+        if (biseq(domainString, domains->domains[i].tag))
+        {
+            return domains->domains + i;
+        }
+    }
+    return NULL;
+}
+
+static void
+initVector(void* ptr, uint64_t start, uint64_t end, DataType type)
+{
+    switch ( type )
+    {
+        case INT:
+            {
+                int* sptr = (int*) ptr;
+                for ( uint64_t i=start; i < end; i++ )
+                {
+                    sptr[i] = 1;
+                }
+            }
+            break;
+
+        case SINGLE:
+            {
+                float* sptr = (float*) ptr;
+                for ( uint64_t i=start; i < end; i++ )
+                {
+                    sptr[i] = 1.0;
+                }
+            }
+            break;
+
+        case DOUBLE:
+            {
+                double* dptr = (double*) ptr;
+                for ( uint64_t i=start; i < end; i++ )
+                {
+                    dptr[i] = 1.0;
+                }
+            }
+            break;
+    }
+}
+
+static void*
+initChunk(void* arg)
+{
+    InitChunk* chunk = (InitChunk*) arg;
+    likwid_pinThread(chunk->cpu);
+    initVector(chunk->ptr, chunk->start, chunk->end, chunk->type);
+    return NULL;
+}
+
+/* Initialize the vector with all hwthreads of the domain, so the pages are
+ * touched first by the domain the vector should be placed in */
+static void
+initVectorParallel(void* ptr, uint64_t size, DataType type, const AffinityDomain* domain)
+{
+    int numThreads = domain->numberOfProcessors;
+    pthread_t* threads = NULL;
+    InitChunk* chunks = NULL;
+    uint64_t chunksize = 0;
+
+    if (numThreads > size)
+    {
+        numThreads = size;
+    }
+    if (numThreads <= 1)
+    {
+        initVector(ptr, 0, size, type);
+        return;
+    }
+    threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+    chunks = (InitChunk*) malloc(numThreads * sizeof(InitChunk));
+    if (!threads || !chunks)
+    {
+        free(threads);
+        free(chunks);
+        initVector(ptr, 0, size, type);
+        return;
+    }
+    chunksize = size / numThreads;
+    for (int i = 0; i < numThreads; i++)
+    {
+        chunks[i].ptr = ptr;
+        chunks[i].start = i * chunksize;
+        chunks[i].end = (i == numThreads - 1 ? size : (i+1) * chunksize);
+        chunks[i].type = type;
+        chunks[i].cpu = domain->processorList[i];
+        if (pthread_create(&threads[i], NULL, initChunk, &chunks[i]) != 0)
+        {
+            initChunk(&chunks[i]);
+            threads[i] = 0;
+        }
+    }
+    for (int i = 0; i < numThreads; i++)
+    {
+        if (threads[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    free(threads);
+    free(chunks);
+}
+
+static void
+interleaveVector(void* ptr, size_t bytesize, const_bstring interleave)
+{
+#ifdef HAS_MEMPOLICY
+    NumaTopology_t numa = get_numaTopology();
+    struct bstrList* tokens = NULL;
+    unsigned long* mask = NULL;
+    unsigned long maxnode = 0;
+    int masklen = 0;
+    int nodes = 0;
+
+    /* Node IDs may be sparse, the mask has to cover the largest one */
+    for (int n = 0; n < numa->numberOfNodes; n++)
+    {
+        if (numa->nodes[n].id + 1 > maxnode)
+        {
+            maxnode = numa->nodes[n].id + 1;
+        }
+    }
+    /* The kernel only evaluates maxnode - 1 bits of the mask */
+    maxnode++;
+    masklen = (maxnode / (8*sizeof(unsigned long))) + 1;
+    mask = (unsigned long*) calloc(masklen, sizeof(unsigned long));
+    if (!mask)
+    {
+        fprintf(stderr, "Error: Cannot allocate NUMA node mask for interleaving\n");
+        exit(EXIT_FAILURE);
+    }
+    tokens = bsplit(interleave, ',');
+    for (int i = 0; i < tokens->qty; i++)
+    {
+        const AffinityDomain* domain = getDomain(tokens->entry[i]);
+        if (!domain)
+        {
+            fprintf(stderr, "Error: Cannot interleave vector over domain %s, Domain %s does not exist.\n",
+                            bdata(tokens->entry[i]), bdata(tokens->entry[i]));
+            exit(EXIT_FAILURE);
+        }
+        /* An affinity domain covers all NUMA nodes its hwthreads belong to */
+        for (int n = 0; n < numa->numberOfNodes; n++)
+        {
+            for (int j = 0; j < domain->numberOfProcessors; j++)
+            {
+                int found = 0;
+                for (int k = 0; k < numa->nodes[n].numberOfProcessors; k++)
+                {
+                    if (numa->nodes[n].processors[k] == domain->processorList[j])
+                    {
+                        found = 1;
+                        break;
+                    }
+                }
+                if (found)
+                {
+                    int id = numa->nodes[n].id;
+                    if (!(mask[id / (8*sizeof(unsigned long))] & (1UL << (id % (8*sizeof(unsigned long))))))
+                    {
+                        mask[id / (8*sizeof(unsigned long))] |= (1UL << (id % (8*sizeof(unsigned long))));
+                        nodes++;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    bstrListDestroy(tokens);
+    if (nodes == 0)
+    {
+        fprintf(stderr, "Error: No NUMA nodes found for interleave domains %s\n", bdata(interleave));
+        exit(EXIT_FAILURE);
+    }
+    if (mbind(ptr, bytesize, MPOL_INTERLEAVE, mask, maxnode, 0) < 0)
+    {
+        fprintf(stderr, "Error: Cannot interleave vector over domains %s - %s\n", bdata(interleave), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    free(mask);
+#else
+    fprintf(stderr, "Warning: Interleaving of vectors not supported, memory policies not available\n");
+#endif
+}
+
+/* numa_maps reports the base page size for THP mappings, the amount of
+ * memory backed by huge pages is only listed in smaps */
+static long
+getAnonHugePages(uint64_t addr)
+{
+    FILE* fp = NULL;
+    char line[1024];
+    int inside = 0;
+    long kB = -1;
+
+    fp = fopen("/proc/self/smaps", "r");
+    if (!fp)
+    {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        uint64_t start = 0, end = 0;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+        {
+            inside = (start <= addr && addr < end);
+            continue;
+        }
+        if (inside && strncmp(line, "AnonHugePages:", 14) == 0)
+        {
+            kB = strtol(line + 14, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return kB;
+}
+
+/* Read the page size and the node placement of the mapping containing ptr
+ * from /proc/self/numa_maps */
+static void
+printVectorPlacement(allocation* alloc)
+{
+    FILE* fp = NULL;
+    char line[4096];
+    char best[4096];
+    uint64_t bestStart = 0;
+    uint64_t addr = (uint64_t) alloc->ptr;
+    int found = 0;
+    struct bstrList* tokens = NULL;
+    bstring nodes = bfromcstr("");
+    bstring pagesize = bfromcstr("4");
+    bstring policy = bfromcstr("");
+
+    fp = fopen("/proc/self/numa_maps", "r");
+    if (!fp)
+    {
+        fprintf(stderr, "Warning: Cannot read /proc/self/numa_maps - %s\n", strerror(errno));
+        bdestroy(nodes);
+        bdestroy(pagesize);
+        bdestroy(policy);
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        uint64_t start = strtoull(line, NULL, 16);
+        if (start <= addr && start >= bestStart)
+        {
+            bestStart = start;
+            strncpy(best, line, sizeof(best)-1);
+            best[sizeof(best)-1] = '\0';
+            found = 1;
+        }
+    }
+    fclose(fp);
+    if (found)
+    {
+        bstring bline = bfromcstr(best);
+        btrimws(bline);
+        tokens = bsplit(bline, ' ');
+        bdestroy(bline);
+        if (tokens->qty > 1)
+        {
+            bassign(policy, tokens->entry[1]);
+        }
+        for (int i = 2; i < tokens->qty; i++)
+        {
+            if (bdata(tokens->entry[i])[0] == 'N' && bstrchr(tokens->entry[i], '=') != BSTR_ERR)
+            {
+                bformata(nodes, " %s", bdata(tokens->entry[i]));
+            }
+            else if (strncmp(bdata(tokens->entry[i]), "kernelpagesize_kB=", 18) == 0)
+            {
+                bdestroy(pagesize);
+                pagesize = bmidstr(tokens->entry[i], 18, blength(tokens->entry[i]) - 18);
+            }
+        }
+        bstrListDestroy(tokens);
+    }
+    bcatcstr(pagesize, " kB");
+    if (alloc->pages == PAGES_THP)
+    {
+        long kB = getAnonHugePages(addr);
+        if (kB >= 0)
+        {
+            bformata(pagesize, " (%ld kB in transparent huge pages)", kB);
+        }
+    }
+    printf("Placement: Vector %p (Domain %s) - Page size %s Policy %s Pages per node:%s\n",
+            alloc->ptr,
+            bdata(alloc->domain),
+            bdata(pagesize),
+            (blength(policy) > 0 ? bdata(policy) : "unknown"),
+            (blength(nodes) > 0 ? bdata(nodes) : " none"));
+    bdestroy(nodes);
+    bdestroy(pagesize);
+    bdestroy(policy);
+}
 
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 void
-allocator_init(int numVectors)
+allocator_init(int numVectors, int parallelInit)
 {
     allocList = (allocation*) malloc(numVectors * sizeof(allocation));
     domains = get_affinityDomains();
+    parallel_init = parallelInit;
 }
 
 
@@ -60,7 +406,15 @@ allocator_finalize()
 
     for (i=0; i<numberOfAllocatedVectors; i++)
     {
-        free(allocList[i].ptr);
+        if (allocList[i].pages == PAGES_HUGE_2MB || allocList[i].pages == PAGES_HUGE_1GB)
+        {
+            munmap(allocList[i].ptr, allocList[i].mapsize);
+        }
+        else
+        {
+            free(allocList[i].ptr);
+        }
+        bdestroy(allocList[i].domain);
         allocList[i].ptr = NULL;
         allocList[i].size = 0;
         allocList[i].offset = 0;
@@ -88,6 +442,33 @@ allocator_dataTypeLength(DataType type)
     return 0;
 }
 
+int
+allocator_pageType(const_bstring str, PageType* pages)
+{
+    if (biseqcstrcaseless(str, "default") || biseqcstrcaseless(str, "4kB"))
+    {
+        *pages = PAGES_DEFAULT;
+    }
+    else if (biseqcstrcaseless(str, "THP"))
+    {
+        *pages = PAGES_THP;
+    }
+    else if (biseqcstrcaseless(str, "2MB"))
+    {
+        *pages = PAGES_HUGE_2MB;
+    }
+    else if (biseqcstrcaseless(str, "1GB"))
+    {
+        *pages = PAGES_HUGE_1GB;
+    }
+    else
+    {
+        fprintf(stderr, "Error: Unknown page type %s, available are default, THP, 2MB and 1GB\n", bdata(str));
+        return -EINVAL;
+    }
+    return 0;
+}
+
 void
 allocator_allocateVector(
         void** ptr,
@@ -97,10 +478,12 @@ allocator_allocateVector(
         DataType type,
         int stride,
         bstring domainString,
-        int init_per_thread)
+        int init_per_thread,
+        PageType pages,
+        const_bstring interleave)
 {
-    int i;
     size_t bytesize = 0;
+    size_t mapsize = 0;
     const AffinityDomain* domain = NULL;
     int errorCode;
     int elements = 0;
@@ -110,13 +493,7 @@ allocator_allocateVector(
     bytesize = (size+offset) * typesize;
     elements = alignment / typesize;
 
-    for (i=0;i<domains->numberOfAffinityDomains;i++)
-    {
-        if (biseq(domainString, domains->domains[i].tag))
-        {
-            domain = domains->domains + i;
-        }
-    }
+    domain = getDomain(domainString);
     if (!domain)
     {
         fprintf(stderr, "Error: Cannot use desired domain %s for vector placement, Domain %s does not exist.\n",
@@ -124,34 +501,72 @@ allocator_allocateVector(
         exit(EXIT_FAILURE);
     }
 
-    errorCode =  posix_memalign(ptr, alignment, bytesize);
-
-    if (errorCode)
+    if (pages == PAGES_HUGE_2MB || pages == PAGES_HUGE_1GB)
     {
-        if (errorCode == EINVAL)
+        size_t hugesize = (pages == PAGES_HUGE_2MB ? HUGEPAGE_2MB : HUGEPAGE_1GB);
+        int flags = MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB;
+        flags |= (pages == PAGES_HUGE_2MB ? MAP_HUGE_2MB : MAP_HUGE_1GB);
+        mapsize = ((bytesize + hugesize - 1) / hugesize) * hugesize;
+        *ptr = mmap(NULL, mapsize, PROT_READ|PROT_WRITE, flags, -1, 0);
+        if (*ptr == MAP_FAILED)
         {
-            fprintf(stderr,
-                    "Error: Alignment parameter is not a power of two\n");
+            fprintf(stderr, "Error: Cannot allocate %llu bytes with %s huge pages - %s\n",
+                            LLU_CAST mapsize,
+                            (pages == PAGES_HUGE_2MB ? "2MB" : "1GB"),
+                            strerror(errno));
+            fprintf(stderr, "Reserve enough huge pages in /sys/kernel/mm/hugepages/hugepages-%lukB/nr_hugepages\n",
+                            hugesize/1024);
             exit(EXIT_FAILURE);
         }
-        if (errorCode == ENOMEM)
+    }
+    else
+    {
+        if (pages == PAGES_THP && alignment < HUGEPAGE_2MB)
+        {
+            alignment = HUGEPAGE_2MB;
+        }
+        mapsize = ((bytesize + alignment - 1) / alignment) * alignment;
+        errorCode =  posix_memalign(ptr, alignment, mapsize);
+
+        if (errorCode)
+        {
+            if (errorCode == EINVAL)
+            {
+                fprintf(stderr,
+                        "Error: Alignment parameter is not a power of two\n");
+                exit(EXIT_FAILURE);
+            }
+            if (errorCode == ENOMEM)
+            {
+                fprintf(stderr,
+                        "Error: Insufficient memory to fulfill the request\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if ((*ptr) == NULL)
         {
-            fprintf(stderr,
-                    "Error: Insufficient memory to fulfill the request\n");
+            fprintf(stderr, "Error: posix_memalign failed!\n");
             exit(EXIT_FAILURE);
         }
+        if (pages == PAGES_THP && madvise(*ptr, mapsize, MADV_HUGEPAGE) != 0)
+        {
+            fprintf(stderr, "Warning: Cannot enable transparent huge pages for vector - %s\n", strerror(errno));
+        }
     }
 
-    if ((*ptr) == NULL)
+    if (interleave && blength(interleave) > 0)
     {
-        fprintf(stderr, "Error: posix_memalign failed!\n");
-        exit(EXIT_FAILURE);
+        interleaveVector(*ptr, mapsize, interleave);
     }
 
     allocList[numberOfAllocatedVectors].ptr = *ptr;
     allocList[numberOfAllocatedVectors].size = bytesize;
     allocList[numberOfAllocatedVectors].offset = offset;
     allocList[numberOfAllocatedVectors].type = type;
+    allocList[numberOfAllocatedVectors].pages = pages;
+    allocList[numberOfAllocatedVectors].mapsize = mapsize;
+    allocList[numberOfAllocatedVectors].domain = bstrcpy(domainString);
     numberOfAllocatedVectors++;
 
     affinity_pinProcess(domain->processorList[0]);
@@ -168,45 +583,168 @@ allocator_allocateVector(
         switch ( type )
         {
             case INT:
-                {
-                    int* sptr = (int*) (*ptr);
-                    sptr += offset;
-
-                    for ( uint64_t i=0; i < size; i++ )
-                    {
-                        sptr[i] = 1;
-                    }
-                    *ptr = (void*) sptr;
-
-                }
+                *ptr = (void*) (((int*) (*ptr)) + offset);
                 break;
-
             case SINGLE:
-                {
-                    float* sptr = (float*) (*ptr);
-                    sptr += offset;
+                *ptr = (void*) (((float*) (*ptr)) + offset);
+                break;
+            case DOUBLE:
+                *ptr = (void*) (((double*) (*ptr)) + offset);
+                break;
+        }
+        if (parallel_init)
+        {
+            initVectorParallel(*ptr, size, type, domain);
+        }
+        else
+        {
+            initVector(*ptr, 0, size, type);
+        }
+    }
+}
 
-                    for ( uint64_t i=0; i < size; i++ )
-                    {
-                        sptr[i] = 1.0;
-                    }
-                    *ptr = (void*) sptr;
+void
+allocator_printPlacement(void)
+{
+    for (int i=0; i<numberOfAllocatedVectors; i++)
+    {
+        printVectorPlacement(&allocList[i]);
+    }
+}
 
-                }
-                break;
+int
+allocator_indexPattern(const_bstring str, IndexPattern* pattern, int* param)
+{
+    int ret = 0;
+    struct bstrList* tokens = bsplit(str, ':');
 
-            case DOUBLE:
-                {
-                    double* dptr = (double*) (*ptr);
-                    dptr += offset;
+    *param = 1;
+    if (biseqcstrcaseless(tokens->entry[0], "linear") && tokens->qty == 1)
+    {
+        *pattern = INDEX_LINEAR;
+    }
+    else if (biseqcstrcaseless(tokens->entry[0], "random") && tokens->qty == 1)
+    {
+        *pattern = INDEX_RANDOM;
+    }
+    else if (biseqcstrcaseless(tokens->entry[0], "blocked") && tokens->qty == 2)
+    {
+        *pattern = INDEX_BLOCKED;
+        *param = atoi(bdata(tokens->entry[1]));
+    }
+    else if (biseqcstrcaseless(tokens->entry[0], "strided") && tokens->qty == 2)
+    {
+        *pattern = INDEX_STRIDED;
+        *param = atoi(bdata(tokens->entry[1]));
+    }
+    else
+    {
+        ret = -EINVAL;
+    }
+    if (ret == 0 && *param <= 0)
+    {
+        ret = -EINVAL;
+    }
+    if (ret != 0)
+    {
+        fprintf(stderr, "Error: Unknown index pattern %s, available are linear, random, blocked:<elements> and strided:<elements>\n", bdata(str));
+    }
+    bstrListDestroy(tokens);
+    return ret;
+}
 
-                    for ( uint64_t i=0; i < size; i++ )
-                    {
-                        dptr[i] = 1.0;
-                    }
-                    *ptr = (void*) dptr;
-                }
+const char*
+allocator_indexPatternName(IndexPattern pattern)
+{
+    switch (pattern)
+    {
+        case INDEX_LINEAR:
+            return "linear";
+        case INDEX_RANDOM:
+            return "random";
+        case INDEX_BLOCKED:
+            return "blocked";
+        case INDEX_STRIDED:
+            return "strided";
+    }
+    return "unknown";
+}
+
+/* Fill an index vector with a permutation of [0, size). The indices have the
+ * width of the data type, so the index stream can be offset and chunked like
+ * all other streams of a kernel. */
+void
+allocator_initIndices(void* ptr,
+                uint64_t size,
+                DataType type,
+                IndexPattern pattern,
+                int param,
+                unsigned int seed)
+{
+    uint64_t* perm = NULL;
+    uint64_t numBlocks = 0;
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ seed;
+
+    if (size == 0)
+    {
+        return;
+    }
+    if (pattern == INDEX_BLOCKED || pattern == INDEX_RANDOM)
+    {
+        uint64_t blocksize = (pattern == INDEX_BLOCKED ? param : 1);
+        numBlocks = (size + blocksize - 1) / blocksize;
+        perm = (uint64_t*) malloc(numBlocks * sizeof(uint64_t));
+        if (!perm)
+        {
+            fprintf(stderr, "Error: Cannot allocate permutation for index vector\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t i = 0; i < numBlocks; i++)
+        {
+            perm[i] = i;
+        }
+        /* Fisher-Yates shuffle with xorshift64, deterministic for a seed */
+        for (uint64_t i = numBlocks - 1; i > 0; i--)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            uint64_t j = state % (i + 1);
+            uint64_t t = perm[i];
+            perm[i] = perm[j];
+            perm[j] = t;
+        }
+    }
+    for (uint64_t k = 0; k < size; k++)
+    {
+        uint64_t idx = k;
+        switch (pattern)
+        {
+            case INDEX_LINEAR:
+                idx = k;
+                break;
+            case INDEX_RANDOM:
+                idx = perm[k];
+                break;
+            case INDEX_BLOCKED:
+                idx = perm[k / param] * param + (k % param);
                 break;
+            case INDEX_STRIDED:
+                idx = ((k * param) % size) + ((k * param) / size);
+                break;
+        }
+        if (idx >= size)
+        {
+            idx %= size;
+        }
+        if (type == DOUBLE)
+        {
+            ((int64_t*)ptr)[k] = (int64_t)idx;
+        }
+        else
+        {
+            ((int32_t*)ptr)[k] = (int32_t)idx;
         }
     }
+    free(perm);
 }
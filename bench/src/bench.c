@@ -48,7 +48,11 @@
 /* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
 
 #define BARRIER   barrier_synchronize(&barr)
+#define GROUP_BARRIER   barrier_synchronize(&groupBarr)
 
+/* All threads start together but each workgroup stops its own clock, so
+ * workgroups running different kernels are measured independently while
+ * they interfere with each other */
 #define EXECUTE(func)   \
     LIKWID_MARKER_REGISTER("bench");  \
     BARRIER; \
@@ -58,7 +62,7 @@
     {   \
         func; \
     } \
-    BARRIER; \
+    GROUP_BARRIER; \
     timer_stop(&time); \
     LIKWID_MARKER_STOP("bench");  \
     data->cycles = timer_printCycles(&time); \
@@ -77,6 +81,7 @@ runTest(void* arg)
     size_t i;
     size_t j = 0;
     BarrierData barr;
+    BarrierData groupBarr;
     ThreadData* data;
     ThreadUserData* myData;
     TimerData time;
@@ -87,6 +92,7 @@ runTest(void* arg)
     func = myData->test->kernel;
     threadId = data->threadId;
     barrier_registerThread(&barr, 0, data->globalThreadId);
+    barrier_registerThread(&groupBarr, data->groupId + 1, data->threadId);
 
     /* Prepare ptrs for thread */
     vecsize = myData->size / data->numberOfThreads;
@@ -168,6 +174,16 @@ runTest(void* arg)
             break;
     }
 
+    if (myData->init_per_thread && myData->test->indexStream >= 0)
+    {
+        allocator_initIndices(myData->streams[myData->test->indexStream],
+                              size,
+                              myData->test->type,
+                              myData->indexPattern,
+                              myData->indexParam,
+                              data->globalThreadId + 1);
+    }
+
     BARRIER;
 
     /* Up to 10 streams the following registers are used for Array ptr:
@@ -459,6 +475,7 @@ runTest(void* arg)
             break;
     }
     free(barr.index);
+    free(groupBarr.index);
     pthread_exit(NULL);
 }
 
@@ -567,6 +584,16 @@ getIterSingle(void* arg)
             break;
     }
 
+    if (myData->init_per_thread && myData->test->indexStream >= 0)
+    {
+        allocator_initIndices(myData->streams[myData->test->indexStream],
+                              size,
+                              myData->test->type,
+                              myData->indexPattern,
+                              myData->indexParam,
+                              data->globalThreadId + 1);
+    }
+
     switch ( myData->test->streams ) {
         case STREAM_1:
             MEASURE(func(size,myData->streams[0]));
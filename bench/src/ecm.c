@@ -0,0 +1,334 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  ecm.c
+ *
+ *      Description:  Execution-Cache-Memory (ECM) model predictions for the benchmark kernels
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:  Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include <test_types.h>
+#include <threads.h>
+#include <allocator.h>
+#include <ecm_types.h>
+#include <ecm.h>
+#include <likwid.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#ifndef MIN
+#define MIN(x,y) ((x)<(y)?(x):(y))
+#endif
+#ifndef MAX
+#define MAX(x,y) ((x)>(y)?(x):(y))
+#endif
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* Nominal values per microarchitecture: issue width, load and store ports,
+ * floating-point ports and the bytes per cycle between L1 and L2 and between
+ * L2 and L3 */
+static EcmMachine ecm_machines[] = {
+    {"sandybridge", 4, 2, 1, 2, 32, 32},
+    {"sandybridgeEP", 4, 2, 1, 2, 32, 32},
+    {"ivybridge", 4, 2, 1, 2, 32, 32},
+    {"ivybridgeEP", 4, 2, 1, 2, 32, 32},
+    {"haswell", 4, 2, 1, 2, 64, 32},
+    {"haswellEP", 4, 2, 1, 2, 64, 32},
+    {"broadwell", 4, 2, 1, 2, 64, 32},
+    {"broadwellD", 4, 2, 1, 2, 64, 32},
+    {"broadwellEP", 4, 2, 1, 2, 64, 32},
+    {"skylake", 4, 2, 1, 2, 64, 32},
+    {"skylakeX", 4, 2, 1, 2, 64, 16},
+    {"CLX", 4, 2, 1, 2, 64, 16},
+    {"ICL", 5, 2, 2, 2, 64, 32},
+    {"TGL", 5, 2, 2, 2, 64, 32},
+    {"RKL", 5, 2, 2, 2, 64, 32},
+    {"ICX", 5, 2, 2, 2, 64, 16},
+    {"SPR", 6, 3, 2, 2, 64, 16},
+    {"zen", 5, 2, 1, 2, 32, 32},
+    {"zen2", 5, 2, 1, 2, 32, 32},
+    {"zen3", 6, 3, 2, 2, 32, 32},
+    {"zen4", 6, 3, 2, 2, 32, 32},
+    {NULL, 0, 0, 0, 0, 0, 0},
+};
+
+static EcmMachine ecm_generic = {"generic", 4, 2, 1, 2, 32, 16};
+
+static const EcmMachine* ecm_machine = NULL;
+
+/* Saturated memory bandwidth of one socket in bytes per second */
+static double ecm_memBandwidth = 0.0;
+
+static int ecm_active = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static const EcmMachine*
+ecm_getMachine(void)
+{
+    if (ecm_machine == NULL)
+    {
+        CpuInfo_t info = get_cpuInfo();
+        ecm_machine = &ecm_generic;
+        for (int i = 0; info && info->short_name && ecm_machines[i].name != NULL; i++)
+        {
+            if (strcmp(ecm_machines[i].name, info->short_name) == 0)
+            {
+                ecm_machine = &ecm_machines[i];
+                break;
+            }
+        }
+    }
+    return ecm_machine;
+}
+
+/* The kernels carry no vector width, it is taken from the naming scheme of
+ * the kernels */
+static int
+ecm_vectorBytes(const TestCase* test, int typesize)
+{
+    static const struct {
+        const char* tag;
+        int bytes;
+    } widths[] = {
+        {"avx512", 64}, {"avx", 32}, {"sse", 16},
+        {"sve512", 64}, {"sve256", 32}, {"sve128", 16},
+        {"neon", 16}, {"vsx", 16}, {NULL, 0},
+    };
+    for (int i = 0; widths[i].tag != NULL; i++)
+    {
+        if (strstr(test->name, widths[i].tag) != NULL)
+        {
+            return widths[i].bytes;
+        }
+    }
+    return typesize;
+}
+
+/* Kernels with non-temporal stores bypass the caches */
+static int
+ecm_nonTemporal(const TestCase* test)
+{
+    return (strstr(test->name, "_mem") != NULL || strstr(test->name, "_nt") != NULL);
+}
+
+/* Index of the memory level holding the working set of a thread: 1 to the
+ * number of cache levels for the caches or one more for the main memory */
+static int
+ecm_dataLevel(uint64_t bytesPerThread, int numberOfThreads, int* numberOfLevels)
+{
+    CpuTopology_t topo = get_cpuTopology();
+    int level = 0;
+    int found = 0;
+    for (int i = 0; i < topo->numCacheLevels; i++)
+    {
+        CacheLevel* c = &topo->cacheLevels[i];
+        if (c->type == INSTRUCTIONCACHE)
+        {
+            continue;
+        }
+        level++;
+        int sharing = MIN((int)c->threads, numberOfThreads);
+        if (!found && bytesPerThread <= c->size / MAX(sharing, 1))
+        {
+            found = level;
+        }
+        if (level == 3)
+        {
+            break;
+        }
+    }
+    *numberOfLevels = level;
+    return (found ? found : level + 1);
+}
+
+static int
+ecm_numberOfSockets(int* threadIds, int numberOfThreads)
+{
+    CpuTopology_t topo = get_cpuTopology();
+    int sockets = 0;
+    int* seen = calloc(topo->numSockets > 0 ? topo->numSockets : 1, sizeof(int));
+    if (!seen)
+    {
+        return 1;
+    }
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        ThreadData* t = &threads_data[threadIds[i]];
+        int cpu = t->data.processors[t->threadId];
+        for (int j = 0; j < topo->numHWThreads; j++)
+        {
+            if ((int)topo->threadPool[j].apicId == cpu &&
+                topo->threadPool[j].packageId < topo->numSockets &&
+                !seen[topo->threadPool[j].packageId])
+            {
+                seen[topo->threadPool[j].packageId] = 1;
+                sockets++;
+            }
+        }
+    }
+    free(seen);
+    return MAX(sockets, 1);
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+ecm_init(const char* memBandwidth)
+{
+    char* end = NULL;
+    double bw = strtod(memBandwidth, &end);
+    if (end == memBandwidth || *end != '\0' || bw < 0)
+    {
+        return -EINVAL;
+    }
+    ecm_memBandwidth = bw * 1.0E09;
+    ecm_active = 1;
+    return 0;
+}
+
+int
+ecm_enabled(void)
+{
+    return ecm_active;
+}
+
+/* The unit of work is one cache line of each stream. In-core, the arithmetic
+ * and the issue of all instructions overlap with the data transfers, while
+ * the loads and stores in L1 and the transfers between the memory levels do
+ * not overlap. */
+void
+ecm_getModel(const TestCase* test, int clsize, double cyclesClock, EcmModel* model)
+{
+    const EcmMachine* m = ecm_getMachine();
+    int typesize = allocator_dataTypeLength(test->type);
+    int vecBytes = ecm_vectorBytes(test, typesize);
+    double elems = (double)clsize / typesize;
+    double loads = MAX(test->loads, 0);
+    double stores = MAX(test->stores, 0);
+    double fma = (strstr(test->name, "fma") != NULL ? 2.0 : 1.0);
+    double loadInstr = loads * clsize / vecBytes;
+    double storeInstr = stores * clsize / vecBytes;
+    /* Stored streams that are not loaded need a write-allocate */
+    double writeAllocs = MAX(0.0, MIN(stores, (double)test->streams - loads));
+    double cacheLines = loads + stores + writeAllocs;
+    double memLines = cacheLines;
+
+    if (ecm_nonTemporal(test))
+    {
+        cacheLines = loads;
+        memLines = loads + stores;
+    }
+    model->tOL = (elems * test->flops) / (m->fpPorts * ((double)vecBytes / typesize) * fma);
+    if (test->uops > 0 && test->stride > 0)
+    {
+        model->tOL = MAX(model->tOL, (elems / test->stride) * test->uops / m->issueWidth);
+    }
+    model->tnOL = MAX(loadInstr / m->loadPorts, storeInstr / m->storePorts);
+    model->tL1L2 = cacheLines * clsize / m->l1l2Bytes;
+    model->tL2L3 = cacheLines * clsize / m->l2l3Bytes;
+    model->tL3Mem = 0.0;
+    if (ecm_memBandwidth > 0)
+    {
+        model->tL3Mem = memLines * clsize * cyclesClock / ecm_memBandwidth;
+    }
+}
+
+void
+ecm_printPrediction(const TestCase* test, int* threadIds, int numberOfThreads,
+                    uint64_t cyclesClock, int clsize, double measuredCycPerCL)
+{
+    EcmModel model;
+    double pred[4];
+    int numberOfLevels = 0;
+    const char* names[] = {"L1", "L2", "L3", "MEM"};
+    ThreadData* first = &threads_data[threadIds[0]];
+    uint64_t bytesPerThread = first->data.size * allocator_dataTypeLength(test->type) * test->streams;
+    const EcmMachine* m = ecm_getMachine();
+
+    ecm_getModel(test, clsize, (double)cyclesClock, &model);
+    int level = ecm_dataLevel(bytesPerThread, numberOfThreads, &numberOfLevels);
+    /* Without a third cache level, the memory is the next level after L2 */
+    double tL2L3 = (numberOfLevels >= 3 ? model.tL2L3 : 0.0);
+    pred[0] = MAX(model.tOL, model.tnOL);
+    pred[1] = MAX(model.tOL, model.tnOL + model.tL1L2);
+    pred[2] = MAX(model.tOL, model.tnOL + model.tL1L2 + tL2L3);
+    pred[3] = MAX(model.tOL, model.tnOL + model.tL1L2 + tL2L3 + model.tL3Mem);
+    int idx = (level > numberOfLevels ? 3 : level - 1);
+
+    printf("ECM machine model:\t%s (issue %d, load %d, store %d, FP %d, L1-L2 %d B/cy, L2-L3 %d B/cy",
+            m->name, m->issueWidth, m->loadPorts, m->storePorts, m->fpPorts, m->l1l2Bytes, m->l2l3Bytes);
+    if (ecm_memBandwidth > 0)
+    {
+        printf(", MEM %.2f GB/s", ecm_memBandwidth * 1.0E-09);
+    }
+    printf(")\n");
+    printf("ECM contributions:\t{ %.2f || %.2f | %.2f | %.2f | ", model.tOL, model.tnOL, model.tL1L2, tL2L3);
+    if (ecm_memBandwidth > 0)
+    {
+        printf("%.2f } cy/CL\n", model.tL3Mem);
+    }
+    else
+    {
+        printf("- } cy/CL\n");
+    }
+    printf("ECM prediction:\t\t{ %.2f ] %.2f ] %.2f ] ", pred[0], pred[1], pred[2]);
+    if (ecm_memBandwidth > 0)
+    {
+        printf("%.2f } cy/CL\n", pred[3]);
+    }
+    else
+    {
+        printf("- } cy/CL\n");
+    }
+    printf("ECM data location:\t%s\n", names[idx]);
+    if (idx == 3 && ecm_memBandwidth <= 0)
+    {
+        printf("ECM cycles per CL:\t- (memory bandwidth required)\n");
+        return;
+    }
+    /* The caches scale with the number of cores, the memory bandwidth
+     * saturates per socket */
+    double predicted = pred[idx] / numberOfThreads;
+    if (idx == 3)
+    {
+        int sockets = ecm_numberOfSockets(threadIds, numberOfThreads);
+        predicted = MAX(predicted, model.tL3Mem / sockets);
+        printf("ECM saturation point:\t%d cores per socket\n", (int)ceil(pred[3] / model.tL3Mem));
+    }
+    printf("ECM cycles per CL:\t%f\n", predicted);
+    if (measuredCycPerCL > 0)
+    {
+        printf("ECM efficiency:\t\t%.2f %%\n", 100.0 * predicted / measuredCycPerCL);
+    }
+}
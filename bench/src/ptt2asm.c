@@ -171,6 +171,7 @@ static struct bstrList* analyse_ptt(bstring pttfile, TestCase** testcase)
     bstring bINSTCONST = bformat("INSTR_CONST");
     bstring bINSTLOOP = bformat("INSTR_LOOP");
     bstring bUOPS = bformat("UOPS");
+    bstring bINDEX = bformat("INDEX");
     bstring bBRANCHES = bformat("BRANCHES");
     bstring bLOOP = bformat("LOOP");
     int (*ownatoi)(const char*) = &atoi;
@@ -189,6 +190,7 @@ static struct bstrList* analyse_ptt(bstring pttfile, TestCase** testcase)
             test->instr_const = -1;
             test->instr_loop = -1;
             test->uops = -1;
+            test->indexStream = -1;
             code = bstrListCreate();
             for (int i = 0; i < ptt->qty; i++)
             {
@@ -228,6 +230,10 @@ static struct bstrList* analyse_ptt(bstring pttfile, TestCase** testcase)
                 {
                     ANALYSE_PTT_GET_INT(ptt->entry[i], bUOPS, test->uops);
                 }
+                else if (bstrncmp(ptt->entry[i], bINDEX, blength(bINDEX)) == BSTR_OK)
+                {
+                    ANALYSE_PTT_GET_INT(ptt->entry[i], bINDEX, test->indexStream);
+                }
                 else if (bstrncmp(ptt->entry[i], bBRANCHES, blength(bBRANCHES)) == BSTR_OK)
                 {
                     ANALYSE_PTT_GET_INT(ptt->entry[i], bBRANCHES, test->branches);
@@ -301,6 +307,7 @@ static struct bstrList* analyse_ptt(bstring pttfile, TestCase** testcase)
     bdestroy(bINSTCONST);
     bdestroy(bINSTLOOP);
     bdestroy(bUOPS);
+    bdestroy(bINDEX);
     bdestroy(bBRANCHES);
     bdestroy(bLOOP);
     return code;
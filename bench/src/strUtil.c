@@ -343,7 +343,7 @@ bstr_to_workgroup(Workgroup* group, const_bstring str, DataType type, int number
 }
 
 void
-workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStreams)
+workgroups_destroy(Workgroup** groupList, int numberOfGroups)
 {
     int i = 0, j = 0;
     if (groupList == NULL)
@@ -354,7 +354,10 @@ workgroups_destroy(Workgroup** groupList, int numberOfGroups, int numberOfStream
     for (i = 0; i < numberOfGroups; i++)
     {
         free(list[i].processorIds);
-        for (j = 0; j < numberOfStreams; j++)
+        bdestroy(list[i].interleave);
+        if ((list[i].streams == NULL) || (list[i].test == NULL))
+            continue;
+        for (j = 0; j < list[i].test->streams; j++)
         {
             bdestroy(list[i].streams[j].domain);
         }
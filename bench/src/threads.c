@@ -235,7 +235,7 @@ size_t
 threads_updateIterations(int groupId, size_t demandIter)
 {
     int i = 0;
-    size_t iterations = threads_data[0].data.iter;
+    size_t iterations = threads_data[threads_groups[groupId].threadIds[0]].data.iter;
     if (demandIter > 0)
     {
         iterations = demandIter;
@@ -3555,6 +3555,30 @@ static void handle_record_spr(AccessDataRecord *record)
     }
 }
 
+/* access_client_writeBatch() sends many records in one go, reads from the
+ * stream socket are not aligned to records then */
+static int
+read_record(int fd, AccessDataRecord *rec)
+{
+    size_t off = 0;
+    while (off < sizeof(AccessDataRecord))
+    {
+        ssize_t ret = read(fd, ((char*)rec) + off, sizeof(AccessDataRecord) - off);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        else if (ret == 0)
+        {
+            break;
+        }
+        off += ret;
+    }
+    return off;
+}
+
 /* #####  MAIN FUNCTION DEFINITION   ################## */
 
 int main(void)
@@ -3963,7 +3987,7 @@ int main(void)
 LOOP:
     while (1)
     {
-        ret = read(connfd, (void*) &dRecord, sizeof(AccessDataRecord));
+        ret = read_record(connfd, &dRecord);
 
         if (ret < 0)
         {
@@ -555,6 +555,11 @@ static int freq_read(FreqDataRecord *rec)
 {
     int read_fd = -1;
     int cpu = rec->cpu;
+    if (rec->cpu >= (uint32_t)avail_cpus)
+    {
+        rec->errorcode = FREQ_ERR_NOFILE;
+        return -1;
+    }
     struct cpufreq_files* f = &cpufiles[cpu];
     switch(rec->loc)
     {
@@ -579,7 +584,7 @@ static int freq_read(FreqDataRecord *rec)
         return -1;
     }
     rec->data[0] = '\0';
-    int ret = read(read_fd, rec->data, LIKWID_FREQUENCY_MAX_DATA_LENGTH);
+    int ret = pread(read_fd, rec->data, LIKWID_FREQUENCY_MAX_DATA_LENGTH - 1, 0);
     if (ret < 0)
     {
         rec->data[0] = '\0';
@@ -599,6 +604,11 @@ static int freq_write(FreqDataRecord *rec)
     int cpu = rec->cpu;
     int check_freq = 0;
     int check_gov = 0;
+    if (rec->cpu >= (uint32_t)avail_cpus)
+    {
+        rec->errorcode = FREQ_ERR_NOFILE;
+        return -1;
+    }
     struct cpufreq_files* f = &cpufiles[cpu];
 
     switch(rec->loc)
@@ -663,6 +673,29 @@ static int freq_write(FreqDataRecord *rec)
     return 0;
 }
 
+/* The client may pipeline several records, so a single read() can return
+ * a partial record. Collect the whole record before handling it. */
+static int read_record(int fd, FreqDataRecord *rec)
+{
+    size_t off = 0;
+    while (off < sizeof(FreqDataRecord))
+    {
+        ssize_t ret = read(fd, ((char*)rec) + off, sizeof(FreqDataRecord) - off);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        else if (ret == 0)
+        {
+            break;
+        }
+        off += ret;
+    }
+    return off;
+}
+
 
 /* #####  MAIN FUNCTION DEFINITION   ################## */
 
@@ -778,14 +811,14 @@ LOOP:
     //syslog(LOG_ERR, "Starting loop %d\n", avail_cpus);
     while (1)
     {
-        ret = read(connfd, (void*) &dRecord, sizeof(FreqDataRecord));
+        ret = read_record(connfd, &dRecord);
 
         if (ret < 0)
         {
             syslog(LOG_ERR, "ERROR - Read returns %d", ret);
             stop_daemon();
         }
-        else if ((ret == 0) && (dRecord.type != FREQ_EXIT))
+        else if ((ret < (int)sizeof(FreqDataRecord)) && (dRecord.type != FREQ_EXIT))
         {
             syslog(LOG_ERR, "ERROR - [%s:%d] zero read, remote socket closed before reading", __FILE__, __LINE__);
             stop_daemon();
@@ -51,7 +51,9 @@
 #include <registers.h>
 #include <access.h>
 #include <access_client.h>
+#include <register_program.h>
 #include <access_x86.h>
+#include <access_sim.h>
 
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
@@ -60,6 +62,7 @@ static int registeredCpus = 0;
 static int *registeredCpuList = NULL;
 static int (*access_read)(PciDeviceIndex dev, const int cpu, uint32_t reg, uint64_t *data) = NULL;
 static int (*access_write)(PciDeviceIndex dev, const int cpu, uint32_t reg, uint64_t data) = NULL;
+static int (*access_writeBatch)(const int cpu, int count, HPMWriteRecord* writes) = NULL;
 static int (*access_init) (int cpu_id) = NULL;
 static void (*access_finalize) (int cpu_id) = NULL;
 static int (*access_check) (PciDeviceIndex dev, int cpu_id) = NULL;
@@ -69,7 +72,7 @@ static int (*access_check) (PciDeviceIndex dev, int cpu_id) = NULL;
 void
 HPMmode(int mode)
 {
-    if ((mode == ACCESSMODE_DIRECT) || (mode == ACCESSMODE_DAEMON) || (mode == ACCESSMODE_PERF))
+    if ((mode == ACCESSMODE_DIRECT) || (mode == ACCESSMODE_DAEMON) || (mode == ACCESSMODE_PERF) || (mode == ACCESSMODE_SIM))
     {
         config.daemonMode = mode;
     }
@@ -99,6 +102,7 @@ HPMinit(void)
             access_init = &access_client_init;
             access_read = &access_client_read;
             access_write = &access_client_write;
+            access_writeBatch = &access_client_writeBatch;
             access_finalize = &access_client_finalize;
             access_check = &access_client_check;
         }
@@ -112,6 +116,15 @@ HPMinit(void)
             access_check = &access_x86_check;
         }
 #endif
+        if (config.daemonMode == ACCESSMODE_SIM)
+        {
+            DEBUG_PLAIN_PRINT(DEBUGLEV_DEVELOP, Adjusting functions for simulated registers);
+            access_init = &access_sim_init;
+            access_read = &access_sim_read;
+            access_write = &access_sim_write;
+            access_finalize = &access_sim_finalize;
+            access_check = &access_sim_check;
+        }
     }
 
     return 0;
@@ -185,6 +198,8 @@ HPMfinalize()
         access_read = NULL;
     if (access_write != NULL)
         access_write = NULL;
+    if (access_writeBatch != NULL)
+        access_writeBatch = NULL;
     if (access_check != NULL)
         access_check = NULL;
     return;
@@ -231,6 +246,51 @@ HPMwrite(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t data)
         return -ENODEV;
     }
     err = access_write(dev, cpu_id, reg, data);
+    if (regprog_tracking && err == 0)
+    {
+        regprog_observe(cpu_id, dev, reg, data);
+    }
+    return err;
+}
+
+int
+HPMwriteBatch(int cpu_id, int count, HPMWriteRecord* writes)
+{
+    int err = 0;
+    if ((cpu_id < 0) || (cpu_id >= cpuid_topology.numHWThreads))
+    {
+        ERROR_PRINT(MSR WRITE C %d OUT OF RANGE, cpu_id);
+        return -ERANGE;
+    }
+    if (registeredCpuList[cpu_id] == 0)
+    {
+        return -ENODEV;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (writes[i].dev >= MAX_NUM_PCI_DEVICES)
+        {
+            return -EFAULT;
+        }
+    }
+    if (access_writeBatch != NULL)
+    {
+        err = access_writeBatch(cpu_id, count, writes);
+    }
+    else
+    {
+        for (int i = 0; i < count && err == 0; i++)
+        {
+            err = access_write(writes[i].dev, cpu_id, writes[i].reg, writes[i].data);
+        }
+    }
+    if (regprog_tracking && err == 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            regprog_observe(cpu_id, writes[i].dev, writes[i].reg, writes[i].data);
+        }
+    }
     return err;
 }
 
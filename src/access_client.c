@@ -58,6 +58,8 @@
 #endif
 
 #define gettid() syscall(SYS_gettid)
+/* Maximal number of records sent to the daemon before reading the replies */
+#define ACCESS_CLIENT_BATCH 128
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -604,6 +606,124 @@ access_client_write(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t
     return 0;
 }
 
+/* Write or read a whole buffer, a short transfer means the daemon is gone */
+static int
+access_client_transfer(int socket, int write_data, char* buf, size_t len)
+{
+    size_t off = 0;
+    while (off < len)
+    {
+        ssize_t ret = (write_data ? write(socket, buf + off, len - off) : read(socket, buf + off, len - off));
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        else if (ret == 0)
+        {
+            return -EPIPE;
+        }
+        off += ret;
+    }
+    return 0;
+}
+
+/* Send all write requests at once and collect the replies afterwards. The
+ * daemon handles the records one after the other, so it is one round trip
+ * instead of one per register. */
+int
+access_client_writeBatch(const int cpu_id, int count, HPMWriteRecord* writes)
+{
+    int socket = globalSocket;
+    int err = 0;
+    int ret = 0;
+    pthread_mutex_t* lockptr = &globalLock;
+    AccessDataRecord records[ACCESS_CLIENT_BATCH];
+
+    if (cpuSockets_open == 0)
+    {
+        return -ENOENT;
+    }
+
+    if (cpuSockets[cpu_id] < 0 && gettid() != masterPid)
+    {
+        pthread_mutex_lock(&cpuLocks[cpu_id]);
+        cpuSockets[cpu_id] = access_client_startDaemon(cpu_id);
+        cpuSockets_open++;
+        if (!daemon_pinned[cpu_id])
+        {
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpu_id, &cpuset);
+            DEBUG_PRINT(DEBUGLEV_INFO, Pinning daemon %d to CPU %d, daemon_pids[cpu_id], cpu_id);
+            sched_setaffinity(daemon_pids[cpu_id], sizeof(cpu_set_t), &cpuset);
+            daemon_pinned[cpu_id] = 1;
+        }
+        pthread_mutex_unlock(&cpuLocks[cpu_id]);
+    }
+
+    if ((cpuSockets[cpu_id] >= 0) && (cpuSockets[cpu_id] != socket))
+    {
+        socket = cpuSockets[cpu_id];
+        lockptr = &cpuLocks[cpu_id];
+    }
+    if (socket == -1)
+    {
+        return -EBADFD;
+    }
+
+    for (int start = 0; start < count; start += ACCESS_CLIENT_BATCH)
+    {
+        int n = MIN(count - start, ACCESS_CLIENT_BATCH);
+        size_t size = n * sizeof(AccessDataRecord);
+        memset(records, 0, size);
+        for (int i = 0; i < n; i++)
+        {
+            HPMWriteRecord* w = &writes[start + i];
+            records[i].cpu = cpu_id;
+            records[i].device = MSR_DEV;
+            if (w->dev != MSR_DEV)
+            {
+                records[i].cpu = affinity_thread2socket_lookup[cpu_id];
+                records[i].device = w->dev;
+            }
+            records[i].reg = w->reg;
+            records[i].data = w->data;
+            records[i].type = DAEMON_WRITE;
+            records[i].errorcode = ERR_OPENFAIL;
+        }
+        pthread_mutex_lock(lockptr);
+        ret = access_client_transfer(socket, 1, (char*)records, size);
+        if (ret < 0)
+        {
+            pthread_mutex_unlock(lockptr);
+            ERROR_PRINT(socket write failed);
+            return ret;
+        }
+        ret = access_client_transfer(socket, 0, (char*)records, size);
+        pthread_mutex_unlock(lockptr);
+        if (ret < 0)
+        {
+            ERROR_PRINT(socket read failed);
+            return ret;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            if (records[i].errorcode != ERR_NOERROR)
+            {
+                DEBUG_PRINT(DEBUGLEV_DEVELOP, Got error '%s' from access daemon writing reg 0x%X at CPU %d,
+                            access_client_strerror(records[i].errorcode), records[i].reg, records[i].cpu);
+                if (err == 0)
+                {
+                    err = access_client_errno(records[i].errorcode);
+                }
+            }
+        }
+    }
+    return err;
+}
+
 void
 access_client_finalize(int cpu_id)
 {
@@ -0,0 +1,550 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  access_sim.c
+ *
+ *      Description:  Simulated register backend for the access module. All MSR and
+ *                    PCI registers live in an in-memory register file per hardware
+ *                    thread. The evolution of counter registers can be scripted with
+ *                    the file given in the LIKWID_SIM_SCRIPT environment variable.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/*
+ * Script syntax (one directive per line, '#' starts a comment, numbers may be
+ * given in decimal or hex, <dev> is MSR or the numeric PciDeviceIndex):
+ *
+ *   cpu <all|id>                                 Apply following directives to all or one CPU
+ *   device <dev>                                 Report device as available in HPMcheck
+ *   value <dev> <reg> <value>                    Preset register value
+ *   counter <dev> <reg> <increment> [<width>]    Advance register by increment on every
+ *                                                read, wrap around at width bits (default 48)
+ *   overflow <dev> <reg> <status> <bit>          Set bit in status register when register wraps
+ *   clear <dev> <reg> <status>                   Writes to reg clear the written bits in status
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <pthread.h>
+
+#include <types.h>
+#include <error.h>
+#include <topology.h>
+#include <access_sim.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define SIM_DEFAULT_WIDTH 48
+#define SIM_INITIAL_SLOTS 256
+#define SIM_MAX_LINE 512
+
+/* #####   TYPE DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ############### */
+
+typedef enum {
+    SIM_RULE_VALUE = 0,
+    SIM_RULE_COUNTER,
+    SIM_RULE_OVERFLOW,
+    SIM_RULE_CLEAR,
+} SimRuleType;
+
+typedef struct {
+    SimRuleType type;
+    int cpu;
+    PciDeviceIndex dev;
+    uint32_t reg;
+    uint64_t value;
+    int width;
+    uint32_t status;
+    int bit;
+} SimRule;
+
+typedef struct {
+    int used;
+    PciDeviceIndex dev;
+    uint32_t reg;
+    uint64_t value;
+    uint64_t increment;
+    uint64_t mask;
+    int overflow;
+    uint32_t status;
+    uint64_t statusBits;
+    int clear;
+    uint32_t clearStatus;
+} SimRegister;
+
+typedef struct {
+    int numSlots;
+    int numUsed;
+    SimRegister* slots;
+    pthread_mutex_t lock;
+} SimRegisterFile;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static pthread_mutex_t sim_init_lock = PTHREAD_MUTEX_INITIALIZER;
+static int sim_script_read = 0;
+static SimRule* sim_rules = NULL;
+static int sim_num_rules = 0;
+static int sim_devices[MAX_NUM_PCI_DEVICES] = { [MSR_DEV] = 1 };
+static SimRegisterFile** sim_files = NULL;
+static int sim_num_files = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static inline uint64_t
+sim_hash(PciDeviceIndex dev, uint32_t reg)
+{
+    uint64_t key = (((uint64_t)dev) << 32) | reg;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/* Slot of the register or the free slot where it would be inserted */
+static int
+sim_probe(SimRegisterFile* file, PciDeviceIndex dev, uint32_t reg)
+{
+    int mask = file->numSlots - 1;
+    int idx = (int)(sim_hash(dev, reg) & mask);
+    while (file->slots[idx].used)
+    {
+        if ((file->slots[idx].dev == dev) && (file->slots[idx].reg == reg))
+        {
+            break;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+static SimRegister*
+sim_lookup(SimRegisterFile* file, PciDeviceIndex dev, uint32_t reg, int create)
+{
+    int idx = sim_probe(file, dev, reg);
+    if (file->slots[idx].used)
+    {
+        return &file->slots[idx];
+    }
+    if (!create)
+    {
+        return NULL;
+    }
+    if (2 * (file->numUsed + 1) > file->numSlots)
+    {
+        SimRegister* old = file->slots;
+        int oldSlots = file->numSlots;
+        SimRegister* new = calloc(2 * oldSlots, sizeof(SimRegister));
+        if (!new)
+        {
+            return NULL;
+        }
+        file->slots = new;
+        file->numSlots = 2 * oldSlots;
+        for (int i = 0; i < oldSlots; i++)
+        {
+            if (old[i].used)
+            {
+                file->slots[sim_probe(file, old[i].dev, old[i].reg)] = old[i];
+            }
+        }
+        free(old);
+        idx = sim_probe(file, dev, reg);
+    }
+    file->slots[idx].used = 1;
+    file->slots[idx].dev = dev;
+    file->slots[idx].reg = reg;
+    file->slots[idx].mask = ~0x0ULL;
+    file->numUsed++;
+    return &file->slots[idx];
+}
+
+static int
+sim_parseDevice(const char* str, PciDeviceIndex* dev)
+{
+    char* end = NULL;
+    unsigned long d = 0;
+    if (strcasecmp(str, "MSR") == 0 || strcasecmp(str, "MSR_DEV") == 0)
+    {
+        *dev = MSR_DEV;
+        return 0;
+    }
+    d = strtoul(str, &end, 0);
+    if ((end == str) || (*end != '\0') || (d >= MAX_NUM_PCI_DEVICES))
+    {
+        return -EINVAL;
+    }
+    *dev = (PciDeviceIndex)d;
+    return 0;
+}
+
+static int
+sim_addRule(SimRule* rule)
+{
+    SimRule* tmp = realloc(sim_rules, (sim_num_rules + 1) * sizeof(SimRule));
+    if (!tmp)
+    {
+        return -ENOMEM;
+    }
+    sim_rules = tmp;
+    sim_rules[sim_num_rules] = *rule;
+    sim_num_rules++;
+    return 0;
+}
+
+static int
+sim_readScript(const char* filename)
+{
+    int lineno = 0;
+    int cpu = -1;
+    char line[SIM_MAX_LINE];
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        ERROR_PRINT(Cannot open simulation script %s, filename);
+        return -errno;
+    }
+    while (fgets(line, SIM_MAX_LINE, fp) != NULL)
+    {
+        char cmd[64], sdev[64], a[64], b[64], c[64];
+        char* comment = strchr(line, '#');
+        int n = 0;
+        SimRule rule;
+        lineno++;
+        if (comment)
+        {
+            *comment = '\0';
+        }
+        n = sscanf(line, "%63s %63s %63s %63s %63s", cmd, sdev, a, b, c);
+        if (n <= 0)
+        {
+            continue;
+        }
+        memset(&rule, 0, sizeof(SimRule));
+        rule.cpu = cpu;
+        rule.width = SIM_DEFAULT_WIDTH;
+        if (strcmp(cmd, "cpu") == 0 && n >= 2)
+        {
+            cpu = (strcmp(sdev, "all") == 0 ? -1 : atoi(sdev));
+            continue;
+        }
+        if ((n < 2) || (sim_parseDevice(sdev, &rule.dev) < 0))
+        {
+            goto parse_error;
+        }
+        if (strcmp(cmd, "device") == 0)
+        {
+            sim_devices[rule.dev] = 1;
+            continue;
+        }
+        if (n < 4)
+        {
+            goto parse_error;
+        }
+        rule.reg = (uint32_t)strtoul(a, NULL, 0);
+        if (strcmp(cmd, "value") == 0)
+        {
+            rule.type = SIM_RULE_VALUE;
+            rule.value = strtoull(b, NULL, 0);
+        }
+        else if (strcmp(cmd, "counter") == 0)
+        {
+            rule.type = SIM_RULE_COUNTER;
+            rule.value = strtoull(b, NULL, 0);
+            if (n == 5)
+            {
+                rule.width = atoi(c);
+            }
+            if (rule.width <= 0 || rule.width > 64)
+            {
+                goto parse_error;
+            }
+        }
+        else if (strcmp(cmd, "overflow") == 0 && n == 5)
+        {
+            rule.type = SIM_RULE_OVERFLOW;
+            rule.status = (uint32_t)strtoul(b, NULL, 0);
+            rule.bit = atoi(c);
+            if (rule.bit < 0 || rule.bit > 63)
+            {
+                goto parse_error;
+            }
+        }
+        else if (strcmp(cmd, "clear") == 0)
+        {
+            rule.type = SIM_RULE_CLEAR;
+            rule.status = (uint32_t)strtoul(b, NULL, 0);
+        }
+        else
+        {
+            goto parse_error;
+        }
+        if (sim_addRule(&rule) < 0)
+        {
+            fclose(fp);
+            return -ENOMEM;
+        }
+        continue;
+parse_error:
+        ERROR_PRINT(Invalid directive in simulation script %s line %d, filename, lineno);
+        fclose(fp);
+        return -EINVAL;
+    }
+    fclose(fp);
+    DEBUG_PRINT(DEBUGLEV_DETAIL, Read %d rules from simulation script %s, sim_num_rules, filename);
+    return 0;
+}
+
+static int
+sim_applyRules(SimRegisterFile* file, int cpu_id)
+{
+    for (int i = 0; i < sim_num_rules; i++)
+    {
+        SimRule* rule = &sim_rules[i];
+        SimRegister* r = NULL;
+        if ((rule->cpu >= 0) && (rule->cpu != cpu_id))
+        {
+            continue;
+        }
+        /* Create the status registers here, inserting them in the read and
+         * write paths may grow the table and invalidate the register pointer */
+        if (((rule->type == SIM_RULE_OVERFLOW) || (rule->type == SIM_RULE_CLEAR)) &&
+            (!sim_lookup(file, rule->dev, rule->status, 1)))
+        {
+            return -ENOMEM;
+        }
+        r = sim_lookup(file, rule->dev, rule->reg, 1);
+        if (!r)
+        {
+            return -ENOMEM;
+        }
+        switch (rule->type)
+        {
+            case SIM_RULE_VALUE:
+                r->value = rule->value;
+                break;
+            case SIM_RULE_COUNTER:
+                r->increment = rule->value;
+                r->mask = (rule->width == 64 ? ~0x0ULL : (1ULL << rule->width) - 1);
+                r->value &= r->mask;
+                break;
+            case SIM_RULE_OVERFLOW:
+                r->overflow = 1;
+                r->status = rule->status;
+                r->statusBits |= (1ULL << rule->bit);
+                break;
+            case SIM_RULE_CLEAR:
+                r->clear = 1;
+                r->clearStatus = rule->status;
+                break;
+        }
+    }
+    return 0;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+access_sim_init(int cpu_id)
+{
+    int ret = 0;
+    SimRegisterFile* file = NULL;
+    if ((cpu_id < 0) || (cpu_id >= cpuid_topology.numHWThreads))
+    {
+        return -ERANGE;
+    }
+    pthread_mutex_lock(&sim_init_lock);
+    if (!sim_script_read)
+    {
+        char* script = getenv("LIKWID_SIM_SCRIPT");
+        if (script != NULL)
+        {
+            ret = sim_readScript(script);
+            if (ret < 0)
+            {
+                pthread_mutex_unlock(&sim_init_lock);
+                return ret;
+            }
+        }
+        sim_script_read = 1;
+    }
+    if (!sim_files)
+    {
+        sim_files = calloc(cpuid_topology.numHWThreads, sizeof(SimRegisterFile*));
+        if (!sim_files)
+        {
+            pthread_mutex_unlock(&sim_init_lock);
+            return -ENOMEM;
+        }
+    }
+    if (!sim_files[cpu_id])
+    {
+        file = malloc(sizeof(SimRegisterFile));
+        if (file)
+        {
+            file->slots = calloc(SIM_INITIAL_SLOTS, sizeof(SimRegister));
+            if (!file->slots)
+            {
+                free(file);
+                file = NULL;
+            }
+        }
+        if (!file)
+        {
+            pthread_mutex_unlock(&sim_init_lock);
+            return -ENOMEM;
+        }
+        file->numSlots = SIM_INITIAL_SLOTS;
+        file->numUsed = 0;
+        if (sim_applyRules(file, cpu_id) < 0)
+        {
+            free(file->slots);
+            free(file);
+            pthread_mutex_unlock(&sim_init_lock);
+            return -ENOMEM;
+        }
+        pthread_mutex_init(&file->lock, NULL);
+        sim_files[cpu_id] = file;
+        sim_num_files++;
+    }
+    pthread_mutex_unlock(&sim_init_lock);
+    return 0;
+}
+
+int
+access_sim_read(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t *data)
+{
+    SimRegisterFile* file = NULL;
+    SimRegister* r = NULL;
+    if ((!sim_files) || (cpu_id < 0) || (cpu_id >= cpuid_topology.numHWThreads) || (!sim_files[cpu_id]))
+    {
+        return -ENODEV;
+    }
+    if ((dev >= MAX_NUM_PCI_DEVICES) || (!sim_devices[dev]))
+    {
+        return -ENODEV;
+    }
+    file = sim_files[cpu_id];
+    pthread_mutex_lock(&file->lock);
+    r = sim_lookup(file, dev, reg, 0);
+    if (!r)
+    {
+        *data = 0x0ULL;
+        pthread_mutex_unlock(&file->lock);
+        return 0;
+    }
+    if (r->increment)
+    {
+        uint64_t next = (r->value + r->increment) & r->mask;
+        /* Also true if the increment is larger than the counter range */
+        if ((r->increment > r->mask - r->value) && r->overflow)
+        {
+            SimRegister* s = sim_lookup(file, dev, r->status, 0);
+            if (s)
+            {
+                s->value |= r->statusBits;
+            }
+        }
+        r->value = next;
+    }
+    *data = r->value;
+    pthread_mutex_unlock(&file->lock);
+    return 0;
+}
+
+int
+access_sim_write(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t data)
+{
+    SimRegisterFile* file = NULL;
+    SimRegister* r = NULL;
+    if ((!sim_files) || (cpu_id < 0) || (cpu_id >= cpuid_topology.numHWThreads) || (!sim_files[cpu_id]))
+    {
+        return -ENODEV;
+    }
+    if ((dev >= MAX_NUM_PCI_DEVICES) || (!sim_devices[dev]))
+    {
+        return -ENODEV;
+    }
+    file = sim_files[cpu_id];
+    pthread_mutex_lock(&file->lock);
+    r = sim_lookup(file, dev, reg, 1);
+    if (!r)
+    {
+        pthread_mutex_unlock(&file->lock);
+        return -ENOMEM;
+    }
+    r->value = data & r->mask;
+    if (r->clear)
+    {
+        SimRegister* s = sim_lookup(file, dev, r->clearStatus, 0);
+        if (s)
+        {
+            s->value &= ~data;
+        }
+    }
+    pthread_mutex_unlock(&file->lock);
+    return 0;
+}
+
+void
+access_sim_finalize(int cpu_id)
+{
+    pthread_mutex_lock(&sim_init_lock);
+    if ((sim_files) && (cpu_id >= 0) && (cpu_id < cpuid_topology.numHWThreads) && (sim_files[cpu_id]))
+    {
+        pthread_mutex_destroy(&sim_files[cpu_id]->lock);
+        free(sim_files[cpu_id]->slots);
+        free(sim_files[cpu_id]);
+        sim_files[cpu_id] = NULL;
+        sim_num_files--;
+    }
+    if ((sim_files) && (sim_num_files == 0))
+    {
+        free(sim_files);
+        sim_files = NULL;
+        free(sim_rules);
+        sim_rules = NULL;
+        sim_num_rules = 0;
+        memset(sim_devices, 0, sizeof(sim_devices));
+        sim_devices[MSR_DEV] = 1;
+        sim_script_read = 0;
+    }
+    pthread_mutex_unlock(&sim_init_lock);
+}
+
+int
+access_sim_check(PciDeviceIndex dev, int cpu_id)
+{
+    if ((!sim_files) || (cpu_id < 0) || (cpu_id >= cpuid_topology.numHWThreads) || (!sim_files[cpu_id]) ||
+        (dev >= MAX_NUM_PCI_DEVICES))
+    {
+        return 0;
+    }
+    return sim_devices[dev];
+}
@@ -53,6 +53,7 @@
 #include <tree.h>
 #include <topology.h>
 #include <topology_hwloc.h>
+#include <topology_cache.h>
 
 /* #####   EXPORTED VARIABLES   ########################################### */
 
@@ -179,7 +180,7 @@ static int get_id_of_type(hwloc_obj_t base, hwloc_obj_type_t type)
 
 #define AFF_FREE_AND_RESET(ptr) if (ptr != NULL) { free(ptr); ptr = NULL; }
 
-static int create_lookups()
+static int create_lookups(int computeLookups)
 {
     int err = 0;
     int do_cache = 1;
@@ -373,6 +374,10 @@ static int create_lookups()
         }
         memset(sharedl3_lock, LOCK_INIT, cputopo->numHWThreads*sizeof(int));
     }
+    if (!computeLookups)
+    {
+        return 0;
+    }
     tmp = malloc(cputopo->numHWThreads * sizeof(int));
     if (!tmp)
     {
@@ -768,6 +773,26 @@ static int affinity_addRocmDomain(int nodeId, AffinityDomain* domain, int offset
 }
 #endif
 
+static int
+affinity_initFromCache(void)
+{
+    int* lookups[5] = {NULL, NULL, NULL, NULL, NULL};
+    int err = topology_cache_getAffinity(&affinityDomains, lookups);
+    if (err < 0)
+    {
+        return err;
+    }
+    domains = affinityDomains.domains;
+    affinity_numberOfDomains = affinityDomains.numberOfAffinityDomains;
+    affinity_thread2core_lookup = lookups[0];
+    affinity_thread2socket_lookup = lookups[1];
+    affinity_thread2sharedl3_lookup = lookups[2];
+    affinity_thread2numa_lookup = lookups[3];
+    affinity_thread2die_lookup = lookups[4];
+    DEBUG_PRINT(DEBUGLEV_DEVELOP, Affinity: %d domains from topology cache, affinity_numberOfDomains);
+    return create_lookups(0);
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
@@ -799,6 +824,12 @@ affinity_init()
     }
     NumaTopology_t numatopo = get_numaTopology();
 
+    if (affinity_initFromCache() == 0)
+    {
+        affinity_initialized = 1;
+        return 0;
+    }
+
 #ifdef LIKWID_WITH_NVMON
     int numCudaDomains = 0;
     CudaTopology_t cudatopo = NULL;
@@ -1003,7 +1034,7 @@ affinity_init()
 #endif
     affinityDomains.domains = domains;
 
-    create_lookups();
+    create_lookups(1);
 
     affinity_initialized = 1;
     return 0;
@@ -38,6 +38,7 @@ print_stdout = print
 print_stderr = function(...) for k,v in pairs({...}) do io.stderr:write(v .. "\n") end end
 
 local filename = "<INSTALLED_PREFIX>/etc/likwid_topo.cfg"
+local binary = false
 
 function version()
     print_stdout(string.format("likwid-genTopoCfg -- Version %d.%d.%d (commit: %s)",likwid.version,likwid.release,likwid.minor,likwid.commit))
@@ -50,13 +51,14 @@ function usage()
     print_stdout("-h, --help\t\t Help message")
     print_stdout("-v, --version\t\t Version information")
     print_stdout("-o, --output <file>\t Use <file> instead of default "..filename)
+    print_stdout("-b, --binary\t\t Write a binary topology snapshot including the affinity domains")
     print_stdout("\t\t\t Likwid searches at startup per default:")
     print_stdout("\t\t\t /etc/likwid_topo.cfg and <INSTALLED_PREFIX>/etc/likwid_topo.cfg")
     print_stdout("\t\t\t Another location can be configured in the configuration file /etc/likwid.cfg,")
     print_stdout("\t\t\t <INSTALLED_PREFIX>/etc/likwid.cfg or the path defined at the build process of Likwid.")
 end
 
-for opt,arg in likwid.getopt(arg, {"h","v","help","version", "o:", "output:"}) do
+for opt,arg in likwid.getopt(arg, {"h","v","help","version", "o:", "output:", "b", "binary"}) do
     if opt == "h" or opt == "help" then
         usage()
         os.exit(0)
@@ -65,6 +67,8 @@ for opt,arg in likwid.getopt(arg, {"h","v","help","version", "o:", "output:"}) d
         os.exit(0)
     elseif opt == "o" or opt == "output" then
         filename = arg
+    elseif opt == "b" or opt == "binary" then
+        binary = true
     elseif opt == "?" then
         print_stderr("Invalid commandline option -"..arg)
         os.exit(1)
@@ -79,6 +83,19 @@ if file ~= nil then
     file:close()
     os.exit(1)
 end
+if binary then
+    likwid.setenv("LIKWID_NO_ACCESS", "1")
+    print_stdout(string.format("Writing new binary topology file %s", filename))
+    local err = likwid.writeTopologyCache(filename)
+    if err ~= 0 then
+        print_stderr("Cannot write binary topology file "..filename)
+        os.exit(1)
+    end
+    likwid.putAffinityInfo()
+    likwid.putNumaInfo()
+    likwid.putTopology()
+    os.exit(0)
+end
 file = io.open(filename, "w")
 if file == nil then
     print_stderr("Cannot open file "..filename.." for writing")
@@ -0,0 +1,195 @@
+#!<INSTALLED_BINPREFIX>/likwid-lua
+--[[
+ * =======================================================================================
+ *
+ *      Filename:  likwid-monitord.lua
+ *
+ *      Description:  A daemon rotating through performance groups on all HW threads
+ *                    of a node and publishing a rolling window of metrics.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@gmail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+]]
+package.path = '<INSTALLED_PREFIX>/share/lua/?.lua;' .. package.path
+local likwid = require("likwid")
+
+print_stdout = print
+print_stderr = function(...) for k,v in pairs({...}) do io.stderr:write(v .. "\n") end end
+
+local function version()
+    print_stdout(string.format("likwid-monitord -- Version %d.%d.%d (commit: %s)",likwid.version,likwid.release,likwid.minor,likwid.commit))
+end
+
+local function examples()
+    print_stdout("Examples:")
+    print_stdout("Monitor the groups FLOPS_DP and MEM on all HW threads, 1 s per group:")
+    print_stdout("likwid-monitord -g FLOPS_DP -g MEM")
+    print_stdout("Monitor socket 0 with 500 ms per group and a window of 120 samples:")
+    print_stdout("likwid-monitord -c S0:0-3 -g MEM -t 500ms -w 120")
+    print_stdout("Query a running monitor for the Prometheus metrics:")
+    print_stdout("likwid-monitord -q prometheus")
+    print_stdout("curl --unix-socket /tmp/likwid-monitord.sock http://localhost/metrics")
+end
+
+local function usage()
+    version()
+    print_stdout("A daemon publishing rolling hardware performance metrics of a node.\n")
+    print_stdout("Options:")
+    print_stdout("-h, --help\t\t Help message")
+    print_stdout("-v, --version\t\t Version information")
+    print_stdout("-V, --verbose <level>\t Verbose output, 0 (only errors), 1 (info), 2 (details), 3 (developer)")
+    print_stdout("-c <list>\t\t Processor IDs to measure (default: all HW threads)")
+    print_stdout("-g, --group <string>\t Performance group or custom event set string, can be given multiple times")
+    print_stdout("-t <time>\t\t Measurement time per group, e.g. 1s, 500ms (default: 1s)")
+    print_stdout("-w <count>\t\t Number of samples kept per group (default: 60)")
+    print_stdout("-b <percent>\t\t CPU budget of the monitor in percent of one CPU (default: 1)")
+    print_stdout("-s, --socket <path>\t Path of the UNIX socket (default: /tmp/likwid-monitord.sock)")
+    print_stdout("--shm <name>\t\t Name of the shared memory segment (default: /likwid-monitor)")
+    print_stdout("-q, --query <request>\t Query a running monitor: json, window or prometheus")
+    print_stdout("-M <0|1|2>\t\t Set how MSR registers are accessed, 0=direct, 1=accessDaemon, 2=perf_event")
+    print_stdout("")
+    examples()
+end
+
+local function monitord_exit(code)
+    likwid.putTopology()
+    likwid.putConfiguration()
+    os.exit(code)
+end
+
+local config = likwid.getConfiguration()
+local cputopo = likwid.getCpuTopology()
+local num_cpus = 0
+local cpulist = {}
+local groups = {}
+local interval = 1.E06
+local window = 60
+local budget = 1
+local socketPath = "/tmp/likwid-monitord.sock"
+local shmName = "/likwid-monitor"
+local query = nil
+local access_mode = config["daemonMode"]
+local set_access_modes = false
+
+for opt,arg in likwid.getopt(arg, {"b:", "c:", "g:", "h", "M:", "q:", "s:", "t:", "v", "V:", "w:",
+                                   "group:", "help", "query:", "shm:", "socket:", "verbose:", "version"}) do
+    if opt == "h" or opt == "help" then
+        usage()
+        monitord_exit(0)
+    elseif opt == "v" or opt == "version" then
+        version()
+        monitord_exit(0)
+    elseif opt == "V" or opt == "verbose" then
+        likwid.setVerbosity(tonumber(arg))
+    elseif opt == "c" then
+        num_cpus, cpulist = likwid.cpustr_to_cpulist(arg)
+    elseif opt == "g" or opt == "group" then
+        table.insert(groups, arg)
+    elseif opt == "t" then
+        interval = likwid.parse_time(arg)
+    elseif opt == "w" then
+        window = tonumber(arg)
+    elseif opt == "b" then
+        budget = tonumber(arg)
+    elseif opt == "s" or opt == "socket" then
+        socketPath = arg
+    elseif opt == "shm" then
+        shmName = arg
+    elseif opt == "q" or opt == "query" then
+        query = arg
+    elseif opt == "M" then
+        access_mode = tonumber(arg)
+        set_access_modes = true
+        if access_mode == nil or access_mode < 0 or access_mode > 2 then
+            print_stderr("Access mode must be 0 for direct access, 1 for access daemon or 2 for perf_event")
+            monitord_exit(1)
+        end
+    elseif opt == "?" then
+        print_stderr("Invalid commandline option -"..arg)
+        monitord_exit(1)
+    elseif opt == "!" then
+        print_stderr("Option requires an argument")
+        monitord_exit(1)
+    end
+end
+
+if query then
+    local response, err = likwid.monitorQuery(socketPath, query)
+    if not response then
+        print_stderr(string.format("Cannot query monitor at %s: error %d", socketPath, err))
+        monitord_exit(1)
+    end
+    io.stdout:write(response)
+    monitord_exit(0)
+end
+
+if #groups == 0 then
+    print_stderr("At least one group must be given with -g")
+    monitord_exit(1)
+end
+if window == nil or window <= 0 then
+    print_stderr("The window size must be a positive number")
+    monitord_exit(1)
+end
+if budget == nil or budget <= 0 or budget > 100 then
+    print_stderr("The CPU budget must be between 0 and 100 percent")
+    monitord_exit(1)
+end
+if interval < 1.E04 then
+    print_stderr("The measurement time per group must be at least 10ms")
+    monitord_exit(1)
+end
+if num_cpus == 0 then
+    for _, t in pairs(cputopo["threadPool"]) do
+        if t["inCpuSet"] == 1 then
+            table.insert(cpulist, t["apicId"])
+        end
+    end
+    table.sort(cpulist)
+    num_cpus = #cpulist
+end
+
+if set_access_modes then
+    if likwid.setAccessClientMode(access_mode) ~= 0 then
+        monitord_exit(1)
+    end
+end
+if likwid.init(num_cpus, cpulist) < 0 then
+    monitord_exit(1)
+end
+local gids = {}
+for _, g in pairs(groups) do
+    local gid = likwid.addEventSet(g)
+    if gid < 0 then
+        print_stderr(string.format("Cannot add group %s", g))
+        likwid.finalize()
+        monitord_exit(1)
+    end
+    table.insert(gids, gid)
+end
+
+local err = likwid.monitorRun(gids, interval/1.E06, window, budget/100, socketPath, shmName)
+if err < 0 then
+    print_stderr(string.format("Node monitor failed with error %d", err))
+end
+likwid.finalize()
+monitord_exit(err < 0 and 1 or 0)
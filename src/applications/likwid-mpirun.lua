@@ -140,7 +140,7 @@ local pid = likwid.getpid()
 local pwd = os.getenv("PWD")
 local hostfilename = string.format(".hostfile_%s.txt", pid)
 local scriptfilename = string.format(".likwidscript_%s.txt", pid)
-local outfilename = string.format("%s/.output_%s_%%r_%%h.csv", pwd, pid)
+local outfilename = string.format("%s/.output_%s_%%r_%%h.jsonl", pwd, pid)
 local filelist = {}
 
 local function mpirun_exit(exitcode)
@@ -1667,418 +1667,164 @@ local function listdir(dir, infilepart)
 end
 
 
-local function parseOutputFile(filename)
-    local rank = 0
-    local host = nil
-    local cpulist = {}
-    local eventlist = {}
-    local counterlist = {}
-    local idx = 1
-    local gidx = 0
-    local results = {}
-    local f = io.open(filename, "r")
-    if f == nil then
-        print_stderr("ERROR: Cannot open output file "..filename)
-        mpirun_exit(1)
-    end
-    rank, host = filename:match("output_%d+_(%d+)_([^%s]+).csv")
-
-    local t = f:read("*all")
-    f:close()
-    if t:len() == 0 then
-        print_stderr("Error Output file "..filename.." is empty")
-        mpirun_exit(1)
-    end
-    for i, line in pairs(likwid.stringsplit(t, "\n")) do
-        if (not line:match("^-")) and
-           (not line:match("^CPU type:")) and
-           (not line:match("^CPU name:")) and
-           (not line:match("^TABLE")) and
-           (not line:match("^STRUCT")) and
-           (not line:match("^%s*$")) and
-           (not line:match("STAT")) then
-            if line:match("^Event") and not line:match("Sum,Min,Max,Avg") then
-                linelist = likwid.stringsplit(line,",")
-                table.remove(linelist,1)
-                table.remove(linelist,1)
-                for _, cpustr in pairs(linelist) do
-                    local test = tonumber(cpustr:match("HWThread (%d+)"))
-                    if test ~= nil then
-                        for _cpu in pairs(cpulist) do
-                            if tonumber(cpu) == test then test = -1 end
-                        end
-                        if test >= 0 then
-                            table.insert(cpulist, test)
-                        end
-                    end
-                end
-                gidx = gidx + 1
-                idx = 1
-                if results[gidx] == nil then
-                    results[gidx] = {}
-                    eventlist[gidx] = {}
-                    counterlist[gidx] = {}
-                    results[gidx]["time"] = {}
-                end
-            elseif not line:match("^CPU clock:") and not line:match("Sum,Min,Max,Avg") then
-                linelist = likwid.stringsplit(line,",")
-                event = linelist[1]
-                counter = linelist[2]
-                table.remove(linelist,1)
-                table.remove(linelist,1)
-                for j=#linelist,1,-1 do
-                    if linelist[j] == "" then
-                        table.remove(linelist, j)
-                    end
-                end
-                if results[gidx][counter] == nil then
-                    results[gidx][counter] = {}
-                end
-                for j, value in pairs(linelist) do
-                    if event:match("[Rr]untime") then
-                        results[gidx]["time"][cpulist[j]] = tonumber(value)
-                    else
-                        results[gidx][counter][cpulist[j]] = tonumber(value)
-                    end
-                end
-                if not event:match("[Rr]untime") then
-                    table.insert(eventlist[gidx], idx, event)
-                    table.insert(counterlist[gidx], idx, counter)
-                    idx = idx + 1
-                end
-            elseif line:match("^CPU clock:") then
-                results["clock"] = line:match("^CPU clock:,([%d.]+)")
-                results["clock"] = tonumber(results["clock"])*1.E09
-            end
-        end
+local function statsColumns(stats, percentiles)
+    local cols = {}
+    local names = {"Sum", "Min", "Max", "Avg"}
+    local keys = {"sum", "min", "max", "avg"}
+    if percentiles then
+        table.insert(names, "%ile 25")
+        table.insert(names, "%ile 50")
+        table.insert(names, "%ile 75")
+        table.insert(keys, "p25")
+        table.insert(keys, "p50")
+        table.insert(keys, "p75")
+    end
+    for k, key in pairs(keys) do
+        local col = {names[k]}
+        for _, s in pairs(stats) do
+            table.insert(col, likwid.num2str(s[key]))
+        end
+        table.insert(cols, col)
+    end
+    return cols
+end
+
+function printMpiOutput(result, group_list)
+    local region = result["region"]
+    local gidx = result["group"]
+    local groupName = result["name"]
+    local firsttab = {}
+    local firsttab_combined = {}
+    local secondtab = {}
+    local secondtab_combined = {}
+    local total_threads = #result["columns"]
+    local hasMetrics = #result["metrics"] > 0
+    local printTime = (total_threads == 1 or not hasMetrics)
+    local rawstats = {}
+    if group_list[gidx] and group_list[gidx]["GroupString"] then
+        groupName = group_list[gidx]["GroupString"]
+    end
+    if total_threads == 0 then
+        return
     end
-    return host, tonumber(rank), results, cpulist
-end
 
-local function parseMarkerOutputFile(filename)
-    local rank = 0
-    local host = nil
-    local cpulist = {}
-    local eventlist = {}
-    local counterlist = {}
-    local regionlist = {}
-    local idx = 1
-    local results = {}
-    local f = io.open(filename, "r")
-    if f == nil then
-        print_stderr("ERROR: Cannot open output file "..filename)
-        mpirun_exit(1)
+    local desc = {"Event"}
+    local cdesc = {"Counter"}
+    if printTime then
+        table.insert(desc, "Runtime (RDTSC) [s]")
+        table.insert(cdesc, "TSC")
+        table.insert(rawstats, result["stats"]["time"])
     end
-    rank, host = filename:match("output_%d+_(%d+)_([^%s]+).csv")
-    local t = f:read("*all")
-    f:close()
-    local parse_reg_info = false
-    local parse_reg_output = false
-    local current_region = nil
-    local gidx = 0
-    local gname = ""
-    local clock = 0
-
-    for i, line in pairs(likwid.stringsplit(t, "\n")) do
-        if (not line:match("^-")) and
-           (not line:match("^CPU type:")) and
-           (not line:match("^CPU name:")) and
-           (not line:match("STAT")) then
-
-            if line:match("^STRUCT,Info") and not parse_reg_info then
-                parse_reg_info = true
-            elseif line:match("^Event") and not line:match("Sum,Min,Max,Avg") then
-                parse_reg_info = false
-                parse_reg_output = true
-                idx = 1
-            elseif line:match("^Event") and line:match("Sum,Min,Max,Avg") then
-                parse_reg_output = false
-            elseif line:match("^CPU clock:,") then
-                clock = line:match("^CPU clock:,([%d.]+)")
-                clock = tonumber(clock)*1.E09
-            elseif parse_reg_info and line:match("TABLE,Region ([^%s]+),Group (%d+) Raw,([^%s]+),") then
-                current_region, gidx, gname  = line:match("TABLE,Region ([^%s]+),Group (%d+) Raw,([^%s]+),")
-                gidx = tonumber(gidx)
-                if results[current_region] == nil then
-                    results[current_region] = {}
-                end
-                if results[current_region][gidx] == nil then
-                    results[current_region][gidx] = {}
-                    results[current_region][gidx]["name"] = gname
-                    results[current_region][gidx]["time"] = {}
-                    results[current_region][gidx]["calls"] = {}
-                end
-                table.insert(regionlist, current_region)
-            elseif parse_reg_info and line:match("^Region Info") then
-                linelist = likwid.stringsplit(line,",")
-                table.remove(linelist,1)
-                for _, cpustr in pairs(linelist) do
-                    if cpustr:match("HWThread %d+") then
-                        local test = tonumber(cpustr:match("HWThread (%d+)"))
-                        if test ~= nil then
-                            for _,cpu in pairs(cpulist) do
-                                if test == cpu then test = -1 end
-                            end
-                            if test >= 0 then
-                                table.insert(cpulist, test)
-                            end
-                        end
-                    end
-                end
-            elseif parse_reg_info and line:match("^RDTSC") then
-                linelist = likwid.stringsplit(line,",")
-                table.remove(linelist,1)
-                for i, time in pairs(linelist) do
-                    if time ~= "" then
-                        results[current_region][gidx]["time"][cpulist[i]] = tonumber(time)
-                    end
-                end
-            elseif parse_reg_info and line:match("^call count") then
-                linelist = likwid.stringsplit(line,",")
-                table.remove(linelist,1)
-                for j, calls in pairs(linelist) do
-                    if calls:match("%d+") then
-                        if calls ~= "" then
-                            results[current_region][gidx]["calls"][cpulist[j]] = tonumber(calls)
-                        end
-                    end
-                end
-            elseif parse_reg_output and not line:match("^%s*$") then
-                linelist = likwid.stringsplit(line,",")
-                if linelist[2] ~= "TSC" then
-                    event = linelist[1]
-                    counter = linelist[2]
-                    table.remove(linelist,1)
-                    table.remove(linelist,1)
-                    for j=#linelist,1,-1 do
-                        if linelist[j] == "" then
-                            table.remove(linelist, j)
-                        end
-                    end
-                    if results[current_region][gidx][counter] == nil then
-                        results[current_region][gidx][counter] = {}
-                    end
-                    for j, value in pairs(linelist) do
-                        v = tonumber(value)
-                        if v then
-                            results[current_region][gidx][counter][cpulist[j]] = v
-                        else
-                            results[current_region][gidx][counter][cpulist[j]] = 0/0
-                        end
-                    end
-                    idx = idx + 1
-                end
-            end
-        end
+    if result["hasCalls"] then
+        table.insert(desc, "Region calls")
+        table.insert(cdesc, "CTR")
+        table.insert(rawstats, result["stats"]["calls"])
     end
-    for region, data in pairs(results) do
-        results[region]["clock"] = clock
+    for i=1,#result["events"] do
+        table.insert(desc, result["events"][i])
+        table.insert(cdesc, result["counters"][i])
+        table.insert(rawstats, result["stats"]["events"][i])
     end
+    table.insert(firsttab, desc)
+    table.insert(firsttab, cdesc)
 
-    return host, tonumber(rank), results, cpulist, regionlist
-end
-
-
-function percentile_table(inputtable, skip_cols, skip_lines)
-    local function percentile(sorted_valuelist, k)
-        index = tonumber(k)/100.0 * #sorted_valuelist
-        if index - math.floor(index) >= 0.5 then
-            index = math.ceil(index)
-        else
-            index = math.floor(index)
+    for _, col in pairs(result["columns"]) do
+        local column = {col["label"]}
+        if printTime then
+            table.insert(column, likwid.num2str(col["time"]))
         end
-        if index == 0 then
-            index = 1
+        if result["hasCalls"] then
+            table.insert(column, likwid.num2str(col["calls"]))
         end
-        return tonumber(sorted_valuelist[index])
-    end
-    local outputtable = {}
-    local ncols = #inputtable
-    if ncols == 0 then
-        return outputtable
-    end
-    local nlines = #inputtable[1]
-    if nlines == 0 then
-        return outputtable
-    end
-    perc25 = {"%ile 25"}
-    perc50 = {"%ile 50"}
-    perc75 = {"%ile 75"}
-    for i=skip_lines+1,nlines do
-        perc25[i-skip_lines+1] = 0
-        perc50[i-skip_lines+1] = 0
-        perc75[i-skip_lines+1] = 0
-    end
-    for l=skip_lines+1,nlines do
-        valuelist = {}
-        for c=skip_cols+1, ncols do
-            table.insert(valuelist, inputtable[c][l])
+        for j=1,#result["events"] do
+            table.insert(column, likwid.num2str(col["values"][j]))
         end
-        table.sort(valuelist)
-        perc25[l-skip_lines+1] = likwid.num2str(percentile(valuelist, 25))
-        perc50[l-skip_lines+1] = likwid.num2str(percentile(valuelist, 50))
-        perc75[l-skip_lines+1] = likwid.num2str(percentile(valuelist, 75))
+        table.insert(firsttab, column)
     end
-    table.insert(outputtable, perc25)
-    table.insert(outputtable, perc50)
-    table.insert(outputtable, perc75)
-    return outputtable
-end
-
-function printMpiOutput(group_list, all_results, regionname)
-    region = regionname or nil
-    if #group_list == 0 or likwid.tablelength(all_results) == 0 then
-        return
-    end
-    for gidx, gdata in pairs(group_list) do
-        local firsttab = {}
-        local firsttab_combined = {}
-        local secondtab = {}
-        local secondtab_combined = {}
-        local total_threads = 0
-        local all_counters = {}
-        local groupName = gdata["GroupString"]
-
-        for rank = 0, #all_results do
-            total_threads = total_threads + #all_results[rank]["cpus"]
-        end
 
-        desc = {"Event"}
-        if total_threads == 1 or not gdata["Metrics"] then
-            table.insert(desc, "Runtime (RDTSC) [s]")
-        end
-        if all_results[0]["results"][1]["calls"] then
-            table.insert(desc, "Region calls")
+    if total_threads > 1 or print_stats then
+        local tmp = {desc[1]}
+        for j=2,#desc do
+            table.insert(tmp, desc[j].." STAT")
         end
-        for i=1,#gdata["Events"] do
-            table.insert(desc, gdata["Events"][i]["Event"])
-        end
-        table.insert(firsttab, desc)
-
-        desc = {"Counter"}
-        if total_threads == 1 or not gdata["Metrics"] then
-            table.insert(desc, "TSC")
+        table.insert(firsttab_combined, tmp)
+        table.insert(firsttab_combined, cdesc)
+        for _, col in pairs(statsColumns(rawstats, false)) do
+            table.insert(firsttab_combined, col)
         end
-        if all_results[0]["results"][1]["calls"] then
-            table.insert(desc, "CTR")
-        end
-        for i=1,#gdata["Events"] do
-            table.insert(desc, gdata["Events"][i]["Counter"])
+    end
+    if hasMetrics then
+        secondtab[1] = {"Metric"}
+        for j=1,#result["metrics"] do
+            table.insert(secondtab[1], result["metrics"][j])
         end
-        table.insert(firsttab, desc)
-
-        for rank = 0, #all_results do
-            for i, cpu in pairs(all_results[rank]["cpus"]) do
-                column = {all_results[rank]["hostname"]..":"..tostring(rank)..":"..tostring(cpu)}
-                if total_threads == 1 or not gdata["Metrics"] then
-                    table.insert(column, all_results[rank]["results"][gidx]["time"][cpu])
-                end
-                if all_results[0]["results"][1]["calls"] then
-                    table.insert(column, all_results[rank]["results"][gidx]["calls"][cpu])
-                end
-                for j=1,#gdata["Events"] do
-                    local value = "0"
-                    cname = gdata["Events"][j]["Counter"]
-                    if all_results[rank]["results"][gidx][cname] and
-                       all_results[rank]["results"][gidx][cname][cpu] then
-                        value = likwid.num2str(all_results[rank]["results"][gidx][cname][cpu])
-                    end
-                    table.insert(column, value)
-                end
-                table.insert(firsttab, column)
+        for _, col in pairs(result["columns"]) do
+            local tmpList = {col["label"]}
+            for j=1,#result["metrics"] do
+                table.insert(tmpList, likwid.num2str(col["metrics"][j]))
             end
+            table.insert(secondtab, tmpList)
         end
-
         if total_threads > 1 or print_stats then
-            firsttab_combined = likwid.tableToMinMaxAvgSum(firsttab, 2, 1)
-        end
-        if gdata["Metrics"] then
-            secondtab[1] = {"Metric"}
-            for j=1,#gdata["Metrics"] do
-                table.insert(secondtab[1], gdata["Metrics"][j]["description"])
-            end
-
-            for rank = 0, #all_results do
-                for i, cpu in pairs(all_results[rank]["cpus"]) do
-                    local counterlist = {}
-                    for j=1,#gdata["Events"] do
-                        local counter = gdata["Events"][j]["Counter"]
-                        counterlist[counter] = 0
-                        if all_results[rank]["results"][gidx][counter] ~= nil and
-                           all_results[rank]["results"][gidx][counter][cpu] ~= nil then
-                            counterlist[counter] = all_results[rank]["results"][gidx][counter][cpu]
-                        end
-                    end
-                    counterlist["time"] = all_results[rank]["results"][gidx]["time"][cpu]
-                    counterlist["inverseClock"] = 1.0/all_results[rank]["results"]["clock"]
-                    tmpList = {all_results[rank]["hostname"]..":"..tostring(rank)..":"..tostring(cpu)}
-                    for j=1,#groupdata["Metrics"] do
-                        local f = gdata["Metrics"][j]["formula"]
-                        local tmp = likwid.num2str(likwid.calculate_metric(f, counterlist))
-                        table.insert(tmpList, tmp)
-                    end
-                    table.insert(secondtab,tmpList)
-                end
+            local tmp = {"Metric"}
+            for j=1,#result["metrics"] do
+                table.insert(tmp, result["metrics"][j].." STAT")
             end
-
-            if total_threads > 1 or print_stats then
-                secondtab_combined = likwid.tableToMinMaxAvgSum(secondtab, 1, 1)
-                local tmp = percentile_table(secondtab, 1, 1)
-                for i, col in pairs(tmp) do
-                    table.insert(secondtab_combined, col)
-                end
+            table.insert(secondtab_combined, tmp)
+            for _, col in pairs(statsColumns(result["stats"]["metrics"], true)) do
+                table.insert(secondtab_combined, col)
             end
         end
-        if use_csv then
-            local maxLineFields = #firsttab
-            if #firsttab_combined > maxLineFields then maxLineFields = #firsttab_combined end
-            if gdata["Metrics"] then
-                if #secondtab > maxLineFields then maxLineFields = #secondtab end
-                if #secondtab_combined > maxLineFields then maxLineFields = #secondtab_combined end
+    end
+    if use_csv then
+        local maxLineFields = #firsttab
+        if #firsttab_combined > maxLineFields then maxLineFields = #firsttab_combined end
+        if hasMetrics then
+            if #secondtab > maxLineFields then maxLineFields = #secondtab end
+            if #secondtab_combined > maxLineFields then maxLineFields = #secondtab_combined end
+        end
+        if region then
+            print_stdout(string.format("TABLE,Region %s,Group %d Raw,%s,%d%s",tostring(region), gidx,groupName,#firsttab[1]-1,string.rep(",",maxLineFields-5)))
+        else
+            print_stdout(string.format("TABLE,Group %d Raw,%s,%d%s",gidx,groupName,#firsttab[1]-1,string.rep(",",maxLineFields-4)))
+        end
+        --print_stdout("Group,"..tostring(gidx) .. string.rep(",", maxLineFields  - 2))
+        likwid.printcsv(firsttab, maxLineFields)
+        if total_threads > 1 or print_stats then
+            if region == nil then
+                print(string.format("TABLE,Group %d Raw STAT,%s,%d%s",gidx,groupName,#firsttab_combined[1]-1,string.rep(",",maxLineFields-4)))
+            else
+                print(string.format("TABLE,Region %s,Group %d Raw STAT,%s,%d%s",tostring(region), gidx,groupName,#firsttab_combined[1]-1,string.rep(",",maxLineFields-5)))
             end
-            if region then
-                print_stdout(string.format("TABLE,Region %s,Group %d Raw,%s,%d%s",tostring(region), gidx,groupName,#firsttab[1]-1,string.rep(",",maxLineFields-5)))
+            likwid.printcsv(firsttab_combined, maxLineFields)
+        end
+        if hasMetrics then
+            if region == nil then
+                print(string.format("TABLE,Group %d Metric,%s,%d%s",gidx,groupName,#secondtab[1]-1,string.rep(",",maxLineFields-4)))
             else
-                print_stdout(string.format("TABLE,Group %d Raw,%s,%d%s",gidx,groupName,#firsttab[1]-1,string.rep(",",maxLineFields-4)))
+                print(string.format("TABLE,Region %s,Group %d Metric,%s,%d%s",tostring(region),gidx,groupName,#secondtab[1]-1,string.rep(",",maxLineFields-5)))
             end
-            --print_stdout("Group,"..tostring(gidx) .. string.rep(",", maxLineFields  - 2))
-            likwid.printcsv(firsttab, maxLineFields)
+            likwid.printcsv(secondtab, maxLineFields)
             if total_threads > 1 or print_stats then
                 if region == nil then
-                    print(string.format("TABLE,Group %d Raw STAT,%s,%d%s",gidx,groupName,#firsttab_combined[1]-1,string.rep(",",maxLineFields-4)))
-                else
-                    print(string.format("TABLE,Region %s,Group %d Raw STAT,%s,%d%s",tostring(region), gidx,groupName,#firsttab_combined[1]-1,string.rep(",",maxLineFields-5)))
-                end
-                likwid.printcsv(firsttab_combined, maxLineFields)
-            end
-            if gdata["Metrics"] then
-                if region == nil then
-                    print(string.format("TABLE,Group %d Metric,%s,%d%s",gidx,groupName,#secondtab[1]-1,string.rep(",",maxLineFields-4)))
+                    print(string.format("TABLE,Group %d Metric STAT,%s,%d%s",gidx,groupName,#secondtab_combined[1]-1,string.rep(",",maxLineFields-4)))
                 else
-                    print(string.format("TABLE,Region %s,Group %d Metric,%s,%d%s",tostring(region),gidx,groupName,#secondtab[1]-1,string.rep(",",maxLineFields-5)))
+                    print(string.format("TABLE,Region %s,Group %d Metric STAT,%s,%d%s",tostring(region),gidx,groupName,#secondtab_combined[1]-1,string.rep(",",maxLineFields-5)))
                 end
-                likwid.printcsv(secondtab, maxLineFields)
-                if total_threads > 1 or print_stats then
-                    if region == nil then
-                        print(string.format("TABLE,Group %d Metric STAT,%s,%d%s",gidx,groupName,#secondtab_combined[1]-1,string.rep(",",maxLineFields-4)))
-                    else
-                        print(string.format("TABLE,Region %s,Group %d Metric STAT,%s,%d%s",tostring(region),gidx,groupName,#secondtab_combined[1]-1,string.rep(",",maxLineFields-5)))
-                    end
-                    likwid.printcsv(secondtab_combined, maxLineFields)
-                end
-            end
-        else
-            if region then
-                print_stdout("Region: "..tostring(region))
-            end
-            print_stdout("Group: "..tostring(gidx))
-            likwid.printtable(firsttab)
-            if total_threads > 1 or print_stats then likwid.printtable(firsttab_combined) end
-            if gdata["Metrics"] then
-                likwid.printtable(secondtab)
-                if total_threads > 1 or print_stats then likwid.printtable(secondtab_combined) end
+                likwid.printcsv(secondtab_combined, maxLineFields)
             end
         end
+    else
+        if region then
+            print_stdout("Region: "..tostring(region))
+        end
+        print_stdout("Group: "..tostring(gidx))
+        likwid.printtable(firsttab)
+        if total_threads > 1 or print_stats then likwid.printtable(firsttab_combined) end
+        if hasMetrics then
+            likwid.printtable(secondtab)
+            if total_threads > 1 or print_stats then likwid.printtable(secondtab_combined) end
+        end
     end
 end
 
@@ -2631,48 +2377,26 @@ local exitvalue = executeCommand(scriptfilename, hostfilename, env, nrNodes)
 
 infilepart = ".output_"..pid
 filelist = listdir(os.getenv("PWD"), infilepart)
-all_results = {}
-if not use_marker then
-    for i, file in pairs(filelist) do
-        local host, rank, results, cpulist = parseOutputFile(file)
-        if host ~= nil and rank ~= nil then
-            if all_results[rank] == nil then
-                all_results[rank] = {}
-            end
-            all_results[rank]["hostname"] = host
-            all_results[rank]["results"] = results
-            all_results[rank]["cpus"] = cpulist
-        end
-    end
-    if likwid.tablelength(all_results) > 0 then
-        printMpiOutput(grouplist, all_results)
+if #filelist > 0 then
+    local aggregate = likwid.aggregateRecords(filelist, cpuCount())
+    if aggregate == nil then
+        print_stderr("ERROR: Cannot aggregate the output files of the MPI processes")
+        mpirun_exit(1)
     end
-else
-    local tmpList = {}
-    local cpuCount = 0
     local regionlist = {}
-    for i, file in pairs(filelist) do
-        host, rank, results, cpulist, rlist = parseMarkerOutputFile(file)
-        if host ~= nil and rank ~= nil then
-            if all_results[rank] == nil then
-                all_results[rank] = {}
-            end
-            all_results[rank]["hostname"] = host
-            all_results[rank]["cpus"] = cpulist
-            for _, r in pairs(rlist) do
-                table.insert(regionlist, r)
-            end
-            cpuCount = cpuCount + #cpulist
-            tmpList[rank] = results
-        end
-    end
-    regionlist = uniqueList(regionlist)
-    if likwid.tablelength(all_results) > 0 then
-        for _,region in pairs(regionlist) do
-            for rank,_ in pairs(all_results) do
-                all_results[rank]["results"] = tmpList[rank][region]
-            end
-            printMpiOutput(grouplist, all_results, region)
+    local regionresults = {}
+    for _, result in pairs(aggregate) do
+        local region = result["region"] or ""
+        if regionresults[region] == nil then
+            regionresults[region] = {}
+            table.insert(regionlist, region)
+        end
+        table.insert(regionresults[region], result)
+    end
+    for _, region in pairs(regionlist) do
+        table.sort(regionresults[region], function(a, b) return a["group"] < b["group"] end)
+        for _, result in pairs(regionresults[region]) do
+            printMpiOutput(result, grouplist)
         end
     end
 end
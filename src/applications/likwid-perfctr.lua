@@ -94,7 +94,7 @@ local function usage(config)
     end
     io.stdout:write("-H\t\t\t Get group help (together with -g switch)\n")
     io.stdout:write("-s, --skip <hex>\t Bitmask with threads to skip\n")
-    io.stdout:write("-M <0|1>\t\t Set how MSR registers are accessed, 0=direct, 1=accessDaemon\n")
+    io.stdout:write("-M <0|1|2>\t\t Set how MSR registers are accessed, 0=direct, 1=accessDaemon, 2=simulated\n")
     io.stdout:write("-a\t\t\t List available performance groups\n")
     io.stdout:write("-e\t\t\t List available events and counter registers\n")
     io.stdout:write("-E <string>\t\t List available events and corresponding counters that match <string>\n")
@@ -111,6 +111,26 @@ local function usage(config)
     io.stdout:write(
     "\t\t\t <groupID> <nrEvents> <nrThreads> <Timestamp> <Metric1_Thread1> <Metric1_Thread2> ... <MetricN_ThreadN>\n")
     io.stdout:write("-m, --marker\t\t Use Marker API inside code\n")
+    io.stdout:write("--tree\t\t\t Print a call path tree with inclusive and exclusive values of nested Marker API regions\n")
+    io.stdout:write("--freqtune <calls>\t Tune CPU and Uncore frequency per Marker API region (calls per setting)\n")
+    io.stdout:write("--mux <calls|time>\t Rotate the event groups automatically every <calls> region calls\n")
+    io.stdout:write("\t\t\t or every <time> in s, ms or us, e.g. 50ms. Groups are switched when\n")
+    io.stdout:write("\t\t\t no region is open, results are extrapolated to the region runtime\n")
+    io.stdout:write("--sample <event[@period]>\t Sample the instruction pointers in Marker API regions every <period> events.\n")
+    io.stdout:write("\t\t\t Comma-separated list of events of the event sets or cpu-clock, task-clock, page-faults,\n")
+    io.stdout:write("\t\t\t context-switches, cycles, instructions, cache-misses and branch-misses\n")
+    io.stdout:write("--samplefile <file>\t File for the IP histograms (default: likwid_samples_<pid>.txt)\n")
+    io.stdout:write("--topdown\t\t Top-down analysis: measure level 1 and drill down into the dominant\n")
+    io.stdout:write("\t\t\t category with the next group, every -T <time> (default 500ms) or, with -m,\n")
+    io.stdout:write("\t\t\t per region with the groups rotated by --mux (default 1 call)\n")
+    io.stdout:write("--roofline\t\t Roofline model: measure the FLOP rate and data rates of the memory levels\n")
+    io.stdout:write("\t\t\t and place them below the ceilings measured with likwid-bench (cached per host)\n")
+    io.stdout:write("--rooflinefile <file>\t File for the gnuplot script of the model (default: likwid_roofline_<pid>.gp)\n")
+    io.stdout:write("--ovfwatch\t\t Read the counters in the background often enough to count all counter\n")
+    io.stdout:write("\t\t\t overflows. For long measurements with -m, -S or without periodic reads\n")
+    io.stdout:write("--live\t\t\t Publish Marker API results in shared memory while the application runs\n")
+    io.stdout:write("--attach <pid>\t\t Print the live Marker API results of a running application\n")
+    io.stdout:write("\t\t\t With -t <time>, print the differences of each interval until the application exits\n")
     io.stdout:write("Output options:\n")
     io.stdout:write(
     "-o, --output <file>\t Store output to file. (Optional: Apply text filter according to filename suffix)\n")
@@ -175,9 +195,24 @@ overflow_interval = 2.E06
 output = ""
 use_csv = false
 print_stats = false
+freqtune = nil
+marker_live = false
+marker_tree = false
+overflow_watch = false
+marker_mux = nil
+marker_sample = nil
+use_topdown = false
+switch_time_set = false
+use_roofline = false
+rooflineFile = string.format("likwid_roofline_%d.gp", likwid.getpid())
+rooflineCeilings = nil
+sampleFile = string.format("likwid_samples_%d.txt", likwid.getpid())
+attach_pid = nil
 execString = nil
 outfile = nil
 outfile_orig = nil
+output_writer = nil
+use_records = false
 outprefix = ""
 forceOverwrite = 0
 gotC = false
@@ -201,7 +236,8 @@ cputopo = nil
 cpuinfo = nil
 cliopts = { "a", "c:", "C:", "e", "E:", "g:", "h", "H", "i", "m", "M:", "o:", "O", "P", "s:", "S:", "t:", "v", "V:",
     "T:", "f", "group:", "help", "info", "version", "verbose:", "output:", "skip:", "marker", "force", "stats",
-    "execpid", "perfflags:", "perfpid:", "Z", "outprefix:" }
+    "execpid", "perfflags:", "perfpid:", "Z", "outprefix:", "freqtune:", "live", "attach:", "mux:", "sample:", "samplefile:",
+    "topdown", "roofline", "rooflinefile:", "ovfwatch", "tree" }
 
 
 ---------------------------
@@ -274,6 +310,10 @@ local function perfctr_exit(exitcode)
         likwid.putConfiguration()
         config = nil
     end
+    if output_writer then
+        likwid.writerClose(output_writer)
+        output_writer = nil
+    end
     os.exit(exitcode)
 end
 
@@ -373,8 +413,8 @@ for opt, arg in likwid.getopt(arg, cliopts) do
         else
             access_flags = "e"
         end
-        if (access_mode < 0 and access_mode > 1) then
-            print_stdout("Access mode must be 0 for direct access and 1 for access daemon")
+        if (access_mode == nil or access_mode < 0 or access_mode > 2) then
+            print_stdout("Access mode must be 0 for direct access, 1 for access daemon and 2 for simulated registers")
             perfctr_exit(1)
         end
     elseif opt == "i" or opt == "info" then
@@ -402,6 +442,7 @@ for opt, arg in likwid.getopt(arg, cliopts) do
     elseif (opt == "T") then
         if arg ~= nil and arg:match("%d+%a?s") then
             duration = likwid.parse_time(arg)
+            switch_time_set = true
         else
             print_stderr("Option requires an argument")
             perfctr_exit(1)
@@ -411,7 +452,9 @@ for opt, arg in likwid.getopt(arg, cliopts) do
         if string.match(arg, "%.") then
             suffix = string.match(arg, ".-[^\\/]-%.?([^%.\\/]*)$")
         end
-        if suffix ~= "txt" then
+        if suffix == "jsonl" then
+            use_records = true
+        elseif suffix ~= "txt" then
             use_csv = true
         end
         outfile_orig = arg
@@ -419,12 +462,62 @@ for opt, arg in likwid.getopt(arg, cliopts) do
         outfile = outfile:gsub("%%p", likwid.getpid())
         outfile = outfile:gsub("%%j", likwid.getjid())
         outfile = outfile:gsub("%%r", likwid.getMPIrank())
-        io.output(outfile)
-        print = function(...) for k, v in pairs({ ... }) do io.write(v .. "\n") end end
+        if suffix == "json" or suffix == "csv" then
+            local err = nil
+            output_writer, err = likwid.writerOpen(outfile, suffix, "perfctr")
+            if not output_writer then
+                print_stderr(string.format("Cannot open output file %s: error %d", outfile, err))
+                perfctr_exit(1)
+            end
+            print = function(...) for k, v in pairs({ ... }) do likwid.writerLine(output_writer, tostring(v)) end end
+        else
+            io.output(outfile)
+            print = function(...) for k, v in pairs({ ... }) do io.write(v .. "\n") end end
+        end
     elseif (opt == "O") then
         use_csv = true
     elseif (opt == "stats") then
         print_stats = true
+    elseif (opt == "live") then
+        marker_live = true
+    elseif (opt == "tree") then
+        marker_tree = true
+    elseif (opt == "ovfwatch") then
+        overflow_watch = true
+    elseif (opt == "mux") then
+        if arg and (arg:match("^%d+$") or arg:match("^%d+%.?%d*[mu]?s$")) and tonumber(arg:match("^[%d%.]+")) > 0 then
+            marker_mux = arg
+        else
+            print_stderr("Option --mux requires a number of region calls or a time in s, ms or us")
+            perfctr_exit(1)
+        end
+    elseif (opt == "sample") then
+        if arg and arg:match("^[^,@%s][^%s]*$") then
+            marker_sample = arg
+        else
+            print_stderr("Option --sample requires a comma-separated list of events with optional @<period>")
+            perfctr_exit(1)
+        end
+    elseif (opt == "samplefile") then
+        sampleFile = arg
+    elseif (opt == "topdown") then
+        use_topdown = true
+    elseif (opt == "roofline") then
+        use_roofline = true
+    elseif (opt == "rooflinefile") then
+        rooflineFile = arg
+    elseif (opt == "attach") then
+        attach_pid = tonumber(arg)
+        if attach_pid == nil or attach_pid <= 0 then
+            print_stderr("Option --attach requires a process ID")
+            perfctr_exit(1)
+        end
+    elseif (opt == "freqtune") then
+        freqtune = tonumber(arg)
+        if freqtune == nil or freqtune < 1 then
+            print_stderr("Option --freqtune requires a positive number of calls per setting")
+            perfctr_exit(1)
+        end
         ---------------------------
     elseif nvSupported and (opt == "G") then
         if arg ~= nil then
@@ -520,6 +613,84 @@ elseif num_cpus == 0 and
     perfctr_exit(1)
 end
 
+if attach_pid then
+    local live, err = likwid.markerLiveAttach(attach_pid)
+    if not live then
+        print_stderr(string.format("Cannot attach to live Marker API results of process %d: error %d", attach_pid, err))
+        print_stderr("The application must be started with likwid-perfctr -m --live.")
+        perfctr_exit(1)
+    end
+    local info = likwid.markerLiveInfo(live)
+    cpulist = info["cpus"]
+    num_cpus = #cpulist
+    if set_access_modes then
+        if likwid.setAccessClientMode(access_mode) ~= 0 then
+            likwid.markerLiveDetach(live)
+            perfctr_exit(1)
+        end
+    end
+    if likwid.init(num_cpus, cpulist) < 0 then
+        likwid.markerLiveDetach(live)
+        perfctr_exit(1)
+    end
+    for _, str in pairs(likwid.stringsplit(info["events"], "|")) do
+        if likwid.addEventSet(str) < 0 then
+            print_stderr(string.format("Cannot add event set %s of process %d", str, attach_pid))
+            likwid.finalize()
+            likwid.markerLiveDetach(live)
+            perfctr_exit(1)
+        end
+    end
+    local running = info["running"]
+    local interval = 0
+    while true do
+        -- The first snapshot contains the totals since the application start
+        local diff = use_timeline and interval > 0
+        results, metrics = likwid.getMarkerLiveResults(live, diff, cpulist, nan2value)
+        if outfile == nil then
+            print_stdout(likwid.hline)
+            if use_timeline then
+                print_stdout(string.format("Process %d, interval %d%s", attach_pid, interval + 1,
+                             (running and "" or ", process finished")))
+            else
+                print_stdout(string.format("Process %d%s", attach_pid, (running and "" or ", process finished")))
+            end
+        end
+        if results and #results > 0 then
+            for r = 1, #results do
+                if use_records then
+                    likwid.printRecord(results[r], metrics[r], cpulist, r)
+                else
+                    likwid.printOutput(results[r], metrics[r], cpulist, r, print_stats)
+                end
+            end
+        elseif outfile == nil then
+            print_stdout("No region results")
+        end
+        if not use_timeline or not running then
+            break
+        end
+        interval = interval + 1
+        local slept = 0
+        while slept < duration and running do
+            local step = math.min(100000, duration - slept)
+            likwid.sleep(step)
+            slept = slept + step
+            running = likwid.markerLiveInfo(live)["running"]
+        end
+        if likwid.getSignalState() ~= 0 then
+            break
+        end
+    end
+    likwid.markerLiveDetach(live)
+    likwid.finalize()
+    if output_writer then
+        likwid.writerClose(output_writer)
+        output_writer = nil
+    end
+    perfctr_exit(0)
+end
+
 if use_timeline and outfile then
     print_stderr("Redirecting output in timeline mode not supported")
     perfctr_exit(1)
@@ -903,6 +1074,50 @@ if print_group_help == true then
     perfctr_exit(0)
 end
 
+if use_topdown then
+    if #event_string_list > 0 then
+        print_stderr("Option --topdown selects the groups itself and cannot be combined with -g")
+        perfctr_exit(1)
+    end
+    if use_stethoscope then
+        print_stderr("Option --topdown is not available in stethoscope mode")
+        perfctr_exit(1)
+    end
+    event_string_list = likwid.getTopdownGroups()
+    if #event_string_list == 0 then
+        print_stderr(string.format("No Top-down groups available for %s", cpuinfo["name"]))
+        perfctr_exit(1)
+    end
+    if use_marker and not marker_mux then
+        marker_mux = "1"
+    end
+    if not switch_time_set and not use_timeline then
+        duration = 500.E03
+    end
+end
+
+if use_roofline then
+    if #event_string_list > 0 or use_topdown then
+        print_stderr("Option --roofline selects the groups itself and cannot be combined with -g or --topdown")
+        perfctr_exit(1)
+    end
+    if use_stethoscope or use_timeline then
+        print_stderr("Option --roofline is not available in stethoscope and timeline mode")
+        perfctr_exit(1)
+    end
+    event_string_list = likwid.getRooflineGroups()
+    if #event_string_list < 2 then
+        print_stderr(string.format("No roofline groups available for %s", cpuinfo["name"]))
+        perfctr_exit(1)
+    end
+    if use_marker and not marker_mux then
+        marker_mux = "1"
+    end
+    if not switch_time_set then
+        duration = 500.E03
+    end
+end
+
 if #event_string_list == 0 and #cuda_event_string_list == 0 and #rocm_event_string_list == 0 and not print_info then
     print_stderr("Option(s) -g <string>, -W <string> (Nvidia) or -R <string> (AMD) must be given on commandline")
     usage()
@@ -988,6 +1203,26 @@ elseif use_timeline == true and use_stethoscope == true then
     print_stderr("Cannot run Timeline and Stethoscope mode simultaneously")
     perfctr_exit(0)
 end
+if marker_live and use_marker == false then
+    print_stderr("Option --live requires the Marker API (-m)")
+    perfctr_exit(1)
+end
+if marker_mux and use_marker == false then
+    print_stderr("Option --mux requires the Marker API (-m)")
+    perfctr_exit(1)
+end
+if marker_tree and use_marker == false then
+    print_stderr("Option --tree requires the Marker API (-m)")
+    perfctr_exit(1)
+end
+if marker_sample and use_marker == false then
+    print_stderr("Option --sample requires the Marker API (-m)")
+    perfctr_exit(1)
+end
+if freqtune and use_marker == false then
+    print_stderr("Option --freqtune requires the Marker API (-m)")
+    perfctr_exit(1)
+end
 
 if use_stethoscope == false and use_timeline == false and use_marker == false then
     use_wrapper = true
@@ -999,6 +1234,11 @@ if use_wrapper and likwid.tablelength(arg) - 2 == 0 and print_info == false then
     perfctr_exit(0)
 end
 
+if use_roofline then
+    print_stderr("Measuring roofline ceilings with likwid-bench")
+    rooflineCeilings = likwid.getRooflineCeilings("<INSTALLED_BINPREFIX>/likwid-bench", cpulist)
+end
+
 if use_marker then
     if likwid.access(markerFile, "rw") ~= -1 then
         print_stderr(string.format("ERROR: MarkerAPI file %s not accessible. Maybe a remaining file of another user.",
@@ -1091,6 +1331,25 @@ if use_marker == true then
     likwid.setenv("LIKWID_THREADS", table.concat(cpulist, ","))
     likwid.setenv("LIKWID_FORCE", "-1")
     likwid.setenv("KMP_INIT_AT_FORK", "FALSE")
+    if freqtune then
+        likwid.setenv("LIKWID_FREQTUNE", tostring(math.tointeger(freqtune)))
+    end
+    if marker_live then
+        likwid.setenv("LIKWID_MARKER_LIVE", "1")
+    end
+    if marker_tree then
+        likwid.setenv("LIKWID_MARKER_TREE", "1")
+    end
+    if overflow_watch then
+        likwid.setenv("LIKWID_OVERFLOW_WATCH", "1")
+    end
+    if marker_mux then
+        likwid.setenv("LIKWID_MARKER_MUX", marker_mux)
+    end
+    if marker_sample then
+        likwid.setenv("LIKWID_MARKER_SAMPLING", marker_sample)
+        likwid.setenv("LIKWID_MARKER_SAMPLING_FILE", sampleFile)
+    end
     if nvSupported and #gpulist_cuda > 0 and #cuda_event_string_list > 0 then
         likwid.setenv("LIKWID_NVMON_GPUS", table.concat(gpulist_cuda, ","))
         str = table.concat(cuda_event_string_list, "|")
@@ -1399,6 +1658,40 @@ if #event_string_list > 0 then
 end
 
 
+-- Group IDs and names of the Top-down groups, the values of the last
+-- measurement of each group select the next group
+local topdownIds = {}
+local topdownNames = {}
+local topdownLast = {}
+local topdownWalkStart = 0
+if use_topdown then
+    for i, name in pairs(event_string_list) do
+        topdownIds[name] = group_ids[i]
+        topdownNames[group_ids[i]] = name
+    end
+end
+
+local function startOverflowWatch()
+    local ret, interval = likwid.startOverflowWatch()
+    if ret < 0 then
+        print_stderr("Cannot start counter overflow watch")
+    elseif verbose > 0 and interval > 0 then
+        print_stdout(string.format("Reading counters for overflows every %.3f seconds", interval))
+    end
+end
+
+local function topdownNext(now)
+    local name = topdownNames[activeGroup]
+    topdownLast[name] = likwid.getTopdownValues(likwid.getLastMetrics(nan2value), activeGroup)
+    local next = likwid.getTopdownNext(name, topdownLast[name], topdownIds)
+    -- In timeline mode, print the tree whenever a walk down the tree is complete
+    if use_timeline and next == event_string_list[1] then
+        likwid.printTopdownTree(topdownLast, string.format("%.2f s - %.2f s", topdownWalkStart, now))
+        topdownWalkStart = now
+    end
+    return topdownIds[next]
+end
+
 io.stdout:flush()
 io.stderr:flush()
 local groupTime = {}
@@ -1422,6 +1715,9 @@ if use_wrapper or use_timeline then
             print_stderr(string.format("Error starting counters for cpu %d.", cpulist[ret * (-1)]))
             perfctr_exit(1)
         end
+        if overflow_watch then
+            startOverflowWatch()
+        end
     end
 
     likwid.sendSignal(pid, 18)
@@ -1492,14 +1788,18 @@ if use_wrapper or use_timeline then
             twork = likwid.getClock(xstart, xstop)
         else
             xstart = likwid.startClock()
-            if #event_string_list > 0 then
+            if #event_string_list > 0 and not overflow_watch then
                 likwid.readCounters()
             end
             xstop = likwid.stopClock()
             twork = likwid.getClock(xstart, xstop)
         end
         if #group_ids > 1 then
-            likwid.switchGroup(activeGroup + 1)
+            if use_topdown then
+                likwid.switchGroup(topdownNext(likwid.getClock(start, likwid.stopClock())))
+            else
+                likwid.switchGroup(activeGroup + 1)
+            end
             activeGroup = likwid.getIdOfActiveGroup()
             if groupTime[activeGroup] == nil then
                 groupTime[activeGroup] = 0
@@ -1515,6 +1815,9 @@ elseif use_stethoscope then
         print_stderr(string.format("Error starting counters for cpu %d.", cpulist[ret * (-1)]))
         perfctr_exit(1)
     end
+    if overflow_watch then
+        startOverflowWatch()
+    end
     likwid.sleep(duration)
 elseif use_marker then
     likwid.sendSignal(pid, 18)
@@ -1523,6 +1826,9 @@ end
 
 if not use_marker then
     if #event_string_list > 0 then
+        if overflow_watch then
+            likwid.stopOverflowWatch()
+        end
         local ret = likwid.stopCounters()
         if ret < 0 then
             print_stderr(string.format("Error stopping counters for thread %d.", ret * (-1)))
@@ -1547,7 +1853,48 @@ if use_marker == true then
                 print_stderr("No regions could be found in Marker API result file.")
             else
                 for r = 1, #results do
-                    likwid.printOutput(results[r], metrics[r], cpulist, r, print_stats)
+                    if use_records then
+                        likwid.printRecord(results[r], metrics[r], cpulist, r)
+                    else
+                        likwid.printOutput(results[r], metrics[r], cpulist, r, print_stats)
+                    end
+                end
+                if marker_tree and not use_records then
+                    likwid.printRegionTree()
+                end
+                if use_topdown and not use_records then
+                    local regions = {}
+                    local tags = {}
+                    for r = 1, #results do
+                        local tag = likwid.markerRegionTag(r)
+                        local gid = likwid.markerRegionGroup(r)
+                        if not regions[tag] then
+                            regions[tag] = {}
+                            table.insert(tags, tag)
+                        end
+                        regions[tag][likwid.getNameOfGroup(gid)] = likwid.getTopdownValues(metrics[r], gid)
+                    end
+                    for _, tag in pairs(tags) do
+                        likwid.printTopdownTree(regions[tag], "Region " .. tag)
+                    end
+                end
+                if use_roofline and not use_records then
+                    local regions = {}
+                    local tags = {}
+                    for r = 1, #results do
+                        local tag = likwid.markerRegionTag(r)
+                        if not regions[tag] then
+                            regions[tag] = {name = tag, values = {}}
+                            table.insert(tags, regions[tag])
+                        end
+                        likwid.getRooflineValues(metrics[r], likwid.markerRegionGroup(r), regions[tag].values)
+                    end
+                    if not likwid.printRoofline(tags, rooflineCeilings, rooflineFile, "Marker API regions") and exitvalue == 0 then
+                        exitvalue = 1
+                    end
+                end
+                if marker_sample and not use_records then
+                    likwid.printSampleHistogram(sampleFile, 10)
                 end
             end
             os.remove(markerFile)
@@ -1601,7 +1948,29 @@ elseif use_timeline == false then
     if #event_string_list > 0 then
         results = likwid.getResults(nan2value)
         metrics = likwid.getMetrics(nan2value)
-        likwid.printOutput(results, metrics, cpulist, nil, print_stats)
+        if use_records then
+            likwid.printRecord(results, metrics, cpulist, nil)
+        elseif use_topdown then
+            local values = {}
+            for i, gid in pairs(group_ids) do
+                if likwid.getRuntimeOfGroup(gid) > 0 then
+                    values[event_string_list[i]] = likwid.getTopdownValues(metrics, gid)
+                end
+            end
+            likwid.printTopdownTree(values, "whole runtime")
+        elseif use_roofline then
+            local values = {}
+            for i, gid in pairs(group_ids) do
+                if likwid.getRuntimeOfGroup(gid) > 0 then
+                    likwid.getRooflineValues(metrics, gid, values)
+                end
+            end
+            if not likwid.printRoofline({{name = "whole runtime", values = values}}, rooflineCeilings, rooflineFile, "whole runtime") and exitvalue == 0 then
+                exitvalue = 1
+            end
+        else
+            likwid.printOutput(results, metrics, cpulist, nil, print_stats)
+        end
     end
 end
 
@@ -1611,7 +1980,10 @@ if outfile and not use_timeline then
         suffix = string.match(outfile, ".-[^\\/]-%.?([^%.\\/]*)$")
     end
     local command = "<INSTALLED_PREFIX>/share/likwid/filter/" .. suffix
-    if suffix:len() > 0 and suffix ~= "csv" and suffix ~= "txt" then
+    if output_writer then
+        likwid.writerClose(output_writer)
+        output_writer = nil
+    elseif suffix:len() > 0 and suffix ~= "csv" and suffix ~= "txt" and suffix ~= "jsonl" then
         if likwid.access(command, "x") == 0 then
             local tmpfile = outfile .. ".tmp"
             os.rename(outfile, tmpfile)
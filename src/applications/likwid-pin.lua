@@ -65,6 +65,15 @@ local function examples()
     print_stdout("Example usage scatter: likwid-pin.lua -c M:scatter ./myApp")
     print_stdout("This will generate a thread to processor mapping scattered among all memory domains")
     print_stdout("with physical hardware threads first.")
+    print_stdout("5. Placement policies computed from the topology.")
+    print_stdout("Example usage policy: likwid-pin.lua -c P:scatter:L3:8 ./myApp")
+    print_stdout("This will spread eight threads over all L3 cache groups (CCDs on AMD Zen), physical cores first.")
+    print_stdout("The following policies are available:")
+    print_stdout("\t1. -c P:compact[:<number of threads>] fills physical cores first, SMT siblings last")
+    print_stdout("\t2. -c P:scatter[:<level>][:<number of threads>] round-robin over all groups of <level>")
+    print_stdout("\t3. -c P:balanced[:<level>][:<number of threads>] evenly split and contiguous per group")
+    print_stdout("\t4. -c P:one[:<level>] one thread per group, e.g. P:one:L2 for one thread per L2 cluster")
+    print_stdout("\tLevels are the affinity domain types S, D, C, M, N or the cache levels L1, L2, L3")
     print_stdout("")
     print_stdout("likwid-pin sets OMP_NUM_THREADS with as many threads as specified")
     print_stdout("in your pin expression if OMP_NUM_THREADS is not present in your environment.")
@@ -81,15 +90,81 @@ local function usage()
     print_stdout("-m\t\t\t Set numa membind policy with all involved numa nodes")
     print_stdout("-S, --sweep\t\t Sweep memory and LLC of involved NUMA nodes")
     print_stdout("-c/-C <list>\t\t Comma separated processor IDs or expression")
-    print_stdout("-s, --skip <hex>\t Bitmask with threads to skip")
+    print_stdout("-s, --skip <hex>\t Bitmask with threads to skip, may be longer than 64 bit")
     print_stdout("-p\t\t\t Print available domains with mapping on physical IDs")
     print_stdout("\t\t\t If used together with -c option outputs the list of physical processor IDs.")
     print_stdout("-d <string>\t\t Delimiter used for using -p to output physical processor list, default is comma.")
+    print_stdout("-M, --map\t\t Print the thread to hardware thread map with its topological location")
+    print_stdout("-a, --audit <sec>\t Sample the NUMA page placement every <sec> seconds and report the")
+    print_stdout("\t\t\t local and remote pages per thread of the last sample before exit")
+    print_stdout("--migrate\t\t With -a, move pages to the NUMA domain of the thread touching them")
     print_stdout("-q, --quiet\t\t Silent without output")
     print_stdout("\n")
     examples()
 end
 
+local function domain_of_cpu(typ, cpu)
+    for _, d in pairs(affinity["domains"]) do
+        if d["tag"]:sub(1,1) == typ and d["tag"]:len() > 1 then
+            for _, c in pairs(d["processorList"]) do
+                if c == cpu then
+                    return d["tag"]
+                end
+            end
+        end
+    end
+    return "-"
+end
+
+local function print_thread_map(cpu_list)
+    local pool = {}
+    for _, t in pairs(cputopo["threadPool"]) do
+        pool[t["apicId"]] = t
+    end
+    print_stdout(string.format("%-8s %-10s %-8s %-8s %-8s %-8s %s", "Thread", "HWThread", "SMT", "Core", "Socket", "LLC", "NUMA"))
+    for i, cpu in pairs(cpu_list) do
+        local t = pool[cpu]
+        if t then
+            print_stdout(string.format("%-8d %-10d %-8d %-8d %-8d %-8s %s", i-1, cpu,
+                                       t["threadId"], t["coreId"], t["packageId"],
+                                       domain_of_cpu("C", cpu), domain_of_cpu("M", cpu)))
+        else
+            print_stdout(string.format("%-8d %-10d %-8s %-8s %-8s %-8s %s", i-1, cpu, "-", "-", "-", "-", "-"))
+        end
+    end
+end
+
+local function print_numa_audit(audit)
+    if not audit then
+        print_stderr("NUMA audit: No sample of the page placement available")
+        return
+    end
+    print_stdout(likwid.hline)
+    print_stdout(string.format("NUMA page placement: %d pages in %d regions", audit["totalPages"], audit["numberOfRegions"]))
+    for i, pages in pairs(audit["nodePages"]) do
+        local frac = 0
+        if audit["totalPages"] > 0 then
+            frac = 100.0 * pages / audit["totalPages"]
+        end
+        print_stdout(string.format("NUMA node %d: %d pages (%.1f%%)", numainfo["nodes"][i]["id"], pages, frac))
+    end
+    print_stdout(string.format("%-8s %-10s %-6s %-12s %-12s %-8s %s", "Thread", "HWThread", "NUMA", "Local", "Remote", "Local%", "Migrated"))
+    for i, t in pairs(audit["threads"]) do
+        local node = "-"
+        if t["node"] >= 0 then
+            node = tostring(numainfo["nodes"][t["node"]+1]["id"])
+        end
+        local total = t["localPages"] + t["remotePages"]
+        local frac = 100.0
+        if total > 0 then
+            frac = 100.0 * t["localPages"] / total
+        end
+        print_stdout(string.format("%-8d %-10d %-6s %-12d %-12d %-8.1f %d", i-1, t["cpu"], node,
+                                   t["localPages"], t["remotePages"], frac, t["migratedPages"]))
+    end
+    print_stdout(likwid.hline)
+end
+
 local function close_and_exit(code)
     likwid.putTopology()
     likwid.putAffinityInfo()
@@ -104,6 +179,9 @@ sweep_sockets = false
 interleaved_policy = false
 membind_policy = false
 print_domains = false
+print_map = false
+audit_interval = nil
+migrate_pages = false
 cpu_list = {}
 skip_mask = nil
 affinity = nil
@@ -117,7 +195,7 @@ if (#arg == 0) then
     os.exit(0)
 end
 
-for opt,arg in likwid.getopt(arg, {"c:", "C:", "d:", "h", "i", "m", "p", "q", "s:", "S", "t:", "v", "V:", "verbose:", "help", "version", "skip","sweep", "quiet"}) do
+for opt,arg in likwid.getopt(arg, {"c:", "C:", "d:", "h", "i", "m", "M", "p", "q", "s:", "S", "t:", "v", "V:", "verbose:", "help", "version", "skip:", "sweep", "quiet", "map", "a:", "audit:", "migrate"}) do
     if opt == "h" or opt == "help" then
         usage()
         close_and_exit(0)
@@ -139,11 +217,21 @@ for opt,arg in likwid.getopt(arg, {"c:", "C:", "d:", "h", "i", "m", "p", "q", "s
         membind_policy = true
     elseif (opt == "p") then
         print_domains = true
+    elseif opt == "M" or opt == "map" then
+        print_map = true
+    elseif opt == "a" or opt == "audit" then
+        audit_interval = tonumber(arg)
+        if not audit_interval or audit_interval <= 0 then
+            print_stderr("Audit interval must be a positive number of seconds")
+            close_and_exit(1)
+        end
+    elseif opt == "migrate" then
+        migrate_pages = true
     elseif opt == "s" or opt == "skip" then
-        if arg:match("0x[0-9A-Fa-f]") then
+        if arg:match("^0x[0-9A-Fa-f]+$") then
             skip_mask = arg
         else
-            if arg:match("[0-9A-Fa-f]") then
+            if arg:match("^[0-9A-Fa-f]+$") then
                 print_stderr("Given skip mask looks like hex, sanitizing arg to 0x"..arg)
                 skip_mask = "0x"..arg
             else
@@ -211,9 +299,18 @@ elseif print_domains then
     close_and_exit(0)
 end
 
+if migrate_pages and not audit_interval then
+    print_stderr("Option --migrate requires -a/--audit")
+    close_and_exit(1)
+end
+
 if num_threads == 0 then
     num_threads, cpu_list = likwid.cpustr_to_cpulist("N")
 end
+if print_map and #arg == 0 then
+    print_thread_map(cpu_list)
+    close_and_exit(0)
+end
 if (#arg == 0) then
     print_stderr("Executable must be given on commandline")
     close_and_exit(1)
@@ -301,6 +398,9 @@ else
 end
 
 local exec = table.concat(execList," ")
+if print_map and quiet == 0 then
+    print_thread_map(cpu_list)
+end
 if verbose > 0 and quiet == 0 then
     print_stdout("Running: " .. exec)
     mask = 0
@@ -320,7 +420,34 @@ if (pid == nil) then
     close_and_exit(1)
 end
 
-local exitvalue = likwid.waitpid(pid)
+local exitvalue = 0
+if audit_interval then
+    -- The address space is gone at exit, so report the last sample
+    local audit = nil
+    local exited = false
+    local step = math.min(audit_interval, 0.1)
+    local elapsed = 0
+    while not exited do
+        likwid.sleep(math.floor(step * 1E6))
+        elapsed = elapsed + step
+        exitvalue, exited = likwid.checkProgram(pid)
+        if not exited and elapsed >= audit_interval then
+            elapsed = 0
+            local sample, err = likwid.auditNumaPages(pid, #cpu_list, cpu_list, migrate_pages)
+            if sample then
+                audit = sample
+                if verbose > 0 and quiet == 0 then
+                    print_numa_audit(audit)
+                end
+            elseif verbose > 0 then
+                print_stderr(string.format("NUMA audit failed with error %d", err))
+            end
+        end
+    end
+    print_numa_audit(audit)
+else
+    exitvalue = likwid.waitpid(pid)
+end
 
 likwid.putAffinityInfo()
 likwid.putTopology()
@@ -47,6 +47,9 @@ local function examples()
     print_stdout("")
     print_stdout("Use it as wrapper for an application to measure the energy for the whole execution")
     print_stdout("likwid-powermeter -c 1 ./a.out")
+    print_stdout("")
+    print_stdout("Sample the energy counters every 10ms in the background and report peak power")
+    print_stdout("likwid-powermeter -r 10ms -c 0 ./a.out")
 end
 
 local function usage()
@@ -56,10 +59,11 @@ local function usage()
     print_stdout("-h, --help\t Help message")
     print_stdout("-v, --version\t Version information")
     print_stdout("-V, --verbose <level>\t Verbose output, 0 (only errors), 1 (info), 2 (details), 3 (developer)")
-    print_stdout("-M <0|1>\t\t Set how MSR registers are accessed, 0=direct, 1=accessDaemon")
+    print_stdout("-M <0|1|2>\t\t Set how MSR registers are accessed, 0=direct, 1=accessDaemon, 2=simulated")
     print_stdout("-c <list>\t\t Specify sockets to measure")
     print_stdout("-i, --info\t Print information from MSR_PKG_POWER_INFO register and Turbo mode")
     print_stdout("-s <duration>\t Set measure duration in us, ms or s. (default 2s)")
+    print_stdout("-r <interval>\t Sample energy counters in the background with interval in ms or s (min. 1ms)")
     print_stdout("-p\t\t Print dynamic clocking and CPI values, uses likwid-perfctr")
     print_stdout("-t\t\t Print current temperatures of all hardware threads")
     print_stdout("-f\t\t Print current temperatures in Fahrenheit")
@@ -83,6 +87,7 @@ end
 time_interval = 2.E06
 time_orig = "2s"
 read_interval = 30.E06
+sample_interval = nil
 sockets = {}
 raw_selection = nil
 cpuinfo = likwid.getCpuInfo()
@@ -95,7 +100,7 @@ cputopo = likwid.getCpuTopology()
 numatopo = likwid.getNumaInfo()
 affinity = likwid_getAffinityInfo()
 
-for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "s:", "v", "f", "t", "help", "info", "version", "verbose:"}) do
+for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "r:", "s:", "v", "f", "t", "help", "info", "version", "verbose:"}) do
     if (type(arg) == "string") then
         local s,e = arg:find("-");
         if s == 1 then
@@ -122,7 +127,7 @@ for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "s:", "v", "
             print_stderr("Access mode (-M) must be an number")
             usage()
             os.exit(1)
-        elseif (access_mode < 0) or (access_mode > 1) then
+        elseif (access_mode < 0) or (access_mode > 2) then
             print_stderr(string.format("Access mode (-M) %d not valid.",access_mode))
             usage()
             os.exit(1)
@@ -139,6 +144,12 @@ for opt,arg in likwid.getopt(arg, {"V:", "c:", "h", "i", "M:", "p", "s:", "v", "
     elseif opt == "V" or opt == "verbose" then
         verbose = tonumber(arg)
         likwid.setVerbosity(verbose)
+    elseif (opt == "r") then
+        sample_interval = likwid.parse_time(arg)
+        if sample_interval < 1000 then
+            print_stderr("Sampling interval (-r) must be at least 1ms")
+            os.exit(1)
+        end
     elseif (opt == "s") then
         time_interval = likwid.parse_time(arg)
         time_orig = arg
@@ -288,9 +299,56 @@ else
     execString = execString .. table.concat(execList," ")
 end
 
+local service_energy = {}
+local service_peak = {}
+local service_time = 0
+local function service_collect()
+    local t_now = likwid.powerServiceTime()
+    for i,socket in pairs(sockets) do
+        for idx, dom in pairs(domainList) do
+            if dom ~= "CORE" and power["domains"][dom] and power["domains"][dom]["supportStatus"] then
+                local e = likwid.powerServiceEnergy(tonumber(socket), idx, service_time, t_now)
+                if e then
+                    service_energy[socket][dom] = service_energy[socket][dom] + e
+                end
+                local t = service_time
+                while t + sample_interval <= t_now do
+                    e = likwid.powerServiceEnergy(tonumber(socket), idx, t, t + sample_interval)
+                    if e and e/sample_interval > service_peak[socket][dom] then
+                        service_peak[socket][dom] = e/sample_interval
+                    end
+                    t = t + sample_interval
+                end
+            end
+        end
+    end
+    service_time = t_now
+end
+
 local exitvalue = 0
 if not print_info and not print_temp then
     if stethoscope or (#arg > 0 and not use_perfctr) then
+        if sample_interval then
+            sample_interval = sample_interval * 1.E-06
+            if read_interval * 1.E-06 > 1000 * sample_interval then
+                read_interval = 1.E06 * 1000 * sample_interval
+            end
+            local samples = math.ceil(2 * read_interval * 1.E-06 / sample_interval) + 2
+            if likwid.startPowerService(-1, sample_interval, samples) ~= 0 then
+                print_stderr("Failed to start background energy sampling")
+                sample_interval = nil
+            else
+                service_time = likwid.powerServiceTime()
+                for i,socket in pairs(sockets) do
+                    service_energy[socket] = {}
+                    service_peak[socket] = {}
+                    for _, dom in pairs(domainList) do
+                        service_energy[socket][dom] = 0
+                        service_peak[socket][dom] = 0
+                    end
+                end
+            end
+        end
         for i,socket in pairs(sockets) do
             for idx, dom in pairs(domainList) do
                 if dom ~= "CORE" then
@@ -333,6 +391,7 @@ if not print_info and not print_temp then
                             end
                         end
                     end
+                    if sample_interval then service_collect() end
                     time_interval = time_interval - read_interval
                     if time_interval < read_interval then
                         read_interval = time_interval
@@ -362,6 +421,7 @@ if not print_info and not print_temp then
                         end
                     end
                 end
+                if sample_interval then service_collect() end
                 exitvalue, exited = likwid.checkProgram(pid)
                 if exited then
                     io.stdout:flush()
@@ -370,6 +430,10 @@ if not print_info and not print_temp then
             end
         end
         time_after = likwid.stopClock()
+        if sample_interval then
+            service_collect()
+            likwid.stopPowerService()
+        end
 
         for i,socket in pairs(sockets) do
             cpu = sock_cpulist[socket][1]
@@ -401,9 +465,15 @@ if not print_info and not print_temp then
             for j, dom in pairs(domainList) do
                 if power["domains"][dom] and power["domains"][dom]["supportStatus"] then
                     local energy = likwid.calcPower(before[cpu][dom], after[cpu][dom], j-1)
+                    if sample_interval and dom ~= "CORE" then
+                        energy = service_energy[socket][dom]
+                    end
                     print_stdout(string.format("Domain %s:", dom))
                     print_stdout(string.format("Energy consumed: %g Joules", energy))
                     print_stdout(string.format("Power consumed: %g Watt", energy/runtime))
+                    if sample_interval and dom ~= "CORE" then
+                        print_stdout(string.format("Peak power (%g ms): %g Watt", sample_interval*1.E03, service_peak[socket][dom]))
+                    end
                 end
             end
             if i < #sockets then print_stdout("") end
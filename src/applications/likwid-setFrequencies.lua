@@ -120,6 +120,18 @@ function valid_freq(freq, freq_list, turbofreq)
     return valid_freq
 end
 
+function report_list_result(what, ret, errors)
+    if ret < 0 then
+        print_stderr(string.format("ERROR: Setting %s failed with error %d", what, ret))
+        return
+    end
+    for i, err in pairs(errors) do
+        if err ~= 0 then
+            print_stderr(string.format("ERROR: Setting %s failed on HWThread %d with error %d", what, cpulist[i], err))
+        end
+    end
+end
+
 function get_base_freq()
     freq = nil
     f = io.open("/sys/devices/system/cpu/cpu0/cpufreq/base_frequency", "r")
@@ -333,15 +345,11 @@ end
 if printCurFreq then
     str = {"Current CPU frequencies:"}
     local processed = 0
-    for i=1,#cpulist do
-        gov = likwid.getGovernor(cpulist[i])
-        freq = tonumber(likwid.getCpuClockCurrent(cpulist[i]))/1E6
-        min = tonumber(likwid.getCpuClockMin(cpulist[i]))/1E6
-        max = tonumber(likwid.getCpuClockMax(cpulist[i]))/1E6
-        t = tonumber(likwid.getTurbo(cpulist[i]));
-        if gov and freq and min and max and t >= 0 then
+    local states = likwid.getCpuFreqStates(cpulist) or {}
+    for i, st in pairs(states) do
+        if st.error == 0 and st.turbo >= 0 then
             processed = processed + 1
-            table.insert(str, string.format("HWThread %d: governor %12s min/cur/max %s/%s/%s GHz Turbo %d",cpulist[i], gov, round(min), round(freq), round(max), t))
+            table.insert(str, string.format("HWThread %d: governor %12s min/cur/max %s/%s/%s GHz Turbo %d",st.cpu, st.governor, round(st.min/1E6), round(st.cur/1E6), round(st.max/1E6), st.turbo))
         end
     end
     table.insert(str, "")
@@ -519,10 +527,10 @@ end
 
 min_first = false
 max_first = false
-if min_freq and tonumber(min_freq)/1E6 > tonumber(likwid.getCpuClockMax(cpulist[i]))/1E6 then
+if min_freq and tonumber(min_freq)/1E6 > tonumber(likwid.getCpuClockMax(cpulist[1]))/1E6 then
     max_first = true
 end
-if max_freq and tonumber(max_freq)/1E6 < tonumber(likwid.getCpuClockMin(cpulist[i]))/1E6 then
+if max_freq and tonumber(max_freq)/1E6 < tonumber(likwid.getCpuClockMin(cpulist[1]))/1E6 then
     min_first = true
 end
 
@@ -537,28 +545,18 @@ end
 
 
 if max_first and max_freq then
-    for i=1,#cpulist do
-        local f = likwid.setCpuClockMax(cpulist[i], max_freq)
-    end
+    report_list_result("maximal frequency", likwid.setCpuClockMaxList(cpulist, max_freq))
     if min_freq then
-        for i=1,#cpulist do
-            local f = likwid.setCpuClockMin(cpulist[i], min_freq)
-        end
+        report_list_result("minimal frequency", likwid.setCpuClockMinList(cpulist, min_freq))
     end
 elseif min_first and min_freq then
-    for i=1,#cpulist do
-        local f = likwid.setCpuClockMin(cpulist[i], min_freq)
-    end
+    report_list_result("minimal frequency", likwid.setCpuClockMinList(cpulist, min_freq))
     if max_freq then
-        for i=1,#cpulist do
-            local f = likwid.setCpuClockMax(cpulist[i], max_freq)
-        end
+        report_list_result("maximal frequency", likwid.setCpuClockMaxList(cpulist, max_freq))
     end
 elseif min_freq and max_freq then
-    for i=1,#cpulist do
-        local f = likwid.setCpuClockMin(cpulist[i], min_freq)
-        local f = likwid.setCpuClockMax(cpulist[i], max_freq)
-    end
+    report_list_result("minimal frequency", likwid.setCpuClockMinList(cpulist, min_freq))
+    report_list_result("maximal frequency", likwid.setCpuClockMaxList(cpulist, max_freq))
 end
 
 if min_u_freq then
@@ -618,13 +616,11 @@ if governor then
         print_stdout(string.format("DEBUG: Set governor %s", governor))
     end
     local govs = likwid.getAvailGovs(cpulist[1])
-    local cur_govs = {}
     local cur_min = {}
     local cur_max = {}
-    for i,c in pairs(cpulist) do
-        cur_govs[i] = likwid.getGovernor(c)
-        cur_min[i] = likwid.getCpuClockMin(c)
-        cur_max[i] = likwid.getCpuClockMax(c)
+    for i, st in pairs(likwid.getCpuFreqStates(cpulist) or {}) do
+        cur_min[i] = st.min or 0
+        cur_max[i] = st.max or 0
     end
 
     local valid_gov = false
@@ -636,15 +632,13 @@ if governor then
     end
     local cur_freqs = {}
     if valid_gov then
-        for i=1,#cpulist do
-            if verbosity == 3 then
-                print_stdout(string.format("DEBUG: Set governor for CPU %d to %s", cpulist[i], governor))
-            end
-            local f = likwid.setGovernor(cpulist[i], governor)
-            if do_reset then
-                likwid.setCpuClockMin(cpulist[i], cur_min[i])
-                likwid.setCpuClockMax(cpulist[i], cur_max[i])
-            end
+        if verbosity == 3 then
+            print_stdout(string.format("DEBUG: Set governor for CPUs %s to %s", table.concat(cpulist, ","), governor))
+        end
+        report_list_result("governor", likwid.setGovernorList(cpulist, governor))
+        if do_reset then
+            likwid.setCpuClockMinList(cpulist, cur_min)
+            likwid.setCpuClockMaxList(cpulist, cur_max)
         end
     else
         print_stderr(string.format("ERROR: Governor %s not available! Please select one of\n%s", governor, table.concat(govs, ", ")))
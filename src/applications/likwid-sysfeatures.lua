@@ -298,18 +298,37 @@ if listFeatures and #hwtlist > 0 then
     end
     setmetatable(first, {align = "left"})
     table.insert(all, first)
+    -- read all features for all devices at once
+    local names = {}
+    local devices = {}
+    local devIdx = {}
+    for _,f in pairs(list) do
+        table.insert(names, string.format("%s.%s", f.Category, f.Name))
+    end
+    for l, ltab in pairs(deviceTree) do
+        for _, e in pairs(ltab) do
+            if e.device then
+                table.insert(devices, e.device)
+                devIdx[e.device] = #devices
+            end
+        end
+    end
+    local snapshot = likwid.sysFeatures_snapshot(names, devices)
     -- create one column per given hw thread with the current value of the feature
     for i, c in pairs(hwtlist) do
         local tab = {}
         table.insert(tab, string.format("HWThread %d", c))
-        for _,f in pairs(list) do
+        for fidx,f in pairs(list) do
             local dev = getDevice(f.TypeID, c)
             if dev then
-                local v = likwid.sysFeatures_get(f.Name, dev)
+                local v = nil
+                if snapshot then
+                    v = snapshot[fidx][devIdx[dev]]
+                end
                 if v == nil then
                     table.insert(tab, "fail")
                 else
-                    table.insert(tab, v)
+                    table.insert(tab, tostring(v))
                 end
             else
                 table.insert(tab, "-")
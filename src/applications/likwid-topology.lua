@@ -61,6 +61,7 @@ print_gpus = false
 print_graphical = false
 measure_clock = false
 outfile = nil
+output_writer = nil
 output_csv = {}
 
 for opt,arg in likwid.getopt(arg, {"h","v","c","C","g","o:","V:", "G","O","help","version","verbose:","clock","caches","output:", "gpus"}) do
@@ -103,8 +104,18 @@ for opt,arg in likwid.getopt(arg, {"h","v","c","C","g","o:","V:", "G","O","help"
             print_csv = true
         end
         outfile = arg:gsub("%%h", likwid.gethostname())
-        io.output(arg..".tmp")
-        print = function(...) for k,v in pairs({...}) do io.write(v .. "\n") end end
+        if suffix == "json" then
+            local err = nil
+            output_writer, err = likwid.writerOpen(outfile, "json", "topology")
+            if not output_writer then
+                print_stderr(string.format("Cannot open output file %s: error %d", outfile, err))
+                os.exit(1)
+            end
+            print = function(...) for k,v in pairs({...}) do likwid.writerLine(output_writer, tostring(v)) end end
+        else
+            io.output(arg..".tmp")
+            print = function(...) for k,v in pairs({...}) do io.write(v .. "\n") end end
+        end
     elseif opt == "?" then
         print_stderr("Invalid commandline option -"..arg)
         os.exit(1)
@@ -491,7 +502,10 @@ if print_graphical and not print_csv then
     end
 end
 
-if outfile then
+if output_writer then
+    likwid.writerClose(output_writer)
+    output_writer = nil
+elseif outfile then
     local suffix = ""
     if string.match(outfile, ".-[^\\/]-%.?([^%.\\/]*)$") then
         suffix = string.match(outfile, ".-[^\\/]-%.?([^%.\\/]*)$")
@@ -60,6 +60,8 @@ likwid.startCounters = likwid_startCounters
 likwid.stopCounters = likwid_stopCounters
 likwid.readCounters = likwid_readCounters
 likwid.switchGroup = likwid_switchGroup
+likwid.startOverflowWatch = likwid_startOverflowWatch
+likwid.stopOverflowWatch = likwid_stopOverflowWatch
 likwid.finalize = likwid_finalize
 likwid.getEventsAndCounters = likwid_getEventsAndCounters
 likwid.getResult = likwid_getResult
@@ -78,15 +80,25 @@ likwid.getNameOfEvent = likwid_getNameOfEvent
 likwid.getNameOfCounter = likwid_getNameOfCounter
 likwid.getNameOfGroup = likwid_getNameOfGroup
 likwid.getGroups = likwid_getGroups
+likwid.buildGroupCatalogue = likwid_buildGroupCatalogue
+likwid.aggregateRecords = likwid_aggregateRecords
 likwid.getShortInfoOfGroup = likwid_getShortInfoOfGroup
 likwid.getLongInfoOfGroup = likwid_getLongInfoOfGroup
 likwid.getCpuInfo = likwid_getCpuInfo
 likwid.getCpuTopology = likwid_getCpuTopology
 likwid.putTopology = likwid_putTopology
+likwid.writeTopologyCache = likwid_writeTopologyCache
 likwid.getNumaInfo = likwid_getNumaInfo
 likwid.putNumaInfo = likwid_putNumaInfo
 likwid.setMemInterleaved = likwid_setMemInterleaved
 likwid.setMembind = likwid_setMembind
+likwid.auditNumaPages = likwid_auditNumaPages
+likwid.writerOpen = likwid_writerOpen
+likwid.writerLine = likwid_writerLine
+likwid.writerRow = likwid_writerRow
+likwid.writerClose = likwid_writerClose
+likwid.monitorRun = likwid_monitorRun
+likwid.monitorQuery = likwid_monitorQuery
 likwid.getAffinityInfo = likwid_getAffinityInfo
 likwid.putAffinityInfo = likwid_putAffinityInfo
 likwid.getPowerInfo = likwid_getPowerInfo
@@ -103,6 +115,10 @@ likwid.sleep = sleep
 likwid.startPower = likwid_startPower
 likwid.stopPower = likwid_stopPower
 likwid.calcPower = likwid_printEnergy
+likwid.startPowerService = likwid_startPowerService
+likwid.stopPowerService = likwid_stopPowerService
+likwid.powerServiceTime = likwid_powerServiceTime
+likwid.powerServiceEnergy = likwid_powerServiceEnergy
 likwid.getPowerLimit = likwid_powerLimitGet
 likwid.setPowerLimit = likwid_powerLimitSet
 likwid.statePowerLimit = likwid_powerLimitState
@@ -143,6 +159,10 @@ likwid.getCpuFeatures = likwid_cpuFeaturesGet
 likwid.enableCpuFeatures = likwid_cpuFeaturesEnable
 likwid.disableCpuFeatures = likwid_cpuFeaturesDisable
 likwid.readMarkerFile = likwid_readMarkerFile
+likwid.markerLiveAttach = likwid_markerLiveAttach
+likwid.markerLiveInfo = likwid_markerLiveInfo
+likwid.readMarkerLive = likwid_readMarkerLive
+likwid.markerLiveDetach = likwid_markerLiveDetach
 likwid.destroyMarkerFile = likwid_destroyMarkerFile
 likwid.markerNumRegions = likwid_markerNumRegions
 likwid.markerRegionGroup = likwid_markerRegionGroup
@@ -152,8 +172,10 @@ likwid.markerRegionCpulist = likwid_markerRegionCpulist
 likwid.markerRegionThreads = likwid_markerRegionThreads
 likwid.markerRegionTime = likwid_markerRegionTime
 likwid.markerRegionCount = likwid_markerRegionCount
+likwid.markerRegionCoverage = likwid_markerRegionCoverage
 likwid.markerRegionResult = likwid_markerRegionResult
 likwid.markerRegionMetric = likwid_markerRegionMetric
+likwid.markerRegionTree = likwid_markerRegionTree
 likwid.initFreq = likwid_initFreq
 likwid.getCpuClockBase = likwid_getCpuClockBase
 likwid.getCpuClockCurrent = likwid_getCpuClockCurrent
@@ -165,6 +187,10 @@ likwid.getConfCpuClockMax = likwid_getConfCpuClockMax
 likwid.setCpuClockMax = likwid_setCpuClockMax
 likwid.getGovernor = likwid_getGovernor
 likwid.setGovernor = likwid_setGovernor
+likwid.getCpuFreqStates = likwid_getCpuFreqStates
+likwid.setCpuClockMinList = likwid_setCpuClockMinList
+likwid.setCpuClockMaxList = likwid_setCpuClockMaxList
+likwid.setGovernorList = likwid_setGovernorList
 likwid.finalizeFreq = likwid_finalizeFreq
 likwid.setTurbo = likwid_setTurbo
 likwid.getTurbo = likwid_getTurbo
@@ -184,6 +210,7 @@ likwid.initSysFeatures = likwid_initSysFeatures
 likwid.sysFeatures_list = likwid_sysFeatures_list
 likwid.sysFeatures_get = likwid_sysFeatures_get
 likwid.sysFeatures_set = likwid_sysFeatures_set
+likwid.sysFeatures_snapshot = likwid_sysFeatures_snapshot
 likwid.finalizeSysFeatures = likwid_finalizeSysFeatures
 
 likwid.createDevice = likwid_createDevice
@@ -882,11 +909,19 @@ local function printOutput(results, metrics, cpulist, region, stats)
         local runtime = likwid.getRuntimeOfGroup(g)
         local groupName = likwid.getNameOfGroup(g)
         if region ~= nil then
-            infotab[1] = {"Region Info","RDTSC Runtime [s]","call count"}
+            local multiplexed = (likwid.markerRegionCoverage(region, 1) >= 0)
+            if multiplexed then
+                infotab[1] = {"Region Info","RDTSC Runtime [s]","group coverage [%]","call count"}
+            else
+                infotab[1] = {"Region Info","RDTSC Runtime [s]","call count"}
+            end
             for c, cpu in pairs(cur_cpulist) do
                 local tmpList = {}
                 table.insert(tmpList, "HWThread "..tostring(cpu))
                 table.insert(tmpList, string.format("%.6f", likwid.markerRegionTime(region, c)))
+                if multiplexed then
+                    table.insert(tmpList, string.format("%.2f", 100*likwid.markerRegionCoverage(region, c)))
+                end
                 table.insert(tmpList, tostring(likwid.markerRegionCount(region, c)))
                 table.insert(infotab, tmpList)
             end
@@ -1019,6 +1054,799 @@ end
 
 likwid.printOutput = printOutput
 
+local function jsonString(s)
+    s = tostring(s):gsub('[%c"\\]', function(c)
+        if c == '"' then return '\\"' end
+        if c == '\\' then return '\\\\' end
+        return string.format("\\u%04x", c:byte())
+    end)
+    return '"'..s..'"'
+end
+
+local function jsonNumber(v)
+    v = tonumber(v)
+    if v == nil or v ~= v or v == math.huge or v == -math.huge then
+        return "null"
+    end
+    return string.format("%.17g", v)
+end
+
+local function jsonList(list, conv)
+    local out = {}
+    for i=1,#list do
+        table.insert(out, conv(list[i]))
+    end
+    return "["..table.concat(out, ",").."]"
+end
+
+local function printRecord(results, metrics, cpulist, region)
+    local host = likwid.gethostname()
+    local rank = tonumber(likwid.getMPIrank()) or -1
+    local clock = likwid.getCpuClock()
+    local cur_cpulist = cpulist
+    if region ~= nil then
+        cur_cpulist = likwid.markerRegionCpulist(region)
+    end
+    for g, group in pairs(results) do
+        local fields = {}
+        local times = {}
+        local calls = {}
+        local coverage = {}
+        local events = {}
+        local counters = {}
+        local values = {}
+        local mnames = {}
+        local mvalues = {}
+        local runtime = likwid.getRuntimeOfGroup(g)
+        for c, cpu in pairs(cur_cpulist) do
+            if region == nil then
+                table.insert(times, runtime)
+            else
+                table.insert(times, likwid.markerRegionTime(region, c))
+                table.insert(calls, likwid.markerRegionCount(region, c))
+                table.insert(coverage, likwid.markerRegionCoverage(region, c))
+            end
+        end
+        for e, event in pairs(group) do
+            local row = {}
+            table.insert(events, likwid.getNameOfEvent(g, e))
+            table.insert(counters, likwid.getNameOfCounter(g, e))
+            for c, cpu in pairs(cur_cpulist) do
+                table.insert(row, event[c])
+            end
+            table.insert(values, jsonList(row, jsonNumber))
+        end
+        for m=1, likwid.getNumberOfMetrics(g) do
+            local row = {}
+            table.insert(mnames, likwid.getNameOfMetric(g, m))
+            for c, cpu in pairs(cur_cpulist) do
+                table.insert(row, metrics[g][m][c])
+            end
+            table.insert(mvalues, jsonList(row, jsonNumber))
+        end
+        table.insert(fields, '"host":'..jsonString(host))
+        table.insert(fields, '"rank":'..tostring(rank))
+        table.insert(fields, '"clock":'..jsonNumber(clock))
+        if region ~= nil then
+            table.insert(fields, '"region":'..jsonString(likwid.markerRegionTag(region)))
+        end
+        table.insert(fields, '"group":'..tostring(g))
+        table.insert(fields, '"name":'..jsonString(likwid.getNameOfGroup(g)))
+        table.insert(fields, '"cpus":'..jsonList(cur_cpulist, jsonNumber))
+        table.insert(fields, '"time":'..jsonList(times, jsonNumber))
+        if region ~= nil then
+            table.insert(fields, '"calls":'..jsonList(calls, jsonNumber))
+            if #coverage > 0 and coverage[1] >= 0 then
+                table.insert(fields, '"coverage":'..jsonList(coverage, jsonNumber))
+            end
+        end
+        table.insert(fields, '"events":'..jsonList(events, jsonString))
+        table.insert(fields, '"counters":'..jsonList(counters, jsonString))
+        table.insert(fields, '"values":['..table.concat(values, ",")..']')
+        table.insert(fields, '"metrics":'..jsonList(mnames, jsonString))
+        table.insert(fields, '"metricvalues":['..table.concat(mvalues, ",")..']')
+        print("{"..table.concat(fields, ",").."}")
+    end
+end
+
+likwid.printRecord = printRecord
+
+local function printRegionTree()
+    local nodes = likwid.markerRegionTree()
+    if #nodes == 0 then
+        return
+    end
+    local children = {}
+    for n=0, #nodes do
+        children[n] = {}
+    end
+    for n, node in pairs(nodes) do
+        table.insert(children[node["parent"]], n)
+    end
+    for g=1, likwid.getNumberOfGroups() do
+        local nmetrics = likwid.getNumberOfMetrics(g)
+        local groupName = likwid.getNameOfGroup(g)
+        local tab = {{"Call path"},{"Calls"},{"Incl. time [s]"},{"Excl. time [s]"}}
+        -- Show the exclusive metrics or the exclusive counts if the group has no metrics
+        if nmetrics > 0 then
+            for m=1, nmetrics do
+                table.insert(tab, {likwid.getNameOfMetric(g, m)})
+            end
+        else
+            for e=1, likwid.getNumberOfEvents(g) do
+                table.insert(tab, {likwid.getNameOfEvent(g, e)})
+            end
+        end
+        local function addNode(n, path)
+            local node = nodes[n]
+            path = (path and path.." > " or "")..node["tag"]
+            table.insert(tab[1], path)
+            table.insert(tab[2], tostring(node["calls"]))
+            table.insert(tab[3], string.format("%.6f", node["time"]))
+            table.insert(tab[4], string.format("%.6f", node["exclTime"]))
+            local values = (nmetrics > 0 and node["exclMetrics"] or node["exclEvents"])
+            for i=1, #values do
+                table.insert(tab[4+i], tostring(likwid.num2str(values[i])))
+            end
+            for _, c in pairs(children[n]) do
+                addNode(c, path)
+            end
+        end
+        for _, n in pairs(children[0]) do
+            if nodes[n]["group"] == g then
+                addNode(n, nil)
+            end
+        end
+        if #tab[1] > 1 then
+            if use_csv then
+                print(string.format("TABLE,Call path tree,Group %d Tree,%s,%d%s",g,groupName,#tab[1]-1,string.rep(",",#tab-5)))
+                likwid.printcsv(tab, #tab)
+            else
+                print("Call path tree, Group "..tostring(g)..": "..groupName.." (exclusive values)")
+                likwid.printtable(tab)
+            end
+        end
+    end
+end
+
+likwid.printRegionTree = printRegionTree
+
+local function printSampleHistogram(filename, top)
+    -- The file is missing if sampling failed in the application
+    local f = io.open(filename, "r")
+    if f == nil then
+        return
+    end
+    local events = {}
+    local regions = {}
+    local totals = {}
+    local lost = 0
+    for line in f:lines() do
+        local id, name = line:match("^EVENT (%d+) (%S+)")
+        if id then
+            events[tonumber(id)] = name
+        end
+        local l = line:match("^THREAD %d+ %d+ (%d+)")
+        if l then
+            lost = lost + tonumber(l)
+        end
+        local region, event, count, ip, location = line:match("^SAMPLE (%S+) %d+ (%d+) (%d+) (%S+) (%S+)")
+        if region then
+            local key = region.." "..event
+            if not regions[key] then
+                regions[key] = {}
+                totals[key] = 0
+            end
+            if not regions[key][ip] then
+                regions[key][ip] = {location, 0}
+            end
+            regions[key][ip][2] = regions[key][ip][2] + tonumber(count)
+            totals[key] = totals[key] + tonumber(count)
+        end
+    end
+    f:close()
+    local keys = {}
+    for key, _ in pairs(regions) do
+        table.insert(keys, key)
+    end
+    table.sort(keys)
+    for _, key in pairs(keys) do
+        local region, event = key:match("(%S+) (%d+)")
+        local ename = events[tonumber(event)] or event
+        local bins = {}
+        for ip, bin in pairs(regions[key]) do
+            table.insert(bins, {ip, bin[1], bin[2]})
+        end
+        table.sort(bins, function(a, b) return a[3] > b[3] end)
+        local tab = {{"IP"},{"Location"},{"Samples"},{"Share [%]"}}
+        for i=1, math.min(top, #bins) do
+            table.insert(tab[1], bins[i][1])
+            table.insert(tab[2], bins[i][2])
+            table.insert(tab[3], tostring(bins[i][3]))
+            table.insert(tab[4], string.format("%.2f", 100*bins[i][3]/totals[key]))
+        end
+        if use_csv then
+            print(string.format("TABLE,Region %s IP histogram %s,%d", region, ename, #tab[1]-1))
+            likwid.printcsv(tab, #tab)
+        else
+            print(string.format("Region %s, IP histogram of %s (%d samples, top %d)", region, ename, totals[key], math.min(top, #bins)))
+            likwid.printtable(tab)
+        end
+    end
+    if lost > 0 then
+        io.stderr:write(string.format("WARN: %d samples were lost, use a larger sample period\n", lost))
+    end
+    if outfile == nil then
+        print(string.format("IP histograms of all regions are stored in %s", filename))
+    end
+end
+
+likwid.printSampleHistogram = printSampleHistogram
+
+-- Top-down tree. The share of a node is given by one of its metrics in the
+-- group of the parent node, the group of a node splits it up further.
+local topdownTree = {
+    group = "TMA",
+    children = {
+        {name = "Front End", metrics = {"Front End [%]"}, group = "TMA_FRONTEND", children = {
+            {name = "Fetch Latency", metrics = {"Fetch Latency of Front End [%]"}},
+            {name = "Fetch Bandwidth", metrics = {"Fetch Bandwidth of Front End [%]"}}}},
+        {name = "Bad Speculation", metrics = {"Bad Speculation [%]", "Speculation [%]"}, group = "TMA_BADSPEC", children = {
+            {name = "Branch Mispredicts", metrics = {"Branch Mispredicts of Bad Speculation [%]"}},
+            {name = "Machine Clears", metrics = {"Machine Clears of Bad Speculation [%]"}}}},
+        {name = "Retiring", metrics = {"Retiring [%]"}},
+        {name = "Back End", metrics = {"Back End [%]"}, group = "TMA_BACKEND", children = {
+            {name = "Memory Bound", metrics = {"Memory Bound of Back End [%]"}, group = "TMA_MEMORY", children = {
+                {name = "L1 Bound", metrics = {"L1 Bound of Memory Bound [%]"}},
+                {name = "L2 Bound", metrics = {"L2 Bound of Memory Bound [%]"}},
+                {name = "L3 Bound", metrics = {"L3 Bound of Memory Bound [%]"}},
+                {name = "DRAM Bound", metrics = {"DRAM Bound of Memory Bound [%]"}}}},
+            {name = "Core Bound", metrics = {"Core Bound of Back End [%]"}}}},
+    }
+}
+
+-- List of the top-down groups available for the current architecture,
+-- the level 1 group comes first
+local function getTopdownGroups()
+    local avail = {}
+    for _, g in pairs(likwid.getGroups() or {}) do
+        avail[g["Name"]] = true
+    end
+    local groups = {}
+    local function walk(node)
+        if node.group and avail[node.group] then
+            table.insert(groups, node.group)
+            for _, c in pairs(node.children or {}) do
+                walk(c)
+            end
+        end
+    end
+    walk(topdownTree)
+    return groups
+end
+
+likwid.getTopdownGroups = getTopdownGroups
+
+-- Average of each metric of a group over all HW threads
+local function getTopdownValues(metrics, groupId)
+    if not metrics or not metrics[groupId] then
+        return nil
+    end
+    local values = {}
+    for m=1, likwid.getNumberOfMetrics(groupId) do
+        local sum = 0
+        local count = 0
+        for _, v in pairs(metrics[groupId][m] or {}) do
+            if type(v) == "number" and v == v then
+                sum = sum + v
+                count = count + 1
+            end
+        end
+        if count > 0 then
+            values[likwid.getNameOfMetric(groupId, m)] = sum/count
+        end
+    end
+    return values
+end
+
+likwid.getTopdownValues = getTopdownValues
+
+local function topdownShares(node, values)
+    local shares = {}
+    local total = 0
+    for i, c in pairs(node.children) do
+        local v = nil
+        for _, m in pairs(c.metrics) do
+            v = v or values[m]
+        end
+        if v == nil then
+            return nil
+        end
+        shares[i] = math.max(v, 0)
+        total = total + shares[i]
+    end
+    return shares, total
+end
+
+-- Walk the tree with the values per group name. The level 1 shares are taken
+-- as they are, the shares of deeper levels are scaled to their parent.
+local function getTopdownTree(valuesByGroup)
+    local rows = {}
+    local function walk(node, path, value, dominant)
+        local values = valuesByGroup[node.group or ""]
+        if not node.children or not values then
+            return
+        end
+        local shares, total = topdownShares(node, values)
+        if not shares then
+            return
+        end
+        local maxIdx = 1
+        for i, s in pairs(shares) do
+            if s > shares[maxIdx] then
+                maxIdx = i
+            end
+        end
+        for i, c in pairs(node.children) do
+            local v = shares[i]
+            if value then
+                v = (total > 0 and value*shares[i]/total or 0)
+            end
+            local p = (path and path.." > " or "")..c.name
+            table.insert(rows, {p, v, dominant and i == maxIdx})
+            walk(c, p, v, dominant and i == maxIdx)
+        end
+    end
+    walk(topdownTree, nil, nil, true)
+    return rows
+end
+
+likwid.getTopdownTree = getTopdownTree
+
+-- Select the group for the next measurement. If the dominant child of the
+-- node split by the given group has a group itself, it is measured next,
+-- otherwise the walk starts again at level 1.
+local function getTopdownNext(groupName, values, available)
+    local function find(node)
+        if node.group == groupName then
+            return node
+        end
+        for _, c in pairs(node.children or {}) do
+            local n = find(c)
+            if n then
+                return n
+            end
+        end
+        return nil
+    end
+    local node = find(topdownTree)
+    if node and node.children and values then
+        local shares = topdownShares(node, values)
+        if shares then
+            local maxIdx = 1
+            for i, s in pairs(shares) do
+                if s > shares[maxIdx] then
+                    maxIdx = i
+                end
+            end
+            local next = node.children[maxIdx].group
+            if next and available[next] then
+                return next
+            end
+        end
+    end
+    return topdownTree.group
+end
+
+likwid.getTopdownNext = getTopdownNext
+
+local function printTopdownTree(valuesByGroup, title)
+    local rows = getTopdownTree(valuesByGroup)
+    if #rows == 0 then
+        return
+    end
+    local tab = {{"Category"},{"Share [%]"},{"Bottleneck"}}
+    for _, r in pairs(rows) do
+        table.insert(tab[1], r[1])
+        table.insert(tab[2], string.format("%.2f", r[2]))
+        table.insert(tab[3], r[3] and "*" or "")
+    end
+    if use_csv then
+        print(string.format("TABLE,Top-down tree,%s,%d", title, #tab[1]-1))
+        likwid.printcsv(tab, #tab)
+    else
+        print("Top-down tree, "..title)
+        likwid.printtable(tab)
+    end
+end
+
+likwid.printTopdownTree = printTopdownTree
+
+-- Roofline model. The FLOP rate of a region divided by the data rate of a
+-- memory level is its operational intensity at that level.
+-- The metric names differ between the architectures. Each entry of metrics is
+-- a list of name patterns, the first list that matches any measured metric is
+-- used and the values of all its matching metrics are summed up (e.g. read and
+-- write bandwidth or the bandwidths of the channel halves). The groups are
+-- alternatives as well, the first one that exists completely is measured.
+local rooflineFlops = "DP [MFLOP/s]"
+local rooflineFlopMetrics = {
+    {"^DP %[MFLOP/s%]$"},
+    {"^MFLOP/s$"},
+    {"^DP %(FP%+SVE512%) %[MFLOP/s%]$"},
+    {"^FP rate %[MFLOP/s%]$"},
+}
+local rooflineLevels = {
+    {name = "L2", groups = {{"L2"}},
+     metrics = {{"^L2 bandwidth %[MBytes/s%]$"},
+                {"^L1<%->L2 bandwidth %[MBytes/s%]$"},
+                {"^L2D load bandwidth %[MBytes/s%]$", "^L2D evict bandwidth %[MBytes/s%]$"}}},
+    {name = "L3", groups = {{"L3"}},
+     metrics = {{"^L3 bandwidth %[MBytes/s%]$"},
+                {"^L3 access bandwidth %[MBytes/s%]$"},
+                {"^L2<%->L3 bandwidth %[MBytes/s%]$"},
+                {"^L3 load bandwidth %[MBytes/s%]$", "^L3 evict bandwidth %[MBytes/s%]$"}}},
+    {name = "MEM", groups = {{"MEM"}, {"MEM1", "MEM2"}, {"MEMREAD", "MEMWRITE"}},
+     metrics = {{"^Memory bandwidth %[MBytes/s%]$"},
+                {"^Memory bandwidth %(.*%) %[MBytes/s%]$"},
+                {"^Memory read bandwidth %[MBytes/s%]$", "^Memory write bandwidth %[MBytes/s%]$"}}},
+}
+
+-- Value of a roofline metric in a table of metric name -> value. Returns nil
+-- if no metric matches.
+local function getRooflineMetric(values, candidates)
+    for _, patterns in pairs(candidates) do
+        local sum = nil
+        for name, v in pairs(values) do
+            for _, p in pairs(patterns) do
+                if name:match(p) then
+                    sum = (sum or 0) + v
+                    break
+                end
+            end
+        end
+        if sum then
+            return sum
+        end
+    end
+    return nil
+end
+
+-- Check whether a group provides one of the candidate metrics
+local function rooflineGroupHas(group, candidates)
+    local data = likwid.get_groupdata(group)
+    local names = {}
+    for _, m in pairs(data and data["Metrics"] or {}) do
+        names[m["description"]] = 1
+    end
+    return getRooflineMetric(names, candidates) ~= nil
+end
+
+-- List of the groups needed for the roofline model of the current
+-- architecture, the FLOP group comes first. The list is empty if no group
+-- provides the DP FLOP rate.
+local function getRooflineGroups()
+    local avail = {}
+    for _, g in pairs(likwid.getGroups() or {}) do
+        avail[g["Name"]] = true
+    end
+    local groups = {}
+    for _, g in pairs({"MEM_DP", "FLOPS_DP"}) do
+        if avail[g] and rooflineGroupHas(g, rooflineFlopMetrics) then
+            table.insert(groups, g)
+            break
+        end
+    end
+    if #groups == 0 then
+        return groups
+    end
+    for _, l in pairs(rooflineLevels) do
+        if not rooflineGroupHas(groups[1], l.metrics) then
+            for _, alt in pairs(l.groups) do
+                local complete = true
+                for _, g in pairs(alt) do
+                    if not avail[g] then
+                        complete = false
+                    end
+                end
+                if complete and rooflineGroupHas(alt[1], l.metrics) then
+                    for _, g in pairs(alt) do
+                        table.insert(groups, g)
+                    end
+                    break
+                end
+            end
+        end
+    end
+    return groups
+end
+
+likwid.getRooflineGroups = getRooflineGroups
+
+-- Sum of each metric of a group over all HW threads. The sums are added to
+-- the given table, so the values of all groups of a region can be collected.
+local function getRooflineValues(metrics, groupId, values)
+    values = values or {}
+    if not metrics or not metrics[groupId] then
+        return values
+    end
+    for m=1, likwid.getNumberOfMetrics(groupId) do
+        local sum = nil
+        for _, v in pairs(metrics[groupId][m] or {}) do
+            if type(v) == "number" and v == v then
+                sum = (sum or 0) + v
+            end
+        end
+        if sum then
+            values[likwid.getNameOfMetric(groupId, m)] = sum
+        end
+    end
+    return values
+end
+
+likwid.getRooflineValues = getRooflineValues
+
+local function rooflineBench(bench, kernel, domain, size, nthreads)
+    local cmd = string.format("%s -t %s -W %s:%dkB:%d 2>/dev/null", bench, kernel, domain,
+                              math.max(math.floor(size/1024), 1), nthreads)
+    local f = io.popen(cmd, "r")
+    if not f then
+        return nil
+    end
+    local out = f:read("*a")
+    f:close()
+    if kernel:match("^peakflops") then
+        return tonumber(out:match("MFlops/s:%s+([%d%.]+)"))
+    end
+    return tonumber(out:match("MByte/s:%s+([%d%.]+)"))
+end
+
+-- Measure the ceilings of the roofline model with likwid-bench for the given
+-- HW threads: the peak FLOP rate and the load bandwidth of each cache level
+-- and of the main memory. The results are cached per host in
+-- $HOME/.likwid/roofline_<hostname>.txt, one line per domain, number of
+-- threads and ceiling. Remove the file to measure the ceilings again.
+local function getRooflineCeilings(bench, cpus)
+    local cpuinfo = likwid.getCpuInfo()
+    local cputopo = likwid.getCpuTopology()
+    local nthreads = #cpus
+    local packages = {}
+    local npackages = 0
+    for _, t in pairs(cputopo["threadPool"]) do
+        for _, c in pairs(cpus) do
+            if t["apicId"] == c and not packages[t["packageId"]] then
+                packages[t["packageId"]] = true
+                npackages = npackages + 1
+            end
+        end
+    end
+    local domain = "N"
+    if npackages == 1 then
+        domain = "S"..tostring(next(packages))
+    end
+    local features = " "..(cpuinfo["features"] or "").." "
+    local isa = ""
+    local fma = ""
+    if features:match(" AVX512 ") then
+        isa = "_avx512"
+    elseif features:match(" AVX ") then
+        isa = "_avx"
+    elseif features:match(" SSE2 ") then
+        isa = "_sse"
+    end
+    if isa ~= "_sse" and isa ~= "" and features:match(" FMA ") then
+        fma = "_fma"
+    end
+
+    local jobs = {}
+    local l1 = nil
+    local llc = nil
+    local level = 0
+    for _, c in pairs(cputopo["cacheLevels"]) do
+        if c["type"] ~= "INSTRUCTIONCACHE" then
+            level = level + 1
+            local instances = math.max(1, math.ceil(nthreads * cputopo["numThreadsPerCore"] / math.max(c["threads"], 1)))
+            local size = c["size"] * instances / 2
+            if level == 1 then
+                l1 = size
+            end
+            llc = c["size"] * math.max(npackages, 1)
+            table.insert(jobs, {"L"..level, "load"..isa, size})
+        end
+    end
+    table.insert(jobs, 1, {"PEAK", "peakflops"..isa..fma, l1 or 16384})
+    table.insert(jobs, {"MEM", "copy_mem"..isa, math.max(4 * (llc or 0), 1024*1024*1024)})
+
+    local file = string.format("%s/.likwid/roofline_%s.txt", os.getenv("HOME") or "/tmp", likwid.gethostname())
+    local cached = {}
+    local f = io.open(file, "r")
+    if f then
+        for l in f:lines() do
+            local d, n, name, value, kernel = l:match("^(%S+)%s+(%d+)%s+(%S+)%s+([%d%.]+)%s+(%S+)")
+            if d == domain and tonumber(n) == nthreads then
+                cached[name] = {value = tonumber(value), kernel = kernel}
+            end
+        end
+        f:close()
+    end
+    local ceilings = {domain = domain, threads = nthreads}
+    local new = {}
+    for _, j in pairs(jobs) do
+        if cached[j[1]] and cached[j[1]].kernel == j[2] then
+            ceilings[j[1]] = cached[j[1]]
+        else
+            local value = rooflineBench(bench, j[2], domain, j[3], nthreads)
+            if value and value > 0 then
+                ceilings[j[1]] = {value = value, kernel = j[2]}
+                table.insert(new, string.format("%s %d %s %.2f %s", domain, nthreads, j[1], value, j[2]))
+            end
+        end
+    end
+    if #new > 0 then
+        os.execute(string.format("mkdir -p %s/.likwid 2>/dev/null", os.getenv("HOME") or "/tmp"))
+        f = io.open(file, "a")
+        if f then
+            for _, l in pairs(new) do
+                f:write(l.."\n")
+            end
+            f:close()
+        end
+    end
+    return ceilings
+end
+
+likwid.getRooflineCeilings = getRooflineCeilings
+
+-- Place a region in the roofline model. The attainable performance at a
+-- memory level is the minimum of the peak FLOP rate and the bandwidth times
+-- the operational intensity, the level with the lowest attainable
+-- performance bounds the region.
+local function getRooflinePoint(values, ceilings)
+    local flops = getRooflineMetric(values, rooflineFlopMetrics)
+    if not flops then
+        return nil
+    end
+    local point = {flops = flops, intensity = {}}
+    if ceilings and ceilings["PEAK"] then
+        point.attainable = ceilings["PEAK"].value
+        point.bound = "PEAK"
+    end
+    for _, l in pairs(rooflineLevels) do
+        local bw = getRooflineMetric(values, l.metrics)
+        if bw and bw > 0 then
+            point.intensity[l.name] = flops/bw
+            if ceilings and ceilings[l.name] then
+                local a = ceilings[l.name].value * flops/bw
+                if not point.attainable or a < point.attainable then
+                    point.attainable = a
+                    point.bound = l.name
+                end
+            end
+        end
+    end
+    return point
+end
+
+likwid.getRooflinePoint = getRooflinePoint
+
+local function writeRooflinePlot(file, regions, ceilings, title)
+    local f = io.open(file, "w")
+    if not f then
+        io.stderr:write(string.format("WARN: Cannot write roofline plot file %s\n", file))
+        return false
+    end
+    f:write(string.format("# Roofline model, %s\n", title))
+    f:write(string.format("# Ceilings measured with likwid-bench on domain %s with %d threads\n", ceilings.domain or "N", ceilings.threads or 0))
+    f:write("set logscale xy\n")
+    f:write("set xrange [0.01:100]\n")
+    f:write("set xlabel \"Operational intensity [FLOP/Byte]\"\n")
+    f:write("set ylabel \"Performance [MFLOP/s]\"\n")
+    f:write("set key left top\n")
+    f:write(string.format("set title \"%s\"\n", title))
+    f:write("min(a, b) = (a < b) ? a : b\n")
+    local lines = {}
+    local peak = ceilings["PEAK"] and ceilings["PEAK"].value
+    if peak then
+        f:write(string.format("peak = %f\n", peak))
+    end
+    for _, c in pairs({"L1", "L2", "L3", "MEM"}) do
+        if ceilings[c] then
+            f:write(string.format("bw_%s = %f\n", c, ceilings[c].value))
+            if peak then
+                table.insert(lines, string.format("min(peak, bw_%s*x) title \"%s (%s)\"", c, c, ceilings[c].kernel))
+            else
+                table.insert(lines, string.format("bw_%s*x title \"%s (%s)\"", c, c, ceilings[c].kernel))
+            end
+        end
+    end
+    for _, l in pairs(rooflineLevels) do
+        local data = {}
+        for _, r in pairs(regions) do
+            if r.point and r.point.intensity[l.name] then
+                table.insert(data, string.format("%e %e \"%s\"", r.point.intensity[l.name], r.point.flops, r.name))
+            end
+        end
+        if #data > 0 then
+            f:write(string.format("$%s << EOD\n%s\nEOD\n", l.name, table.concat(data, "\n")))
+            table.insert(lines, string.format("$%s using 1:2 with points pointsize 1.5 title \"Regions at %s\"", l.name, l.name))
+            table.insert(lines, string.format("$%s using 1:2:3 with labels offset 1,1 notitle", l.name))
+        end
+    end
+    if #lines > 0 then
+        f:write("plot "..table.concat(lines, ", \\\n     ").."\n")
+    end
+    f:close()
+    return true
+end
+
+-- Print the ceilings and one row per region with its FLOP rate, operational
+-- intensities, attainable performance and bounding ceiling. With a plot file,
+-- a gnuplot script of the model is written as well.
+local function printRoofline(regions, ceilings, plotFile, title)
+    ceilings = ceilings or {}
+    local ctab = {{"Ceiling"},{"Value"},{"Kernel"}}
+    for _, c in pairs({"PEAK", "L1", "L2", "L3", "MEM"}) do
+        if ceilings[c] then
+            table.insert(ctab[1], c == "PEAK" and "Peak [MFLOP/s]" or c.." [MBytes/s]")
+            table.insert(ctab[2], string.format("%.2f", ceilings[c].value))
+            table.insert(ctab[3], ceilings[c].kernel)
+        end
+    end
+    local tab = {{"Region"},{rooflineFlops}}
+    for _, l in pairs(rooflineLevels) do
+        table.insert(tab, {"Intensity "..l.name.." [FLOP/Byte]"})
+    end
+    table.insert(tab, {"Attainable [MFLOP/s]"})
+    table.insert(tab, {"Efficiency [%]"})
+    table.insert(tab, {"Bound"})
+    local missing = {}
+    for _, r in pairs(regions) do
+        r.point = getRooflinePoint(r.values or {}, ceilings)
+        if not r.point then
+            table.insert(missing, r.name)
+        else
+            local p = r.point
+            table.insert(tab[1], r.name)
+            table.insert(tab[2], string.format("%.2f", p.flops))
+            for i, l in pairs(rooflineLevels) do
+                table.insert(tab[2+i], p.intensity[l.name] and string.format("%.4f", p.intensity[l.name]) or "-")
+            end
+            local n = #rooflineLevels
+            table.insert(tab[n+3], p.attainable and string.format("%.2f", p.attainable) or "-")
+            table.insert(tab[n+4], (p.attainable and p.attainable > 0) and string.format("%.2f", 100*p.flops/p.attainable) or "-")
+            table.insert(tab[n+5], p.bound or "-")
+        end
+    end
+    if #missing > 0 then
+        io.stderr:write(string.format("%s: No DP FLOP rate measured for %s\n",
+                        #missing == #regions and "ERROR" or "WARN", table.concat(missing, ", ")))
+        if #missing == #regions then
+            return false
+        end
+    end
+    if use_csv then
+        if #ctab[1] > 1 then
+            print(string.format("TABLE,Roofline ceilings,%s,%d", title, #ctab[1]-1))
+            likwid.printcsv(ctab, #ctab)
+        end
+        print(string.format("TABLE,Roofline,%s,%d", title, #tab[1]-1))
+        likwid.printcsv(tab, #tab)
+    else
+        if #ctab[1] > 1 then
+            print(string.format("Roofline ceilings, domain %s with %d threads", ceilings.domain or "N", ceilings.threads or 0))
+            likwid.printtable(ctab)
+        end
+        print("Roofline, "..title)
+        likwid.printtable(tab)
+    end
+    if plotFile and writeRooflinePlot(plotFile, regions, ceilings, title) and not use_csv then
+        print(string.format("Roofline plot script written to %s, show it with: gnuplot -p %s", plotFile, plotFile))
+    end
+    return true
+end
+
+likwid.printRoofline = printRoofline
+
 
 
 local function getResults(nan2value)
@@ -1121,9 +1949,7 @@ end
 
 likwid.getLastMetrics = getLastMetrics
 
-local function getMarkerResults(filename, cpulist, nan2value)
-    local cpuinfo = likwid.getCpuInfo()
-    local ret = likwid.readMarkerFile(filename)
+local function collectMarkerResults(ret, nan2value)
     if ret < 0 then
         return nil, nil
     elseif ret == 0 then
@@ -1169,8 +1995,18 @@ local function getMarkerResults(filename, cpulist, nan2value)
     return results, metrics
 end
 
+local function getMarkerResults(filename, cpulist, nan2value)
+    return collectMarkerResults(likwid.readMarkerFile(filename), nan2value)
+end
+
 likwid.getMarkerResults = getMarkerResults
 
+local function getMarkerLiveResults(live, diff, cpulist, nan2value)
+    return collectMarkerResults(likwid.readMarkerLive(live, diff), nan2value)
+end
+
+likwid.getMarkerLiveResults = getMarkerLiveResults
+
 
 local function msr_available(flags)
     local ret = likwid_access("/dev/cpu/0/msr", flags)
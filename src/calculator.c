@@ -415,7 +415,7 @@ int doOp(Stack *s, token op)
     token loperand = (token)stackPop(s);
     number lside = buildNumber(loperand);
     number rside = buildNumber(roperand);
-    number ret;
+    number ret = 0;
     switch(*op)
     {
         case '^':
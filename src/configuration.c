@@ -73,6 +73,13 @@ default_configuration(void)
         init_config = 1;
         return 0;
     }
+    if ((getenv("LIKWID_MODE") != NULL) && (atoi(getenv("LIKWID_MODE")) == ACCESSMODE_SIM))
+    {
+        /* Simulated registers need neither root priviledges nor the access daemon */
+        config.daemonMode = ACCESSMODE_SIM;
+        init_config = 1;
+        return 0;
+    }
     config.daemonMode = ACCESSMODE_DAEMON;
 
     FILE* fp = popen("bash --noprofile -c \"which likwid-accessD 2>/dev/null | tr -d '\n'\"","r");
@@ -261,6 +268,10 @@ init_configuration(void)
             {
                 config.daemonMode = ACCESSMODE_DIRECT;
             }
+            else if (strcmp(value, "sim") == 0)
+            {
+                config.daemonMode = ACCESSMODE_SIM;
+            }
         }
         else if (strcmp(name, "max_threads") == 0)
         {
@@ -380,6 +380,464 @@ method_done:
     return 0;
 }
 
+static int
+policy_cmp_key(const void* a, const void* b)
+{
+    const int64_t* x = (const int64_t*)a;
+    const int64_t* y = (const int64_t*)b;
+    if (*x < *y) return -1;
+    if (*x > *y) return 1;
+    return 0;
+}
+
+typedef struct {
+    int group;
+    int smt;
+    int socket;
+    int core;
+    int idx;
+} PolicyKey;
+
+static int
+policy_cmp_member(const void* a, const void* b)
+{
+    const PolicyKey* x = (const PolicyKey*)a;
+    const PolicyKey* y = (const PolicyKey*)b;
+    if (x->group != y->group) return x->group - y->group;
+    if (x->smt != y->smt) return x->smt - y->smt;
+    if (x->socket != y->socket) return x->socket - y->socket;
+    return x->core - y->core;
+}
+
+static int
+policy_dense_ids(int64_t* keys, int* ids, int count)
+{
+    int num = 0;
+    int64_t* sorted = malloc(count * sizeof(int64_t));
+    if (!sorted)
+    {
+        return -ENOMEM;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (keys[i] >= 0)
+        {
+            sorted[num++] = keys[i];
+        }
+    }
+    qsort(sorted, num, sizeof(int64_t), policy_cmp_key);
+    int uniq = 0;
+    for (int i = 0; i < num; i++)
+    {
+        if (uniq == 0 || sorted[uniq-1] != sorted[i])
+        {
+            sorted[uniq++] = sorted[i];
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        ids[i] = -1;
+        if (keys[i] < 0)
+            continue;
+        int64_t* f = bsearch(&keys[i], sorted, uniq, sizeof(int64_t), policy_cmp_key);
+        if (f)
+        {
+            ids[i] = (int)(f - sorted);
+        }
+    }
+    free(sorted);
+    return uniq;
+}
+
+/* Assign every HW thread of the pool to a group of the given topology level.
+ * Levels are either affinity domain types (N, S, D, C, M) or cache levels
+ * (L1, L2, L3, ...). The socket and core offsets of each HW thread are
+ * returned as well as they are needed for the ordering inside the groups. */
+static int
+policy_groups(bstring level, int* groups, int* sockets, int* cores)
+{
+    int err = 0;
+    CpuTopology_t cpuid_topology = get_cpuTopology();
+    AffinityDomains_t affinity = get_affinityDomains();
+    int nthreads = cpuid_topology->numHWThreads;
+    int64_t* keys = malloc(nthreads * sizeof(int64_t));
+    if (!keys)
+    {
+        return -ENOMEM;
+    }
+
+    for (int i = 0; i < nthreads; i++)
+    {
+        HWThread* t = &cpuid_topology->threadPool[i];
+        keys[i] = (t->inCpuSet ? (int64_t)t->packageId : -1);
+    }
+    err = policy_dense_ids(keys, sockets, nthreads);
+    if (err < 0)
+        goto policy_groups_out;
+    for (int i = 0; i < nthreads; i++)
+    {
+        HWThread* t = &cpuid_topology->threadPool[i];
+        keys[i] = (t->inCpuSet ? (((int64_t)sockets[i]) << 32) + t->coreId : -1);
+    }
+    err = policy_dense_ids(keys, cores, nthreads);
+    if (err < 0)
+        goto policy_groups_out;
+    /* Make the core offsets relative to the socket */
+    for (int s = 0; s < cpuid_topology->numSockets; s++)
+    {
+        int first = -1;
+        for (int i = 0; i < nthreads; i++)
+        {
+            if (sockets[i] == s && (first < 0 || cores[i] < first))
+                first = cores[i];
+        }
+        for (int i = 0; i < nthreads && first > 0; i++)
+        {
+            if (sockets[i] == s)
+                cores[i] -= first;
+        }
+    }
+
+    if (blength(level) >= 2 && bchar(level, 0) == 'L')
+    {
+        int cachelevel = check_and_atoi(bdata(level)+1);
+        int threads = 0;
+        int found = 0;
+        /* The level member is not filled consistently by all topology
+         * backends, so count the data and unified caches instead */
+        for (int j = 0; j < cpuid_topology->numCacheLevels; j++)
+        {
+            CacheLevel* c = &cpuid_topology->cacheLevels[j];
+            if (c->type == DATACACHE || c->type == UNIFIEDCACHE)
+            {
+                found++;
+                if (found == cachelevel)
+                {
+                    threads = c->threads;
+                    break;
+                }
+            }
+        }
+        if (threads <= 0)
+        {
+            fprintf(stderr, "Cache level %s not available\n", bdata(level));
+            err = -EINVAL;
+            goto policy_groups_out;
+        }
+        int coresPerCache = MAX(threads / MAX(cpuid_topology->numThreadsPerCore, 1), 1);
+        for (int i = 0; i < nthreads; i++)
+        {
+            keys[i] = (sockets[i] >= 0 ? (((int64_t)sockets[i]) << 32) + (cores[i] / coresPerCache) : -1);
+        }
+    }
+    else if (blength(level) == 1 && strchr("NSDCM", bchar(level, 0)) != NULL)
+    {
+        char type = bchar(level, 0);
+        for (int i = 0; i < nthreads; i++)
+        {
+            keys[i] = -1;
+            if (sockets[i] < 0)
+                continue;
+            int cpu = cpuid_topology->threadPool[i].apicId;
+            for (int d = 0; d < affinity->numberOfAffinityDomains; d++)
+            {
+                if (bchar(affinity->domains[d].tag, 0) == type &&
+                    cpu_in_domain(d, cpu))
+                {
+                    keys[i] = d;
+                    break;
+                }
+            }
+        }
+    }
+    else
+    {
+        fprintf(stderr, "Unknown topology level %s for placement policy\n", bdata(level));
+        err = -EINVAL;
+        goto policy_groups_out;
+    }
+    err = policy_dense_ids(keys, groups, nthreads);
+policy_groups_out:
+    free(keys);
+    return err;
+}
+
+/* Placement policies computed from the topology:
+ *   P:compact[:<count>]             physical cores in order, SMT siblings last
+ *   P:scatter[:<level>][:<count>]   round-robin over the groups of <level>
+ *   P:balanced[:<level>][:<count>]  <count> split evenly, contiguous per group
+ *   P:one[:<level>][:<count>]       first physical core of each group
+ * The default level is the last level cache for scatter and one and M for
+ * balanced. In every group the physical cores are selected before their SMT
+ * siblings. */
+static int
+cpustr_to_cpulist_policy(bstring bcpustr, int* cpulist, int length)
+{
+    int insert = 0;
+    int count = -1;
+    int ngroups = 0;
+    int maxsmt = 0;
+    bstring strategy = NULL;
+    bstring level = NULL;
+    topology_init();
+    CpuTopology_t cpuid_topology = get_cpuTopology();
+    affinity_init();
+    int nthreads = cpuid_topology->numHWThreads;
+    struct bstrList* parts = bsplit(bcpustr, ':');
+    if (parts->qty < 2 || parts->qty > 4)
+    {
+        fprintf(stderr, "Not a valid placement policy %s\n", bdata(bcpustr));
+        bstrListDestroy(parts);
+        return 0;
+    }
+    strategy = parts->entry[1];
+    for (int i = 2; i < parts->qty; i++)
+    {
+        int tmp = check_and_atoi(bdata(parts->entry[i]));
+        if (tmp > 0 && i == parts->qty - 1)
+            count = tmp;
+        else if (i == 2 && tmp < 0)
+            level = bstrcpy(parts->entry[i]);
+        else
+        {
+            fprintf(stderr, "Not a valid placement policy %s\n", bdata(bcpustr));
+            bstrListDestroy(parts);
+            bdestroy(level);
+            return 0;
+        }
+    }
+    if (!level)
+    {
+        if (biseqcstr(strategy, "balanced"))
+            level = bfromcstr("M");
+        else if (biseqcstr(strategy, "compact"))
+            level = bfromcstr("N");
+        else
+        {
+            /* Last level cache, e.g. the CCDs of AMD Zen */
+            int llc = 0;
+            for (int j = 0; j < cpuid_topology->numCacheLevels; j++)
+            {
+                CacheType type = cpuid_topology->cacheLevels[j].type;
+                if (type == DATACACHE || type == UNIFIEDCACHE)
+                    llc++;
+            }
+            level = (llc > 0 ? bformat("L%d", llc) : bfromcstr("S"));
+        }
+    }
+    if (!biseqcstr(strategy, "compact") && !biseqcstr(strategy, "scatter") &&
+        !biseqcstr(strategy, "balanced") && !biseqcstr(strategy, "one"))
+    {
+        fprintf(stderr, "Unknown placement policy %s, available are compact, scatter, balanced and one\n", bdata(strategy));
+        bdestroy(level);
+        bstrListDestroy(parts);
+        return 0;
+    }
+
+    int* groups = malloc(nthreads * sizeof(int));
+    int* sockets = malloc(nthreads * sizeof(int));
+    int* cores = malloc(nthreads * sizeof(int));
+    int* members = malloc(nthreads * sizeof(int));
+    PolicyKey* policy_keys = malloc(nthreads * sizeof(PolicyKey));
+    if (!groups || !sockets || !cores || !members || !policy_keys)
+    {
+        insert = -ENOMEM;
+        goto policy_out;
+    }
+    ngroups = policy_groups(level, groups, sockets, cores);
+    if (ngroups <= 0)
+    {
+        insert = (ngroups < 0 ? ngroups : 0);
+        goto policy_out;
+    }
+    for (int i = 0; i < nthreads; i++)
+    {
+        if (groups[i] >= 0)
+            maxsmt = MAX(maxsmt, (int)cpuid_topology->threadPool[i].threadId);
+    }
+
+    /* Group members sorted by SMT offset, socket and core, stored back to back */
+    int* start = calloc(ngroups + 1, sizeof(int));
+    int* pos = malloc(ngroups * sizeof(int));
+    int* order = malloc(ngroups * sizeof(int));
+    int* share = calloc(ngroups, sizeof(int));
+    if (!start || !pos || !order || !share)
+    {
+        free(start);
+        free(pos);
+        free(order);
+        free(share);
+        insert = -ENOMEM;
+        goto policy_out;
+    }
+    for (int i = 0; i < nthreads; i++)
+    {
+        if (groups[i] >= 0)
+        {
+            policy_keys[insert].group = groups[i];
+            policy_keys[insert].smt = cpuid_topology->threadPool[i].threadId;
+            policy_keys[insert].socket = sockets[i];
+            policy_keys[insert].core = cores[i];
+            policy_keys[insert].idx = i;
+            insert++;
+        }
+    }
+    qsort(policy_keys, insert, sizeof(PolicyKey), policy_cmp_member);
+    for (int i = 0; i < insert; i++)
+    {
+        members[i] = policy_keys[i].idx;
+        if (i == 0 || policy_keys[i].group != policy_keys[i-1].group)
+            start[policy_keys[i].group] = i;
+    }
+    start[ngroups] = insert;
+    int total = insert;
+    insert = 0;
+
+    /* Groups interleaved over the sockets: first group of each socket, then
+     * the second group of each socket, ... */
+    {
+        int o = 0;
+        for (int sub = 0; o < ngroups; sub++)
+        {
+            for (int s = 0; s < cpuid_topology->numSockets; s++)
+            {
+                int seen = 0;
+                for (int g = 0; g < ngroups; g++)
+                {
+                    if (sockets[members[start[g]]] != s)
+                        continue;
+                    if (seen == sub)
+                    {
+                        order[o++] = g;
+                        break;
+                    }
+                    seen++;
+                }
+            }
+            if (sub > total)
+                break;
+        }
+        /* Groups whose socket was not matched above are appended, so every
+         * entry of order is valid */
+        for (int g = 0; g < ngroups && o < ngroups; g++)
+        {
+            int found = 0;
+            for (int k = 0; k < o; k++)
+            {
+                if (order[k] == g)
+                {
+                    found = 1;
+                    break;
+                }
+            }
+            if (!found)
+                order[o++] = g;
+        }
+    }
+
+    if (biseqcstr(strategy, "compact"))
+    {
+        if (count < 0)
+            count = total;
+        count = MIN(count, length);
+        for (int k = 0; k <= maxsmt && insert < count; k++)
+        {
+            for (int g = 0; g < ngroups && insert < count; g++)
+            {
+                for (int j = start[g]; j < start[g+1] && insert < count; j++)
+                {
+                    if (cpuid_topology->threadPool[members[j]].threadId == k)
+                        cpulist[insert++] = cpuid_topology->threadPool[members[j]].apicId;
+                }
+            }
+        }
+    }
+    else if (biseqcstr(strategy, "scatter"))
+    {
+        if (count < 0)
+            count = total;
+        count = MIN(count, length);
+        for (int k = 0; k <= maxsmt && insert < count; k++)
+        {
+            int progress = 1;
+            for (int g = 0; g < ngroups; g++)
+            {
+                pos[g] = start[g];
+                while (pos[g] < start[g+1] &&
+                       cpuid_topology->threadPool[members[pos[g]]].threadId < k)
+                    pos[g]++;
+            }
+            while (progress && insert < count)
+            {
+                progress = 0;
+                for (int o = 0; o < ngroups && insert < count; o++)
+                {
+                    int g = order[o];
+                    if (pos[g] < start[g+1] &&
+                        cpuid_topology->threadPool[members[pos[g]]].threadId == k)
+                    {
+                        cpulist[insert++] = cpuid_topology->threadPool[members[pos[g]]].apicId;
+                        pos[g]++;
+                        progress = 1;
+                    }
+                }
+            }
+        }
+    }
+    else if (biseqcstr(strategy, "balanced"))
+    {
+        int assigned = 0;
+        int progress = 1;
+        if (count < 0)
+            count = total;
+        count = MIN(count, length);
+        while (assigned < count && progress)
+        {
+            progress = 0;
+            for (int o = 0; o < ngroups && assigned < count; o++)
+            {
+                int g = order[o];
+                if (share[g] < start[g+1] - start[g])
+                {
+                    share[g]++;
+                    assigned++;
+                    progress = 1;
+                }
+            }
+        }
+        for (int g = 0; g < ngroups; g++)
+        {
+            for (int j = 0; j < share[g]; j++)
+                cpulist[insert++] = cpuid_topology->threadPool[members[start[g]+j]].apicId;
+        }
+    }
+    else if (biseqcstr(strategy, "one"))
+    {
+        if (count < 0)
+            count = ngroups;
+        count = MIN(count, length);
+        for (int o = 0; o < ngroups && insert < count; o++)
+        {
+            int g = order[o];
+            if (start[g+1] > start[g])
+                cpulist[insert++] = cpuid_topology->threadPool[members[start[g]]].apicId;
+        }
+    }
+    free(start);
+    free(pos);
+    free(order);
+    free(share);
+policy_out:
+    free(groups);
+    free(sockets);
+    free(cores);
+    free(members);
+    free(policy_keys);
+    bdestroy(level);
+    bstrListDestroy(parts);
+    return insert;
+}
+
 static int
 cpustr_to_cpulist_expression(bstring bcpustr, int* cpulist, int length)
 {
@@ -839,6 +1297,7 @@ cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)
     struct bstrList* strlist;
     bstring scattercheck = bformat("scatter");
     bstring balancedcheck = bformat("balanced");
+    bstring policycheck = bformat("P:");
     topology_init();
     CpuTopology_t cpuid_topology = get_cpuTopology();
     strlist = bsplit(bcpustr, '@');
@@ -849,13 +1308,19 @@ cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)
         bstrListDestroy(strlist);
         bdestroy(scattercheck);
         bdestroy(balancedcheck);
+        bdestroy(policycheck);
         bdestroy(bcpustr);
         return -ENOMEM;
     }
     memset(tmpList, 0, length * sizeof(int));
     for (int i=0; i< strlist->qty; i++)
     {
-        if (binstr(strlist->entry[i], 0, scattercheck) != BSTR_ERR ||
+        if (bstrncmp(strlist->entry[i], policycheck, 2) == 0)
+        {
+            ret = cpustr_to_cpulist_policy(strlist->entry[i], tmpList, length);
+            insert += cpulist_concat(cpulist, insert, tmpList, ret);
+        }
+        else if (binstr(strlist->entry[i], 0, scattercheck) != BSTR_ERR ||
             binstr(strlist->entry[i], 0, balancedcheck) != BSTR_ERR)
         {
             ret = cpustr_to_cpulist_method(strlist->entry[i], tmpList, length);
@@ -934,6 +1399,7 @@ cpustr_to_cpulist(const char* cpustring, int* cpulist, int length)
     bdestroy(bcpustr);
     bdestroy(scattercheck);
     bdestroy(balancedcheck);
+    bdestroy(policycheck);
     bstrListDestroy(strlist);
     return insert;
 }
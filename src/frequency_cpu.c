@@ -63,6 +63,7 @@
 
 void (*freq_init_f)() = NULL;
 int (*freq_send)(FreqDataRecordType type, FreqDataRecordLocation loc, int cpu, int len, char* data) = NULL;
+int (*freq_send_list)(int num_records, FreqDataRecord* records) = NULL;
 void (*freq_finalize_f)() = NULL;
 static int freq_initialized = 0;
 static int own_hpm = 0;
@@ -438,10 +439,13 @@ static int freq_read_location(FreqDataRecordLocation loc, int cpu, int len, char
     {
         fname[ret] = '\0';
         ret = open_cpu_file(fname, &fd);
-        if (ret == 0)
+        if (ret == 0 && fd < 0)
+        {
+            return -ENOENT;
+        }
+        else if (ret == 0)
         {
-            lseek(fd, 0, SEEK_SET);
-            ret = read(fd, data, len);
+            ret = pread(fd, data, len, 0);
             close(fd);
             if (ret < 0)
                 return ret;
@@ -451,12 +455,35 @@ static int freq_read_location(FreqDataRecordLocation loc, int cpu, int len, char
     return 0;
 }
 
+/* Only the scaling_{cur,min,max}_freq files are opened at initialization to
+ * keep the number of file descriptors low on large systems. The other files
+ * are opened at first use and kept open afterwards. */
+static int freq_open_location(FreqDataRecordLocation loc, int cpu, int* fd)
+{
+    char fname[1024];
+    if (*fd >= 0)
+    {
+        return 0;
+    }
+    int ret = snprintf(fname, 1023, "%s%d%s/%s", basefolder1, cpu, basefolder2, cpufreq_filenames[loc]);
+    if (ret > 0)
+    {
+        fname[ret] = '\0';
+        return open_cpu_file(fname, fd);
+    }
+    return -EINVAL;
+}
+
 static int freq_send_direct(FreqDataRecordType type, FreqDataRecordLocation loc, int cpu, int len, char* data)
 {
     //printf("Calling %s\n", __func__);
     int fd = -1;
     int ret = 0;
     int only_read = 0;
+    if ((!cpufiles) || (cpu < 0) || (cpu >= (int)cpuid_topology.numHWThreads))
+    {
+        return -EINVAL;
+    }
     struct cpufreq_files* f = &cpufiles[cpu];
 
     switch(loc)
@@ -475,25 +502,30 @@ static int freq_send_direct(FreqDataRecordType type, FreqDataRecordLocation loc,
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_MAX FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
             break;
         case FREQ_LOC_GOV:
+            freq_open_location(loc, cpu, &f->set_gov);
             fd = f->set_gov;
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_GOV FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
             break;
         case FREQ_LOC_AVAIL_GOV:
+            freq_open_location(loc, cpu, &f->avail_govs);
             fd = f->avail_govs;
             only_read = 1;
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_AVAIL_GOV FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
             break;
         case FREQ_LOC_AVAIL_FREQ:
+            freq_open_location(loc, cpu, &f->avail_freq);
             fd = f->avail_freq;
             only_read = 1;
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_AVAIL_FREQ FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
             break;
         case FREQ_LOC_CONF_MIN:
+            freq_open_location(loc, cpu, &f->conf_min_freq);
             fd = f->conf_min_freq;
             only_read = 1;
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_CONF_MIN FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
             break;
         case FREQ_LOC_CONF_MAX:
+            freq_open_location(loc, cpu, &f->conf_max_freq);
             fd = f->conf_max_freq;
             only_read = 1;
             DEBUG_PRINT(DEBUGLEV_DEVELOP, CMD %s CPU %d FREQ_LOC_CONF_MAX FD %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, fd);
@@ -511,18 +543,20 @@ static int freq_send_direct(FreqDataRecordType type, FreqDataRecordLocation loc,
                 {
                     return -EPERM;
                 }
-                lseek(fd, 0, SEEK_SET);
-                ret = write(fd, data, len);
+                ret = pwrite(fd, data, len, 0);
                 break;
             case FREQ_READ:
-                lseek(fd, 0, SEEK_SET);
-                ret = read(fd, data, len);
+                ret = pread(fd, data, len, 0);
                 break;
             default:
                 break;
         }
         if (ret < 0)
-            return ret;
+            return -errno;
+    }
+    else if (type == FREQ_WRITE)
+    {
+        return -ENOENT;
     }
     else
     {
@@ -533,6 +567,33 @@ static int freq_send_direct(FreqDataRecordType type, FreqDataRecordLocation loc,
     return 0;
 }
 
+static int freq_send_list_direct(int num_records, FreqDataRecord* records)
+{
+    for (int i = 0; i < num_records; i++)
+    {
+        FreqDataRecord* r = &records[i];
+        int ret = freq_send_direct(r->type, r->loc, r->cpu, r->datalen, r->data);
+        switch (ret)
+        {
+            case 0:
+                r->errorcode = FREQ_ERR_NONE;
+                break;
+            case -ENOENT:
+            case -EINVAL:
+                r->errorcode = FREQ_ERR_NOFILE;
+                break;
+            case -EPERM:
+            case -EACCES:
+                r->errorcode = FREQ_ERR_NOPERM;
+                break;
+            default:
+                r->errorcode = FREQ_ERR_UNKNOWN;
+                break;
+        }
+    }
+    return 0;
+}
+
 static void freq_finalize_direct()
 {
     //printf("Calling %s\n", __func__);
@@ -556,6 +617,74 @@ static void freq_init_client()
     return;
 }
 
+static int freq_record_error(FreqDataRecord* record)
+{
+    switch(record->errorcode)
+    {
+        case FREQ_ERR_NONE:
+            return 0;
+        case FREQ_ERR_NOFILE:
+            return -ENOENT;
+        case FREQ_ERR_NOPERM:
+            return -EACCES;
+        case FREQ_ERR_UNKNOWN:
+            return -EBADF;
+        default:
+            break;
+    }
+    return -1;
+}
+
+static int freq_client_transfer(int write_data, char* buf, size_t len)
+{
+    size_t off = 0;
+    while (off < len)
+    {
+        ssize_t ret = (write_data ? write(fsocket, buf + off, len - off) : read(fsocket, buf + off, len - off));
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        else if (ret == 0)
+        {
+            return -EPIPE;
+        }
+        off += ret;
+    }
+    return 0;
+}
+
+/* The daemon handles the records in order, so a whole chunk of records is
+ * written at once and the replies are collected afterwards. This saves a
+ * round trip per record. */
+static int freq_send_list_client(int num_records, FreqDataRecord* records)
+{
+    if (fsocket < 0)
+    {
+        return -EBADF;
+    }
+    for (int i = 0; i < num_records; i += LIKWID_FREQUENCY_BATCH_RECORDS)
+    {
+        int chunk = MIN(LIKWID_FREQUENCY_BATCH_RECORDS, num_records - i);
+        DEBUG_PRINT(DEBUGLEV_DEVELOP, DAEMON CMD LIST with %d records, chunk);
+        int ret = freq_client_transfer(1, (char*)&records[i], chunk * sizeof(FreqDataRecord));
+        if (ret < 0)
+        {
+            ERROR_PRINT(socket write failed);
+            return ret;
+        }
+        ret = freq_client_transfer(0, (char*)&records[i], chunk * sizeof(FreqDataRecord));
+        if (ret < 0)
+        {
+            ERROR_PRINT(socket read failed);
+            return ret;
+        }
+    }
+    return 0;
+}
+
 static int freq_send_client(FreqDataRecordType type, FreqDataRecordLocation loc, int cpu, int len, char* data)
 {
     //printf("Calling %s\n", __func__);
@@ -572,24 +701,7 @@ static int freq_send_client(FreqDataRecordType type, FreqDataRecordLocation loc,
         DEBUG_PRINT(DEBUGLEV_DEVELOP, DAEMON CMD %s CPU %d LOC %d, (type == FREQ_WRITE ? "WRITE" : "READ"), cpu, loc);
         CHECK_ERROR(write(fsocket, &record, sizeof(FreqDataRecord)),socket write failed);
         CHECK_ERROR(read(fsocket, &record, sizeof(FreqDataRecord)), socket read failed);
-        if (record.errorcode != FREQ_ERR_NONE)
-        {
-            switch(record.errorcode)
-            {
-                case FREQ_ERR_NOFILE:
-                    return -ENOENT;
-                    break;
-                case FREQ_ERR_NOPERM:
-                    return -EACCES;
-                    break;
-                case FREQ_ERR_UNKNOWN:
-                    return -EBADF;
-                    break;
-                default:
-                    break;
-            }
-            return -1;
-        }
+        return freq_record_error(&record);
     }
     return 0;
 }
@@ -952,6 +1064,7 @@ _freqInit(void)
             DEBUG_PLAIN_PRINT(DEBUGLEV_DEVELOP, Adjusting functions for daemon mode);
             freq_init_f = freq_init_client;
             freq_send = freq_send_client;
+            freq_send_list = freq_send_list_client;
             freq_finalize_f = freq_finalize_client;
         }
         else if (config.daemonMode == ACCESSMODE_DIRECT)
@@ -959,6 +1072,7 @@ _freqInit(void)
             DEBUG_PLAIN_PRINT(DEBUGLEV_DEVELOP, Adjusting functions for direct mode);
             freq_init_f = freq_init_direct;
             freq_send = freq_send_direct;
+            freq_send_list = freq_send_list_direct;
             freq_finalize_f = freq_finalize_direct;
         }
         else if (config.daemonMode == ACCESSMODE_PERF)
@@ -1003,6 +1117,7 @@ void _freqFinalize(void)
     freq_initialized = 0;
     freq_finalize_f = NULL;
     freq_send = NULL;
+    freq_send_list = NULL;
     freq_init_f = NULL;
     if (own_hpm)
         HPMfinalize();
@@ -1290,6 +1405,181 @@ int freq_setTurbo(const int cpu_id, const int turbo)
     return 1;
 }
 
+static void freq_readTurboList(int num_cpus, FreqCpuState* states)
+{
+#ifdef LIKWID_USE_PERFEVENT
+    for (int i = 0; i < num_cpus; i++)
+    {
+        states[i].turbo = -EPERM;
+    }
+#else
+    uint32_t reg = (isAMD() ? 0xC0010015 : MSR_IA32_MISC_ENABLE);
+    int bit = (isAMD() ? 25 : 38);
+
+    if (!lock_check())
+    {
+        for (int i = 0; i < num_cpus; i++)
+        {
+            states[i].turbo = -EPERM;
+        }
+        return;
+    }
+    if (!HPMinitialized())
+    {
+        HPMinit();
+        own_hpm = 1;
+    }
+    for (int i = 0; i < num_cpus; i++)
+    {
+        uint64_t tmp = 0x0ULL;
+        if (states[i].error != 0)
+        {
+            states[i].turbo = states[i].error;
+            continue;
+        }
+        int err = HPMaddThread(states[i].cpu);
+        if (err == 0)
+        {
+            err = HPMread(states[i].cpu, MSR_DEV, reg, &tmp);
+        }
+        if (err != 0)
+        {
+            DEBUG_PRINT(DEBUGLEV_DEVELOP, Cannot read register 0x%X on CPU %d, reg, states[i].cpu);
+            states[i].turbo = (err < 0 ? err : -EIO);
+            continue;
+        }
+        states[i].turbo = (((tmp >> bit) & 0x1) == 0);
+    }
+#endif
+}
+
+int freq_getCpuStates(int num_cpus, const int* cpus, FreqCpuState* states)
+{
+    int count = 0;
+    char s[LIKWID_FREQUENCY_MAX_DATA_LENGTH];
+    FreqDataRecordLocation locs[3] = {FREQ_LOC_CUR, FREQ_LOC_MIN, FREQ_LOC_MAX};
+
+    if ((num_cpus <= 0) || (!cpus) || (!states))
+    {
+        return -EINVAL;
+    }
+    if (!freq_initialized)
+    {
+        _freqInit();
+    }
+    for (int i = 0; i < num_cpus; i++)
+    {
+        FreqCpuState* st = &states[i];
+        uint64_t* dest[3] = {&st->cur, &st->min, &st->max};
+        int ret = 0;
+
+        memset(st, 0, sizeof(FreqCpuState));
+        st->cpu = cpus[i];
+        for (int l = 0; l < 3 && ret == 0; l++)
+        {
+            memset(s, '\0', LIKWID_FREQUENCY_MAX_DATA_LENGTH*sizeof(char));
+            ret = freq_send_direct(FREQ_READ, locs[l], st->cpu, LIKWID_FREQUENCY_MAX_DATA_LENGTH-1, s);
+            if (ret == 0)
+            {
+                *dest[l] = strtoull(s, NULL, 10);
+            }
+        }
+        if (ret == 0)
+        {
+            memset(s, '\0', LIKWID_FREQUENCY_MAX_DATA_LENGTH*sizeof(char));
+            ret = freq_send_direct(FREQ_READ, FREQ_LOC_GOV, st->cpu, LIKWID_FREQUENCY_MAX_DATA_LENGTH-1, s);
+            if (ret == 0)
+            {
+                s[strcspn(s, "\n")] = '\0';
+                snprintf(st->governor, LIKWID_FREQ_GOVERNOR_LENGTH, "%s", s);
+            }
+        }
+        st->error = (ret < 0 ? ret : 0);
+        if (st->error == 0)
+        {
+            count++;
+        }
+    }
+    freq_readTurboList(num_cpus, states);
+    return count;
+}
+
+static int freq_setCpuList(FreqDataRecordLocation loc, int num_cpus, const int* cpus, const uint64_t* freqs, const char* gov, int* errors)
+{
+    int ret = 0;
+    int count = 0;
+    FreqDataRecord* records = NULL;
+
+    if ((num_cpus <= 0) || (!cpus) || ((!freqs) && (!gov)))
+    {
+        return -EINVAL;
+    }
+    if (!freq_initialized)
+    {
+        _freqInit();
+    }
+    if (!freq_send_list)
+    {
+        return -ENODEV;
+    }
+    records = malloc(num_cpus * sizeof(FreqDataRecord));
+    if (!records)
+    {
+        return -ENOMEM;
+    }
+    for (int i = 0; i < num_cpus; i++)
+    {
+        FreqDataRecord* r = &records[i];
+        memset(r, 0, sizeof(FreqDataRecord));
+        r->type = FREQ_WRITE;
+        r->loc = loc;
+        r->cpu = cpus[i];
+        r->errorcode = FREQ_ERR_NONE;
+        if (gov)
+        {
+            r->datalen = snprintf(r->data, LIKWID_FREQUENCY_MAX_DATA_LENGTH, "%s", gov);
+        }
+        else
+        {
+            r->datalen = snprintf(r->data, LIKWID_FREQUENCY_MAX_DATA_LENGTH, "%lu", freqs[i]);
+        }
+    }
+    ret = freq_send_list(num_cpus, records);
+    for (int i = 0; i < num_cpus; i++)
+    {
+        int err = (ret < 0 ? ret : freq_record_error(&records[i]));
+        if (errors)
+        {
+            errors[i] = err;
+        }
+        if (err == 0)
+        {
+            count++;
+        }
+    }
+    free(records);
+    return count;
+}
+
+int freq_setCpuClockMinList(int num_cpus, const int* cpus, const uint64_t* freqs, int* errors)
+{
+    return freq_setCpuList(FREQ_LOC_MIN, num_cpus, cpus, freqs, NULL, errors);
+}
+
+int freq_setCpuClockMaxList(int num_cpus, const int* cpus, const uint64_t* freqs, int* errors)
+{
+    return freq_setCpuList(FREQ_LOC_MAX, num_cpus, cpus, freqs, NULL, errors);
+}
+
+int freq_setGovernorList(int num_cpus, const int* cpus, const char* gov, int* errors)
+{
+    if (!gov)
+    {
+        return -EINVAL;
+    }
+    return freq_setCpuList(FREQ_LOC_GOV, num_cpus, cpus, NULL, gov, errors);
+}
+
 /*void __attribute__((destructor (104))) close_frequency_cpu(void)*/
 /*{*/
 /*    _freqFinalize();*/
@@ -0,0 +1,774 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  frequency_tune.c
+ *
+ *      Description:  Adaptive per-region tuning of the CPU and Uncore frequency for
+ *                    the MarkerAPI. Each region is measured with different frequency
+ *                    settings and the setting with the lowest energy-delay product is
+ *                    applied when entering the region afterwards.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <likwid.h>
+#include <types.h>
+#include <error.h>
+#include <topology.h>
+#include <access.h>
+#include <registers.h>
+#include <ghash.h>
+#include <frequency_tune.h>
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int freqtune_active = 0;
+
+/* #####   LOCAL TYPES   ################################################## */
+
+typedef enum {
+    FREQTUNE_PHASE_BASELINE = 0,
+    FREQTUNE_PHASE_CPU,
+    FREQTUNE_PHASE_UNCORE,
+    FREQTUNE_PHASE_DONE,
+    FREQTUNE_PHASE_SKIP,
+} FreqTunePhase;
+
+/* Indices into the candidate lists, 0 is the setting found at initialization */
+typedef struct {
+    int cpuIdx;
+    int uncoreIdx;
+} FreqTuneSetting;
+
+typedef struct FreqTuneRegion {
+    char* tag;
+    FreqTunePhase phase;
+    FreqTuneSetting current;
+    FreqTuneSetting best;
+    /* Samples of the current setting */
+    int samples;
+    double sumTime;
+    double sumEnergy;
+    /* Per-call values of the baseline and the best setting */
+    double baseTime;
+    double baseEnergy;
+    double bestTime;
+    double bestEnergy;
+    /* Calls after the decision */
+    uint64_t tunedCalls;
+    double tunedTime;
+    double tunedEnergy;
+    /* Running measurement of the sampling thread */
+    int sampling;
+    double startTime;
+    PowerData energy[MAX_NUM_NODES][2];
+    struct FreqTuneRegion* next;
+} FreqTuneRegion;
+
+typedef struct {
+    FreqTuneRegion* region;
+    FreqTuneSetting setting;
+} FreqTuneStackEntry;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static pthread_mutex_t ft_lock = PTHREAD_MUTEX_INITIALIZER;
+static GHashTable* ft_regions = NULL;
+static FreqTuneRegion* ft_regionList = NULL;
+static FreqTuneRegion* ft_regionLast = NULL;
+static FILE* ft_log = NULL;
+static int ft_samples = 0;
+static double ft_minTime = 1E-3;
+
+static int ft_numThreads = 0;
+static int ft_threadCpu[MAX_NUM_THREADS];
+static int ft_threadSocket[MAX_NUM_THREADS];
+static uint64_t ft_defaultCpuMax[MAX_NUM_THREADS];
+static int ft_appliedCpu[MAX_NUM_THREADS];
+static int ft_depth[MAX_NUM_THREADS];
+static FreqTuneStackEntry ft_stack[MAX_NUM_THREADS][FREQTUNE_MAX_DEPTH];
+
+static int ft_numSockets = 0;
+static int ft_socketCpu[MAX_NUM_NODES];
+static int ft_socketPkg[MAX_NUM_NODES];
+static uint64_t ft_defaultUncore[MAX_NUM_NODES];
+static int ft_appliedUncore[MAX_NUM_NODES];
+static int ft_socketActive[MAX_NUM_NODES];
+
+static int ft_numDomains = 0;
+static PowerType ft_domains[2];
+
+static int ft_numCpuFreqs = 0;
+static uint64_t ft_cpuFreqs[FREQTUNE_MAX_CANDIDATES];
+static int ft_numUncore = 0;
+static uint64_t ft_uncoreRatios[FREQTUNE_MAX_CANDIDATES];
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static double
+freqtune_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1E-9);
+}
+
+static int
+freqtune_validFreq(uint64_t f)
+{
+    return (f > 0 && f != (uint64_t)-1);
+}
+
+static void
+freqtune_setCpuCandidates(int cpu, uint64_t stepKHz)
+{
+    uint64_t fmin = freq_getConfCpuClockMin(cpu);
+    char* avail = freq_getAvailFreq(cpu);
+    uint64_t last = ft_cpuFreqs[0];
+
+    ft_numCpuFreqs = 1;
+    if (avail)
+    {
+        /* The cpufreq driver accepts only the listed frequencies */
+        uint64_t list[FREQTUNE_MAX_CANDIDATES * 4];
+        int count = 0;
+        char* ptr = avail;
+        while (*ptr != '\0' && count < FREQTUNE_MAX_CANDIDATES * 4)
+        {
+            char* end = NULL;
+            uint64_t f = strtoull(ptr, &end, 10);
+            if (end == ptr)
+                break;
+            list[count++] = f;
+            ptr = end;
+        }
+        free(avail);
+        for (int i = 0; i < count; i++)
+        {
+            for (int j = i + 1; j < count; j++)
+            {
+                if (list[j] > list[i])
+                {
+                    uint64_t t = list[i];
+                    list[i] = list[j];
+                    list[j] = t;
+                }
+            }
+        }
+        for (int i = 0; i < count && ft_numCpuFreqs < FREQTUNE_MAX_CANDIDATES; i++)
+        {
+            if (list[i] + stepKHz <= last)
+            {
+                ft_cpuFreqs[ft_numCpuFreqs++] = list[i];
+                last = list[i];
+            }
+        }
+    }
+    else if (freqtune_validFreq(fmin))
+    {
+        while (last >= fmin + stepKHz && ft_numCpuFreqs < FREQTUNE_MAX_CANDIDATES)
+        {
+            last -= stepKHz;
+            ft_cpuFreqs[ft_numCpuFreqs++] = last;
+        }
+    }
+}
+
+static void
+freqtune_setUncoreCandidates(uint64_t stepMHz)
+{
+    uint64_t maxRatio = extractBitField(ft_defaultUncore[0], 7, 0);
+    uint64_t minRatio = extractBitField(ft_defaultUncore[0], 7, 8);
+    uint64_t stepRatio = (stepMHz >= 100 ? stepMHz / 100 : 1);
+
+    ft_numUncore = 1;
+    ft_uncoreRatios[0] = maxRatio;
+    while (maxRatio >= minRatio + stepRatio && ft_numUncore < FREQTUNE_MAX_CANDIDATES)
+    {
+        maxRatio -= stepRatio;
+        ft_uncoreRatios[ft_numUncore++] = maxRatio;
+    }
+}
+
+static void
+freqtune_applyCpu(int threadId, int cpuIdx)
+{
+    if (ft_appliedCpu[threadId] == cpuIdx)
+    {
+        return;
+    }
+    uint64_t f = (cpuIdx == 0 ? ft_defaultCpuMax[threadId] : ft_cpuFreqs[cpuIdx]);
+    if (freq_setCpuClockMax(ft_threadCpu[threadId], f) != f)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Failed to set maximal frequency %lu kHz for CPU %d, f, ft_threadCpu[threadId]);
+    }
+    ft_appliedCpu[threadId] = cpuIdx;
+}
+
+/* Must be called with ft_lock held, the Uncore setting is shared by all threads of a socket */
+static void
+freqtune_applyUncore(int socket, int uncoreIdx)
+{
+    uint64_t val = ft_defaultUncore[socket];
+    if (ft_numUncore < 2 || ft_appliedUncore[socket] == uncoreIdx)
+    {
+        return;
+    }
+    if (uncoreIdx > 0)
+    {
+        uint64_t ratio = ft_uncoreRatios[uncoreIdx];
+        val = (val & ~0x7FULL) | ratio;
+        if (extractBitField(val, 7, 8) > ratio)
+        {
+            val = (val & ~0x7F00ULL) | (ratio << 8);
+        }
+    }
+    if (HPMwrite(ft_socketCpu[socket], MSR_DEV, MSR_UNCORE_FREQ, val) != 0)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Failed to write Uncore frequency limits on CPU %d, ft_socketCpu[socket]);
+    }
+    ft_appliedUncore[socket] = uncoreIdx;
+}
+
+static void
+freqtune_energyStart(FreqTuneRegion* r)
+{
+    for (int s = 0; s < ft_numSockets; s++)
+    {
+        for (int d = 0; d < ft_numDomains; d++)
+        {
+            power_start(&r->energy[s][d], ft_socketCpu[s], ft_domains[d]);
+        }
+    }
+}
+
+static double
+freqtune_energyStop(FreqTuneRegion* r)
+{
+    double energy = 0.0;
+    for (int s = 0; s < ft_numSockets; s++)
+    {
+        for (int d = 0; d < ft_numDomains; d++)
+        {
+            if (power_stop(&r->energy[s][d], ft_socketCpu[s], ft_domains[d]) == 0)
+            {
+                energy += power_printEnergy(&r->energy[s][d]);
+            }
+        }
+    }
+    return energy;
+}
+
+static void
+freqtune_printSetting(FreqTuneSetting* s, char* buf, int len)
+{
+    char cpu[40];
+    char uncore[40];
+    if (ft_numCpuFreqs > 0)
+        snprintf(cpu, sizeof(cpu), "%lu kHz", ft_cpuFreqs[s->cpuIdx]);
+    else
+        snprintf(cpu, sizeof(cpu), "default");
+    if (s->uncoreIdx > 0)
+        snprintf(uncore, sizeof(uncore), "%lu MHz", ft_uncoreRatios[s->uncoreIdx] * 100);
+    else
+        snprintf(uncore, sizeof(uncore), "default");
+    snprintf(buf, len, "cpu %s uncore %s", cpu, uncore);
+}
+
+static double
+freqtune_percent(double value, double base)
+{
+    return (base > 0 ? 100.0 * (value - base) / base : 0.0);
+}
+
+static void
+freqtune_decide(FreqTuneRegion* r)
+{
+    char setting[100];
+    double edp = r->bestTime * r->bestEnergy;
+    double baseEDP = r->baseTime * r->baseEnergy;
+
+    r->current = r->best;
+    r->phase = FREQTUNE_PHASE_DONE;
+    freqtune_printSetting(&r->best, setting, sizeof(setting));
+    fprintf(ft_log, "FREQTUNE %s selected %s: EDP %+.1f%% energy %+.1f%% time %+.1f%% against baseline\n",
+            r->tag, setting, freqtune_percent(edp, baseEDP),
+            freqtune_percent(r->bestEnergy, r->baseEnergy),
+            freqtune_percent(r->bestTime, r->baseTime));
+}
+
+static void
+freqtune_startUncore(FreqTuneRegion* r)
+{
+    r->current = r->best;
+    if (ft_numUncore > 1)
+    {
+        r->phase = FREQTUNE_PHASE_UNCORE;
+        r->current.uncoreIdx = 1;
+        return;
+    }
+    freqtune_decide(r);
+}
+
+/* Coordinate search: lower the CPU frequency as long as the energy-delay product
+ * improves, then do the same for the Uncore frequency. */
+static void
+freqtune_nextSetting(FreqTuneRegion* r, double time, double energy)
+{
+    int improved = (time * energy < r->bestTime * r->bestEnergy * (1.0 - FREQTUNE_MIN_GAIN));
+
+    switch (r->phase)
+    {
+        case FREQTUNE_PHASE_BASELINE:
+            r->baseTime = time;
+            r->baseEnergy = energy;
+            r->bestTime = time;
+            r->bestEnergy = energy;
+            r->best = r->current;
+            if (time < ft_minTime)
+            {
+                r->phase = FREQTUNE_PHASE_SKIP;
+                fprintf(ft_log, "FREQTUNE %s skipped: runtime per call %e s below %e s\n", r->tag, time, ft_minTime);
+            }
+            else if (ft_numCpuFreqs > 1)
+            {
+                r->phase = FREQTUNE_PHASE_CPU;
+                r->current.cpuIdx = 1;
+            }
+            else
+            {
+                freqtune_startUncore(r);
+            }
+            break;
+        case FREQTUNE_PHASE_CPU:
+            if (improved)
+            {
+                r->best = r->current;
+                r->bestTime = time;
+                r->bestEnergy = energy;
+                if (r->current.cpuIdx + 1 < ft_numCpuFreqs)
+                {
+                    r->current.cpuIdx++;
+                    break;
+                }
+            }
+            freqtune_startUncore(r);
+            break;
+        case FREQTUNE_PHASE_UNCORE:
+            if (improved)
+            {
+                r->best = r->current;
+                r->bestTime = time;
+                r->bestEnergy = energy;
+                if (r->current.uncoreIdx + 1 < ft_numUncore)
+                {
+                    r->current.uncoreIdx++;
+                    break;
+                }
+            }
+            freqtune_decide(r);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Must be called with ft_lock held */
+static void
+freqtune_addSample(FreqTuneRegion* r, double time, double energy)
+{
+    char setting[100];
+
+    if (r->phase == FREQTUNE_PHASE_DONE)
+    {
+        r->tunedCalls++;
+        r->tunedTime += time;
+        r->tunedEnergy += energy;
+        return;
+    }
+    else if (r->phase == FREQTUNE_PHASE_SKIP)
+    {
+        return;
+    }
+    r->sumTime += time;
+    r->sumEnergy += energy;
+    r->samples++;
+    if (r->samples < ft_samples)
+    {
+        return;
+    }
+    time = r->sumTime / r->samples;
+    energy = r->sumEnergy / r->samples;
+    freqtune_printSetting(&r->current, setting, sizeof(setting));
+    fprintf(ft_log, "FREQTUNE %s %s calls %d time %e s energy %e J EDP %e Js\n",
+            r->tag, setting, r->samples, time, energy, time * energy);
+    r->samples = 0;
+    r->sumTime = 0.0;
+    r->sumEnergy = 0.0;
+    freqtune_nextSetting(r, time, energy);
+}
+
+/* Must be called with ft_lock held */
+static FreqTuneRegion*
+freqtune_getRegion(const char* regionTag)
+{
+    FreqTuneRegion* r = g_hash_table_lookup(ft_regions, regionTag);
+    if (!r)
+    {
+        r = calloc(1, sizeof(FreqTuneRegion));
+        if (!r)
+        {
+            return NULL;
+        }
+        r->tag = strdup(regionTag);
+        if (!r->tag)
+        {
+            free(r);
+            return NULL;
+        }
+        g_hash_table_insert(ft_regions, r->tag, r);
+        if (ft_regionLast)
+        {
+            ft_regionLast->next = r;
+        }
+        else
+        {
+            ft_regionList = r;
+        }
+        ft_regionLast = r;
+    }
+    return r;
+}
+
+static void
+freqtune_freeRegion(gpointer data)
+{
+    FreqTuneRegion* r = (FreqTuneRegion*)data;
+    free(r->tag);
+    free(r);
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+freqtune_init(int numThreads, int* threadsToCpu)
+{
+    char* sampleStr = getenv("LIKWID_FREQTUNE");
+    char* stepStr = getenv("LIKWID_FREQTUNE_STEP");
+    char* minTimeStr = getenv("LIKWID_FREQTUNE_MINTIME");
+    char* logStr = getenv("LIKWID_FREQTUNE_LOG");
+    uint64_t stepMHz = 200;
+
+    if (sampleStr == NULL)
+    {
+        return 0;
+    }
+    ft_samples = atoi(sampleStr);
+    if (ft_samples <= 0)
+    {
+        fprintf(stderr, "WARN: Invalid value '%s' for LIKWID_FREQTUNE, frequency tuning disabled\n", sampleStr);
+        return -EINVAL;
+    }
+#ifdef LIKWID_USE_PERFEVENT
+    fprintf(stderr, "WARN: Frequency tuning not available with ACCESSMODE=perf_event\n");
+    return -EPERM;
+#else
+    if (stepStr != NULL && atoi(stepStr) > 0)
+    {
+        stepMHz = atoi(stepStr);
+    }
+    if (minTimeStr != NULL)
+    {
+        ft_minTime = atof(minTimeStr);
+    }
+
+    ft_numThreads = MIN(numThreads, MAX_NUM_THREADS);
+    ft_numSockets = 0;
+    for (int i = 0; i < ft_numThreads; i++)
+    {
+        int cpu = threadsToCpu[i];
+        int pkg = -1;
+        for (int j = 0; j < (int)cpuid_topology.numHWThreads; j++)
+        {
+            if (cpuid_topology.threadPool[j].apicId == (uint32_t)cpu)
+            {
+                pkg = cpuid_topology.threadPool[j].packageId;
+                break;
+            }
+        }
+        ft_threadCpu[i] = cpu;
+        ft_threadSocket[i] = -1;
+        for (int s = 0; s < ft_numSockets; s++)
+        {
+            if (ft_socketPkg[s] == pkg)
+            {
+                ft_threadSocket[i] = s;
+                break;
+            }
+        }
+        if (ft_threadSocket[i] < 0 && ft_numSockets < MAX_NUM_NODES)
+        {
+            ft_socketCpu[ft_numSockets] = cpu;
+            ft_socketPkg[ft_numSockets] = pkg;
+            ft_threadSocket[i] = ft_numSockets++;
+        }
+        ft_appliedCpu[i] = 0;
+        ft_depth[i] = 0;
+    }
+
+    ft_numDomains = 0;
+    for (int s = 0; s < ft_numSockets; s++)
+    {
+        power_init(ft_socketCpu[s]);
+    }
+    if (power_info.hasRAPL)
+    {
+        PowerType types[2] = {PKG, DRAM};
+        for (int d = 0; d < 2; d++)
+        {
+            if (power_info.domains[types[d]].supportFlags & POWER_DOMAIN_SUPPORT_STATUS)
+            {
+                ft_domains[ft_numDomains++] = types[d];
+            }
+        }
+    }
+    if (ft_numDomains == 0)
+    {
+        fprintf(stderr, "WARN: Frequency tuning requires RAPL energy counters, frequency tuning disabled\n");
+        return -ENODEV;
+    }
+
+    int cpuValid = 1;
+    ft_numCpuFreqs = 0;
+    for (int i = 0; i < ft_numThreads && cpuValid; i++)
+    {
+        ft_defaultCpuMax[i] = freq_getCpuClockMax(ft_threadCpu[i]);
+        cpuValid = freqtune_validFreq(ft_defaultCpuMax[i]);
+    }
+    if (cpuValid)
+    {
+        ft_cpuFreqs[0] = ft_defaultCpuMax[0];
+        freqtune_setCpuCandidates(ft_threadCpu[0], stepMHz * 1000);
+    }
+
+    ft_numUncore = 0;
+    if (cpuid_info.isIntel)
+    {
+        int err = 0;
+        for (int s = 0; s < ft_numSockets && err == 0; s++)
+        {
+            err = HPMread(ft_socketCpu[s], MSR_DEV, MSR_UNCORE_FREQ, &ft_defaultUncore[s]);
+            ft_appliedUncore[s] = 0;
+            ft_socketActive[s] = 0;
+        }
+        if (err == 0 && extractBitField(ft_defaultUncore[0], 7, 0) > 0)
+        {
+            freqtune_setUncoreCandidates(stepMHz);
+        }
+    }
+
+    if (ft_numCpuFreqs < 2 && ft_numUncore < 2)
+    {
+        fprintf(stderr, "WARN: No adjustable CPU or Uncore frequency found, frequency tuning disabled\n");
+        return -ENODEV;
+    }
+
+    ft_log = stderr;
+    if (logStr != NULL)
+    {
+        ft_log = fopen(logStr, "w");
+        if (!ft_log)
+        {
+            fprintf(stderr, "WARN: Cannot open frequency tuning log %s, using stderr\n", logStr);
+            ft_log = stderr;
+        }
+    }
+    ft_regions = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, freqtune_freeRegion);
+    if (!ft_regions)
+    {
+        if (ft_log != stderr)
+            fclose(ft_log);
+        ft_log = NULL;
+        return -ENOMEM;
+    }
+    fprintf(ft_log, "FREQTUNE calls per setting %d, %d CPU frequencies (%lu - %lu kHz), %d Uncore settings\n",
+            ft_samples, ft_numCpuFreqs, (ft_numCpuFreqs > 0 ? ft_cpuFreqs[ft_numCpuFreqs - 1] : 0),
+            (ft_numCpuFreqs > 0 ? ft_cpuFreqs[0] : 0), ft_numUncore);
+    freqtune_active = 1;
+    return 0;
+#endif
+}
+
+void
+freqtune_regionStart(const char* regionTag, int threadId)
+{
+    FreqTuneRegion* r = NULL;
+    FreqTuneSetting s;
+
+    if ((!freqtune_active) || (threadId < 0) || (threadId >= ft_numThreads) ||
+        (ft_depth[threadId] >= FREQTUNE_MAX_DEPTH))
+    {
+        return;
+    }
+    int socket = ft_threadSocket[threadId];
+
+    pthread_mutex_lock(&ft_lock);
+    r = freqtune_getRegion(regionTag);
+    if (!r)
+    {
+        pthread_mutex_unlock(&ft_lock);
+        return;
+    }
+    s = r->current;
+    ft_socketActive[socket]++;
+    freqtune_applyUncore(socket, s.uncoreIdx);
+    pthread_mutex_unlock(&ft_lock);
+
+    ft_stack[threadId][ft_depth[threadId]].region = r;
+    ft_stack[threadId][ft_depth[threadId]].setting = s;
+    ft_depth[threadId]++;
+    freqtune_applyCpu(threadId, s.cpuIdx);
+
+    /* The measurements of the first thread drive the search */
+    if (threadId == 0 && r->phase != FREQTUNE_PHASE_SKIP)
+    {
+        freqtune_energyStart(r);
+        r->startTime = freqtune_now();
+        r->sampling = 1;
+    }
+}
+
+void
+freqtune_regionStop(const char* regionTag, int threadId)
+{
+    int idx = -1;
+    double time = 0.0;
+    double energy = 0.0;
+    FreqTuneRegion* r = NULL;
+    FreqTuneSetting prev = {0, 0};
+
+    if ((!freqtune_active) || (threadId < 0) || (threadId >= ft_numThreads))
+    {
+        return;
+    }
+    double stop = freqtune_now();
+    for (int i = ft_depth[threadId] - 1; i >= 0; i--)
+    {
+        if (strcmp(ft_stack[threadId][i].region->tag, regionTag) == 0)
+        {
+            idx = i;
+            break;
+        }
+    }
+    if (idx < 0)
+    {
+        return;
+    }
+    r = ft_stack[threadId][idx].region;
+    int sampled = (threadId == 0 && r->sampling);
+    if (sampled)
+    {
+        energy = freqtune_energyStop(r);
+        time = stop - r->startTime;
+        r->sampling = 0;
+    }
+    for (int i = idx; i < ft_depth[threadId] - 1; i++)
+    {
+        ft_stack[threadId][i] = ft_stack[threadId][i + 1];
+    }
+    ft_depth[threadId]--;
+    if (ft_depth[threadId] > 0)
+    {
+        prev = ft_stack[threadId][ft_depth[threadId] - 1].setting;
+    }
+
+    int socket = ft_threadSocket[threadId];
+    pthread_mutex_lock(&ft_lock);
+    if (sampled)
+    {
+        freqtune_addSample(r, time, energy);
+    }
+    ft_socketActive[socket]--;
+    freqtune_applyUncore(socket, (ft_socketActive[socket] > 0 ? prev.uncoreIdx : 0));
+    pthread_mutex_unlock(&ft_lock);
+    freqtune_applyCpu(threadId, prev.cpuIdx);
+}
+
+void
+freqtune_finalize(void)
+{
+    if (!freqtune_active)
+    {
+        return;
+    }
+    freqtune_active = 0;
+    for (int i = 0; i < ft_numThreads; i++)
+    {
+        freqtune_applyCpu(i, 0);
+        ft_depth[i] = 0;
+    }
+    for (int s = 0; s < ft_numSockets; s++)
+    {
+        freqtune_applyUncore(s, 0);
+        ft_socketActive[s] = 0;
+    }
+    for (FreqTuneRegion* r = ft_regionList; r != NULL; r = r->next)
+    {
+        if (r->phase != FREQTUNE_PHASE_DONE)
+        {
+            fprintf(ft_log, "FREQTUNE %s not tuned\n", r->tag);
+        }
+        else if (r->tunedCalls > 0)
+        {
+            double energy = r->tunedEnergy / r->tunedCalls;
+            double time = r->tunedTime / r->tunedCalls;
+            fprintf(ft_log, "FREQTUNE %s tuned calls %lu energy %e J time %e s: saved energy %e J (%+.1f%%) delay %e s (%+.1f%%)\n",
+                    r->tag, r->tunedCalls, r->tunedEnergy, r->tunedTime,
+                    (r->baseEnergy - energy) * r->tunedCalls, freqtune_percent(energy, r->baseEnergy),
+                    (time - r->baseTime) * r->tunedCalls, freqtune_percent(time, r->baseTime));
+        }
+        else
+        {
+            fprintf(ft_log, "FREQTUNE %s no calls after tuning\n", r->tag);
+        }
+    }
+    if (ft_log && ft_log != stderr)
+    {
+        fclose(ft_log);
+    }
+    ft_log = NULL;
+    g_hash_table_destroy(ft_regions);
+    ft_regions = NULL;
+    ft_regionList = NULL;
+    ft_regionLast = NULL;
+}
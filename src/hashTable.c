@@ -124,6 +124,7 @@ hashTable_get(bstring label, LikwidThreadResults** resEntry)
         (*resEntry)->count = 0;
         (*resEntry)->index = resPtr->hashIndex++;
         (*resEntry)->state = MARKER_STATE_NEW;
+        (*resEntry)->liveIndex = -1;
         for (int i=0; i< NUM_PMC; i++)
         {
             (*resEntry)->PMcounters[i] = 0.0;
@@ -195,6 +196,7 @@ hashTable_finalize(int* numThreads, int* numRegions, LikwidResults** results)
                         numberOfThreads * sizeof(int));
                 break;
             }
+            (*results)[i].coverage = NULL;
             (*results)[i].counters = (double**) malloc(numberOfThreads * sizeof(double*));
             if (!(*results)[i].counters)
             {
@@ -30,6 +30,12 @@
 #ifndef ACCESS_H
 #define ACCESS_H
 
+typedef struct {
+    PciDeviceIndex dev;
+    uint32_t reg;
+    uint64_t data;
+} HPMWriteRecord;
+
 void HPMmode(int mode);
 int HPMinit(void);
 int HPMinitialized(void);
@@ -37,6 +43,7 @@ int HPMaddThread(int cpu_id);
 void HPMfinalize();
 int HPMread(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t* data);
 int HPMwrite(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t data);
+int HPMwriteBatch(int cpu_id, int count, HPMWriteRecord* writes);
 int HPMcheck(PciDeviceIndex dev, int cpu_id);
 
 #endif /* ACCESS_H */
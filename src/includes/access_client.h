@@ -33,6 +33,7 @@
 int access_client_init(int cpu_id);
 int access_client_read(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t *data);
 int access_client_write(PciDeviceIndex dev, const int cpu_id, uint32_t reg, uint64_t data);
+int access_client_writeBatch(const int cpu_id, int count, HPMWriteRecord* writes);
 void access_client_finalize(int cpu_id);
 int access_client_check(PciDeviceIndex dev, int cpu_id);
 
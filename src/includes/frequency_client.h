@@ -32,6 +32,8 @@
 #define LIKWID_FREQUENCY_CLIENT_H
 
 #define LIKWID_FREQUENCY_MAX_DATA_LENGTH   200
+/* Number of records the client sends to the daemon before collecting the replies */
+#define LIKWID_FREQUENCY_BATCH_RECORDS     64
 
 typedef enum {
     FREQ_READ = 0,
@@ -0,0 +1,47 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  frequency_tune.h
+ *
+ *      Description:  Header File of the per-region frequency tuning for the MarkerAPI
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_FREQUENCY_TUNE_H
+#define LIKWID_FREQUENCY_TUNE_H
+
+/* Maximal number of frequency settings tested per dimension */
+#define FREQTUNE_MAX_CANDIDATES 32
+/* Maximal nesting depth of tuned regions per thread */
+#define FREQTUNE_MAX_DEPTH 16
+/* Relative EDP improvement required to accept a lower frequency */
+#define FREQTUNE_MIN_GAIN 0.01
+
+extern int freqtune_active;
+
+int freqtune_init(int numThreads, int* threadsToCpu);
+void freqtune_regionStart(const char* regionTag, int threadId);
+void freqtune_regionStop(const char* regionTag, int threadId);
+void freqtune_finalize(void);
+
+#endif /* LIKWID_FREQUENCY_TUNE_H */
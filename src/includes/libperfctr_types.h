@@ -51,6 +51,7 @@ typedef struct LikwidThreadResults{
     int StartOverflows[NUM_PMC];
     double PMcounters[NUM_PMC];
     LikwidThreadStates state;
+    int liveIndex;
 } LikwidThreadResults;
 
 typedef struct {
@@ -81,6 +82,21 @@ typedef struct {
     uint32_t*  count;
     int* cpulist;
     double** counters;
+    double* coverage;
 } LikwidResults;
 
+typedef struct {
+    bstring  tag;
+    int parent;
+    int groupID;
+    int threadCount;
+    int eventCount;
+    int* cpulist;
+    uint32_t* count;
+    double* inclTime;
+    double* exclTime;
+    double** inclCounters;
+    double** exclCounters;
+} LikwidRegionNode;
+
 #endif /*LIBPERFCTR_H*/
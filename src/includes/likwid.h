@@ -292,7 +292,8 @@ extern int likwid_pinThread(int processorId)
 LIKWID supports multiple access modes to the MSR and PCI performance monitoring
 registers. For direct access the user must have enough priviledges to access the
 MSR and PCI devices. The daemon mode forwards the operations to a daemon with
-higher priviledges.
+higher priviledges. The simulation mode keeps all registers in memory and
+advances counters as described by the script in LIKWID_SIM_SCRIPT.
 */
 typedef enum {
   ACCESSMODE_PERF = -1, /*!< \brief Access performance monitoring through
@@ -300,7 +301,9 @@ typedef enum {
   ACCESSMODE_DIRECT =
       0, /*!< \brief Access performance monitoring registers directly */
   ACCESSMODE_DAEMON =
-      1 /*!< \brief Use the access daemon to access the registers */
+      1, /*!< \brief Use the access daemon to access the registers */
+  ACCESSMODE_SIM =
+      2 /*!< \brief Use simulated registers in memory, no hardware access */
 } AccessMode;
 
 /*! \brief Set access mode
@@ -556,6 +559,19 @@ Retrieved pointers to the structures are not valid anymore after this function
 call \sa CpuInfo_t and CpuTopology_t
 */
 extern void topology_finalize(void) __attribute__((visibility("default")));
+/*! \brief Write a binary topology cache
+
+Stores CpuInfo_t, CpuTopology_t, NumaTopology_t and AffinityDomains_t together
+with the affinity lookup tables in a versioned binary file. If the file is used
+as topology file, topology_init() maps it instead of probing the system. The
+cache is ignored if the CPU signature, the number of configured HW threads or
+the online HW threads and NUMA nodes differ from the generating system. The
+affinity domains are only reused if the CPU set is the same.
+@param [in] filename Path of the cache file
+@return 0 on success, negative errno in case of failure
+*/
+extern int topology_writeCache(const char *filename)
+    __attribute__((visibility("default")));
 /*! \brief Print all supported architectures
  */
 extern void print_supportedCPUs(void) __attribute__((visibility("default")));
@@ -644,6 +660,55 @@ allocation to be placed in NUMA domains spanning the given processor list.
 */
 extern void numa_setMembind(const int *processorList, int numberOfProcessors)
     __attribute__((visibility("default")));
+/*! \brief Page placement of one thread in a NUMA audit
+
+The pages of the audited regions are split in equally sized chunks, one per
+thread, as touched by a statically scheduled loop.
+\extends NumaAudit
+*/
+typedef struct {
+  int cpu;  /*!< \brief HW thread the thread is pinned to */
+  int node; /*!< \brief Index of the NUMA node of the HW thread in \a numa_info */
+  uint64_t localPages;    /*!< \brief Pages on the NUMA node of the thread */
+  uint64_t remotePages;   /*!< \brief Pages on other NUMA nodes */
+  uint64_t migratedPages; /*!< \brief Pages moved to the NUMA node of the thread */
+} NumaAuditThread;
+
+/*! \brief Result of a NUMA page placement audit of a process */
+typedef struct {
+  int numberOfThreads; /*!< \brief Number of threads and length of \a threads */
+  NumaAuditThread *threads; /*!< \brief Page placement per thread */
+  int numberOfRegions; /*!< \brief Number of audited memory regions */
+  uint64_t totalPages; /*!< \brief Present pages in the audited regions */
+  int numberOfNodes;   /*!< \brief Length of \a nodePages */
+  uint64_t *nodePages; /*!< \brief Present pages per NUMA node */
+} NumaAudit;
+
+/** \brief Pointer for exporting the NumaAudit data structure */
+typedef NumaAudit *NumaAudit_t;
+
+/*! \brief Audit the NUMA page placement of a process
+
+Queries the NUMA node of all present pages in the large anonymous memory regions
+(heap and mmap'ed data, no thread stacks) of the process with move_pages(2). Each
+region is split in \a numberOfThreads chunks and the pages of chunk i are
+compared to the NUMA node of \a cpus[i]. With \a migrate set, remote pages are
+moved to the NUMA node of the thread.
+@param [in] pid Process ID
+@param [in] numberOfThreads Number of threads and length of \a cpus
+@param [in] cpus HW threads the threads are pinned to
+@param [in] migrate Move remote pages to the NUMA node of the thread
+@param [out] audit Audit result, free with numa_freeAudit()
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int numa_auditProcess(int pid, int numberOfThreads, const int *cpus,
+                             int migrate, NumaAudit_t *audit)
+    __attribute__((visibility("default")));
+/*! \brief Free the result of numa_auditProcess()
+@param [in] audit Audit result
+*/
+extern void numa_freeAudit(NumaAudit_t audit)
+    __attribute__((visibility("default")));
 /*! \brief Destroy NUMA information structure
 
 Destroys the NUMA information structure NumaTopology_t. Retrieved pointers
@@ -793,7 +858,8 @@ extern void affinity_finalize(void) __attribute__((visibility("default")));
 
 Reads the CPU selection string and fills the given list with the CPU numbers
 defined in the selection string. This function is a interface function for the
-different selection modes: scatter, expression, logical and physical.
+different selection modes: scatter, placement policy, expression, logical and
+physical.
 @param [in] cpustring Selection string
 @param [in,out] cpulist List of CPUs
 @param [in] length Length of cpulist
@@ -937,6 +1003,10 @@ extern int perfmon_addEventSet(const char *eventCString)
     __attribute__((visibility("default")));
 /*! \brief Setup all performance monitoring counters of an eventSet
 
+The register writes of the first setup are recorded per CPU. Later setups of
+the same eventSet only write the configuration registers that differ from the
+current state, in daemon mode with a single request per CPU. Set the environment
+variable LIKWID_FORCE_SETUP to write all registers.
 @param [in] groupId (returned from perfmon_addEventSet()
 @return error code (-ENOENT if groupId is invalid and -1 if the counters of one
 CPU cannot be set up)
@@ -1009,6 +1079,28 @@ counters and start the counters.
 */
 extern int perfmon_switchActiveGroup(int new_group)
     __attribute__((visibility("default")));
+/*! \brief Start the background counter overflow watch
+
+Starts one thread per socket that reads the counters of the active eventSet
+often enough that no counter can wrap around twice between two reads. The
+detected overflows are accumulated and used at the next regular read or stop,
+so long measurements without periodic reads give correct counts. The read
+interval is derived from the counter widths and a maximal event rate. With the
+perf_event backend the counters are 64 bit wide and the call does nothing.
+@return 0 on success, error code otherwise
+*/
+extern int perfmon_startOverflowWatch(void)
+    __attribute__((visibility("default")));
+/*! \brief Stop the background counter overflow watch
+*/
+extern void perfmon_stopOverflowWatch(void)
+    __attribute__((visibility("default")));
+/*! \brief Get the read interval of the counter overflow watch
+
+@return Interval in seconds or 0 if the overflow watch is not running
+*/
+extern double perfmon_getOverflowWatchInterval(void)
+    __attribute__((visibility("default")));
 /*! \brief Close the perfomance monitoring facility of LIKWID
 
 Deallocates all internal data that is used during performance monitoring. Also
@@ -1182,6 +1274,57 @@ extern int perfmon_readMarkerFile(const char *filename)
  */
 extern void perfmon_destroyMarkerResults(void)
     __attribute__((visibility("default")));
+/*! \brief Opaque handle of the live Marker API results of a process */
+typedef struct LikwidMarkerLive *LikwidMarkerLive_t;
+/*! \brief Attach to the live Marker API results of a running process
+
+Applications started with LIKWID_MARKER_LIVE set (likwid-perfctr -m --live)
+publish their region results in the shared memory segment
+/likwid-marker-<pid> after each likwid_markerStopRegion(). The results are
+updated with a sequence lock per region and thread, so the measured threads
+never wait for readers.
+@param [in] pid Process ID of the application
+@param [out] live Handle for the live results
+@return 0 or negative error number
+*/
+extern int likwid_markerLiveAttach(int pid, LikwidMarkerLive_t *live)
+    __attribute__((visibility("default")));
+/*! \brief Get the HW threads measured by the application
+@param [in] live Handle for the live results
+@param [in] length Length of \a cpus
+@param [out] cpus HW thread IDs (can be NULL)
+@return Number of threads or negative error number
+*/
+extern int likwid_markerLiveThreads(LikwidMarkerLive_t live, int length, int *cpus)
+    __attribute__((visibility("default")));
+/*! \brief Get the event sets measured by the application
+@param [in] live Handle for the live results
+@return Event sets separated by '|' as in LIKWID_EVENTS
+*/
+extern const char *likwid_markerLiveEvents(LikwidMarkerLive_t live)
+    __attribute__((visibility("default")));
+/*! \brief Check whether the application still publishes results
+@param [in] live Handle for the live results
+@return 1 if the application is running and the Marker API not closed, 0 otherwise
+*/
+extern int likwid_markerLiveRunning(LikwidMarkerLive_t live)
+    __attribute__((visibility("default")));
+/*! \brief Read a snapshot of the live Marker API results
+
+The snapshot replaces the results of perfmon_readMarkerFile() and is accessed
+with the same functions (perfmon_getNumberOfRegions(), ...). The event sets of
+likwid_markerLiveEvents() must be added with perfmon_addEventSet() before.
+@param [in] live Handle for the live results
+@param [in] diff Return the difference to the previous snapshot instead of the totals
+@return Number of regions or negative error number
+*/
+extern int perfmon_readMarkerLive(LikwidMarkerLive_t live, int diff)
+    __attribute__((visibility("default")));
+/*! \brief Detach from the live Marker API results
+@param [in] live Handle for the live results
+*/
+extern void likwid_markerLiveDetach(LikwidMarkerLive_t live)
+    __attribute__((visibility("default")));
 /*! \brief Get the number of regions listed in Marker API result file
 
 @return Number of regions
@@ -1240,6 +1383,17 @@ extern double perfmon_getTimeOfRegion(int region, int thread)
 */
 extern int perfmon_getCountOfRegion(int region, int thread)
     __attribute__((visibility("default")));
+/*! \brief Get the coverage of a multiplexed region for a thread
+
+With automatic group multiplexing (LIKWID_MARKER_MUX), each group measures only
+a part of the region's runtime and the results are extrapolated to the whole
+runtime. The coverage is the measured fraction.
+@param [in] region ID of region
+@param [in] thread ID of thread
+@return Coverage between 0 and 1 or -1 if the region was not multiplexed
+*/
+extern double perfmon_getCoverageOfRegion(int region, int thread)
+    __attribute__((visibility("default")));
 /*! \brief Get the event result of a region for an event and thread
 @param [in] region ID of region
 @param [in] event ID of event
@@ -1258,6 +1412,82 @@ extern double perfmon_getMetricOfRegionThread(int region, int metricId,
                                               int threadId)
     __attribute__((visibility("default")));
 
+/*! \brief Get the number of nodes in the call-path tree of nested regions
+
+If regions were nested, the Marker API file contains a call-path tree. Each
+node is a region called from a specific parent region. Inclusive values contain
+the nested regions, exclusive values only the part outside of them.
+@return Number of nodes (0 if regions were not nested)
+*/
+extern int perfmon_getNumberOfRegionNodes(void)
+    __attribute__((visibility("default")));
+/*! \brief Get the region tag of a call-path node
+@param [in] node ID of node
+@return Region tag
+*/
+extern char *perfmon_getTagOfRegionNode(int node)
+    __attribute__((visibility("default")));
+/*! \brief Get the parent of a call-path node
+@param [in] node ID of node
+@return ID of the parent node or -1 for top-level regions
+*/
+extern int perfmon_getParentOfRegionNode(int node)
+    __attribute__((visibility("default")));
+/*! \brief Get the group ID of a call-path node
+@param [in] node ID of node
+@return Group ID
+*/
+extern int perfmon_getGroupOfRegionNode(int node)
+    __attribute__((visibility("default")));
+/*! \brief Get the number of threads with results for a call-path node
+@param [in] node ID of node
+@return Number of threads
+*/
+extern int perfmon_getThreadsOfRegionNode(int node)
+    __attribute__((visibility("default")));
+/*! \brief Get the HW thread of a thread of a call-path node
+@param [in] node ID of node
+@param [in] thread ID of thread
+@return HW thread ID
+*/
+extern int perfmon_getCpuOfRegionNode(int node, int thread)
+    __attribute__((visibility("default")));
+/*! \brief Get the call count of a call-path node for a thread
+@param [in] node ID of node
+@param [in] thread ID of thread
+@return Call count
+*/
+extern int perfmon_getCountOfRegionNode(int node, int thread)
+    __attribute__((visibility("default")));
+/*! \brief Get the inclusive or exclusive runtime of a call-path node for a thread
+@param [in] node ID of node
+@param [in] thread ID of thread
+@param [in] exclusive Exclude the runtime of nested regions
+@return Runtime in seconds
+*/
+extern double perfmon_getTimeOfRegionNode(int node, int thread, int exclusive)
+    __attribute__((visibility("default")));
+/*! \brief Get the inclusive or exclusive event result of a call-path node for a thread
+@param [in] node ID of node
+@param [in] event ID of event
+@param [in] thread ID of thread
+@param [in] exclusive Exclude the counts of nested regions
+@return Result of the event
+*/
+extern double perfmon_getResultOfRegionNode(int node, int event, int thread, int exclusive)
+    __attribute__((visibility("default")));
+/*! \brief Get the inclusive or exclusive metric result of a call-path node
+
+The counts of all threads are summed up and the runtime is the maximum of all
+threads.
+@param [in] node ID of node
+@param [in] metricId ID of metric
+@param [in] exclusive Exclude the counts and runtime of nested regions
+@return Result of the metric
+*/
+extern double perfmon_getMetricOfRegionNode(int node, int metricId, int exclusive)
+    __attribute__((visibility("default")));
+
 /** @}*/
 
 /*
@@ -1449,6 +1679,18 @@ Read group from file
 int perfgroup_readGroup(const char *grouppath, const char *architecture,
                         const char *groupname, GroupInfo *ginfo)
     __attribute__((visibility("default")));
+/*! \brief Build the group catalogue of an architecture
+
+Parse all group files in <grouppath>/<architecture> and write them to the
+catalogue file .groups.cat in the same folder. perfgroup_getGroups() and perfgroup_readGroup() use the catalogue
+as long as it matches the group files. Catalogues in the user's group folder
+are rebuilt automatically when a group file changes.
+@param [in] grouppath Base path to all groups
+@param [in] architecture Architecture string (e.g. short_info in cpuid_info)
+@return Number of groups in the catalogue or negative error code
+*/
+int perfgroup_buildCatalogue(const char *grouppath, const char *architecture)
+    __attribute__((visibility("default")));
 /*! \brief Create group from event string
 
 Create group from event string (list of event:counter(:opts)).
@@ -1802,6 +2044,57 @@ NOT IMPLEMENTED
 int power_limitState(int cpuId, PowerType domain)
     __attribute__((visibility("default")));
 
+/*! \brief Start the background energy service
+
+Starts a thread that samples all RAPL domains of all sockets periodically. The
+raw counters are extended to 64 bit and stored with timestamps in a ring
+buffer, so energy and power can be queried later for arbitrary time windows
+without reading the registers in the measured code. The registers of a socket
+are read on its first hardware thread. Requires power_init().
+@param [in] cpuId Pin the sampling thread to this CPU (-1 for no pinning)
+@param [in] interval Sampling interval in seconds (minimum 1 ms)
+@param [in] numSamples Size of the sample ring buffer
+@return error code
+*/
+extern int power_energyServiceStart(int cpuId, double interval, int numSamples)
+    __attribute__((visibility("default")));
+/*! \brief Stop the background energy service and free the sample buffer
+ */
+extern void power_energyServiceStop(void)
+    __attribute__((visibility("default")));
+/*! \brief Get a timestamp in the time base of the energy service
+
+@return Timestamp in seconds
+*/
+extern double power_energyServiceTime(void)
+    __attribute__((visibility("default")));
+/*! \brief Get the energy consumed in a time window
+
+The energy at the window boundaries is interpolated between the neighbouring
+samples. If the window ends after the latest sample, a new sample is taken.
+@param [in] socket Socket ID
+@param [in] type RAPL domain
+@param [in] t0 Start of the window (from power_energyServiceTime())
+@param [in] t1 End of the window (from power_energyServiceTime())
+@param [out] energy Energy in Joules
+@return error code (-ERANGE if the window is not covered by the ring buffer)
+*/
+extern int power_energyServiceEnergy(int socket, PowerType type, double t0,
+                                     double t1, double *energy)
+    __attribute__((visibility("default")));
+/*! \brief Get the average power in a time window
+
+@param [in] socket Socket ID
+@param [in] type RAPL domain
+@param [in] t0 Start of the window (from power_energyServiceTime())
+@param [in] t1 End of the window (from power_energyServiceTime())
+@param [out] power Average power in Watt
+@return error code
+*/
+extern int power_energyServicePower(int socket, PowerType type, double t0,
+                                    double t1, double *power)
+    __attribute__((visibility("default")));
+
 /*! \brief Free space of power_unit
  */
 extern void power_finalize(void) __attribute__((visibility("default")));
@@ -1864,6 +2157,160 @@ extern void memsweep_threadGroup(const int *processorList,
     __attribute__((visibility("default")));
 /** @}*/
 
+/*
+################################################################################
+# Output writer related functions
+################################################################################
+*/
+/** \addtogroup OutputWriter Streaming CSV and JSON output module
+ *  @{
+ */
+/*! \brief Output formats of the output writer */
+typedef enum {
+    LIKWID_WRITER_CSV = 0, /*!< \brief Comma-separated values */
+    LIKWID_WRITER_JSON,    /*!< \brief JSON document */
+} LikwidWriterFormat;
+
+/*! \brief Opaque handle of an output writer */
+typedef struct LikwidWriter *LikwidWriter_t;
+
+/*! \brief Open an output writer
+
+The writer emits all records directly to the file, only the current nesting
+level is kept in memory. In JSON mode, lines in the LIKWID CSV block format
+(STRUCT and TABLE blocks) are converted into nested JSON objects. With
+\a application "perfctr", the tables of likwid-perfctr are stored per group
+(resp. MarkerAPI region) as done by the former json filter script.
+@param [in] filename Output file (NULL for stdout)
+@param [in] format Output format
+@param [in] application Producer of the CSV blocks ("perfctr", "topology" or NULL)
+@param [out] writer Handle of the writer
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerOpen(const char *filename, LikwidWriterFormat format,
+                             const char *application, LikwidWriter_t *writer)
+    __attribute__((visibility("default")));
+/*! \brief Write lines in the LIKWID CSV block format
+
+In CSV mode the lines are written unchanged, in JSON mode they are parsed and
+the resulting records are emitted.
+@param [in] writer Handle of the writer
+@param [in] line One or more newline-separated lines
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerLine(LikwidWriter_t writer, const char *line)
+    __attribute__((visibility("default")));
+/*! \brief Write one row of cells
+
+In CSV mode, cells containing commas or quotes are quoted.
+@param [in] writer Handle of the writer
+@param [in] numCells Number of cells
+@param [in] cells Cell contents
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerRow(LikwidWriter_t writer, int numCells, const char **cells)
+    __attribute__((visibility("default")));
+/*! \brief Open a JSON object
+
+@param [in] writer Handle of the writer (JSON mode only)
+@param [in] key Key in the enclosing object (ignored inside arrays)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerBeginObject(LikwidWriter_t writer, const char *key)
+    __attribute__((visibility("default")));
+/*! \brief Close the current JSON object
+@param [in] writer Handle of the writer (JSON mode only)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerEndObject(LikwidWriter_t writer)
+    __attribute__((visibility("default")));
+/*! \brief Open a JSON array
+
+@param [in] writer Handle of the writer (JSON mode only)
+@param [in] key Key in the enclosing object (ignored inside arrays)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerBeginArray(LikwidWriter_t writer, const char *key)
+    __attribute__((visibility("default")));
+/*! \brief Close the current JSON array
+@param [in] writer Handle of the writer (JSON mode only)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerEndArray(LikwidWriter_t writer)
+    __attribute__((visibility("default")));
+/*! \brief Write a JSON string value
+@param [in] writer Handle of the writer (JSON mode only)
+@param [in] key Key in the enclosing object (ignored inside arrays)
+@param [in] value String (NULL is written as null)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerString(LikwidWriter_t writer, const char *key, const char *value)
+    __attribute__((visibility("default")));
+/*! \brief Write a JSON number
+
+NaN and infinite values are written as null.
+@param [in] writer Handle of the writer (JSON mode only)
+@param [in] key Key in the enclosing object (ignored inside arrays)
+@param [in] value Number
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerNumber(LikwidWriter_t writer, const char *key, double value)
+    __attribute__((visibility("default")));
+/*! \brief Close an output writer
+
+Closes all open JSON objects and arrays, so the output is valid also if a
+table was not completed. The handle is invalid afterwards.
+@param [in] writer Handle of the writer
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int likwid_writerClose(LikwidWriter_t writer)
+    __attribute__((visibility("default")));
+/** @}*/
+
+/*
+################################################################################
+# Node monitoring related functions
+################################################################################
+*/
+/** \addtogroup NodeMonitor Node monitoring daemon module
+ *  @{
+ */
+/*! \brief Run the node monitoring loop
+
+Rotates through the given event sets and measures each for \a interval
+seconds on all HW threads of perfmon_init(). After each measurement, the
+metrics per HW thread, their sum and average per socket and the package/DRAM
+power and temperature per socket are stored in a ring buffer of \a windowSize
+samples per event set in the shared memory segment \a shmName. Snapshots are
+served on the UNIX socket \a socketPath, requests are 'json', 'window' or
+'prometheus' or HTTP GET requests of /json, /window or /metrics. If the CPU
+time of the monitor exceeds the budget, it pauses before the next measurement.
+The function returns after SIGINT or SIGTERM.
+@param [in] numberOfGroups Number of event sets in \a groupIds
+@param [in] groupIds List of event set IDs from perfmon_addEventSet()
+@param [in] interval Measurement time per event set in seconds
+@param [in] windowSize Number of samples kept per event set
+@param [in] cpuBudget Maximal fraction of one CPU used by the monitor (e.g. 0.01)
+@param [in] socketPath Path of the UNIX socket (NULL for no socket)
+@param [in] shmName Name of the shared memory segment (e.g. /likwid-monitor)
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int monitor_run(int numberOfGroups, const int *groupIds,
+                       double interval, int windowSize, double cpuBudget,
+                       const char *socketPath, const char *shmName)
+    __attribute__((visibility("default")));
+/*! \brief Query a running node monitor
+
+@param [in] socketPath Path of the UNIX socket of the monitor
+@param [in] request Request ('json', 'window' or 'prometheus')
+@param [out] response Response of the monitor, must be freed by the caller
+@return error code (0 for success, -ERRORCODE on failure)
+*/
+extern int monitor_query(const char *socketPath, const char *request,
+                         char **response)
+    __attribute__((visibility("default")));
+/** @}*/
+
 /*
 ################################################################################
 # CPU feature related functions
@@ -2090,6 +2537,72 @@ must be freed by the caller.
 extern char *freq_getAvailGovs(const int cpu_id)
     __attribute__((visibility("default")));
 
+/*! \brief Maximal length of a governor name in FreqCpuState */
+#define LIKWID_FREQ_GOVERNOR_LENGTH 32
+
+/*! \brief Frequency settings of a hardware thread
+
+Filled by freq_getCpuStates(). All frequencies are in kHz.
+*/
+typedef struct {
+    int cpu; /*!< \brief ID of the hardware thread */
+    int error; /*!< \brief 0 or negative error code if the cpufreq files could not be read */
+    uint64_t cur; /*!< \brief Current clock frequency */
+    uint64_t min; /*!< \brief Minimal clock frequency */
+    uint64_t max; /*!< \brief Maximal clock frequency */
+    int turbo; /*!< \brief Turbo mode (1=on, 0=off) or negative error code */
+    char governor[LIKWID_FREQ_GOVERNOR_LENGTH]; /*!< \brief Frequency governor */
+} FreqCpuState;
+
+/*! \brief Get the frequency settings of multiple hardware threads
+
+Read the current, minimal and maximal clock frequency, the governor and the
+turbo mode of all given hardware threads in a single pass. The cpufreq files
+are kept open between calls.
+@param [in] num_cpus Number of hardware threads
+@param [in] cpus List of hardware thread IDs
+@param [out] states Array with num_cpus entries for the results
+@return Number of hardware threads read successfully or -EINVAL
+*/
+extern int freq_getCpuStates(int num_cpus, const int* cpus, FreqCpuState* states)
+    __attribute__((visibility("default")));
+/*! \brief Set the minimal clock frequency of multiple hardware threads
+
+Set the minimal clock frequency of multiple hardware threads. In access daemon
+mode, the requests are sent to the daemon in batches.
+@param [in] num_cpus Number of hardware threads
+@param [in] cpus List of hardware thread IDs
+@param [in] freqs Frequency in kHz for each hardware thread
+@param [out] errors Array with num_cpus entries for the per-thread result (0 or negative error code), can be NULL
+@return Number of successfully changed hardware threads or negative error code
+*/
+extern int freq_setCpuClockMinList(int num_cpus, const int* cpus, const uint64_t* freqs, int* errors)
+    __attribute__((visibility("default")));
+/*! \brief Set the maximal clock frequency of multiple hardware threads
+
+Set the maximal clock frequency of multiple hardware threads. In access daemon
+mode, the requests are sent to the daemon in batches.
+@param [in] num_cpus Number of hardware threads
+@param [in] cpus List of hardware thread IDs
+@param [in] freqs Frequency in kHz for each hardware thread
+@param [out] errors Array with num_cpus entries for the per-thread result (0 or negative error code), can be NULL
+@return Number of successfully changed hardware threads or negative error code
+*/
+extern int freq_setCpuClockMaxList(int num_cpus, const int* cpus, const uint64_t* freqs, int* errors)
+    __attribute__((visibility("default")));
+/*! \brief Set the frequency governor of multiple hardware threads
+
+Set the frequency governor of multiple hardware threads. In access daemon
+mode, the requests are sent to the daemon in batches.
+@param [in] num_cpus Number of hardware threads
+@param [in] cpus List of hardware thread IDs
+@param [in] gov Governor
+@param [out] errors Array with num_cpus entries for the per-thread result (0 or negative error code), can be NULL
+@return Number of successfully changed hardware threads or negative error code
+*/
+extern int freq_setGovernorList(int num_cpus, const int* cpus, const char* gov, int* errors)
+    __attribute__((visibility("default")));
+
 /*! \brief Set the minimal Uncore frequency
 
 Set the minimal Uncore frequency. Since the ranges are not documented, valid
@@ -3292,6 +3805,37 @@ typedef struct {
     SysFeature* features;
 } SysFeatureList;
 
+typedef enum {
+    HWFEATURES_TYPE_UINT64 = 0,
+    HWFEATURES_TYPE_DOUBLE,
+    HWFEATURES_TYPE_STRING
+} HWFEATURES_VALUE_TYPES;
+
+/*! \brief Value of a feature for a device in a snapshot
+
+Numeric values are stored as uint64 if the feature reports an integer and as
+double otherwise. Values that cannot be converted are kept as string.
+*/
+typedef struct {
+    HWFEATURES_VALUE_TYPES type; /*!< \brief Type of the value */
+    int error; /*!< \brief 0 on success, negative error code if the value could not be read */
+    union {
+        uint64_t uint64; /*!< \brief Value for HWFEATURES_TYPE_UINT64 */
+        double dbl; /*!< \brief Value for HWFEATURES_TYPE_DOUBLE */
+        char* str; /*!< \brief Value for HWFEATURES_TYPE_STRING */
+    } value;
+} SysFeatureValue;
+
+/*! \brief Snapshot of multiple features for multiple devices
+
+The value of feature f for device d is stored at values[f * num_devices + d].
+*/
+typedef struct {
+    int num_features; /*!< \brief Number of features */
+    int num_devices; /*!< \brief Number of devices */
+    SysFeatureValue* values; /*!< \brief Values, one row per feature */
+} SysFeatureSnapshot;
+
 
 #define SYSFEATURE_PCI_DEVICE_TO_ID(domain, bus, slot, func) \
     ((((uint16_t)(domain))<<16)|(((uint8_t)(bus))<<8)|(((((uint8_t)(slot)) & 0x1f) << 3) | (((uint8_t)(func)) & 0x07)))
@@ -3311,6 +3855,24 @@ int sysFeatures_get(SysFeature* feature, LikwidDevice_t device, char** value) __
 int sysFeatures_getByName(char* name, LikwidDevice_t device, char** value) __attribute__ ((visibility ("default") ));
 int sysFeatures_modify(SysFeature* feature, LikwidDevice_t device, char* value) __attribute__ ((visibility ("default") ));
 int sysFeatures_modifyByName(char* name, LikwidDevice_t device, char* value) __attribute__ ((visibility ("default") ));
+/*! \brief Read multiple features for multiple devices at once
+
+Reads all features in \a names for all devices in \a devices. Reads of the
+same register or file are performed only once and the devices are processed
+in parallel. Features not matching the type of a device are marked with
+-ENODEV in the value's error field.
+@param [in] num_features Number of feature names
+@param [in] names Feature names (name or category.name)
+@param [in] num_devices Number of devices
+@param [in] devices List of devices
+@param [out] snapshot Snapshot with num_features * num_devices values
+@return 0 for success, -EINVAL for invalid arguments or unknown features, -ENOMEM if allocation fails
+*/
+int sysFeatures_snapshot(int num_features, char** names, int num_devices, LikwidDevice_t* devices, SysFeatureSnapshot* snapshot) __attribute__ ((visibility ("default") ));
+/*! \brief Free the values of a snapshot
+@param [in] snapshot Snapshot filled by sysFeatures_snapshot
+*/
+void sysFeatures_snapshot_return(SysFeatureSnapshot* snapshot) __attribute__ ((visibility ("default") ));
 
 void sysFeatures_finalize(void) __attribute__ ((visibility ("default") ));
 #endif /* LIKWID_WITH_SYSFEATURES */
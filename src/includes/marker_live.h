@@ -0,0 +1,46 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_live.h
+ *
+ *      Description:  Header File of the live MarkerAPI results in shared memory
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_MARKER_LIVE_H
+#define LIKWID_MARKER_LIVE_H
+
+#include <types.h>
+
+/* Default number of regions in the shared memory segment */
+#define MARKERLIVE_MAX_REGIONS 256
+/* Maximal length of a region tag in the shared memory segment */
+#define MARKERLIVE_TAG_LENGTH 128
+
+extern int markerlive_active;
+
+int markerlive_init(int numThreads, int* threadsToCpu, const char* events);
+void markerlive_publish(LikwidThreadResults* results, const char* regionTag, int threadId);
+void markerlive_finalize(void);
+
+#endif /* LIKWID_MARKER_LIVE_H */
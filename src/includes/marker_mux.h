@@ -0,0 +1,44 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_mux.h
+ *
+ *      Description:  Header File of the time-sliced group multiplexing for the MarkerAPI
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_MARKER_MUX_H
+#define LIKWID_MARKER_MUX_H
+
+#include <types.h>
+
+extern int markermux_active;
+
+int markermux_init(int numberOfGroups);
+void markermux_regionStart(void);
+void markermux_regionStop(void);
+void markermux_regionCancel(void);
+void markermux_extrapolate(LikwidResults* results, int numberOfRegions, int numberOfThreads, double** coverage);
+void markermux_finalize(void);
+
+#endif /* LIKWID_MARKER_MUX_H */
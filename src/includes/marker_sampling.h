@@ -0,0 +1,50 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_sampling.h
+ *
+ *      Description:  Header File of the event-based IP sampling of MarkerAPI regions
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_MARKER_SAMPLING_H
+#define LIKWID_MARKER_SAMPLING_H
+
+/* Maximal number of sampled events */
+#define MARKERSAMPLE_MAX_EVENTS 4
+/* Maximal nesting depth of regions per thread */
+#define MARKERSAMPLE_MAX_DEPTH 64
+/* Default sample period in events (or ns for the clock software events) */
+#define MARKERSAMPLE_DEFAULT_PERIOD 1000000
+/* Data pages of the ring buffer per thread and event (power of two) */
+#define MARKERSAMPLE_DATA_PAGES 256
+
+extern int markersample_active;
+
+int markersample_init(int numThreads, int* threadsToCpu, const char* spec);
+void markersample_regionStart(int threadId, const char* regionTag);
+void markersample_regionStop(int threadId, const char* regionTag);
+int markersample_write(const char* filename);
+void markersample_finalize(void);
+
+#endif /* LIKWID_MARKER_SAMPLING_H */
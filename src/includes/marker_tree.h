@@ -0,0 +1,48 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_tree.h
+ *
+ *      Description:  Header File of the call-path tree of nested MarkerAPI regions
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_MARKER_TREE_H
+#define LIKWID_MARKER_TREE_H
+
+#include <stdio.h>
+#include <types.h>
+
+/* Maximal nesting depth of regions per thread */
+#define MARKERTREE_MAX_DEPTH 64
+
+extern int markertree_active;
+
+int markertree_init(int numThreads, int* threadsToCpu, int maxEvents);
+void markertree_regionStart(int threadId, const char* regionTag, int groupId);
+double* markertree_deltas(int threadId);
+void markertree_regionStop(int threadId, const char* regionTag, int groupId, double time);
+void markertree_write(FILE* file);
+void markertree_finalize(void);
+
+#endif /* LIKWID_MARKER_TREE_H */
@@ -0,0 +1,89 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  node_monitor.h
+ *
+ *      Description:  Header File of the node monitoring daemon. Shared memory
+ *                    layout of the rolling metric window.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_NODE_MONITOR_H
+#define LIKWID_NODE_MONITOR_H
+
+#include <stdint.h>
+
+#define NODEMON_MAGIC 0x4e4f4d44574b494cULL
+#define NODEMON_VERSION 1
+#define NODEMON_NAME_LENGTH 64
+/* Per-socket values besides the metrics: package power, DRAM power, temperature */
+#define NODEMON_SOCKET_VALUES 3
+
+/* Layout of the segment:
+ * header | threads[numberOfThreads] | groups[numberOfGroups] |
+ * per group: metric names[numberOfMetrics] | samples[windowSize]
+ * The samples of a group form a ring buffer, the latest one has the index
+ * (written - 1) % windowSize. Each sample is protected by a sequence counter,
+ * odd values mark an ongoing update. The values of a sample are:
+ * thread metrics [numberOfThreads][numberOfMetrics]
+ * socket sums [numberOfSockets][numberOfMetrics]
+ * socket averages [numberOfSockets][numberOfMetrics]
+ * socket values [numberOfSockets][NODEMON_SOCKET_VALUES] */
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    int32_t pid;
+    int32_t numberOfThreads;
+    int32_t numberOfSockets;
+    int32_t numberOfGroups;
+    int32_t windowSize;
+    double interval;
+    uint64_t threadsOffset;
+    uint64_t groupsOffset;
+    uint64_t size;
+} NodeMonitorHeader;
+
+typedef struct {
+    int32_t cpu;
+    int32_t socket;
+} NodeMonitorThread;
+
+typedef struct {
+    char name[NODEMON_NAME_LENGTH];
+    int32_t numberOfMetrics;
+    int32_t numberOfValues;
+    uint64_t metricsOffset;
+    uint64_t samplesOffset;
+    uint64_t sampleSize;
+    uint64_t written;
+} NodeMonitorGroup;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t reserved;
+    double timestamp;
+    double runtime;
+    double values[];
+} NodeMonitorSample;
+
+#endif /* LIKWID_NODE_MONITOR_H */
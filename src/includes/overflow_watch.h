@@ -0,0 +1,47 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  overflow_watch.h
+ *
+ *      Description:  Header File of the background counter overflow watch
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_OVERFLOW_WATCH_H
+#define LIKWID_OVERFLOW_WATCH_H
+
+#include <types.h>
+
+/* Upper bound of the event rate of a single counter (events per second). This
+ * covers e.g. eight events per cycle at 10 GHz and wide uncore counters
+ * counting bytes. */
+#define OVFWATCH_MAX_EVENT_RATE 1.0E11
+/* Upper bound of the power consumption of a single RAPL domain (Watt) */
+#define OVFWATCH_MAX_POWER 1000.0
+/* Limits of the read interval (seconds) */
+#define OVFWATCH_MIN_INTERVAL 0.01
+#define OVFWATCH_MAX_INTERVAL 3600.0
+
+extern int ovfwatch_active;
+
+#endif /* LIKWID_OVERFLOW_WATCH_H */
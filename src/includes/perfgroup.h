@@ -80,6 +80,11 @@ extern void destroy_clist(CounterList* clist);
 
 extern int calc_metric(char* formula, CounterList* clist, double *result);
 
+extern int perfgroup_parseGroupFile(const char* filename, const char* groupname, GroupInfo* ginfo, int* requireNoHT);
+extern int perfgroup_parseGroupListInfo(const char* filename, char** shortinfo, char** longinfo, int* requireNoHT);
+extern int perfgroup_addTotalGroups(int groups);
+extern int isdir(char* dirname);
+
 
 
 
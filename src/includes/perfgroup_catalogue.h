@@ -0,0 +1,42 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  perfgroup_catalogue.h
+ *
+ *      Description:  Header File of the preparsed performance group catalogue.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef PERFGROUP_CATALOGUE_H
+#define PERFGROUP_CATALOGUE_H
+
+#include <likwid.h>
+
+#define PERFGROUP_CATALOGUE_MAGIC "LIKWIDGC"
+#define PERFGROUP_CATALOGUE_VERSION 1
+#define PERFGROUP_CATALOGUE_NAME ".groups.cat"
+
+int perfgroup_catalogueGetGroups(const char* grouppath, const char* architecture, char*** groupnames, char*** groupshort, char*** grouplong);
+int perfgroup_catalogueReadGroup(const char* grouppath, const char* architecture, const char* groupname, GroupInfo* ginfo);
+
+#endif /* PERFGROUP_CATALOGUE_H */
@@ -52,6 +52,12 @@ extern int (*initThreadArch) (int cpu_id);
 /* Internal helpers */
 extern int getCounterTypeOffset(int index);
 extern uint64_t perfmon_getMaxCounterValue(RegisterType type);
+extern int perfmon_setThreadLocking(int enable);
+extern int perfmon_watchOverflowsThread(int thread_id);
 extern char** getArchRegisterTypeNames();
+#ifdef LIKWID_USE_PERFEVENT
+#include <linux/perf_event.h>
+extern int perfmon_getSamplingAttr(int groupId, int eventId, struct perf_event_attr* attr);
+#endif
 
 #endif /*PERFMON_H*/
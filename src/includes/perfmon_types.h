@@ -202,6 +202,7 @@ typedef struct {
     int         init; /*!< \brief Flag if corresponding control register is set up properly */
     int         id; /*!< \brief Offset in higher level control register, e.g. position of enable bit */
     int         overflows; /*!< \brief Amount of overflows */
+    int         totalOverflows; /*!< \brief Amount of overflows since the counters were started */
     uint64_t    startData; /*!< \brief Start data from the counter */
     uint64_t    counterData; /*!< \brief Intermediate data from the counters */
     double      lastResult; /*!< \brief Last measurement result*/
@@ -246,6 +247,7 @@ typedef struct {
     uint64_t              regTypeMask6; /*!< \brief Bitmask6 for easy checks which types are included in the eventSet */
     GroupState            state; /*!< \brief Current state of the event group (configured, started, none) */
     GroupInfo             group; /*!< \brief Structure holding the performance group information */
+    struct RegisterProgram* programs; /*!< \brief Recorded register setup for each thread, see register_program.h */
 } PerfmonEventSet;
 
 /*! \brief Structure specifying all performance monitoring event groups
@@ -0,0 +1,84 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  rankrecords.h
+ *
+ *      Description:  Header File of the aggregation module for per-rank result records.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef RANKRECORDS_H
+#define RANKRECORDS_H
+
+typedef struct {
+    double sum;
+    double min;
+    double max;
+    double avg;
+    double p25;
+    double p50;
+    double p75;
+} RankStatistics;
+
+/* One column of the output, i.e. one hardware thread of one rank */
+typedef struct {
+    char* label; /* host:rank:cpu */
+    int rank;
+    int seq;
+    double time;
+    double calls;
+    double* values;
+    double* metrics;
+} RankColumn;
+
+/* All columns of one group, in a marker run one group of one region */
+typedef struct {
+    char* region;
+    int group;
+    char* name;
+    int hasCalls;
+    int nevents;
+    char** events;
+    char** counters;
+    int nmetrics;
+    char** metrics;
+    int ncolumns;
+    int maxColumns;
+    RankColumn* columns;
+    RankStatistics timeStats;
+    RankStatistics callStats;
+    RankStatistics* eventStats;
+    RankStatistics* metricStats;
+} RankGroupResult;
+
+typedef struct {
+    int ngroups;
+    int maxGroups;
+    RankGroupResult* groups;
+    int failed;
+} RankAggregate;
+
+int rankrecords_aggregate(int nfiles, char** files, int nthreads, RankAggregate** aggregate);
+void rankrecords_free(RankAggregate* aggregate);
+
+#endif /* RANKRECORDS_H */
@@ -0,0 +1,61 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  register_program.h
+ *
+ *      Description:  Header File of the pre-encoded register programs of event sets
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef LIKWID_REGISTER_PROGRAM_H
+#define LIKWID_REGISTER_PROGRAM_H
+
+#include <types.h>
+#include <access.h>
+
+/*! \brief Register writes of the setup of an event set on one thread
+
+The program is recorded at the first setup of the event set. Afterwards, the
+setup is done by replaying the writes that differ from the current register
+state.
+*/
+typedef struct RegisterProgram {
+    int             compiled; /*!< \brief The program was recorded */
+    int             numberOfWrites; /*!< \brief Number of writes in \a writes */
+    int             size; /*!< \brief Allocated entries in \a writes */
+    HPMWriteRecord* writes; /*!< \brief List of register writes in setup order */
+    uint8_t*        config; /*!< \brief Write is a pure configuration register and skipped if unchanged */
+    int             numberOfEvents; /*!< \brief Number of entries in \a init */
+    int*            init; /*!< \brief Init state of the event counters after the setup */
+} RegisterProgram;
+
+extern int regprog_tracking;
+
+int regprog_init(void);
+void regprog_finalize(void);
+void regprog_observe(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t data);
+void regprog_invalidate(int cpu_id);
+int regprog_setupThread(int thread_id, PerfmonEventSet* eventSet);
+void regprog_destroy(PerfmonEventSet* eventSet, int numberOfThreads);
+
+#endif /* LIKWID_REGISTER_PROGRAM_H */
@@ -2,6 +2,8 @@
 #define HWFEATURES_COMMON_H
 
 #include <sysFeatures.h>
+#include <pci_types.h>
+#include <bstrlib.h>
 
 int register_features(_SysFeatureList *features, _SysFeatureList* in);
 int sysFeatures_init_generic(_HWArchFeatures* infeatures, _SysFeatureList *list);
@@ -9,4 +11,12 @@ int sysFeatures_init_generic(_HWArchFeatures* infeatures, _SysFeatureList *list)
 int _uint64_to_string(uint64_t value, char** str);
 int _string_to_uint64(char* str, uint64_t* value);
 
+/* Register and file reads of the getters. While a read cache is active in the
+ * calling thread, repeated reads of the same register or file are served
+ * from the cache. */
+int _sysFeatures_HPMread(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t* data);
+bstring _sysFeatures_read_file(char* filename);
+int _sysFeatures_cache_begin(void);
+void _sysFeatures_cache_end(void);
+
 #endif
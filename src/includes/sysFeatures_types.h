@@ -5,13 +5,6 @@
 #include <likwid.h>
 #include <likwid_device.h>
 
-typedef enum {
-    HWFEATURES_TYPE_UINT64 = 0,
-    HWFEATURES_TYPE_DOUBLE,
-    HWFEATURES_TYPE_STRING
-} HWFEATURES_VALUE_TYPES;
-
-
 typedef int (*hwfeature_getter_function)(LikwidDevice_t device, char** value);
 typedef int (*hwfeature_setter_function)(LikwidDevice_t device, char* value);
 typedef int (*hwfeature_test_function)();
@@ -0,0 +1,44 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  topology_cache.h
+ *
+ *      Description:  Header File of binary topology cache module.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+#ifndef TOPOLOGY_CACHE_H
+#define TOPOLOGY_CACHE_H
+
+#include <sched.h>
+#include <likwid.h>
+
+#define TOPOLOGY_CACHE_MAGIC "LIKWIDTC"
+#define TOPOLOGY_CACHE_VERSION 1
+
+int topology_cache_check(const char* filename);
+int topology_cache_load(const char* filename, cpu_set_t cpuSet);
+int topology_cache_getAffinity(AffinityDomains* affinity, int* lookups[5]);
+void topology_cache_release(void);
+
+#endif /* TOPOLOGY_CACHE_H */
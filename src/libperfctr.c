@@ -55,6 +55,11 @@
 #include <perfmon.h>
 #include <bstrlib.h>
 #include <voltage.h>
+#include <frequency_tune.h>
+#include <marker_live.h>
+#include <marker_mux.h>
+#include <marker_tree.h>
+#include <marker_sampling.h>
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -114,7 +119,9 @@ calculateMarkerResult(RegisterIndex index, uint64_t start, uint64_t stop, int ov
 {
     double result = 0.0;
     uint64_t maxValue = 0ULL;
-    if (start > stop)
+    /* A single wrap-around may not have been seen by the read functions. If
+     * they counted overflows (e.g. with the overflow watch), the count is exact. */
+    if (start > stop && overflows == 0)
     {
         overflows++;
     }
@@ -325,6 +332,39 @@ likwid_markerInit(void)
 
     perfmon_setupCounters(groupSet->activeGroup);
     perfmon_startCounters();
+
+    freqtune_init(num_cpus, threads2Cpu);
+    markermux_init(numberOfGroups);
+    if (getenv("LIKWID_MARKER_TREE") != NULL)
+    {
+        int maxEvents = 0;
+        for (i=0; i<numberOfGroups; i++)
+        {
+            maxEvents = MAX(maxEvents, groupSet->groups[groups[i]].numberOfEvents);
+        }
+        if (markertree_init(num_cpus, threads2Cpu, maxEvents) < 0)
+        {
+            fprintf(stderr, "Cannot initialize call path tree of regions, tree disabled\n");
+        }
+    }
+    if (getenv("LIKWID_MARKER_SAMPLING") != NULL)
+    {
+        if (markersample_init(num_cpus, threads2Cpu, getenv("LIKWID_MARKER_SAMPLING")) < 0)
+        {
+            fprintf(stderr, "Cannot initialize sampling of regions, sampling disabled\n");
+        }
+    }
+    if (getenv("LIKWID_MARKER_LIVE") != NULL)
+    {
+        markerlive_init(num_cpus, threads2Cpu, eventStr);
+    }
+    if (getenv("LIKWID_OVERFLOW_WATCH") != NULL)
+    {
+        if (perfmon_startOverflowWatch() < 0)
+        {
+            fprintf(stderr, "Cannot start counter overflow watch\n");
+        }
+    }
 }
 
 void
@@ -393,6 +433,7 @@ likwid_markerNextGroup(void)
  * 3 regionID:regionTag1
  * 4 regionID threadID countersvalues(space separated)
  * 5 regionID threadID countersvalues
+ * With group multiplexing, the coverage of the group is appended to the values
  */
 void
 likwid_markerClose(void)
@@ -403,17 +444,26 @@ likwid_markerClose(void)
     int numberOfRegions = 0;
     char* markerfile = NULL;
     int* validRegions = NULL;
+    double* coverage = NULL;
 
     if ( ! likwid_init )
     {
         return;
     }
+    perfmon_stopOverflowWatch();
+    freqtune_finalize();
+    markerlive_finalize();
+    markermux_finalize();
     hashTable_finalize(&numberOfThreads, &numberOfRegions, &results);
     if ((numberOfThreads == 0)||(numberOfRegions == 0))
     {
         fprintf(stderr, "No threads or regions defined in hash table\n");
         return;
     }
+    if (markermux_active)
+    {
+        markermux_extrapolate(results, numberOfRegions, numberOfThreads, &coverage);
+    }
     markerfile = getenv("LIKWID_FILEPATH");
     if (markerfile == NULL)
     {
@@ -493,12 +543,19 @@ likwid_markerClose(void)
                     bconcat(l, tmp);
                     bdestroy(tmp);
                 }
+                if (coverage)
+                {
+                    bstring tmp = bformat("%e ", coverage[i*numberOfThreads+j]);
+                    bconcat(l, tmp);
+                    bdestroy(tmp);
+                }
                 fprintf(file,"%s\n", bdata(l));
                 DEBUG_PRINT(DEBUGLEV_DEVELOP, %s, bdata(l));
                 bdestroy(l);
             }
             newRegionID++;
         }
+        markertree_write(file);
         fclose(file);
     }
     else
@@ -510,6 +567,10 @@ likwid_markerClose(void)
     {
         free(validRegions);
     }
+    if (coverage)
+    {
+        free(coverage);
+    }
     if ((numberOfThreads == 0)||(numberOfThreads == 0))
     {
         return;
@@ -530,6 +591,9 @@ likwid_markerClose(void)
     {
         free(results);
     }
+    markertree_finalize();
+    markersample_write(getenv("LIKWID_MARKER_SAMPLING_FILE"));
+    markersample_finalize();
     perfmon_finalize();
     HPMfinalize();
     likwid_init = 0;
@@ -649,6 +713,7 @@ likwid_markerWriteFile(const char* markerfile)
             }
             newRegionID++;
         }
+        markertree_write(file);
         fclose(file);
         free(validRegions);
         free(cpulist);
@@ -703,18 +768,44 @@ likwid_markerStartRegion(const char* regionTag)
     {
         return -EFAULT;
     }
+    if (markermux_active)
+    {
+        markermux_regionStart();
+    }
 
     bstring tag = bformat("%.*s-%d", 100, regionTag, groupSet->activeGroup);
     int cpu_id = hashTable_get(tag, &results);
     if (!results)
     {
         fprintf(stderr, "ERROR: Failed to get thread data for tag %s\n", regionTag);
+        if (markermux_active)
+        {
+            markermux_regionCancel();
+        }
         return -EFAULT;
     }
     int thread_id = getThreadID(cpu_id);
     if (results->state == MARKER_STATE_START)
     {
         fprintf(stderr, "WARN: Region %s was already started\n", regionTag);
+        /* The first start holds the mux lock already and the single stop
+         * releases only one */
+        if (markermux_active)
+        {
+            markermux_regionCancel();
+        }
+    }
+    if (freqtune_active)
+    {
+        freqtune_regionStart(regionTag, thread_id);
+    }
+    if (markertree_active)
+    {
+        markertree_regionStart(thread_id, regionTag, groupSet->activeGroup);
+    }
+    if (markersample_active)
+    {
+        markersample_regionStart(thread_id, regionTag);
     }
     perfmon_readCountersCpu(cpu_id);
     results->cpuID = cpu_id;
@@ -729,7 +820,7 @@ likwid_markerStartRegion(const char* regionTag)
             //        groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData;
 
             results->StartPMcounters[i] = groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData;
-            results->StartOverflows[i] = groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].overflows;
+            results->StartOverflows[i] = groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].totalOverflows;
         }
         else
         {
@@ -756,6 +847,8 @@ likwid_markerStopRegion(const char* regionTag)
     LikwidThreadResults* results = NULL;
     timer_stop(&timestamp);
     double result = 0.0;
+    double regionTime = 0.0;
+    double* deltas = NULL;
     int cpu_id;
     int myCPU = likwid_getProcessorId();
     if (getThreadID(myCPU) < 0)
@@ -791,9 +884,18 @@ likwid_markerStopRegion(const char* regionTag)
     }
     results->groupID = groupSet->activeGroup;
     results->startTime.stop.int64 = timestamp.stop.int64;
-    results->time += timer_print(&(results->startTime));
+    regionTime = timer_print(&(results->startTime));
+    results->time += regionTime;
     results->count++;
     bdestroy(tag);
+    if (markertree_active)
+    {
+        deltas = markertree_deltas(thread_id);
+    }
+    if (markersample_active)
+    {
+        markersample_regionStop(thread_id, regionTag);
+    }
 
     perfmon_readCountersCpu(cpu_id);
 
@@ -803,10 +905,14 @@ likwid_markerStopRegion(const char* regionTag)
         {
             result = calculateMarkerResult(groupSet->groups[groupSet->activeGroup].events[i].index, results->StartPMcounters[i],
                                             groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData,
-                                            groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].overflows -
+                                            groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].totalOverflows -
                                             results->StartOverflows[i]);
             DEBUG_PRINT(DEBUGLEV_DEVELOP, STOP [%s] READ EVENT [%d=%d] EVENT %d VALUE %llu DIFF %f, regionTag, thread_id, cpu_id, i,
                             LLU_CAST groupSet->groups[groupSet->activeGroup].events[i].threadCounter[thread_id].counterData, result);
+            if (deltas)
+            {
+                deltas[i] = result;
+            }
             if ((counter_map[groupSet->groups[groupSet->activeGroup].events[i].index].type != THERMAL) &&
                 (counter_map[groupSet->groups[groupSet->activeGroup].events[i].index].type != VOLTAGE) &&
                 (counter_map[groupSet->groups[groupSet->activeGroup].events[i].index].type != MBOX0TMP))
@@ -821,13 +927,33 @@ likwid_markerStopRegion(const char* regionTag)
         else
         {
             results->PMcounters[i] = NAN;
+            if (deltas)
+            {
+                deltas[i] = NAN;
+            }
         }
     }
     results->state = MARKER_STATE_STOP;
+    if (deltas)
+    {
+        markertree_regionStop(thread_id, regionTag, groupSet->activeGroup, regionTime);
+    }
+    if (markerlive_active)
+    {
+        markerlive_publish(results, regionTag, thread_id);
+    }
+    if (freqtune_active)
+    {
+        freqtune_regionStop(regionTag, thread_id);
+    }
     if (use_locks == 1)
     {
         pthread_mutex_unlock(&threadLocks[myCPU]);
     }
+    if (markermux_active)
+    {
+        markermux_regionStop();
+    }
     return 0;
 }
 
@@ -53,6 +53,7 @@
 #include <access.h>
 #include <bstrlib.h>
 #include <perfmon.h>
+#include <rankrecords.h>
 
 #ifdef COLOR
 #include <textcolor.h>
@@ -187,8 +188,8 @@ static int lua_likwid_setAccessMode(lua_State *L) {
   int flag;
   flag = luaL_checknumber(L, 1);
   luaL_argcheck(
-      L, flag >= 0 && flag <= 1, 1,
-      "invalid access mode, only 0 (direct) and 1 (accessdaemon) allowed");
+      L, flag >= 0 && flag <= 2, 1,
+      "invalid access mode, only 0 (direct), 1 (accessdaemon) and 2 (simulation) allowed");
   HPMmode(flag);
   lua_pushinteger(L, 0);
   return 1;
@@ -322,6 +323,25 @@ static int lua_likwid_readCounters(lua_State *L) {
   return 1;
 }
 
+static int lua_likwid_startOverflowWatch(lua_State *L) {
+  int ret;
+  if (perfmon_isInitialized == 0) {
+    return 0;
+  }
+  ret = perfmon_startOverflowWatch();
+  lua_pushinteger(L, ret);
+  lua_pushnumber(L, perfmon_getOverflowWatchInterval());
+  return 2;
+}
+
+static int lua_likwid_stopOverflowWatch(lua_State *L) {
+  if (perfmon_isInitialized == 0) {
+    return 0;
+  }
+  perfmon_stopOverflowWatch();
+  return 0;
+}
+
 static int lua_likwid_switchGroup(lua_State *L) {
   int ret = -1;
   int newgroup = lua_tonumber(L, 1) - 1;
@@ -585,6 +605,142 @@ static int lua_likwid_getGroups(lua_State *L) {
   return 0;
 }
 
+static int lua_likwid_buildGroupCatalogue(lua_State *L) {
+  const char *grouppath = (const char *)luaL_checkstring(L, 1);
+  const char *architecture = (const char *)luaL_checkstring(L, 2);
+  lua_pushinteger(L, perfgroup_buildCatalogue(grouppath, architecture));
+  return 1;
+}
+
+static void lua_likwid_pushStatistics(lua_State *L, RankStatistics *stats,
+                                      int percentiles) {
+  lua_newtable(L);
+  lua_pushnumber(L, stats->sum);
+  lua_setfield(L, -2, "sum");
+  lua_pushnumber(L, stats->min);
+  lua_setfield(L, -2, "min");
+  lua_pushnumber(L, stats->max);
+  lua_setfield(L, -2, "max");
+  lua_pushnumber(L, stats->avg);
+  lua_setfield(L, -2, "avg");
+  if (percentiles) {
+    lua_pushnumber(L, stats->p25);
+    lua_setfield(L, -2, "p25");
+    lua_pushnumber(L, stats->p50);
+    lua_setfield(L, -2, "p50");
+    lua_pushnumber(L, stats->p75);
+    lua_setfield(L, -2, "p75");
+  }
+}
+
+static void lua_likwid_pushStrings(lua_State *L, char **strings, int count) {
+  lua_newtable(L);
+  for (int i = 0; i < count; i++) {
+    lua_pushstring(L, strings[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+}
+
+static int lua_likwid_aggregateRecords(lua_State *L) {
+  int ret = 0;
+  int nfiles = 0;
+  int nthreads = 1;
+  char **files = NULL;
+  RankAggregate *agg = NULL;
+  luaL_checktype(L, 1, LUA_TTABLE);
+  if (lua_gettop(L) > 1) {
+    nthreads = (int)luaL_checkinteger(L, 2);
+  }
+  nfiles = (int)lua_rawlen(L, 1);
+  if (nfiles > 0) {
+    files = malloc(nfiles * sizeof(char *));
+    if (!files) {
+      lua_pushnil(L);
+      return 1;
+    }
+    for (int i = 0; i < nfiles; i++) {
+      lua_rawgeti(L, 1, i + 1);
+      /* The strings stay referenced by the argument table */
+      files[i] = (char *)luaL_checkstring(L, -1);
+      lua_pop(L, 1);
+    }
+  }
+  ret = rankrecords_aggregate(nfiles, files, nthreads, &agg);
+  free(files);
+  if (ret < 0) {
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_newtable(L);
+  for (int g = 0; g < agg->ngroups; g++) {
+    RankGroupResult *grp = &agg->groups[g];
+    lua_newtable(L);
+    if (grp->region) {
+      lua_pushstring(L, grp->region);
+      lua_setfield(L, -2, "region");
+    }
+    lua_pushinteger(L, grp->group);
+    lua_setfield(L, -2, "group");
+    lua_pushstring(L, grp->name);
+    lua_setfield(L, -2, "name");
+    lua_pushboolean(L, grp->hasCalls);
+    lua_setfield(L, -2, "hasCalls");
+    lua_likwid_pushStrings(L, grp->events, grp->nevents);
+    lua_setfield(L, -2, "events");
+    lua_likwid_pushStrings(L, grp->counters, grp->nevents);
+    lua_setfield(L, -2, "counters");
+    lua_likwid_pushStrings(L, grp->metrics, grp->nmetrics);
+    lua_setfield(L, -2, "metrics");
+    lua_newtable(L);
+    for (int c = 0; c < grp->ncolumns; c++) {
+      RankColumn *col = &grp->columns[c];
+      lua_newtable(L);
+      lua_pushstring(L, col->label);
+      lua_setfield(L, -2, "label");
+      lua_pushnumber(L, col->time);
+      lua_setfield(L, -2, "time");
+      lua_pushnumber(L, col->calls);
+      lua_setfield(L, -2, "calls");
+      lua_newtable(L);
+      for (int e = 0; e < grp->nevents; e++) {
+        lua_pushnumber(L, col->values[e]);
+        lua_rawseti(L, -2, e + 1);
+      }
+      lua_setfield(L, -2, "values");
+      lua_newtable(L);
+      for (int m = 0; m < grp->nmetrics; m++) {
+        lua_pushnumber(L, col->metrics[m]);
+        lua_rawseti(L, -2, m + 1);
+      }
+      lua_setfield(L, -2, "metrics");
+      lua_rawseti(L, -2, c + 1);
+    }
+    lua_setfield(L, -2, "columns");
+    lua_newtable(L);
+    lua_likwid_pushStatistics(L, &grp->timeStats, 0);
+    lua_setfield(L, -2, "time");
+    lua_likwid_pushStatistics(L, &grp->callStats, 0);
+    lua_setfield(L, -2, "calls");
+    lua_newtable(L);
+    for (int e = 0; e < grp->nevents; e++) {
+      lua_likwid_pushStatistics(L, &grp->eventStats[e], 0);
+      lua_rawseti(L, -2, e + 1);
+    }
+    lua_setfield(L, -2, "events");
+    lua_newtable(L);
+    for (int m = 0; m < grp->nmetrics; m++) {
+      lua_likwid_pushStatistics(L, &grp->metricStats[m], 1);
+      lua_rawseti(L, -2, m + 1);
+    }
+    lua_setfield(L, -2, "metrics");
+    lua_setfield(L, -2, "stats");
+    lua_rawseti(L, -2, g + 1);
+  }
+  rankrecords_free(agg);
+  free(agg);
+  return 1;
+}
+
 static int lua_likwid_printSupportedCPUs(lua_State *L) {
   print_supportedCPUs();
   return 0;
@@ -862,6 +1018,18 @@ static int lua_likwid_putTopology(lua_State *L) {
   return 0;
 }
 
+static int lua_likwid_writeTopologyCache(lua_State *L) {
+  const char *filename = (const char *)luaL_checkstring(L, 1);
+  int ret = topology_writeCache(filename);
+  if (ret == 0) {
+    topology_isInitialized = 1;
+    numa_isInitialized = 1;
+    affinity_isInitialized = 1;
+  }
+  lua_pushinteger(L, ret);
+  return 1;
+}
+
 static int
 lua_likwid_getEventsAndCounters(lua_State* L)
 {
@@ -1156,6 +1324,155 @@ static int lua_likwid_setMembind(lua_State *L) {
   return 0;
 }
 
+static int lua_likwid_auditNumaPages(lua_State *L) {
+  int i;
+  NumaAudit_t audit = NULL;
+  int pid = luaL_checknumber(L, 1);
+  int nrThreads = luaL_checknumber(L, 2);
+  luaL_argcheck(L, nrThreads > 0, 2, "Thread count must be greater than 0");
+  luaL_checktype(L, 3, LUA_TTABLE);
+  int migrate = lua_toboolean(L, 4);
+  int cpus[nrThreads];
+  for (i = 1; i <= nrThreads; i++) {
+    lua_rawgeti(L, 3, i);
+    cpus[i - 1] = (int)lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+  int err = numa_auditProcess(pid, nrThreads, cpus, migrate, &audit);
+  if (err < 0) {
+    lua_pushnil(L);
+    lua_pushinteger(L, err);
+    return 2;
+  }
+  lua_newtable(L);
+  lua_pushstring(L, "numberOfRegions");
+  lua_pushinteger(L, audit->numberOfRegions);
+  lua_settable(L, -3);
+  lua_pushstring(L, "totalPages");
+  lua_pushinteger(L, audit->totalPages);
+  lua_settable(L, -3);
+  lua_pushstring(L, "nodePages");
+  lua_newtable(L);
+  for (i = 0; i < audit->numberOfNodes; i++) {
+    lua_pushinteger(L, audit->nodePages[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+  lua_settable(L, -3);
+  lua_pushstring(L, "threads");
+  lua_newtable(L);
+  for (i = 0; i < audit->numberOfThreads; i++) {
+    NumaAuditThread *t = &audit->threads[i];
+    lua_newtable(L);
+    lua_pushstring(L, "cpu");
+    lua_pushinteger(L, t->cpu);
+    lua_settable(L, -3);
+    lua_pushstring(L, "node");
+    lua_pushinteger(L, t->node);
+    lua_settable(L, -3);
+    lua_pushstring(L, "localPages");
+    lua_pushinteger(L, t->localPages);
+    lua_settable(L, -3);
+    lua_pushstring(L, "remotePages");
+    lua_pushinteger(L, t->remotePages);
+    lua_settable(L, -3);
+    lua_pushstring(L, "migratedPages");
+    lua_pushinteger(L, t->migratedPages);
+    lua_settable(L, -3);
+    lua_rawseti(L, -2, i + 1);
+  }
+  lua_settable(L, -3);
+  numa_freeAudit(audit);
+  return 1;
+}
+
+static int lua_likwid_writerOpen(lua_State *L) {
+  LikwidWriter_t writer = NULL;
+  const char *filename = lua_isnoneornil(L, 1) ? NULL : luaL_checkstring(L, 1);
+  const char *format = luaL_checkstring(L, 2);
+  const char *app = luaL_optstring(L, 3, NULL);
+  LikwidWriterFormat fmt = LIKWID_WRITER_CSV;
+  if (strcmp(format, "json") == 0) {
+    fmt = LIKWID_WRITER_JSON;
+  } else if (strcmp(format, "csv") != 0) {
+    luaL_argerror(L, 2, "Format must be csv or json");
+  }
+  int err = likwid_writerOpen(filename, fmt, app, &writer);
+  if (err < 0) {
+    lua_pushnil(L);
+    lua_pushinteger(L, err);
+    return 2;
+  }
+  lua_pushlightuserdata(L, writer);
+  return 1;
+}
+
+static int lua_likwid_writerLine(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  LikwidWriter_t writer = lua_touserdata(L, 1);
+  const char *line = luaL_checkstring(L, 2);
+  lua_pushinteger(L, likwid_writerLine(writer, line));
+  return 1;
+}
+
+static int lua_likwid_writerRow(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  LikwidWriter_t writer = lua_touserdata(L, 1);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  int n = lua_rawlen(L, 2);
+  const char *cells[n > 0 ? n : 1];
+  /* Keep the cells on the stack, numbers are converted to new strings */
+  luaL_checkstack(L, n, "Too many cells");
+  for (int i = 1; i <= n; i++) {
+    lua_rawgeti(L, 2, i);
+    cells[i - 1] = lua_tostring(L, -1);
+  }
+  int err = likwid_writerRow(writer, n, cells);
+  lua_pop(L, n);
+  lua_pushinteger(L, err);
+  return 1;
+}
+
+static int lua_likwid_writerClose(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  LikwidWriter_t writer = lua_touserdata(L, 1);
+  lua_pushinteger(L, likwid_writerClose(writer));
+  return 1;
+}
+
+static int lua_likwid_monitorRun(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TTABLE);
+  int n = lua_rawlen(L, 1);
+  int groups[n > 0 ? n : 1];
+  for (int i = 1; i <= n; i++) {
+    lua_rawgeti(L, 1, i);
+    groups[i - 1] = lua_tointeger(L, -1) - 1;
+    lua_pop(L, 1);
+  }
+  double interval = luaL_checknumber(L, 2);
+  int window = luaL_checkinteger(L, 3);
+  double budget = luaL_checknumber(L, 4);
+  const char *socketPath = luaL_optstring(L, 5, NULL);
+  const char *shmName = luaL_checkstring(L, 6);
+  lua_pushinteger(L, monitor_run(n, groups, interval, window, budget,
+                                 socketPath, shmName));
+  return 1;
+}
+
+static int lua_likwid_monitorQuery(lua_State *L) {
+  char *response = NULL;
+  const char *socketPath = luaL_checkstring(L, 1);
+  const char *request = luaL_checkstring(L, 2);
+  int err = monitor_query(socketPath, request, &response);
+  if (err < 0) {
+    lua_pushnil(L);
+    lua_pushinteger(L, err);
+    return 2;
+  }
+  lua_pushstring(L, response);
+  free(response);
+  return 1;
+}
+
 static int lua_likwid_getAffinityInfo(lua_State *L) {
   int i, j;
 
@@ -1592,6 +1909,46 @@ static int lua_likwid_printEnergy(lua_State *L) {
   return 1;
 }
 
+static int lua_likwid_startPowerService(lua_State *L) {
+  int cpuId = lua_tonumber(L, 1);
+  double interval = luaL_checknumber(L, 2);
+  int numSamples = luaL_checknumber(L, 3);
+  luaL_argcheck(L, interval >= 1E-3, 2, "Interval must be at least 1 ms");
+  luaL_argcheck(L, numSamples > 1, 3, "At least two samples required");
+  lua_pushinteger(L, power_energyServiceStart(cpuId, interval, numSamples));
+  return 1;
+}
+
+static int lua_likwid_stopPowerService(lua_State *L) {
+  power_energyServiceStop();
+  return 0;
+}
+
+static int lua_likwid_powerServiceTime(lua_State *L) {
+  lua_pushnumber(L, power_energyServiceTime());
+  return 1;
+}
+
+static int lua_likwid_powerServiceEnergy(lua_State *L) {
+  double energy = 0.0;
+  int socket = lua_tonumber(L, 1);
+#if LUA_VERSION_NUM == 501
+  PowerType type = (PowerType)((lua_Integer)lua_tointeger(L, 2));
+#else
+  PowerType type = (PowerType)((lua_Unsigned)lua_tointegerx(L, 2, NULL));
+#endif
+  double t0 = luaL_checknumber(L, 3);
+  double t1 = luaL_checknumber(L, 4);
+  luaL_argcheck(L, type >= PKG + 1 && type <= NUM_POWER_DOMAINS, 2,
+                "Type not valid");
+  if (power_energyServiceEnergy(socket, type - 1, t0, t1, &energy) != 0) {
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_pushnumber(L, energy);
+  return 1;
+}
+
 static int lua_likwid_power_limitGet(lua_State *L) {
   int err;
   int cpuId = lua_tonumber(L, 1);
@@ -2209,6 +2566,60 @@ static int lua_likwid_markerFile_read(lua_State *L) {
   return 1;
 }
 
+static int lua_likwid_markerLive_attach(lua_State *L) {
+  LikwidMarkerLive_t live = NULL;
+  int pid = luaL_checknumber(L, 1);
+  int err = likwid_markerLiveAttach(pid, &live);
+  if (err < 0) {
+    lua_pushnil(L);
+    lua_pushinteger(L, err);
+    return 2;
+  }
+  lua_pushlightuserdata(L, live);
+  return 1;
+}
+
+static int lua_likwid_markerLive_info(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  LikwidMarkerLive_t live = lua_touserdata(L, 1);
+  int n = likwid_markerLiveThreads(live, 0, NULL);
+  if (n < 0) {
+    lua_pushnil(L);
+    return 1;
+  }
+  int cpus[n > 0 ? n : 1];
+  likwid_markerLiveThreads(live, n, cpus);
+  lua_newtable(L);
+  lua_pushstring(L, "events");
+  lua_pushstring(L, likwid_markerLiveEvents(live));
+  lua_settable(L, -3);
+  lua_pushstring(L, "running");
+  lua_pushboolean(L, likwid_markerLiveRunning(live));
+  lua_settable(L, -3);
+  lua_pushstring(L, "cpus");
+  lua_newtable(L);
+  for (int i = 0; i < n; i++) {
+    lua_pushinteger(L, cpus[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+  lua_settable(L, -3);
+  return 1;
+}
+
+static int lua_likwid_markerLive_read(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  LikwidMarkerLive_t live = lua_touserdata(L, 1);
+  int diff = lua_toboolean(L, 2);
+  lua_pushinteger(L, perfmon_readMarkerLive(live, diff));
+  return 1;
+}
+
+static int lua_likwid_markerLive_detach(lua_State *L) {
+  luaL_checktype(L, 1, LUA_TLIGHTUSERDATA);
+  likwid_markerLiveDetach(lua_touserdata(L, 1));
+  return 0;
+}
+
 static int lua_likwid_markerFile_destroy(lua_State *L) {
   perfmon_destroyMarkerResults();
   return 0;
@@ -2292,6 +2703,13 @@ static int lua_likwid_markerRegionCount(lua_State *L) {
   return 1;
 }
 
+static int lua_likwid_markerRegionCoverage(lua_State *L) {
+  int region = lua_tointeger(L, -2);
+  int thread = lua_tointeger(L, -1);
+  lua_pushnumber(L, perfmon_getCoverageOfRegion(region - 1, thread - 1));
+  return 1;
+}
+
 static int lua_likwid_markerRegionResult(lua_State *L) {
   int region = lua_tointeger(L, -3);
   int event = lua_tointeger(L, -2);
@@ -2310,6 +2728,80 @@ static int lua_likwid_markerRegionMetric(lua_State *L) {
   return 1;
 }
 
+static void lua_likwid_pushNodeValues(lua_State *L, const char *key, int node,
+                                       int count, int exclusive, int metrics) {
+  int threads = perfmon_getThreadsOfRegionNode(node);
+  lua_pushstring(L, key);
+  lua_newtable(L);
+  for (int i = 0; i < count; i++) {
+    double v = 0;
+    if (metrics) {
+      v = perfmon_getMetricOfRegionNode(node, i, exclusive);
+    } else {
+      for (int t = 0; t < threads; t++) {
+        double r = perfmon_getResultOfRegionNode(node, i, t, exclusive);
+        if (r == r) {
+          v += r;
+        }
+      }
+    }
+    lua_pushinteger(L, i + 1);
+    lua_pushnumber(L, v);
+    lua_settable(L, -3);
+  }
+  lua_settable(L, -3);
+}
+
+static int lua_likwid_markerRegionTree(lua_State *L) {
+  int nodes = perfmon_getNumberOfRegionNodes();
+  lua_newtable(L);
+  for (int n = 0; n < nodes; n++) {
+    int group = perfmon_getGroupOfRegionNode(n);
+    int threads = perfmon_getThreadsOfRegionNode(n);
+    int calls = 0;
+    double inclTime = 0;
+    double exclTime = 0;
+    for (int t = 0; t < threads; t++) {
+      calls += perfmon_getCountOfRegionNode(n, t);
+      inclTime = MAX(inclTime, perfmon_getTimeOfRegionNode(n, t, 0));
+      exclTime = MAX(exclTime, perfmon_getTimeOfRegionNode(n, t, 1));
+    }
+    lua_pushinteger(L, n + 1);
+    lua_newtable(L);
+    lua_pushstring(L, "tag");
+    lua_pushstring(L, perfmon_getTagOfRegionNode(n));
+    lua_settable(L, -3);
+    lua_pushstring(L, "parent");
+    lua_pushinteger(L, perfmon_getParentOfRegionNode(n) + 1);
+    lua_settable(L, -3);
+    lua_pushstring(L, "group");
+    lua_pushinteger(L, group + 1);
+    lua_settable(L, -3);
+    lua_pushstring(L, "threads");
+    lua_pushinteger(L, threads);
+    lua_settable(L, -3);
+    lua_pushstring(L, "calls");
+    lua_pushinteger(L, calls);
+    lua_settable(L, -3);
+    lua_pushstring(L, "time");
+    lua_pushnumber(L, inclTime);
+    lua_settable(L, -3);
+    lua_pushstring(L, "exclTime");
+    lua_pushnumber(L, exclTime);
+    lua_settable(L, -3);
+    lua_likwid_pushNodeValues(L, "events", n, perfmon_getNumberOfEvents(group),
+                              0, 0);
+    lua_likwid_pushNodeValues(L, "exclEvents", n,
+                              perfmon_getNumberOfEvents(group), 1, 0);
+    lua_likwid_pushNodeValues(L, "metrics", n,
+                              perfmon_getNumberOfMetrics(group), 0, 1);
+    lua_likwid_pushNodeValues(L, "exclMetrics", n,
+                              perfmon_getNumberOfMetrics(group), 1, 1);
+    lua_settable(L, -3);
+  }
+  return 1;
+}
+
 static int lua_likwid_initFreq(lua_State *L) {
   lua_pushnumber(L, freq_init());
   return 1;
@@ -2423,6 +2915,130 @@ static int lua_likwid_getAvailGovs(lua_State *L) {
   return 1;
 }
 
+static int *lua_likwid_cpuList(lua_State *L, int idx, int *num_cpus) {
+  int *cpus = NULL;
+  luaL_checktype(L, idx, LUA_TTABLE);
+  *num_cpus = lua_rawlen(L, idx);
+  cpus = malloc((*num_cpus + 1) * sizeof(int));
+  if (cpus) {
+    for (int i = 0; i < *num_cpus; i++) {
+      lua_rawgeti(L, idx, i + 1);
+      cpus[i] = lua_tointeger(L, -1);
+      lua_pop(L, 1);
+    }
+  }
+  return cpus;
+}
+
+static int lua_likwid_getCpuFreqStates(lua_State *L) {
+  int num_cpus = 0;
+  int *cpus = lua_likwid_cpuList(L, 1, &num_cpus);
+  FreqCpuState *states = malloc((num_cpus + 1) * sizeof(FreqCpuState));
+  if ((!cpus) || (!states) || freq_getCpuStates(num_cpus, cpus, states) < 0) {
+    free(cpus);
+    free(states);
+    lua_pushnil(L);
+    return 1;
+  }
+  lua_newtable(L);
+  for (int i = 0; i < num_cpus; i++) {
+    lua_pushinteger(L, i + 1);
+    lua_newtable(L);
+    lua_pushstring(L, "cpu");
+    lua_pushinteger(L, states[i].cpu);
+    lua_settable(L, -3);
+    lua_pushstring(L, "error");
+    lua_pushinteger(L, states[i].error);
+    lua_settable(L, -3);
+    if (states[i].error == 0) {
+      lua_pushstring(L, "cur");
+      lua_pushnumber(L, states[i].cur);
+      lua_settable(L, -3);
+      lua_pushstring(L, "min");
+      lua_pushnumber(L, states[i].min);
+      lua_settable(L, -3);
+      lua_pushstring(L, "max");
+      lua_pushnumber(L, states[i].max);
+      lua_settable(L, -3);
+      lua_pushstring(L, "governor");
+      lua_pushstring(L, states[i].governor);
+      lua_settable(L, -3);
+    }
+    lua_pushstring(L, "turbo");
+    lua_pushinteger(L, states[i].turbo);
+    lua_settable(L, -3);
+    lua_settable(L, -3);
+  }
+  free(cpus);
+  free(states);
+  return 1;
+}
+
+static int lua_likwid_setCpuClockList(lua_State *L, int max) {
+  int ret = 0;
+  int num_cpus = 0;
+  int *cpus = lua_likwid_cpuList(L, 1, &num_cpus);
+  uint64_t *freqs = malloc((num_cpus + 1) * sizeof(uint64_t));
+  int *errors = malloc((num_cpus + 1) * sizeof(int));
+  if ((!cpus) || (!freqs) || (!errors)) {
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+  for (int i = 0; i < num_cpus; i++) {
+    if (lua_istable(L, 2)) {
+      lua_rawgeti(L, 2, i + 1);
+      freqs[i] = lua_tointeger(L, -1);
+      lua_pop(L, 1);
+    } else {
+      freqs[i] = lua_tointeger(L, 2);
+    }
+  }
+  if (max)
+    ret = freq_setCpuClockMaxList(num_cpus, cpus, freqs, errors);
+  else
+    ret = freq_setCpuClockMinList(num_cpus, cpus, freqs, errors);
+cleanup:
+  lua_pushinteger(L, ret);
+  lua_newtable(L);
+  for (int i = 0; ret >= 0 && i < num_cpus; i++) {
+    lua_pushinteger(L, errors[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+  free(cpus);
+  free(freqs);
+  free(errors);
+  return 2;
+}
+
+static int lua_likwid_setCpuClockMinList(lua_State *L) {
+  return lua_likwid_setCpuClockList(L, 0);
+}
+
+static int lua_likwid_setCpuClockMaxList(lua_State *L) {
+  return lua_likwid_setCpuClockList(L, 1);
+}
+
+static int lua_likwid_setGovernorList(lua_State *L) {
+  int ret = 0;
+  int num_cpus = 0;
+  int *cpus = lua_likwid_cpuList(L, 1, &num_cpus);
+  const char *gov = (const char *)luaL_checkstring(L, 2);
+  int *errors = malloc((num_cpus + 1) * sizeof(int));
+  if ((!cpus) || (!errors))
+    ret = -ENOMEM;
+  else
+    ret = freq_setGovernorList(num_cpus, cpus, gov, errors);
+  lua_pushinteger(L, ret);
+  lua_newtable(L);
+  for (int i = 0; ret >= 0 && i < num_cpus; i++) {
+    lua_pushinteger(L, errors[i]);
+    lua_rawseti(L, -2, i + 1);
+  }
+  free(cpus);
+  free(errors);
+  return 2;
+}
+
 static int lua_likwid_setUncoreFreqMin(lua_State *L) {
   const int socket_id = lua_tointeger(L, -2);
   const uint64_t freq = lua_tointeger(L, -1);
@@ -3814,6 +4430,84 @@ lua_likwid_setSysFeature(lua_State *L)
     return 1;
 }
 
+static int
+lua_likwid_getSysFeatureSnapshot(lua_State *L)
+{
+    int err = 0;
+    int num_features = 0;
+    int num_devices = 0;
+    char** names = NULL;
+    LikwidDevice_t* devices = NULL;
+    SysFeatureSnapshot snap = {0, 0, NULL};
+    if (!sysfeatures_inititalized)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    num_features = lua_rawlen(L, 1);
+    num_devices = lua_rawlen(L, 2);
+    names = malloc((num_features + 1) * sizeof(char*));
+    devices = malloc((num_devices + 1) * sizeof(LikwidDevice_t));
+    if (names && devices)
+    {
+        for (int i = 0; i < num_features; i++)
+        {
+            lua_rawgeti(L, 1, i + 1);
+            names[i] = (char*)lua_tostring(L, -1);
+            lua_pop(L, 1);
+        }
+        for (int i = 0; i < num_devices; i++)
+        {
+            lua_rawgeti(L, 2, i + 1);
+            devices[i] = lua_touserdata(L, -1);
+            lua_pop(L, 1);
+        }
+        err = sysFeatures_snapshot(num_features, names, num_devices, devices, &snap);
+    }
+    else
+    {
+        err = -ENOMEM;
+    }
+    free(names);
+    free(devices);
+    if (err < 0)
+    {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_newtable(L);
+    for (int f = 0; f < snap.num_features; f++)
+    {
+        lua_newtable(L);
+        for (int d = 0; d < snap.num_devices; d++)
+        {
+            SysFeatureValue* v = &snap.values[f * snap.num_devices + d];
+            if (v->error < 0)
+            {
+                continue;
+            }
+            switch (v->type)
+            {
+                case HWFEATURES_TYPE_UINT64:
+                    lua_pushinteger(L, (lua_Integer)v->value.uint64);
+                    break;
+                case HWFEATURES_TYPE_DOUBLE:
+                    lua_pushnumber(L, v->value.dbl);
+                    break;
+                default:
+                    lua_pushstring(L, v->value.str);
+                    break;
+            }
+            lua_rawseti(L, -2, d + 1);
+        }
+        lua_rawseti(L, -2, f + 1);
+    }
+    sysFeatures_snapshot_return(&snap);
+    return 1;
+}
+
 static int
 lua_likwid_createDevice(lua_State *L)
 {
@@ -3910,6 +4604,8 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_stopCounters", lua_likwid_stopCounters);
   lua_register(L, "likwid_readCounters", lua_likwid_readCounters);
   lua_register(L, "likwid_switchGroup", lua_likwid_switchGroup);
+  lua_register(L, "likwid_startOverflowWatch", lua_likwid_startOverflowWatch);
+  lua_register(L, "likwid_stopOverflowWatch", lua_likwid_stopOverflowWatch);
   lua_register(L, "likwid_finalize", lua_likwid_finalize);
   lua_register(L, "likwid_getEventsAndCounters",
                lua_likwid_getEventsAndCounters);
@@ -3929,16 +4625,26 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_getNameOfMetric", lua_likwid_getNameOfMetric);
   lua_register(L, "likwid_getNameOfGroup", lua_likwid_getNameOfGroup);
   lua_register(L, "likwid_getGroups", lua_likwid_getGroups);
+  lua_register(L, "likwid_buildGroupCatalogue", lua_likwid_buildGroupCatalogue);
+  lua_register(L, "likwid_aggregateRecords", lua_likwid_aggregateRecords);
   lua_register(L, "likwid_getShortInfoOfGroup", lua_likwid_getShortInfoOfGroup);
   lua_register(L, "likwid_getLongInfoOfGroup", lua_likwid_getLongInfoOfGroup);
   // Topology functions
   lua_register(L, "likwid_getCpuInfo", lua_likwid_getCpuInfo);
   lua_register(L, "likwid_getCpuTopology", lua_likwid_getCpuTopology);
   lua_register(L, "likwid_putTopology", lua_likwid_putTopology);
+  lua_register(L, "likwid_writeTopologyCache", lua_likwid_writeTopologyCache);
   lua_register(L, "likwid_getNumaInfo", lua_likwid_getNumaInfo);
   lua_register(L, "likwid_putNumaInfo", lua_likwid_putNumaInfo);
   lua_register(L, "likwid_setMemInterleaved", lua_likwid_setMemInterleaved);
   lua_register(L, "likwid_setMembind", lua_likwid_setMembind);
+  lua_register(L, "likwid_auditNumaPages", lua_likwid_auditNumaPages);
+  lua_register(L, "likwid_writerOpen", lua_likwid_writerOpen);
+  lua_register(L, "likwid_writerLine", lua_likwid_writerLine);
+  lua_register(L, "likwid_writerRow", lua_likwid_writerRow);
+  lua_register(L, "likwid_writerClose", lua_likwid_writerClose);
+  lua_register(L, "likwid_monitorRun", lua_likwid_monitorRun);
+  lua_register(L, "likwid_monitorQuery", lua_likwid_monitorQuery);
   lua_register(L, "likwid_getAffinityInfo", lua_likwid_getAffinityInfo);
   lua_register(L, "likwid_putAffinityInfo", lua_likwid_putAffinityInfo);
   lua_register(L, "likwid_getPowerInfo", lua_likwid_getPowerInfo);
@@ -3961,6 +4667,10 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_startPower", lua_likwid_startPower);
   lua_register(L, "likwid_stopPower", lua_likwid_stopPower);
   lua_register(L, "likwid_printEnergy", lua_likwid_printEnergy);
+  lua_register(L, "likwid_startPowerService", lua_likwid_startPowerService);
+  lua_register(L, "likwid_stopPowerService", lua_likwid_stopPowerService);
+  lua_register(L, "likwid_powerServiceTime", lua_likwid_powerServiceTime);
+  lua_register(L, "likwid_powerServiceEnergy", lua_likwid_powerServiceEnergy);
   lua_register(L, "likwid_powerLimitGet", lua_likwid_power_limitGet);
   lua_register(L, "likwid_powerLimitSet", lua_likwid_power_limitSet);
   lua_register(L, "likwid_powerLimitState", lua_likwid_power_limitState);
@@ -4006,6 +4716,10 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_cpuFeaturesDisable", lua_likwid_cpuFeatures_disable);
   // Marker API related functions
   lua_register(L, "likwid_readMarkerFile", lua_likwid_markerFile_read);
+  lua_register(L, "likwid_markerLiveAttach", lua_likwid_markerLive_attach);
+  lua_register(L, "likwid_markerLiveInfo", lua_likwid_markerLive_info);
+  lua_register(L, "likwid_readMarkerLive", lua_likwid_markerLive_read);
+  lua_register(L, "likwid_markerLiveDetach", lua_likwid_markerLive_detach);
   lua_register(L, "likwid_destroyMarkerFile", lua_likwid_markerFile_destroy);
   lua_register(L, "likwid_markerNumRegions", lua_likwid_markerNumRegions);
   lua_register(L, "likwid_markerRegionGroup", lua_likwid_markerRegionGroup);
@@ -4015,8 +4729,11 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_markerRegionCpulist", lua_likwid_markerRegionCpulist);
   lua_register(L, "likwid_markerRegionTime", lua_likwid_markerRegionTime);
   lua_register(L, "likwid_markerRegionCount", lua_likwid_markerRegionCount);
+  lua_register(L, "likwid_markerRegionCoverage",
+               lua_likwid_markerRegionCoverage);
   lua_register(L, "likwid_markerRegionResult", lua_likwid_markerRegionResult);
   lua_register(L, "likwid_markerRegionMetric", lua_likwid_markerRegionMetric);
+  lua_register(L, "likwid_markerRegionTree", lua_likwid_markerRegionTree);
   // CPU frequency functions
   lua_register(L, "likwid_initFreq", lua_likwid_initFreq);
   lua_register(L, "likwid_finalizeFreq", lua_likwid_finalizeFreq);
@@ -4030,6 +4747,10 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
   lua_register(L, "likwid_setCpuClockMax", lua_likwid_setCpuClockMax);
   lua_register(L, "likwid_getGovernor", lua_likwid_getGovernor);
   lua_register(L, "likwid_setGovernor", lua_likwid_setGovernor);
+  lua_register(L, "likwid_getCpuFreqStates", lua_likwid_getCpuFreqStates);
+  lua_register(L, "likwid_setCpuClockMinList", lua_likwid_setCpuClockMinList);
+  lua_register(L, "likwid_setCpuClockMaxList", lua_likwid_setCpuClockMaxList);
+  lua_register(L, "likwid_setGovernorList", lua_likwid_setGovernorList);
   lua_register(L, "likwid_getAvailFreq", lua_likwid_getAvailFreq);
   lua_register(L, "likwid_getAvailGovs", lua_likwid_getAvailGovs);
   lua_register(L, "likwid_setTurbo", lua_likwid_setTurbo);
@@ -4136,6 +4857,7 @@ int __attribute__((visibility("default"))) luaopen_liblikwid(lua_State *L) {
     lua_register(L, "likwid_sysFeatures_list",lua_likwid_getSysFeatureList);
     lua_register(L, "likwid_sysFeatures_get",lua_likwid_getSysFeature);
     lua_register(L, "likwid_sysFeatures_set",lua_likwid_setSysFeature);
+    lua_register(L, "likwid_sysFeatures_snapshot",lua_likwid_getSysFeatureSnapshot);
     lua_register(L, "likwid_createDevice",lua_likwid_createDevice);
     lua_register(L, "likwid_destroyDevice",lua_likwid_destroyDevice);
 #endif /* LIKWID_WITH_SYSFEATURES */
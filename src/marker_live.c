@@ -0,0 +1,540 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_live.c
+ *
+ *      Description:  Publication of the MarkerAPI results in a shared memory
+ *                    segment while the application runs and the reader side
+ *                    for likwid-perfctr --attach.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <likwid.h>
+#include <types.h>
+#include <error.h>
+#include <bstrlib.h>
+#include <perfmon.h>
+#include <marker_live.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define MARKERLIVE_MAGIC 0x4c49564d524b5731ULL
+#define MARKERLIVE_VERSION 1
+#define MARKERLIVE_ALIGN(x) (((x) + 63) & ~((size_t)63))
+/* Attempts to get a consistent copy of a record */
+#define MARKERLIVE_MAX_RETRIES 100000
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int markerlive_active = 0;
+
+extern int perfmon_initialized;
+extern LikwidResults* markerResults;
+extern int markerRegions;
+
+/* #####   LOCAL TYPES   ################################################## */
+
+/* Layout of the segment:
+ * header | cpus[numberOfThreads] | events string | regions[maxRegions] |
+ * records[maxRegions][numberOfThreads]
+ * Each part starts at a cache line boundary. The records are updated by the
+ * owning thread only and protected by a sequence counter, odd values mark
+ * an ongoing update. */
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    int32_t pid;
+    int32_t numberOfThreads;
+    int32_t maxRegions;
+    int32_t maxEvents;
+    int32_t numberOfRegions;
+    int32_t closed;
+    uint32_t recordSize;
+    uint64_t cpusOffset;
+    uint64_t eventsOffset;
+    uint64_t regionsOffset;
+    uint64_t recordsOffset;
+    uint64_t size;
+} MarkerLiveHeader;
+
+typedef struct {
+    char tag[MARKERLIVE_TAG_LENGTH];
+    int32_t groupID;
+    int32_t numberOfEvents;
+} MarkerLiveRegion;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t count;
+    double time;
+    double counters[];
+} MarkerLiveRecord;
+
+struct LikwidMarkerLive {
+    MarkerLiveHeader* header;
+    size_t size;
+    /* Snapshot of the last read for interval differences */
+    char* previous;
+};
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static pthread_mutex_t ml_lock = PTHREAD_MUTEX_INITIALIZER;
+static MarkerLiveHeader* ml_header = NULL;
+static char ml_name[64];
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+markerlive_shmName(int pid, char* name, size_t len)
+{
+    snprintf(name, len, "/likwid-marker-%d", pid);
+}
+
+static MarkerLiveRegion*
+markerlive_regions(MarkerLiveHeader* h)
+{
+    return (MarkerLiveRegion*)((char*)h + h->regionsOffset);
+}
+
+static MarkerLiveRecord*
+markerlive_record(MarkerLiveHeader* h, int region, int thread)
+{
+    size_t idx = (size_t)region * h->numberOfThreads + thread;
+    return (MarkerLiveRecord*)((char*)h + h->recordsOffset + idx * h->recordSize);
+}
+
+static int
+markerlive_region(const char* regionTag, int groupID, int numberOfEvents)
+{
+    MarkerLiveRegion* regions = markerlive_regions(ml_header);
+    int idx = -1;
+    pthread_mutex_lock(&ml_lock);
+    int n = ml_header->numberOfRegions;
+    for (int i = 0; i < n; i++)
+    {
+        if (regions[i].groupID == groupID && strncmp(regions[i].tag, regionTag, MARKERLIVE_TAG_LENGTH-1) == 0)
+        {
+            idx = i;
+            break;
+        }
+    }
+    if (idx < 0 && n < ml_header->maxRegions)
+    {
+        idx = n;
+        snprintf(regions[idx].tag, MARKERLIVE_TAG_LENGTH, "%s", regionTag);
+        regions[idx].groupID = groupID;
+        regions[idx].numberOfEvents = numberOfEvents;
+        /* Readers only look at regions below numberOfRegions */
+        __atomic_store_n(&ml_header->numberOfRegions, n + 1, __ATOMIC_RELEASE);
+    }
+    else if (idx < 0)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, No space for region %s in live results, regionTag);
+    }
+    pthread_mutex_unlock(&ml_lock);
+    return idx;
+}
+
+/* Consistent copy of a record, retries while the owner updates it. If the
+ * application died during an update, the last copy is used. */
+static void
+markerlive_readRecord(MarkerLiveHeader* h, MarkerLiveRecord* rec, MarkerLiveRecord* copy)
+{
+    size_t len = h->recordSize - sizeof(uint32_t);
+    for (int retry = 0; retry < MARKERLIVE_MAX_RETRIES; retry++)
+    {
+        uint32_t s1 = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+        memcpy((char*)copy + sizeof(uint32_t), (char*)rec + sizeof(uint32_t), len);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (!(s1 & 0x1) && __atomic_load_n(&rec->seq, __ATOMIC_RELAXED) == s1)
+        {
+            break;
+        }
+        sched_yield();
+    }
+    copy->seq = 0;
+}
+
+static void
+markerlive_freeResults(void)
+{
+    if (markerResults != NULL)
+    {
+        perfmon_destroyMarkerResults();
+        markerResults = NULL;
+        markerRegions = 0;
+    }
+}
+
+/* Gauges like temperatures are not accumulated by the MarkerAPI */
+static int
+markerlive_isGauge(int groupID, int event)
+{
+    if (groupID < 0 || groupID >= groupSet->numberOfGroups ||
+        event >= groupSet->groups[groupID].numberOfEvents)
+    {
+        return 0;
+    }
+    RegisterType type = counter_map[groupSet->groups[groupID].events[event].index].type;
+    return (type == THERMAL || type == VOLTAGE || type == MBOX0TMP);
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+markerlive_init(int numThreads, int* threadsToCpu, const char* events)
+{
+    char* maxStr = getenv("LIKWID_MARKER_LIVE_REGIONS");
+    int maxRegions = MARKERLIVE_MAX_REGIONS;
+    int maxEvents = 1;
+    if (!events)
+    {
+        events = "";
+    }
+    if (maxStr != NULL && atoi(maxStr) > 0)
+    {
+        maxRegions = atoi(maxStr);
+    }
+    for (int i = 0; i < groupSet->numberOfGroups; i++)
+    {
+        maxEvents = MAX(maxEvents, groupSet->groups[i].numberOfEvents);
+    }
+    maxEvents = MIN(maxEvents, NUM_PMC);
+
+    MarkerLiveHeader h;
+    memset(&h, 0, sizeof(MarkerLiveHeader));
+    h.magic = MARKERLIVE_MAGIC;
+    h.version = MARKERLIVE_VERSION;
+    h.pid = getpid();
+    h.numberOfThreads = numThreads;
+    h.maxRegions = maxRegions;
+    h.maxEvents = maxEvents;
+    h.recordSize = MARKERLIVE_ALIGN(sizeof(MarkerLiveRecord) + maxEvents * sizeof(double));
+    h.cpusOffset = MARKERLIVE_ALIGN(sizeof(MarkerLiveHeader));
+    h.eventsOffset = h.cpusOffset + MARKERLIVE_ALIGN(numThreads * sizeof(int));
+    h.regionsOffset = h.eventsOffset + MARKERLIVE_ALIGN(strlen(events) + 1);
+    h.recordsOffset = h.regionsOffset + MARKERLIVE_ALIGN(maxRegions * sizeof(MarkerLiveRegion));
+    h.size = h.recordsOffset + (uint64_t)maxRegions * numThreads * h.recordSize;
+
+    markerlive_shmName(h.pid, ml_name, sizeof(ml_name));
+    int fd = shm_open(ml_name, O_CREAT|O_RDWR|O_TRUNC, S_IRUSR|S_IWUSR);
+    if (fd < 0)
+    {
+        int err = -errno;
+        ERROR_PRINT(Cannot create shared memory segment %s for live MarkerAPI results, ml_name);
+        return err;
+    }
+    if (ftruncate(fd, h.size) < 0)
+    {
+        int err = -errno;
+        close(fd);
+        shm_unlink(ml_name);
+        return err;
+    }
+    void* ptr = mmap(NULL, h.size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        int err = -errno;
+        shm_unlink(ml_name);
+        return err;
+    }
+    ml_header = ptr;
+    memcpy(ml_header, &h, sizeof(MarkerLiveHeader));
+    memcpy((char*)ml_header + h.cpusOffset, threadsToCpu, numThreads * sizeof(int));
+    strcpy((char*)ml_header + h.eventsOffset, events);
+    markerlive_active = 1;
+    DEBUG_PRINT(DEBUGLEV_INFO, Live MarkerAPI results in %s (%lu bytes), ml_name, h.size);
+    return 0;
+}
+
+void
+markerlive_publish(LikwidThreadResults* results, const char* regionTag, int threadId)
+{
+    if (!ml_header || threadId < 0 || threadId >= ml_header->numberOfThreads)
+    {
+        return;
+    }
+    int nevents = MIN(groupSet->groups[results->groupID].numberOfEvents, ml_header->maxEvents);
+    if (results->liveIndex < 0)
+    {
+        results->liveIndex = markerlive_region(regionTag, results->groupID, nevents);
+        if (results->liveIndex < 0)
+        {
+            return;
+        }
+    }
+    MarkerLiveRecord* rec = markerlive_record(ml_header, results->liveIndex, threadId);
+    uint32_t seq = rec->seq;
+    __atomic_store_n(&rec->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    rec->count = results->count;
+    rec->time = results->time;
+    for (int i = 0; i < nevents; i++)
+    {
+        rec->counters[i] = results->PMcounters[i];
+    }
+    __atomic_store_n(&rec->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void
+markerlive_finalize(void)
+{
+    if (ml_header)
+    {
+        /* Attached readers keep their mapping and see the final values */
+        __atomic_store_n(&ml_header->closed, 1, __ATOMIC_RELEASE);
+        munmap(ml_header, ml_header->size);
+        ml_header = NULL;
+        shm_unlink(ml_name);
+    }
+    markerlive_active = 0;
+}
+
+int
+likwid_markerLiveAttach(int pid, LikwidMarkerLive_t* live)
+{
+    char name[64];
+    struct stat st;
+    if (!live)
+    {
+        return -EINVAL;
+    }
+    markerlive_shmName(pid, name, sizeof(name));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(MarkerLiveHeader))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    void* ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        return -errno;
+    }
+    MarkerLiveHeader* h = ptr;
+    if (h->magic != MARKERLIVE_MAGIC || h->version != MARKERLIVE_VERSION || h->size > (uint64_t)st.st_size)
+    {
+        ERROR_PRINT(Shared memory segment %s has an unknown format, name);
+        munmap(ptr, st.st_size);
+        return -EINVAL;
+    }
+    LikwidMarkerLive_t l = malloc(sizeof(struct LikwidMarkerLive));
+    if (!l)
+    {
+        munmap(ptr, st.st_size);
+        return -ENOMEM;
+    }
+    l->header = h;
+    l->size = st.st_size;
+    l->previous = NULL;
+    *live = l;
+    return 0;
+}
+
+int
+likwid_markerLiveThreads(LikwidMarkerLive_t live, int length, int* cpus)
+{
+    if (!live)
+    {
+        return -EINVAL;
+    }
+    MarkerLiveHeader* h = live->header;
+    if (cpus)
+    {
+        memcpy(cpus, (char*)h + h->cpusOffset, MIN(length, h->numberOfThreads) * sizeof(int));
+    }
+    return h->numberOfThreads;
+}
+
+const char*
+likwid_markerLiveEvents(LikwidMarkerLive_t live)
+{
+    if (!live)
+    {
+        return NULL;
+    }
+    return (const char*)live->header + live->header->eventsOffset;
+}
+
+int
+likwid_markerLiveRunning(LikwidMarkerLive_t live)
+{
+    if (!live)
+    {
+        return 0;
+    }
+    if (__atomic_load_n(&live->header->closed, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    return (kill(live->header->pid, 0) == 0 || errno == EPERM);
+}
+
+int
+perfmon_readMarkerLive(LikwidMarkerLive_t live, int diff)
+{
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    if (!live)
+    {
+        return -EINVAL;
+    }
+    MarkerLiveHeader* h = live->header;
+    MarkerLiveRegion* regions = markerlive_regions(h);
+    int nthreads = h->numberOfThreads;
+    int nregions = __atomic_load_n(&h->numberOfRegions, __ATOMIC_ACQUIRE);
+    int* cpus = (int*)((char*)h + h->cpusOffset);
+    size_t recSize = h->recordSize;
+    if (!live->previous)
+    {
+        live->previous = calloc((size_t)h->maxRegions * nthreads, recSize);
+        if (!live->previous)
+        {
+            return -ENOMEM;
+        }
+    }
+    char* current = malloc(nregions * nthreads * recSize + 1);
+    if (!current)
+    {
+        return -ENOMEM;
+    }
+    for (int i = 0; i < nregions; i++)
+    {
+        for (int j = 0; j < nthreads; j++)
+        {
+            markerlive_readRecord(h, markerlive_record(h, i, j),
+                                  (MarkerLiveRecord*)(current + ((size_t)i * nthreads + j) * recSize));
+        }
+    }
+
+    markerlive_freeResults();
+    markerResults = malloc(MAX(nregions, 1) * sizeof(LikwidResults));
+    if (!markerResults)
+    {
+        free(current);
+        return -ENOMEM;
+    }
+    int out = 0;
+    for (int i = 0; i < nregions; i++)
+    {
+        LikwidResults* res = &markerResults[out];
+        int nevents = regions[i].numberOfEvents;
+        uint32_t total = 0;
+        res->tag = bfromcstr(regions[i].tag);
+        res->groupID = regions[i].groupID;
+        res->threadCount = nthreads;
+        res->eventCount = nevents;
+        res->time = malloc(nthreads * sizeof(double));
+        res->count = malloc(nthreads * sizeof(uint32_t));
+        res->cpulist = malloc(nthreads * sizeof(int));
+        res->counters = malloc(nthreads * sizeof(double*));
+        res->coverage = NULL;
+        if (!res->time || !res->count || !res->cpulist || !res->counters)
+        {
+            free(res->time);
+            free(res->count);
+            free(res->cpulist);
+            free(res->counters);
+            bdestroy(res->tag);
+            break;
+        }
+        for (int j = 0; j < nthreads; j++)
+        {
+            MarkerLiveRecord* cur = (MarkerLiveRecord*)(current + ((size_t)i * nthreads + j) * recSize);
+            MarkerLiveRecord* prev = (MarkerLiveRecord*)(live->previous + ((size_t)i * nthreads + j) * recSize);
+            /* A smaller call count means the region was reset in between */
+            int sub = (diff && cur->count >= prev->count);
+            res->cpulist[j] = cpus[j];
+            res->count[j] = cur->count - (sub ? prev->count : 0);
+            res->time[j] = cur->time - (sub ? prev->time : 0.0);
+            res->counters[j] = malloc(MAX(nevents, 1) * sizeof(double));
+            for (int k = 0; k < nevents && res->counters[j]; k++)
+            {
+                res->counters[j][k] = cur->counters[k];
+                if (sub && !markerlive_isGauge(res->groupID, k))
+                {
+                    res->counters[j][k] -= prev->counters[k];
+                }
+            }
+            total += res->count[j];
+        }
+        /* Skip regions without calls like the marker file does */
+        if (total == 0)
+        {
+            for (int j = 0; j < nthreads; j++)
+            {
+                free(res->counters[j]);
+            }
+            free(res->time);
+            free(res->count);
+            free(res->cpulist);
+            free(res->counters);
+            bdestroy(res->tag);
+            continue;
+        }
+        out++;
+    }
+    markerRegions = out;
+    groupSet->numberOfThreads = nthreads;
+    memcpy(live->previous, current, nregions * nthreads * recSize);
+    free(current);
+    return out;
+}
+
+void
+likwid_markerLiveDetach(LikwidMarkerLive_t live)
+{
+    if (live)
+    {
+        munmap(live->header, live->size);
+        free(live->previous);
+        free(live);
+    }
+}
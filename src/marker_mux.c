@@ -0,0 +1,276 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_mux.c
+ *
+ *      Description:  Automatic time-sliced multiplexing of event groups in the MarkerAPI.
+ *                    Groups are rotated at region exits, results are extrapolated.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <likwid.h>
+#include <types.h>
+#include <error.h>
+#include <bstrlib.h>
+#include <perfmon.h>
+#include <marker_mux.h>
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int markermux_active = 0;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static int mm_groups = 0;
+static uint64_t mm_calls = 0;
+static double mm_interval = 0.0;
+static uint64_t mm_stops = 0;
+static double mm_last = 0.0;
+static uint64_t mm_switches = 0;
+/* Open regions hold the lock for reading, a group switch is only possible
+ * when the write lock can be taken, so when no region is open in any thread */
+static pthread_rwlock_t mm_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static double
+markermux_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1E-9);
+}
+
+static int
+markermux_isGauge(int group, int event)
+{
+    RegisterType type = counter_map[groupSet->groups[group].events[event].index].type;
+    return (type == THERMAL || type == VOLTAGE || type == MBOX0TMP);
+}
+
+static int
+markermux_nameLength(bstring tag)
+{
+    int pos = bstrrchr(tag, '-');
+    return (pos == BSTR_ERR ? blength(tag) : pos);
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+markermux_init(int numberOfGroups)
+{
+    char* muxStr = getenv("LIKWID_MARKER_MUX");
+    char* end = NULL;
+    double value = 0;
+
+    if (muxStr == NULL)
+    {
+        return 0;
+    }
+    value = strtod(muxStr, &end);
+    if (value <= 0 || end == muxStr)
+    {
+        fprintf(stderr, "WARN: Invalid value '%s' for LIKWID_MARKER_MUX, group multiplexing disabled\n", muxStr);
+        return -EINVAL;
+    }
+    if (*end == '\0')
+    {
+        mm_calls = (uint64_t)value;
+    }
+    else if (strcmp(end, "s") == 0)
+    {
+        mm_interval = value;
+    }
+    else if (strcmp(end, "ms") == 0)
+    {
+        mm_interval = value * 1E-3;
+    }
+    else if (strcmp(end, "us") == 0)
+    {
+        mm_interval = value * 1E-6;
+    }
+    else
+    {
+        fprintf(stderr, "WARN: Invalid unit '%s' for LIKWID_MARKER_MUX, group multiplexing disabled\n", end);
+        return -EINVAL;
+    }
+    if (numberOfGroups < 2)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Group multiplexing requires at least two groups);
+        return 0;
+    }
+    mm_groups = numberOfGroups;
+    mm_stops = 0;
+    mm_switches = 0;
+    mm_last = markermux_now();
+    markermux_active = 1;
+    DEBUG_PRINT(DEBUGLEV_INFO, Multiplexing %d groups every %s, numberOfGroups, muxStr);
+    return 0;
+}
+
+void
+markermux_regionStart(void)
+{
+    pthread_rwlock_rdlock(&mm_lock);
+}
+
+/* Release the lock of a region start that does not open a region */
+void
+markermux_regionCancel(void)
+{
+    pthread_rwlock_unlock(&mm_lock);
+}
+
+void
+markermux_regionStop(void)
+{
+    pthread_rwlock_unlock(&mm_lock);
+    uint64_t stops = __atomic_add_fetch(&mm_stops, 1, __ATOMIC_RELAXED);
+    if (mm_calls > 0 && stops < mm_calls)
+    {
+        return;
+    }
+    if (mm_interval > 0 && markermux_now() - mm_last < mm_interval)
+    {
+        return;
+    }
+    /* Safe point: the last open region in the process was closed. If another
+     * thread is inside a region, the switch is retried at a later region exit */
+    if (pthread_rwlock_trywrlock(&mm_lock) != 0)
+    {
+        return;
+    }
+    if ((mm_calls > 0 && mm_stops >= mm_calls) ||
+        (mm_interval > 0 && markermux_now() - mm_last >= mm_interval))
+    {
+        int next = (groupSet->activeGroup + 1) % mm_groups;
+        DEBUG_PRINT(DEBUGLEV_DEVELOP, Multiplexing: switch from group %d to group %d, groupSet->activeGroup, next);
+        perfmon_switchActiveGroup(next);
+        mm_stops = 0;
+        mm_last = markermux_now();
+        mm_switches++;
+    }
+    pthread_rwlock_unlock(&mm_lock);
+}
+
+/* The results contain one entry per region and group. For each region and
+ * thread, the runtime of all groups is summed up. The counts of each group are
+ * scaled to that runtime, the coverage is the fraction of it the group was
+ * measured. */
+void
+markermux_extrapolate(LikwidResults* results, int numberOfRegions, int numberOfThreads, double** coverage)
+{
+    double* totalTime = NULL;
+    uint32_t* totalCount = NULL;
+    double* cov = NULL;
+
+    *coverage = NULL;
+    if (!markermux_active || numberOfRegions <= 0 || numberOfThreads <= 0)
+    {
+        return;
+    }
+    totalTime = malloc(numberOfRegions * numberOfThreads * sizeof(double));
+    totalCount = malloc(numberOfRegions * numberOfThreads * sizeof(uint32_t));
+    cov = malloc(numberOfRegions * numberOfThreads * sizeof(double));
+    if (!totalTime || !totalCount || !cov)
+    {
+        free(totalTime);
+        free(totalCount);
+        free(cov);
+        return;
+    }
+    for (int i = 0; i < numberOfRegions; i++)
+    {
+        int len = markermux_nameLength(results[i].tag);
+        for (int j = 0; j < numberOfThreads; j++)
+        {
+            totalTime[i*numberOfThreads+j] = 0;
+            totalCount[i*numberOfThreads+j] = 0;
+        }
+        for (int k = 0; k < numberOfRegions; k++)
+        {
+            if (markermux_nameLength(results[k].tag) != len ||
+                strncmp(bdata(results[i].tag), bdata(results[k].tag), len) != 0)
+            {
+                continue;
+            }
+            for (int j = 0; j < numberOfThreads; j++)
+            {
+                totalTime[i*numberOfThreads+j] += results[k].time[j];
+                totalCount[i*numberOfThreads+j] += results[k].count[j];
+            }
+        }
+    }
+    for (int i = 0; i < numberOfRegions; i++)
+    {
+        int group = results[i].groupID;
+        int nevents = MIN(groupSet->groups[group].numberOfEvents, NUM_PMC);
+        for (int j = 0; j < numberOfThreads; j++)
+        {
+            double total = totalTime[i*numberOfThreads+j];
+            double c = (total > 0 ? results[i].time[j] / total : 0.0);
+            cov[i*numberOfThreads+j] = c;
+            if (c <= 0)
+            {
+                continue;
+            }
+            for (int k = 0; k < nevents; k++)
+            {
+                if (!markermux_isGauge(group, k))
+                {
+                    results[i].counters[j][k] /= c;
+                }
+            }
+            results[i].time[j] = total;
+            results[i].count[j] = totalCount[i*numberOfThreads+j];
+        }
+    }
+    free(totalTime);
+    free(totalCount);
+    *coverage = cov;
+}
+
+void
+markermux_finalize(void)
+{
+    if (markermux_active && mm_switches == 0)
+    {
+        fprintf(stderr, "WARN: No group switch happened during multiplexing. Either the interval\n");
+        fprintf(stderr, "      is too long or a region is open the whole time, groups are only\n");
+        fprintf(stderr, "      switched when no region is open in any thread.\n");
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Multiplexing performed %lu group switches, mm_switches);
+}
@@ -0,0 +1,648 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_sampling.c
+ *
+ *      Description:  Event-based sampling of MarkerAPI regions. The instruction
+ *                    pointers are collected through the perf_event ring buffer
+ *                    and aggregated to histograms per thread and region.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <ghash.h>
+#include <bstrlib.h>
+#include <types.h>
+#include <error.h>
+#include <perfmon.h>
+#include <marker_sampling.h>
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int markersample_active = 0;
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define perf_event_open(attr, pid, cpu, group, flags) \
+    syscall(SYS_perf_event_open, attr, pid, cpu, group, flags)
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+typedef struct {
+    char name[64];
+    int group;
+    int event;
+    uint32_t type;
+    uint64_t config;
+    uint64_t period;
+} MarkerSampleEvent;
+
+typedef struct {
+    uint64_t ip;
+    uint64_t count;
+    int region;
+    int event;
+} MarkerSampleBin;
+
+typedef struct {
+    int fds[MARKERSAMPLE_MAX_EVENTS];
+    struct perf_event_mmap_page* buffers[MARKERSAMPLE_MAX_EVENTS];
+    uint64_t lost[MARKERSAMPLE_MAX_EVENTS];
+    uint64_t outside[MARKERSAMPLE_MAX_EVENTS];
+    int depth;
+    int skipped;
+    int stack[MARKERSAMPLE_MAX_DEPTH];
+    int numberOfRegions;
+    bstring* regions;
+    GHashTable* lookup;
+    int numberOfBins;
+    int size;
+    MarkerSampleBin* bins;
+} MarkerSampleThread;
+
+typedef struct {
+    char* name;
+    uint32_t type;
+    uint64_t config;
+} MarkerSampleGeneric;
+
+static MarkerSampleGeneric markersample_generic[] = {
+    {"cpu-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK},
+    {"task-clock", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static int ms_numThreads = 0;
+static int* ms_cpus = NULL;
+static int ms_numEvents = 0;
+static MarkerSampleEvent ms_events[MARKERSAMPLE_MAX_EVENTS];
+static MarkerSampleThread** ms_threads = NULL;
+static long ms_pagesize = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static int
+markersample_parseEvent(const char* str, MarkerSampleEvent* ev)
+{
+    char* period = NULL;
+    memset(ev, 0, sizeof(MarkerSampleEvent));
+    snprintf(ev->name, sizeof(ev->name), "%s", str);
+    period = strchr(ev->name, '@');
+    ev->period = MARKERSAMPLE_DEFAULT_PERIOD;
+    if (period)
+    {
+        *period = '\0';
+        ev->period = strtoull(period + 1, NULL, 0);
+        if (ev->period == 0)
+        {
+            ERROR_PRINT(Invalid sample period for event %s, ev->name);
+            return -EINVAL;
+        }
+    }
+    ev->group = -1;
+    ev->event = -1;
+    for (int i = 0; i < sizeof(markersample_generic)/sizeof(MarkerSampleGeneric); i++)
+    {
+        if (strcmp(ev->name, markersample_generic[i].name) == 0)
+        {
+            ev->type = markersample_generic[i].type;
+            ev->config = markersample_generic[i].config;
+#ifndef LIKWID_USE_PERFEVENT
+            /* The kernel would program the same counter registers */
+            if (ev->type != PERF_TYPE_SOFTWARE)
+            {
+                ERROR_PRINT(Sampling of hardware event %s requires the perf_event access mode, ev->name);
+                return -ENOTSUP;
+            }
+#endif
+            return 0;
+        }
+    }
+    for (int g = 0; g < groupSet->numberOfGroups; g++)
+    {
+        for (int e = 0; e < groupSet->groups[g].numberOfEvents; e++)
+        {
+            if (strcmp(ev->name, groupSet->groups[g].events[e].event.name) == 0)
+            {
+#ifdef LIKWID_USE_PERFEVENT
+                ev->group = g;
+                ev->event = e;
+                return 0;
+#else
+                ERROR_PRINT(Sampling of hardware event %s requires the perf_event access mode, ev->name);
+                return -ENOTSUP;
+#endif
+            }
+        }
+    }
+    ERROR_PRINT(Event %s is neither a software event nor an event of the event sets, ev->name);
+    return -EINVAL;
+}
+
+static void
+markersample_copy(struct perf_event_mmap_page* m, uint64_t offset, void* dst, size_t len)
+{
+    char* data = (char*)m + ms_pagesize;
+    uint64_t size = MARKERSAMPLE_DATA_PAGES * ms_pagesize;
+    uint64_t start = offset % size;
+    size_t first = MIN(len, size - start);
+    memcpy(dst, data + start, first);
+    if (first < len)
+    {
+        memcpy((char*)dst + first, data, len - first);
+    }
+}
+
+static int
+markersample_addBin(MarkerSampleThread* t, uint64_t ip, int region, int event)
+{
+    if (2 * (t->numberOfBins + 1) > t->size)
+    {
+        int newsize = (t->size > 0 ? 2 * t->size : 1024);
+        MarkerSampleBin* bins = calloc(newsize, sizeof(MarkerSampleBin));
+        if (!bins)
+        {
+            return -ENOMEM;
+        }
+        for (int i = 0; i < t->size; i++)
+        {
+            if (t->bins[i].count == 0)
+            {
+                continue;
+            }
+            MarkerSampleBin* b = &t->bins[i];
+            uint64_t h = (b->ip * 0x9E3779B97F4A7C15ULL) ^ (b->region << 4) ^ b->event;
+            while (bins[h & (newsize - 1)].count != 0)
+            {
+                h++;
+            }
+            bins[h & (newsize - 1)] = *b;
+        }
+        free(t->bins);
+        t->bins = bins;
+        t->size = newsize;
+    }
+    uint64_t h = (ip * 0x9E3779B97F4A7C15ULL) ^ (region << 4) ^ event;
+    while (1)
+    {
+        MarkerSampleBin* b = &t->bins[h & (t->size - 1)];
+        if (b->count == 0)
+        {
+            b->ip = ip;
+            b->region = region;
+            b->event = event;
+            b->count = 1;
+            t->numberOfBins++;
+            return 0;
+        }
+        if (b->ip == ip && b->region == region && b->event == event)
+        {
+            b->count++;
+            return 0;
+        }
+        h++;
+    }
+}
+
+/* All samples since the last region start or stop belong to the innermost
+ * region that was active in between. */
+static void
+markersample_drain(MarkerSampleThread* t)
+{
+    int region = (t->depth > 0 ? t->stack[t->depth-1] : -1);
+    for (int e = 0; e < ms_numEvents; e++)
+    {
+        struct perf_event_mmap_page* m = t->buffers[e];
+        if (!m)
+        {
+            continue;
+        }
+        uint64_t head = __atomic_load_n(&m->data_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = m->data_tail;
+        while (tail < head)
+        {
+            struct perf_event_header hdr;
+            uint64_t payload[2] = {0, 0};
+            markersample_copy(m, tail, &hdr, sizeof(hdr));
+            if (hdr.size == 0)
+            {
+                break;
+            }
+            markersample_copy(m, tail + sizeof(hdr), payload,
+                              MIN(sizeof(payload), hdr.size - sizeof(hdr)));
+            if (hdr.type == PERF_RECORD_SAMPLE)
+            {
+                if (region < 0 || markersample_addBin(t, payload[0], region, e) < 0)
+                {
+                    t->outside[e]++;
+                }
+            }
+            else if (hdr.type == PERF_RECORD_LOST)
+            {
+                t->lost[e] += payload[1];
+            }
+            tail += hdr.size;
+        }
+        __atomic_store_n(&m->data_tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+/* The sampling events are opened for the calling thread at its first region */
+static MarkerSampleThread*
+markersample_getThread(int threadId)
+{
+    if (threadId < 0 || threadId >= ms_numThreads)
+    {
+        return NULL;
+    }
+    MarkerSampleThread* t = ms_threads[threadId];
+    if (t)
+    {
+        return t;
+    }
+    t = malloc(sizeof(MarkerSampleThread));
+    if (!t)
+    {
+        return NULL;
+    }
+    memset(t, 0, sizeof(MarkerSampleThread));
+    t->lookup = g_hash_table_new(g_str_hash, g_str_equal);
+    ms_threads[threadId] = t;
+    for (int e = 0; e < ms_numEvents; e++)
+    {
+        struct perf_event_attr attr;
+        MarkerSampleEvent* ev = &ms_events[e];
+        t->fds[e] = -1;
+        memset(&attr, 0, sizeof(struct perf_event_attr));
+#ifdef LIKWID_USE_PERFEVENT
+        if (ev->group >= 0)
+        {
+            if (perfmon_getSamplingAttr(ev->group, ev->event, &attr) != 0)
+            {
+                ERROR_PRINT(Event %s cannot be used for sampling, ev->name);
+                continue;
+            }
+        }
+        else
+#endif
+        {
+            attr.type = ev->type;
+            attr.config = ev->config;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+        }
+        attr.size = sizeof(struct perf_event_attr);
+        attr.sample_period = ev->period;
+        attr.sample_type = PERF_SAMPLE_IP;
+        attr.disabled = 0;
+        attr.inherit = 0;
+        attr.pinned = 0;
+        int fd = perf_event_open(&attr, 0, -1, -1, 0);
+        if (fd < 0)
+        {
+            ERROR_PRINT(Cannot open sampling event %s on HW thread %d: %s, ev->name, ms_cpus[threadId], strerror(errno));
+            continue;
+        }
+        void* buf = mmap(NULL, (MARKERSAMPLE_DATA_PAGES + 1) * ms_pagesize,
+                         PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        if (buf == MAP_FAILED)
+        {
+            ERROR_PRINT(Cannot map sample buffer of event %s: %s, ev->name, strerror(errno));
+            close(fd);
+            continue;
+        }
+        t->fds[e] = fd;
+        t->buffers[e] = buf;
+    }
+    return t;
+}
+
+static int
+markersample_getRegion(MarkerSampleThread* t, const char* regionTag)
+{
+    gpointer idx = g_hash_table_lookup(t->lookup, regionTag);
+    if (idx != NULL)
+    {
+        return (int)((intptr_t)idx - 1);
+    }
+    bstring* regions = realloc(t->regions, (t->numberOfRegions + 1) * sizeof(bstring));
+    if (!regions)
+    {
+        return -ENOMEM;
+    }
+    t->regions = regions;
+    t->regions[t->numberOfRegions] = bformat("%.*s", 100, regionTag);
+    g_hash_table_insert(t->lookup, g_strdup(regionTag), (gpointer)((intptr_t)t->numberOfRegions + 1));
+    return t->numberOfRegions++;
+}
+
+static int
+markersample_compareBins(const void* a, const void* b)
+{
+    const MarkerSampleBin* x = a;
+    const MarkerSampleBin* y = b;
+    if (x->region != y->region)
+        return (x->region < y->region ? -1 : 1);
+    if (x->event != y->event)
+        return (x->event < y->event ? -1 : 1);
+    if (x->count != y->count)
+        return (x->count > y->count ? -1 : 1);
+    return 0;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+markersample_init(int numThreads, int* threadsToCpu, const char* spec)
+{
+    int err = 0;
+    if (!spec || strlen(spec) == 0)
+    {
+        return -EINVAL;
+    }
+    ms_numEvents = 0;
+    bstring bspec = bfromcstr(spec);
+    struct bstrList* list = bsplit(bspec, ',');
+    bdestroy(bspec);
+    for (int i = 0; i < list->qty; i++)
+    {
+        if (ms_numEvents == MARKERSAMPLE_MAX_EVENTS)
+        {
+            ERROR_PRINT(Only %d events can be sampled, MARKERSAMPLE_MAX_EVENTS);
+            break;
+        }
+        err = markersample_parseEvent(bdata(list->entry[i]), &ms_events[ms_numEvents]);
+        if (err < 0)
+        {
+            bstrListDestroy(list);
+            return err;
+        }
+        ms_numEvents++;
+    }
+    bstrListDestroy(list);
+    ms_pagesize = sysconf(_SC_PAGESIZE);
+    ms_numThreads = MIN(numThreads, MAX_NUM_THREADS);
+    ms_threads = calloc(ms_numThreads, sizeof(MarkerSampleThread*));
+    ms_cpus = malloc(ms_numThreads * sizeof(int));
+    if (!ms_threads || !ms_cpus)
+    {
+        free(ms_threads);
+        free(ms_cpus);
+        ms_threads = NULL;
+        ms_cpus = NULL;
+        return -ENOMEM;
+    }
+    memcpy(ms_cpus, threadsToCpu, ms_numThreads * sizeof(int));
+    markersample_active = 1;
+    return 0;
+}
+
+void
+markersample_regionStart(int threadId, const char* regionTag)
+{
+    MarkerSampleThread* t = markersample_getThread(threadId);
+    if (!t)
+    {
+        return;
+    }
+    markersample_drain(t);
+    if (t->depth == MARKERSAMPLE_MAX_DEPTH)
+    {
+        t->skipped++;
+        return;
+    }
+    int region = markersample_getRegion(t, regionTag);
+    if (region < 0)
+    {
+        return;
+    }
+    t->stack[t->depth++] = region;
+}
+
+void
+markersample_regionStop(int threadId, const char* regionTag)
+{
+    MarkerSampleThread* t = markersample_getThread(threadId);
+    if (!t)
+    {
+        return;
+    }
+    markersample_drain(t);
+    for (int i = t->depth - 1; i >= 0; i--)
+    {
+        if (strncmp(bdata(t->regions[t->stack[i]]), regionTag, 100) == 0)
+        {
+            for (int j = i; j < t->depth - 1; j++)
+            {
+                t->stack[j] = t->stack[j+1];
+            }
+            t->depth--;
+            break;
+        }
+    }
+}
+
+/* Histogram format:
+ * EVENT eventID name period
+ * MAP start-end offset path (executable mappings for offline symbolization)
+ * THREAD cpu eventID lost samplesOutsideOfRegions
+ * SAMPLE regionTag cpu eventID count ip path+offset
+ * The samples are sorted by region, event and descending count. */
+int
+markersample_write(const char* filename)
+{
+    char line[1024];
+    char fname[256];
+    int numberOfMaps = 0;
+    struct { uint64_t start; uint64_t end; uint64_t offset; bstring path; } maps[512];
+
+    if (!markersample_active)
+    {
+        return 0;
+    }
+    if (!filename)
+    {
+        snprintf(fname, sizeof(fname), "likwid_samples_%d.txt", getpid());
+        filename = fname;
+    }
+    FILE* file = fopen(filename, "w");
+    if (!file)
+    {
+        int err = -errno;
+        ERROR_PRINT(Cannot open sample file %s, filename);
+        return err;
+    }
+    fprintf(file, "# LIKWID IP sampling of process %d\n", getpid());
+    for (int e = 0; e < ms_numEvents; e++)
+    {
+        fprintf(file, "EVENT %d %s %llu\n", e, ms_events[e].name, LLU_CAST ms_events[e].period);
+    }
+    FILE* fp = fopen("/proc/self/maps", "r");
+    while (fp && fgets(line, sizeof(line), fp) != NULL && numberOfMaps < 512)
+    {
+        unsigned long start = 0, end = 0, offset = 0;
+        char perms[8];
+        char path[512];
+        path[0] = '\0';
+        if (sscanf(line, "%lx-%lx %7s %lx %*s %*s %511s", &start, &end, perms, &offset, path) < 4)
+        {
+            continue;
+        }
+        if (perms[2] != 'x' || path[0] == '\0')
+        {
+            continue;
+        }
+        maps[numberOfMaps].start = start;
+        maps[numberOfMaps].end = end;
+        maps[numberOfMaps].offset = offset;
+        maps[numberOfMaps].path = bfromcstr(path);
+        fprintf(file, "MAP %lx-%lx %lx %s\n", start, end, offset, path);
+        numberOfMaps++;
+    }
+    if (fp)
+    {
+        fclose(fp);
+    }
+    for (int i = 0; i < ms_numThreads; i++)
+    {
+        MarkerSampleThread* t = ms_threads[i];
+        if (!t)
+        {
+            continue;
+        }
+        markersample_drain(t);
+        for (int e = 0; e < ms_numEvents; e++)
+        {
+            fprintf(file, "THREAD %d %d %llu %llu\n", ms_cpus[i], e, LLU_CAST t->lost[e], LLU_CAST t->outside[e]);
+            if (t->lost[e] > 0)
+            {
+                fprintf(stderr, "WARN: %llu samples of event %s on HW thread %d were lost\n",
+                        LLU_CAST t->lost[e], ms_events[e].name, ms_cpus[i]);
+            }
+        }
+        if (t->skipped > 0)
+        {
+            fprintf(stderr, "WARN: %d region calls on HW thread %d exceeded the maximal nesting depth of %d\n",
+                    t->skipped, ms_cpus[i], MARKERSAMPLE_MAX_DEPTH);
+        }
+        MarkerSampleBin* bins = malloc((t->numberOfBins + 1) * sizeof(MarkerSampleBin));
+        if (!bins)
+        {
+            continue;
+        }
+        int n = 0;
+        for (int j = 0; j < t->size; j++)
+        {
+            if (t->bins[j].count > 0)
+            {
+                bins[n++] = t->bins[j];
+            }
+        }
+        qsort(bins, n, sizeof(MarkerSampleBin), markersample_compareBins);
+        for (int j = 0; j < n; j++)
+        {
+            int m = 0;
+            for (m = 0; m < numberOfMaps; m++)
+            {
+                if (bins[j].ip >= maps[m].start && bins[j].ip < maps[m].end)
+                {
+                    break;
+                }
+            }
+            fprintf(file, "SAMPLE %s %d %d %llu 0x%llx ", bdata(t->regions[bins[j].region]),
+                          ms_cpus[i], bins[j].event, LLU_CAST bins[j].count, LLU_CAST bins[j].ip);
+            if (m < numberOfMaps)
+            {
+                fprintf(file, "%s+0x%llx\n", bdata(maps[m].path), LLU_CAST (bins[j].ip - maps[m].start + maps[m].offset));
+            }
+            else
+            {
+                fprintf(file, "[unknown]\n");
+            }
+        }
+        free(bins);
+    }
+    for (int m = 0; m < numberOfMaps; m++)
+    {
+        bdestroy(maps[m].path);
+    }
+    fclose(file);
+    return 0;
+}
+
+void
+markersample_finalize(void)
+{
+    for (int i = 0; ms_threads && i < ms_numThreads; i++)
+    {
+        MarkerSampleThread* t = ms_threads[i];
+        if (!t)
+        {
+            continue;
+        }
+        for (int e = 0; e < ms_numEvents; e++)
+        {
+            if (t->buffers[e])
+            {
+                munmap(t->buffers[e], (MARKERSAMPLE_DATA_PAGES + 1) * ms_pagesize);
+            }
+            if (t->fds[e] >= 0)
+            {
+                close(t->fds[e]);
+            }
+        }
+        for (int j = 0; j < t->numberOfRegions; j++)
+        {
+            bdestroy(t->regions[j]);
+        }
+        free(t->regions);
+        free(t->bins);
+        g_hash_table_destroy(t->lookup);
+        free(t);
+    }
+    free(ms_threads);
+    free(ms_cpus);
+    ms_threads = NULL;
+    ms_cpus = NULL;
+    ms_numThreads = 0;
+    ms_numEvents = 0;
+    markersample_active = 0;
+}
@@ -0,0 +1,434 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_tree.c
+ *
+ *      Description:  Call-path tree of nested MarkerAPI regions with inclusive and
+ *                    exclusive time and counts per node.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <ghash.h>
+#include <bstrlib.h>
+#include <types.h>
+#include <error.h>
+#include <perfmon.h>
+#include <marker_tree.h>
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int markertree_active = 0;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+typedef struct {
+    bstring tag;
+    int parent;
+    int groupID;
+    int nevents;
+    uint32_t count;
+    double inclTime;
+    double exclTime;
+    double* incl;
+    double* excl;
+} MarkerTreeNode;
+
+typedef struct {
+    int node;
+    double childTime;
+    double* child;
+} MarkerTreeFrame;
+
+typedef struct {
+    int numberOfNodes;
+    int size;
+    MarkerTreeNode* nodes;
+    int depth;
+    int skipped;
+    MarkerTreeFrame frames[MARKERTREE_MAX_DEPTH];
+    double* deltas;
+    double* buffer;
+    GHashTable* lookup;
+} MarkerTreeThread;
+
+static int mt_numThreads = 0;
+static int mt_maxEvents = 0;
+static int* mt_cpus = NULL;
+static MarkerTreeThread** mt_threads = NULL;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static int
+markertree_isGauge(int group, int event)
+{
+    RegisterType type = counter_map[groupSet->groups[group].events[event].index].type;
+    return (type == THERMAL || type == VOLTAGE || type == MBOX0TMP);
+}
+
+static MarkerTreeThread*
+markertree_getThread(int threadId)
+{
+    if (threadId < 0 || threadId >= mt_numThreads)
+    {
+        return NULL;
+    }
+    MarkerTreeThread* t = mt_threads[threadId];
+    if (t)
+    {
+        return t;
+    }
+    t = malloc(sizeof(MarkerTreeThread));
+    if (!t)
+    {
+        return NULL;
+    }
+    memset(t, 0, sizeof(MarkerTreeThread));
+    t->deltas = calloc(mt_maxEvents, sizeof(double));
+    /* All frame buffers in one allocation, frame 0 owns it */
+    double* child = calloc(MARKERTREE_MAX_DEPTH * mt_maxEvents, sizeof(double));
+    if (!t->deltas || !child)
+    {
+        ERROR_PLAIN_PRINT(Cannot allocate region tree of thread);
+        free(t->deltas);
+        free(child);
+        free(t);
+        return NULL;
+    }
+    t->buffer = child;
+    for (int i = 0; i < MARKERTREE_MAX_DEPTH; i++)
+    {
+        t->frames[i].child = child + i * mt_maxEvents;
+    }
+    t->lookup = g_hash_table_new(g_str_hash, g_str_equal);
+    mt_threads[threadId] = t;
+    return t;
+}
+
+static int
+markertree_getNode(MarkerTreeThread* t, int parent, const char* regionTag, int groupId)
+{
+    char key[256];
+    snprintf(key, sizeof(key), "%d:%.*s-%d", parent, 200, regionTag, groupId);
+    gpointer idx = g_hash_table_lookup(t->lookup, key);
+    if (idx != NULL)
+    {
+        return (int)((intptr_t)idx - 1);
+    }
+    if (t->numberOfNodes == t->size)
+    {
+        int newsize = (t->size > 0 ? 2 * t->size : 16);
+        MarkerTreeNode* nodes = realloc(t->nodes, newsize * sizeof(MarkerTreeNode));
+        if (!nodes)
+        {
+            return -ENOMEM;
+        }
+        t->nodes = nodes;
+        t->size = newsize;
+    }
+    MarkerTreeNode* n = &t->nodes[t->numberOfNodes];
+    n->nevents = groupSet->groups[groupId].numberOfEvents;
+    n->incl = calloc(n->nevents + 1, sizeof(double));
+    n->excl = calloc(n->nevents + 1, sizeof(double));
+    if (!n->incl || !n->excl)
+    {
+        free(n->incl);
+        free(n->excl);
+        return -ENOMEM;
+    }
+    n->tag = bformat("%.*s", 100, regionTag);
+    n->parent = parent;
+    n->groupID = groupId;
+    n->count = 0;
+    n->inclTime = 0;
+    n->exclTime = 0;
+    g_hash_table_insert(t->lookup, g_strdup(key), (gpointer)((intptr_t)t->numberOfNodes + 1));
+    return t->numberOfNodes++;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+markertree_init(int numThreads, int* threadsToCpu, int maxEvents)
+{
+    mt_numThreads = MIN(numThreads, MAX_NUM_THREADS);
+    mt_maxEvents = MAX(maxEvents, 1);
+    mt_threads = calloc(mt_numThreads, sizeof(MarkerTreeThread*));
+    mt_cpus = malloc(mt_numThreads * sizeof(int));
+    if (!mt_threads || !mt_cpus)
+    {
+        free(mt_threads);
+        free(mt_cpus);
+        mt_threads = NULL;
+        mt_cpus = NULL;
+        return -ENOMEM;
+    }
+    memcpy(mt_cpus, threadsToCpu, mt_numThreads * sizeof(int));
+    markertree_active = 1;
+    return 0;
+}
+
+void
+markertree_regionStart(int threadId, const char* regionTag, int groupId)
+{
+    MarkerTreeThread* t = markertree_getThread(threadId);
+    if (!t)
+    {
+        return;
+    }
+    if (t->depth == MARKERTREE_MAX_DEPTH)
+    {
+        t->skipped++;
+        return;
+    }
+    int parent = (t->depth > 0 ? t->frames[t->depth-1].node : -1);
+    int node = markertree_getNode(t, parent, regionTag, groupId);
+    if (node < 0)
+    {
+        return;
+    }
+    MarkerTreeFrame* f = &t->frames[t->depth];
+    f->node = node;
+    f->childTime = 0;
+    memset(f->child, 0, mt_maxEvents * sizeof(double));
+    t->depth++;
+}
+
+double*
+markertree_deltas(int threadId)
+{
+    MarkerTreeThread* t = markertree_getThread(threadId);
+    return (t ? t->deltas : NULL);
+}
+
+/* The deltas of the region call are expected in markertree_deltas(threadId).
+ * Usually the stopped region is the innermost one. If regions overlap without
+ * nesting, the matching frame is taken out of the stack. */
+void
+markertree_regionStop(int threadId, const char* regionTag, int groupId, double time)
+{
+    MarkerTreeThread* t = markertree_getThread(threadId);
+    int level = -1;
+    if (!t)
+    {
+        return;
+    }
+    for (int i = t->depth - 1; i >= 0; i--)
+    {
+        MarkerTreeNode* n = &t->nodes[t->frames[i].node];
+        if (n->groupID == groupId && strncmp(bdata(n->tag), regionTag, 100) == 0)
+        {
+            level = i;
+            break;
+        }
+    }
+    if (level < 0)
+    {
+        return;
+    }
+    MarkerTreeFrame* f = &t->frames[level];
+    MarkerTreeNode* n = &t->nodes[f->node];
+    n->count++;
+    n->inclTime += time;
+    n->exclTime += time - f->childTime;
+    for (int e = 0; e < n->nevents && e < mt_maxEvents; e++)
+    {
+        if (markertree_isGauge(groupId, e))
+        {
+            n->incl[e] = t->deltas[e];
+            n->excl[e] = t->deltas[e];
+        }
+        else
+        {
+            n->incl[e] += t->deltas[e];
+            n->excl[e] += t->deltas[e] - f->child[e];
+        }
+    }
+    if (level > 0)
+    {
+        MarkerTreeFrame* p = &t->frames[level-1];
+        p->childTime += time;
+        for (int e = 0; e < n->nevents && e < mt_maxEvents; e++)
+        {
+            if (!markertree_isGauge(groupId, e))
+            {
+                p->child[e] += t->deltas[e];
+            }
+        }
+    }
+    /* Keep the buffers of the removed frame for reuse */
+    double* child = f->child;
+    for (int i = level; i < t->depth - 1; i++)
+    {
+        t->frames[i] = t->frames[i+1];
+    }
+    t->depth--;
+    t->frames[t->depth].child = child;
+}
+
+/* Tree format, appended to the marker file:
+ * N nodeID parentID groupID regionTag
+ * P nodeID cpu count inclusiveTime exclusiveTime nevents inclusive counts exclusive counts
+ * Nodes of all threads with the same call path get the same ID. The tree is
+ * only written if regions were nested. */
+void
+markertree_write(FILE* file)
+{
+    int nested = 0;
+    int numberOfNodes = 0;
+    int** ids = NULL;
+    GHashTable* global = NULL;
+
+    if (!markertree_active || !file)
+    {
+        return;
+    }
+    for (int i = 0; i < mt_numThreads; i++)
+    {
+        MarkerTreeThread* t = mt_threads[i];
+        for (int j = 0; t && j < t->numberOfNodes; j++)
+        {
+            if (t->nodes[j].parent >= 0)
+            {
+                nested = 1;
+            }
+        }
+        if (t && t->skipped > 0)
+        {
+            fprintf(stderr, "WARN: %d region calls on HW thread %d exceeded the maximal nesting depth of %d\n",
+                    t->skipped, mt_cpus[i], MARKERTREE_MAX_DEPTH);
+        }
+    }
+    if (!nested)
+    {
+        return;
+    }
+    ids = calloc(mt_numThreads, sizeof(int*));
+    global = g_hash_table_new(g_str_hash, g_str_equal);
+    if (!ids || !global)
+    {
+        free(ids);
+        return;
+    }
+    for (int i = 0; i < mt_numThreads; i++)
+    {
+        MarkerTreeThread* t = mt_threads[i];
+        if (!t || t->numberOfNodes == 0)
+        {
+            continue;
+        }
+        ids[i] = malloc(t->numberOfNodes * sizeof(int));
+        if (!ids[i])
+        {
+            continue;
+        }
+        /* Parents are always created before their children */
+        for (int j = 0; j < t->numberOfNodes; j++)
+        {
+            MarkerTreeNode* n = &t->nodes[j];
+            int parent = (n->parent >= 0 ? ids[i][n->parent] : -1);
+            bstring key = bformat("%d:%s-%d", parent, bdata(n->tag), n->groupID);
+            gpointer idx = g_hash_table_lookup(global, bdata(key));
+            if (idx == NULL)
+            {
+                ids[i][j] = numberOfNodes++;
+                g_hash_table_insert(global, g_strdup(bdata(key)), (gpointer)((intptr_t)ids[i][j] + 1));
+                fprintf(file, "N %d %d %d %s\n", ids[i][j], parent, n->groupID, bdata(n->tag));
+            }
+            else
+            {
+                ids[i][j] = (int)((intptr_t)idx - 1);
+            }
+            bdestroy(key);
+        }
+    }
+    for (int i = 0; i < mt_numThreads; i++)
+    {
+        MarkerTreeThread* t = mt_threads[i];
+        if (!t || !ids[i])
+        {
+            continue;
+        }
+        for (int j = 0; j < t->numberOfNodes; j++)
+        {
+            MarkerTreeNode* n = &t->nodes[j];
+            if (n->count == 0)
+            {
+                continue;
+            }
+            fprintf(file, "P %d %d %u %e %e %d", ids[i][j], mt_cpus[i], n->count,
+                          n->inclTime, n->exclTime, n->nevents);
+            for (int e = 0; e < n->nevents; e++)
+            {
+                fprintf(file, " %e", n->incl[e]);
+            }
+            for (int e = 0; e < n->nevents; e++)
+            {
+                fprintf(file, " %e", n->excl[e]);
+            }
+            fprintf(file, "\n");
+        }
+        free(ids[i]);
+    }
+    free(ids);
+    g_hash_table_destroy(global);
+}
+
+void
+markertree_finalize(void)
+{
+    for (int i = 0; mt_threads && i < mt_numThreads; i++)
+    {
+        MarkerTreeThread* t = mt_threads[i];
+        if (!t)
+        {
+            continue;
+        }
+        for (int j = 0; j < t->numberOfNodes; j++)
+        {
+            bdestroy(t->nodes[j].tag);
+            free(t->nodes[j].incl);
+            free(t->nodes[j].excl);
+        }
+        free(t->buffer);
+        free(t->nodes);
+        free(t->deltas);
+        g_hash_table_destroy(t->lookup);
+        free(t);
+    }
+    free(mt_threads);
+    free(mt_cpus);
+    mt_threads = NULL;
+    mt_cpus = NULL;
+    mt_numThreads = 0;
+    markertree_active = 0;
+}
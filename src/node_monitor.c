@@ -0,0 +1,900 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  node_monitor.c
+ *
+ *      Description:  Node monitoring daemon. Rotates through event sets, keeps a
+ *                    rolling window of per-CPU and per-socket metrics in shared
+ *                    memory and serves snapshots over a UNIX socket as JSON or
+ *                    Prometheus text.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <bstrlib.h>
+#include <types.h>
+#include <error.h>
+#include <likwid.h>
+#include <lock.h>
+#include <topology.h>
+#include <perfmon.h>
+#include <node_monitor.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define NODEMON_ALIGN(x) (((x) + 63) & ~((size_t)63))
+/* Time in ms a connected client gets for sending the request and receiving
+ * the reply, the sampling loop is blocked meanwhile */
+#define NODEMON_REQUEST_TIMEOUT 200
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+static volatile sig_atomic_t nm_stop = 0;
+static NodeMonitorHeader* nm_header = NULL;
+static char nm_shmName[NAME_MAX];
+static int nm_socketCpu[MAX_NUM_NODES];
+static int nm_numDomains = 0;
+static PowerType nm_domains[2];
+static int nm_thermal = 0;
+static double nm_cpuFraction = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+nodemon_handler(int sig)
+{
+    nm_stop = 1;
+}
+
+static double
+nodemon_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static double
+nodemon_cpuTime(void)
+{
+    struct rusage r;
+    getrusage(RUSAGE_SELF, &r);
+    return r.ru_utime.tv_sec + r.ru_utime.tv_usec * 1E-6 +
+           r.ru_stime.tv_sec + r.ru_stime.tv_usec * 1E-6;
+}
+
+static NodeMonitorThread*
+nodemon_threads(void)
+{
+    return (NodeMonitorThread*)((char*)nm_header + nm_header->threadsOffset);
+}
+
+static NodeMonitorGroup*
+nodemon_group(int g)
+{
+    return &((NodeMonitorGroup*)((char*)nm_header + nm_header->groupsOffset))[g];
+}
+
+static char*
+nodemon_metricName(NodeMonitorGroup* grp, int m)
+{
+    return (char*)nm_header + grp->metricsOffset + m * NODEMON_NAME_LENGTH;
+}
+
+static NodeMonitorSample*
+nodemon_sample(NodeMonitorGroup* grp, uint64_t idx)
+{
+    return (NodeMonitorSample*)((char*)nm_header + grp->samplesOffset +
+                                (idx % nm_header->windowSize) * grp->sampleSize);
+}
+
+static int
+nodemon_createShm(const char* name, int numberOfGroups, const int* groupIds,
+                  int windowSize, double interval)
+{
+    int nthreads = perfmon_getNumberOfThreads();
+    int nsockets = 0;
+    int socketPkg[MAX_NUM_NODES];
+    int threadSocket[MAX_NUM_THREADS];
+    size_t size = NODEMON_ALIGN(sizeof(NodeMonitorHeader));
+    size_t threadsOffset = size;
+    size += NODEMON_ALIGN(nthreads * sizeof(NodeMonitorThread));
+    size_t groupsOffset = size;
+    size += NODEMON_ALIGN(numberOfGroups * sizeof(NodeMonitorGroup));
+
+    for (int t = 0; t < nthreads && t < MAX_NUM_THREADS; t++)
+    {
+        int cpu = groupSet->threads[t].processorId;
+        int pkg = -1;
+        for (int j = 0; j < (int)cpuid_topology.numHWThreads; j++)
+        {
+            if (cpuid_topology.threadPool[j].apicId == (uint32_t)cpu)
+            {
+                pkg = cpuid_topology.threadPool[j].packageId;
+                break;
+            }
+        }
+        threadSocket[t] = -1;
+        for (int s = 0; s < nsockets; s++)
+        {
+            if (socketPkg[s] == pkg)
+            {
+                threadSocket[t] = s;
+                break;
+            }
+        }
+        if (threadSocket[t] < 0 && nsockets < MAX_NUM_NODES)
+        {
+            nm_socketCpu[nsockets] = cpu;
+            socketPkg[nsockets] = pkg;
+            threadSocket[t] = nsockets++;
+        }
+    }
+    size_t groupSizes[numberOfGroups];
+    for (int g = 0; g < numberOfGroups; g++)
+    {
+        int nmetrics = perfmon_getNumberOfMetrics(groupIds[g]);
+        int nvalues = (nthreads + 2 * nsockets) * nmetrics + nsockets * NODEMON_SOCKET_VALUES;
+        groupSizes[g] = NODEMON_ALIGN(sizeof(NodeMonitorSample) + nvalues * sizeof(double));
+        size += NODEMON_ALIGN(nmetrics * NODEMON_NAME_LENGTH);
+        size += windowSize * groupSizes[g];
+    }
+
+    snprintf(nm_shmName, sizeof(nm_shmName), "%s", name);
+    int fd = shm_open(nm_shmName, O_CREAT|O_RDWR|O_TRUNC, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if (fd < 0)
+    {
+        int err = -errno;
+        ERROR_PRINT(Cannot create shared memory segment %s, nm_shmName);
+        return err;
+    }
+    fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+    if (ftruncate(fd, size) != 0)
+    {
+        int err = -errno;
+        close(fd);
+        shm_unlink(nm_shmName);
+        return err;
+    }
+    void* mem = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+        int err = -errno;
+        shm_unlink(nm_shmName);
+        return err;
+    }
+    memset(mem, 0, size);
+    nm_header = mem;
+    nm_header->version = NODEMON_VERSION;
+    nm_header->pid = getpid();
+    nm_header->numberOfThreads = nthreads;
+    nm_header->numberOfSockets = nsockets;
+    nm_header->numberOfGroups = numberOfGroups;
+    nm_header->windowSize = windowSize;
+    nm_header->interval = interval;
+    nm_header->threadsOffset = threadsOffset;
+    nm_header->groupsOffset = groupsOffset;
+    nm_header->size = size;
+    for (int t = 0; t < nthreads; t++)
+    {
+        nodemon_threads()[t].cpu = groupSet->threads[t].processorId;
+        nodemon_threads()[t].socket = threadSocket[t];
+    }
+    size_t offset = groupsOffset + NODEMON_ALIGN(numberOfGroups * sizeof(NodeMonitorGroup));
+    for (int g = 0; g < numberOfGroups; g++)
+    {
+        NodeMonitorGroup* grp = nodemon_group(g);
+        int nmetrics = perfmon_getNumberOfMetrics(groupIds[g]);
+        snprintf(grp->name, NODEMON_NAME_LENGTH, "%s", perfmon_getGroupName(groupIds[g]));
+        grp->numberOfMetrics = nmetrics;
+        grp->numberOfValues = (nthreads + 2 * nsockets) * nmetrics + nsockets * NODEMON_SOCKET_VALUES;
+        grp->metricsOffset = offset;
+        for (int m = 0; m < nmetrics; m++)
+        {
+            snprintf(nodemon_metricName(grp, m), NODEMON_NAME_LENGTH, "%s",
+                     perfmon_getMetricName(groupIds[g], m));
+        }
+        offset += NODEMON_ALIGN(nmetrics * NODEMON_NAME_LENGTH);
+        grp->samplesOffset = offset;
+        grp->sampleSize = groupSizes[g];
+        offset += windowSize * groupSizes[g];
+    }
+    __atomic_store_n(&nm_header->magic, NODEMON_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void
+nodemon_store(int g, int groupId, double timestamp, double* socketValues)
+{
+    NodeMonitorGroup* grp = nodemon_group(g);
+    NodeMonitorSample* s = nodemon_sample(grp, grp->written);
+    int nthreads = nm_header->numberOfThreads;
+    int nsockets = nm_header->numberOfSockets;
+    int nmetrics = grp->numberOfMetrics;
+    double* sums = s->values + nthreads * nmetrics;
+    double* avgs = sums + nsockets * nmetrics;
+    int counts[MAX_NUM_NODES];
+
+    uint32_t seq = s->seq;
+    __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->timestamp = timestamp;
+    s->runtime = perfmon_getLastTimeOfGroup(groupId);
+    memset(sums, 0, 2 * nsockets * nmetrics * sizeof(double));
+    memset(counts, 0, nsockets * sizeof(int));
+    for (int t = 0; t < nthreads; t++)
+    {
+        int socket = nodemon_threads()[t].socket;
+        counts[socket]++;
+        for (int m = 0; m < nmetrics; m++)
+        {
+            double v = perfmon_getLastMetric(groupId, m, t);
+            s->values[t * nmetrics + m] = v;
+            sums[socket * nmetrics + m] += v;
+        }
+    }
+    for (int i = 0; i < nsockets; i++)
+    {
+        for (int m = 0; m < nmetrics; m++)
+        {
+            avgs[i * nmetrics + m] = sums[i * nmetrics + m] / MAX(counts[i], 1);
+        }
+    }
+    memcpy(avgs + nsockets * nmetrics, socketValues, nsockets * NODEMON_SOCKET_VALUES * sizeof(double));
+    __atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&grp->written, grp->written + 1, __ATOMIC_RELEASE);
+}
+
+static void
+nodemon_jsonNumber(bstring out, double v)
+{
+    if (isnan(v) || isinf(v))
+        bcatcstr(out, "null");
+    else
+        bformata(out, "%.17g", v);
+}
+
+static void
+nodemon_jsonList(bstring out, double* values, int count)
+{
+    bconchar(out, '[');
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0)
+            bconchar(out, ',');
+        nodemon_jsonNumber(out, values[i]);
+    }
+    bconchar(out, ']');
+}
+
+static void
+nodemon_jsonString(bstring out, const char* s)
+{
+    bconchar(out, '"');
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            bformata(out, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            bformata(out, "\\u%04x", *s);
+        else
+            bconchar(out, *s);
+    }
+    bconchar(out, '"');
+}
+
+static void
+nodemon_jsonSample(bstring out, NodeMonitorGroup* grp, NodeMonitorSample* s)
+{
+    int nthreads = nm_header->numberOfThreads;
+    int nsockets = nm_header->numberOfSockets;
+    int nmetrics = grp->numberOfMetrics;
+    double* sums = s->values + nthreads * nmetrics;
+    double* avgs = sums + nsockets * nmetrics;
+    double* extra = avgs + nsockets * nmetrics;
+
+    bcatcstr(out, "{\"timestamp\":");
+    nodemon_jsonNumber(out, s->timestamp);
+    bcatcstr(out, ",\"runtime\":");
+    nodemon_jsonNumber(out, s->runtime);
+    bcatcstr(out, ",\"cpus\":{");
+    for (int t = 0; t < nthreads; t++)
+    {
+        bformata(out, "%s\"%d\":", (t > 0 ? "," : ""), nodemon_threads()[t].cpu);
+        nodemon_jsonList(out, &s->values[t * nmetrics], nmetrics);
+    }
+    bcatcstr(out, "},\"sockets\":{");
+    for (int i = 0; i < nsockets; i++)
+    {
+        bformata(out, "%s\"%d\":{\"sum\":", (i > 0 ? "," : ""), i);
+        nodemon_jsonList(out, &sums[i * nmetrics], nmetrics);
+        bcatcstr(out, ",\"avg\":");
+        nodemon_jsonList(out, &avgs[i * nmetrics], nmetrics);
+        bcatcstr(out, ",\"power_pkg\":");
+        nodemon_jsonNumber(out, extra[i * NODEMON_SOCKET_VALUES]);
+        bcatcstr(out, ",\"power_dram\":");
+        nodemon_jsonNumber(out, extra[i * NODEMON_SOCKET_VALUES + 1]);
+        bcatcstr(out, ",\"temperature\":");
+        nodemon_jsonNumber(out, extra[i * NODEMON_SOCKET_VALUES + 2]);
+        bconchar(out, '}');
+    }
+    bcatcstr(out, "}}");
+}
+
+/* {"pid":..,"interval":..,"cpu_fraction":..,"groups":{"<name>":{"metrics":[..],
+ * "latest":<sample>}}} or with "window":[<samples>] from oldest to latest */
+static void
+nodemon_json(bstring out, int window)
+{
+    bformata(out, "{\"pid\":%d,\"interval\":", nm_header->pid);
+    nodemon_jsonNumber(out, nm_header->interval);
+    bcatcstr(out, ",\"cpu_fraction\":");
+    nodemon_jsonNumber(out, nm_cpuFraction);
+    bcatcstr(out, ",\"groups\":{");
+    for (int g = 0; g < nm_header->numberOfGroups; g++)
+    {
+        NodeMonitorGroup* grp = nodemon_group(g);
+        uint64_t written = grp->written;
+        uint64_t first = (window && written > nm_header->windowSize ? written - nm_header->windowSize : written - 1);
+        if (g > 0)
+            bconchar(out, ',');
+        nodemon_jsonString(out, grp->name);
+        bcatcstr(out, ":{\"metrics\":[");
+        for (int m = 0; m < grp->numberOfMetrics; m++)
+        {
+            if (m > 0)
+                bconchar(out, ',');
+            nodemon_jsonString(out, nodemon_metricName(grp, m));
+        }
+        bcatcstr(out, (window ? "],\"window\":[" : "],\"latest\":"));
+        if (written == 0)
+        {
+            bcatcstr(out, (window ? "]}" : "null}"));
+            continue;
+        }
+        for (uint64_t i = (window ? 0 : written - 1); window ? (i < written) : (i < written); i++)
+        {
+            if (window && i < first)
+                continue;
+            if (window && i > first)
+                bconchar(out, ',');
+            nodemon_jsonSample(out, grp, nodemon_sample(grp, i));
+        }
+        bcatcstr(out, (window ? "]}" : "}"));
+    }
+    bcatcstr(out, "}}\n");
+}
+
+static void
+nodemon_promLabel(bstring out, const char* s)
+{
+    bconchar(out, '"');
+    for (; *s; s++)
+    {
+        if (*s == '"' || *s == '\\')
+            bformata(out, "\\%c", *s);
+        else if (*s == '\n')
+            bcatcstr(out, "\\n");
+        else
+            bconchar(out, *s);
+    }
+    bconchar(out, '"');
+}
+
+static void
+nodemon_promValue(bstring out, double v)
+{
+    if (isnan(v))
+        bcatcstr(out, " NaN\n");
+    else if (isinf(v))
+        bcatcstr(out, (v > 0 ? " +Inf\n" : " -Inf\n"));
+    else
+        bformata(out, " %.17g\n", v);
+}
+
+static void
+nodemon_prometheus(bstring out)
+{
+    int nthreads = nm_header->numberOfThreads;
+    int nsockets = nm_header->numberOfSockets;
+    const char* socketNames[NODEMON_SOCKET_VALUES] = {"likwid_socket_power_pkg_watts",
+                                                      "likwid_socket_power_dram_watts",
+                                                      "likwid_socket_temperature_celsius"};
+    NodeMonitorSample* newest = NULL;
+    NodeMonitorGroup* newestGroup = NULL;
+
+    bcatcstr(out, "# HELP likwid_metric Latest value of a LIKWID metric per hardware thread\n");
+    bcatcstr(out, "# TYPE likwid_metric gauge\n");
+    for (int g = 0; g < nm_header->numberOfGroups; g++)
+    {
+        NodeMonitorGroup* grp = nodemon_group(g);
+        if (grp->written == 0)
+            continue;
+        NodeMonitorSample* s = nodemon_sample(grp, grp->written - 1);
+        if (!newest || s->timestamp > newest->timestamp)
+        {
+            newest = s;
+            newestGroup = grp;
+        }
+        for (int t = 0; t < nthreads; t++)
+        {
+            for (int m = 0; m < grp->numberOfMetrics; m++)
+            {
+                bcatcstr(out, "likwid_metric{group=");
+                nodemon_promLabel(out, grp->name);
+                bcatcstr(out, ",metric=");
+                nodemon_promLabel(out, nodemon_metricName(grp, m));
+                bformata(out, ",cpu=\"%d\"}", nodemon_threads()[t].cpu);
+                nodemon_promValue(out, s->values[t * grp->numberOfMetrics + m]);
+            }
+        }
+    }
+    for (int k = 0; k < 2; k++)
+    {
+        bformata(out, "# HELP likwid_socket_metric_%s %s of a LIKWID metric over the hardware threads of a socket\n",
+                 (k == 0 ? "sum" : "avg"), (k == 0 ? "Sum" : "Average"));
+        bformata(out, "# TYPE likwid_socket_metric_%s gauge\n", (k == 0 ? "sum" : "avg"));
+        for (int g = 0; g < nm_header->numberOfGroups; g++)
+        {
+            NodeMonitorGroup* grp = nodemon_group(g);
+            if (grp->written == 0)
+                continue;
+            NodeMonitorSample* s = nodemon_sample(grp, grp->written - 1);
+            double* values = s->values + (nthreads + k * nsockets) * grp->numberOfMetrics;
+            for (int i = 0; i < nsockets; i++)
+            {
+                for (int m = 0; m < grp->numberOfMetrics; m++)
+                {
+                    bformata(out, "likwid_socket_metric_%s{group=", (k == 0 ? "sum" : "avg"));
+                    nodemon_promLabel(out, grp->name);
+                    bcatcstr(out, ",metric=");
+                    nodemon_promLabel(out, nodemon_metricName(grp, m));
+                    bformata(out, ",socket=\"%d\"}", i);
+                    nodemon_promValue(out, values[i * grp->numberOfMetrics + m]);
+                }
+            }
+        }
+    }
+    if (newest)
+    {
+        double* extra = newest->values + (nthreads + 2 * nsockets) * newestGroup->numberOfMetrics;
+        for (int k = 0; k < NODEMON_SOCKET_VALUES; k++)
+        {
+            bformata(out, "# TYPE %s gauge\n", socketNames[k]);
+            for (int i = 0; i < nsockets; i++)
+            {
+                bformata(out, "%s{socket=\"%d\"}", socketNames[k], i);
+                nodemon_promValue(out, extra[i * NODEMON_SOCKET_VALUES + k]);
+            }
+        }
+    }
+    bcatcstr(out, "# TYPE likwid_monitor_cpu_fraction gauge\n");
+    bcatcstr(out, "likwid_monitor_cpu_fraction");
+    nodemon_promValue(out, nm_cpuFraction);
+}
+
+/* Poll a client socket until it is ready or the deadline (from nodemon_now())
+ * has passed */
+static int
+nodemon_wait(struct pollfd* pfd, double deadline)
+{
+    double remaining = deadline - nodemon_now();
+    if (remaining <= 0)
+    {
+        return 0;
+    }
+    int ret = poll(pfd, 1, (int)(remaining * 1000) + 1);
+    if (ret > 0 && !(pfd->revents & pfd->events))
+    {
+        return -1;
+    }
+    return (ret < 0 && errno == EINTR ? 1 : ret);
+}
+
+/* Requests are 'json', 'window' or 'prometheus' or an HTTP GET of /json,
+ * /window or /metrics. The connection is non-blocking and the whole request
+ * is limited to NODEMON_REQUEST_TIMEOUT so a slow client cannot stall the
+ * sampling. */
+static void
+nodemon_client(int fd)
+{
+    char request[1024];
+    int len = 0;
+    int http = 0;
+    double deadline = nodemon_now() + NODEMON_REQUEST_TIMEOUT * 1E-3;
+    struct pollfd pfd = {fd, POLLIN, 0};
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+        return;
+    }
+    while (len < (int)sizeof(request) - 1 && nodemon_wait(&pfd, deadline) > 0)
+    {
+        int ret = read(fd, request + len, sizeof(request) - 1 - len);
+        if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (ret <= 0)
+            break;
+        len += ret;
+        request[len] = '\0';
+        if (strchr(request, '\n'))
+            break;
+    }
+    request[len] = '\0';
+    char* req = request;
+    if (strncmp(req, "GET ", 4) == 0)
+    {
+        http = 1;
+        req += 4;
+        if (*req == '/')
+            req++;
+    }
+    bstring body = bfromcstr("");
+    const char* type = "application/json";
+    const char* status = "200 OK";
+    if (strncmp(req, "metrics", 7) == 0 || strncmp(req, "prometheus", 10) == 0)
+    {
+        type = "text/plain; version=0.0.4";
+        nodemon_prometheus(body);
+    }
+    else if (strncmp(req, "window", 6) == 0)
+    {
+        nodemon_json(body, 1);
+    }
+    else if (strncmp(req, "json", 4) == 0 || (http && (*req == ' ' || *req == '\0')))
+    {
+        nodemon_json(body, 0);
+    }
+    else
+    {
+        type = "text/plain";
+        status = "404 Not Found";
+        bcatcstr(body, "Unknown request, use json, window or prometheus\n");
+    }
+    bstring resp = bfromcstr("");
+    if (http)
+    {
+        bformata(resp, "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n\r\n",
+                 status, type, blength(body));
+    }
+    bconcat(resp, body);
+    char* data = bdata(resp);
+    int remaining = blength(resp);
+    pfd.events = POLLOUT;
+    while (remaining > 0 && nodemon_wait(&pfd, deadline) > 0)
+    {
+        int ret = write(fd, data, remaining);
+        if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (ret <= 0)
+            break;
+        data += ret;
+        remaining -= ret;
+    }
+    bdestroy(body);
+    bdestroy(resp);
+}
+
+/* Serve requests until the given time (from nodemon_now()) */
+static void
+nodemon_serve(int listenfd, double until)
+{
+    while (!nm_stop)
+    {
+        double remaining = until - nodemon_now();
+        if (remaining <= 0)
+            break;
+        if (listenfd < 0)
+        {
+            struct timespec ts = {(time_t)remaining, (long)((remaining - (time_t)remaining) * 1E9)};
+            nanosleep(&ts, NULL);
+            continue;
+        }
+        struct pollfd pfd = {listenfd, POLLIN, 0};
+        int ret = poll(&pfd, 1, (int)(remaining * 1000) + 1);
+        if (ret > 0 && (pfd.revents & POLLIN))
+        {
+            int fd = accept(listenfd, NULL, NULL);
+            if (fd >= 0)
+            {
+                nodemon_client(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+static int
+nodemon_listen(const char* path)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return -ENAMETOOLONG;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    memset(&addr, 0, sizeof(struct sockaddr_un));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    /* Remove a stale socket of a previous run */
+    if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+    {
+        unlink(path);
+    }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(struct sockaddr_un)) != 0 || listen(fd, 16) != 0)
+    {
+        int err = -errno;
+        close(fd);
+        return err;
+    }
+    chmod(path, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
+    return fd;
+}
+
+static void
+nodemon_initSockets(void)
+{
+    nm_numDomains = 0;
+    nm_thermal = 0;
+    if (!lock_check())
+    {
+        return;
+    }
+    for (int s = 0; s < nm_header->numberOfSockets; s++)
+    {
+        power_init(nm_socketCpu[s]);
+    }
+    if (power_info.hasRAPL)
+    {
+        PowerType types[2] = {PKG, DRAM};
+        for (int d = 0; d < 2; d++)
+        {
+            if (power_info.domains[types[d]].supportFlags & POWER_DOMAIN_SUPPORT_STATUS)
+            {
+                nm_domains[nm_numDomains++] = types[d];
+            }
+        }
+    }
+    if (cpuid_hasFeature(TM2))
+    {
+        for (int s = 0; s < nm_header->numberOfSockets; s++)
+        {
+            thermal_init(nm_socketCpu[s]);
+        }
+        nm_thermal = 1;
+    }
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+monitor_run(int numberOfGroups, const int* groupIds, double interval, int windowSize,
+            double cpuBudget, const char* socketPath, const char* shmName)
+{
+    int err = 0;
+    int listenfd = -1;
+    int handlers = 0;
+    struct sigaction sa, oldInt, oldTerm, oldPipe;
+    PowerData energy[MAX_NUM_NODES][2];
+    double socketValues[MAX_NUM_NODES * NODEMON_SOCKET_VALUES];
+
+    if (numberOfGroups <= 0 || !groupIds || interval <= 0 || windowSize <= 0 ||
+        cpuBudget <= 0 || !shmName)
+    {
+        return -EINVAL;
+    }
+    for (int g = 0; g < numberOfGroups; g++)
+    {
+        if (groupIds[g] < 0 || groupIds[g] >= perfmon_getNumberOfGroups())
+        {
+            return -EINVAL;
+        }
+    }
+    err = nodemon_createShm(shmName, numberOfGroups, groupIds, windowSize, interval);
+    if (err < 0)
+    {
+        return err;
+    }
+    if (socketPath)
+    {
+        listenfd = nodemon_listen(socketPath);
+        if (listenfd < 0)
+        {
+            err = listenfd;
+            ERROR_PRINT(Cannot listen on UNIX socket %s: %s, socketPath, strerror(-err));
+            goto monitor_out;
+        }
+    }
+    nodemon_initSockets();
+    int nsockets = nm_header->numberOfSockets;
+
+    nm_stop = 0;
+    memset(&sa, 0, sizeof(struct sigaction));
+    sa.sa_handler = nodemon_handler;
+    sigaction(SIGINT, &sa, &oldInt);
+    sigaction(SIGTERM, &sa, &oldTerm);
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, &oldPipe);
+    handlers = 1;
+
+    while (!nm_stop)
+    {
+        for (int g = 0; g < numberOfGroups && !nm_stop; g++)
+        {
+            double wall = nodemon_now();
+            double cpu = nodemon_cpuTime();
+            err = perfmon_setupCounters(groupIds[g]);
+            if (err < 0)
+            {
+                ERROR_PRINT(Cannot setup event set %s, perfmon_getGroupName(groupIds[g]));
+                goto monitor_out;
+            }
+            for (int s = 0; s < nsockets; s++)
+            {
+                for (int d = 0; d < nm_numDomains; d++)
+                {
+                    power_start(&energy[s][d], nm_socketCpu[s], nm_domains[d]);
+                }
+            }
+            err = perfmon_startCounters();
+            if (err < 0)
+            {
+                goto monitor_out;
+            }
+            nodemon_serve(listenfd, wall + interval);
+            perfmon_stopCounters();
+            double runtime = perfmon_getLastTimeOfGroup(groupIds[g]);
+            for (int s = 0; s < nsockets; s++)
+            {
+                double* v = &socketValues[s * NODEMON_SOCKET_VALUES];
+                uint32_t temp = 0;
+                v[0] = NAN;
+                v[1] = NAN;
+                v[2] = NAN;
+                for (int d = 0; d < nm_numDomains; d++)
+                {
+                    if (power_stop(&energy[s][d], nm_socketCpu[s], nm_domains[d]) == 0 && runtime > 0)
+                    {
+                        v[(nm_domains[d] == PKG ? 0 : 1)] = power_printEnergy(&energy[s][d]) / runtime;
+                    }
+                }
+                if (nm_thermal && thermal_read(nm_socketCpu[s], &temp) == 0)
+                {
+                    v[2] = temp;
+                }
+            }
+            nodemon_store(g, groupIds[g], nodemon_now(), socketValues);
+            /* Keep the CPU time of the daemon below the budget by pausing */
+            double used = nodemon_cpuTime() - cpu;
+            double elapsed = nodemon_now() - wall;
+            nm_cpuFraction = used / elapsed;
+            if (used / cpuBudget > elapsed)
+            {
+                DEBUG_PRINT(DEBUGLEV_DETAIL, CPU fraction %f exceeds budget %f and pauses %f s,
+                            nm_cpuFraction, cpuBudget, used / cpuBudget - elapsed);
+                nodemon_serve(listenfd, nodemon_now() + used / cpuBudget - elapsed);
+            }
+        }
+    }
+    err = 0;
+monitor_out:
+    if (handlers)
+    {
+        sigaction(SIGINT, &oldInt, NULL);
+        sigaction(SIGTERM, &oldTerm, NULL);
+        sigaction(SIGPIPE, &oldPipe, NULL);
+    }
+    if (listenfd >= 0)
+    {
+        close(listenfd);
+        unlink(socketPath);
+    }
+    munmap(nm_header, nm_header->size);
+    nm_header = NULL;
+    shm_unlink(nm_shmName);
+    return err;
+}
+
+int
+monitor_query(const char* socketPath, const char* request, char** response)
+{
+    struct sockaddr_un addr;
+    size_t size = 4096;
+    size_t len = 0;
+    if (!socketPath || !request || !response || strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        return -EINVAL;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    memset(&addr, 0, sizeof(struct sockaddr_un));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(struct sockaddr_un)) != 0 ||
+        write(fd, request, strlen(request)) < 0 || write(fd, "\n", 1) < 0)
+    {
+        int err = -errno;
+        close(fd);
+        return err;
+    }
+    shutdown(fd, SHUT_WR);
+    char* buf = malloc(size);
+    while (buf)
+    {
+        if (len == size - 1)
+        {
+            char* tmp = realloc(buf, 2 * size);
+            if (!tmp)
+            {
+                free(buf);
+                buf = NULL;
+                break;
+            }
+            buf = tmp;
+            size *= 2;
+        }
+        ssize_t ret = read(fd, buf + len, size - 1 - len);
+        if (ret <= 0)
+        {
+            break;
+        }
+        len += ret;
+    }
+    close(fd);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+    buf[len] = '\0';
+    *response = buf;
+    return 0;
+}
@@ -331,6 +331,7 @@ numa_finalize(void)
     if (numa_info.nodes)
     {
         free(numa_info.nodes);
+        numa_info.nodes = NULL;
     }
     numa_info.numberOfNodes = 0;
     numaInitialized = 0;
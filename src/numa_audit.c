@@ -0,0 +1,284 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  numa_audit.c
+ *
+ *      Description:  Audit of the NUMA page placement of a running process and
+ *                    migration of misplaced pages.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+
+#include <types.h>
+#include <error.h>
+#include <likwid.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1<<1)
+#endif
+
+#define move_pages(pid, count, pages, nodes, status, flags) \
+    syscall(SYS_move_pages, pid, count, pages, nodes, status, flags)
+
+/* Number of pages queried with one move_pages call */
+#define NUMA_AUDIT_BATCH 4096
+/* Regions smaller than this are not audited (libraries, TLS, small mallocs) */
+#define NUMA_AUDIT_MIN_REGION (1024*1024)
+/* Guard pages of thread stacks are at most that large */
+#define NUMA_AUDIT_MAX_GUARD (64*1024)
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static int
+numa_audit_nodeIdx(int osNode)
+{
+    for (int i = 0; i < numa_info.numberOfNodes; i++)
+    {
+        if (numa_info.nodes[i].id == osNode)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int
+numa_audit_cpuNode(int cpu)
+{
+    for (int i = 0; i < numa_info.numberOfNodes; i++)
+    {
+        for (int j = 0; j < numa_info.nodes[i].numberOfProcessors; j++)
+        {
+            if (numa_info.nodes[i].processors[j] == cpu)
+            {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+/* Query (and optionally migrate) the pages of one region. The region is split
+ * in equally sized chunks, one per thread, as a statically scheduled loop over
+ * the region would touch it. Pages that are not present yet are ignored. */
+static int
+numa_audit_region(int pid, unsigned long start, unsigned long end, long pagesize,
+                  int migrate, NumaAudit_t audit)
+{
+    int err = 0;
+    unsigned long npages = (end - start) / pagesize;
+    unsigned long chunk = (npages + audit->numberOfThreads - 1) / audit->numberOfThreads;
+    void** pages = malloc(NUMA_AUDIT_BATCH * sizeof(void*));
+    int* status = malloc(NUMA_AUDIT_BATCH * sizeof(int));
+    int* nodes = malloc(NUMA_AUDIT_BATCH * sizeof(int));
+    if (!pages || !status || !nodes)
+    {
+        err = -ENOMEM;
+        goto region_out;
+    }
+    for (unsigned long p = 0; p < npages; p += NUMA_AUDIT_BATCH)
+    {
+        int count = (int)MIN(NUMA_AUDIT_BATCH, npages - p);
+        int nmove = 0;
+        for (int i = 0; i < count; i++)
+        {
+            pages[i] = (void*)(start + (p + i) * pagesize);
+        }
+        if (move_pages(pid, count, pages, NULL, status, 0) < 0)
+        {
+            err = -errno;
+            goto region_out;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            if (status[i] < 0)
+            {
+                continue;
+            }
+            int node = numa_audit_nodeIdx(status[i]);
+            NumaAuditThread* t = &audit->threads[(p + i) / chunk];
+            audit->totalPages++;
+            if (node >= 0)
+            {
+                audit->nodePages[node]++;
+            }
+            if (t->node < 0 || node == t->node)
+            {
+                t->localPages++;
+            }
+            else
+            {
+                t->remotePages++;
+                if (migrate)
+                {
+                    pages[nmove] = pages[i];
+                    nodes[nmove] = numa_info.nodes[t->node].id;
+                    nmove++;
+                }
+            }
+        }
+        if (nmove > 0)
+        {
+            if (move_pages(pid, nmove, pages, nodes, status, MPOL_MF_MOVE) < 0)
+            {
+                DEBUG_PRINT(DEBUGLEV_INFO, Migration of %d pages failed: %s, nmove, strerror(errno));
+                continue;
+            }
+            for (int i = 0; i < nmove; i++)
+            {
+                if (status[i] == nodes[i])
+                {
+                    int t = (((unsigned long)pages[i] - start) / pagesize) / chunk;
+                    audit->threads[t].migratedPages++;
+                }
+            }
+        }
+    }
+region_out:
+    free(pages);
+    free(status);
+    free(nodes);
+    return err;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+numa_auditProcess(int pid, int numberOfThreads, const int* cpus, int migrate, NumaAudit_t* audit)
+{
+    int err = 0;
+    char fname[256];
+    char line[1024];
+    unsigned long lastGuardEnd = 0;
+    long pagesize = sysconf(_SC_PAGESIZE);
+    if (numberOfThreads <= 0 || !cpus || !audit)
+    {
+        return -EINVAL;
+    }
+    err = numa_init();
+    if (err < 0)
+    {
+        return err;
+    }
+    NumaAudit_t a = malloc(sizeof(NumaAudit));
+    if (!a)
+    {
+        return -ENOMEM;
+    }
+    memset(a, 0, sizeof(NumaAudit));
+    a->threads = malloc(numberOfThreads * sizeof(NumaAuditThread));
+    a->nodePages = malloc(numa_info.numberOfNodes * sizeof(uint64_t));
+    if (!a->threads || !a->nodePages)
+    {
+        numa_freeAudit(a);
+        return -ENOMEM;
+    }
+    memset(a->nodePages, 0, numa_info.numberOfNodes * sizeof(uint64_t));
+    a->numberOfNodes = numa_info.numberOfNodes;
+    a->numberOfThreads = numberOfThreads;
+    for (int i = 0; i < numberOfThreads; i++)
+    {
+        a->threads[i].cpu = cpus[i];
+        a->threads[i].node = numa_audit_cpuNode(cpus[i]);
+        a->threads[i].localPages = 0;
+        a->threads[i].remotePages = 0;
+        a->threads[i].migratedPages = 0;
+    }
+
+    snprintf(fname, 255, "/proc/%d/maps", pid);
+    FILE* fp = fopen(fname, "r");
+    if (!fp)
+    {
+        err = -errno;
+        ERROR_PRINT(Cannot open %s, fname);
+        numa_freeAudit(a);
+        return err;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        unsigned long start = 0, end = 0, inode = 0;
+        char perms[8];
+        char path[512];
+        path[0] = '\0';
+        if (sscanf(line, "%lx-%lx %7s %*s %*s %lu %511s", &start, &end, perms, &inode, path) < 4)
+        {
+            continue;
+        }
+        /* Thread stacks are anonymous regions directly above a small guard
+         * region. They belong to a single thread, so skip them. */
+        if (strncmp(perms, "---p", 4) == 0 && end - start <= NUMA_AUDIT_MAX_GUARD)
+        {
+            lastGuardEnd = end;
+            continue;
+        }
+        if (perms[0] != 'r' || perms[1] != 'w' || inode != 0 ||
+            (path[0] != '\0' && strcmp(path, "[heap]") != 0) ||
+            start == lastGuardEnd || end - start < NUMA_AUDIT_MIN_REGION)
+        {
+            continue;
+        }
+        err = numa_audit_region(pid, start, end, pagesize, migrate, a);
+        if (err < 0)
+        {
+            DEBUG_PRINT(DEBUGLEV_INFO, Cannot audit region 0x%lx-0x%lx: %s, start, end, strerror(-err));
+            if (err == -EPERM || err == -ESRCH || err == -ENOMEM)
+            {
+                break;
+            }
+            err = 0;
+            continue;
+        }
+        a->numberOfRegions++;
+    }
+    fclose(fp);
+    if (err < 0)
+    {
+        numa_freeAudit(a);
+        return err;
+    }
+    *audit = a;
+    return 0;
+}
+
+void
+numa_freeAudit(NumaAudit_t audit)
+{
+    if (audit)
+    {
+        free(audit->threads);
+        free(audit->nodePages);
+        free(audit);
+    }
+}
@@ -0,0 +1,805 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  output_writer.c
+ *
+ *      Description:  Streaming CSV and JSON writers for the output of the LIKWID
+ *                    applications. Replaces the post-processing filter scripts.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include <error.h>
+#include <bstrlib.h>
+#include <likwid.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define WRITER_MAX_DEPTH 32
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+typedef enum {
+    WRITER_APP_GENERIC = 0,
+    WRITER_APP_PERFCTR,
+} WriterApplication;
+
+/* States of the parser for the LIKWID CSV block format. A block starts with
+ * STRUCT,<name>,<lines> or TABLE,...,<lines> and is followed by the given
+ * number of lines (plus a header line for tables). */
+typedef enum {
+    BLOCK_NONE = 0,
+    BLOCK_STRUCT,
+    BLOCK_INFO,
+    BLOCK_SKIP,
+    BLOCK_HEADER,
+    BLOCK_REGIONINFO,
+    BLOCK_ROWS,
+} WriterBlockState;
+
+typedef enum {
+    TABLE_GENERIC = 0,
+    TABLE_RAW,
+    TABLE_METRIC,
+    TABLE_STAT,
+} WriterTableType;
+
+struct LikwidWriter {
+    FILE* fp;
+    LikwidWriterFormat format;
+    WriterApplication app;
+    int depth;
+    int first[WRITER_MAX_DEPTH];
+    int isArray[WRITER_MAX_DEPTH];
+    /* Block parser */
+    WriterBlockState state;
+    WriterTableType tableType;
+    int remaining;
+    struct bstrList* header;
+    bstring block;
+    bstring group;
+    struct bstrList* info;
+    struct bstrList* cpus;
+    int infoDone;
+};
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+writer_indent(LikwidWriter_t w)
+{
+    fputc('\n', w->fp);
+    for (int i = 0; i < w->depth; i++)
+    {
+        fputs("    ", w->fp);
+    }
+}
+
+static void
+writer_escape(LikwidWriter_t w, const char* s)
+{
+    fputc('"', w->fp);
+    for (const unsigned char* c = (const unsigned char*)s; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', w->fp);
+            fputc(*c, w->fp);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(w->fp, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, w->fp);
+        }
+    }
+    fputc('"', w->fp);
+}
+
+/* Separator, indentation and key of the next element */
+static int
+writer_prefix(LikwidWriter_t w, const char* key)
+{
+    if (w->format != LIKWID_WRITER_JSON)
+    {
+        return -EINVAL;
+    }
+    if (w->depth > 0)
+    {
+        if (!w->first[w->depth])
+        {
+            fputc(',', w->fp);
+            if (w->isArray[w->depth])
+            {
+                fputc(' ', w->fp);
+            }
+        }
+        if (!w->isArray[w->depth])
+        {
+            writer_indent(w);
+            writer_escape(w, (key ? key : ""));
+            fputs(": ", w->fp);
+        }
+        w->first[w->depth] = 0;
+    }
+    return 0;
+}
+
+static int
+writer_begin(LikwidWriter_t w, const char* key, int array)
+{
+    int err = writer_prefix(w, key);
+    if (err < 0)
+    {
+        return err;
+    }
+    if (w->depth >= WRITER_MAX_DEPTH - 1)
+    {
+        return -E2BIG;
+    }
+    fputc((array ? '[' : '{'), w->fp);
+    w->depth++;
+    w->first[w->depth] = 1;
+    w->isArray[w->depth] = array;
+    return 0;
+}
+
+static int
+writer_end(LikwidWriter_t w, int array)
+{
+    if (w->format != LIKWID_WRITER_JSON || w->depth == 0 || w->isArray[w->depth] != array)
+    {
+        return -EINVAL;
+    }
+    int empty = w->first[w->depth];
+    w->depth--;
+    if (!array && !empty)
+    {
+        writer_indent(w);
+    }
+    fputc((array ? ']' : '}'), w->fp);
+    return 0;
+}
+
+static void
+writer_double(LikwidWriter_t w, double value)
+{
+    char buf[64];
+    if (isnan(value) || isinf(value))
+    {
+        fputs("null", w->fp);
+        return;
+    }
+    /* Shortest representation that reads back to the same value */
+    snprintf(buf, sizeof(buf), "%.15g", value);
+    if (strtod(buf, NULL) != value)
+    {
+        snprintf(buf, sizeof(buf), "%.17g", value);
+    }
+    fputs(buf, w->fp);
+}
+
+/* Values in the CSV output are numbers, '-' for unavailable values or text */
+static void
+writer_typed(LikwidWriter_t w, const char* key, const char* s)
+{
+    char* end = NULL;
+    writer_prefix(w, key);
+    if (s[0] == '\0' || strcmp(s, "-") == 0 || strcasecmp(s, "nan") == 0)
+    {
+        fputs("null", w->fp);
+        return;
+    }
+    if (strspn(s, "0123456789+-.eE") == strlen(s))
+    {
+        double v = strtod(s, &end);
+        if (end && *end == '\0')
+        {
+            writer_double(w, v);
+            return;
+        }
+    }
+    writer_escape(w, s);
+}
+
+static int
+writer_cellCount(struct bstrList* cells)
+{
+    int n = cells->qty;
+    while (n > 0 && blength(cells->entry[n-1]) == 0)
+    {
+        n--;
+    }
+    return n;
+}
+
+static void
+writer_closeBlocks(LikwidWriter_t w)
+{
+    if (w->group)
+    {
+        writer_end(w, 0);
+        bdestroy(w->group);
+        w->group = NULL;
+    }
+    if (w->block)
+    {
+        writer_end(w, 0);
+        bdestroy(w->block);
+        w->block = NULL;
+    }
+}
+
+static void
+writer_emitInfo(LikwidWriter_t w)
+{
+    if (!w->info)
+    {
+        return;
+    }
+    writer_begin(w, "Info", 0);
+    for (int i = 0; i < w->info->qty; i++)
+    {
+        struct bstrList* cells = bsplit(w->info->entry[i], ',');
+        for (int j = 0; j < cells->qty; j++)
+        {
+            btrimws(cells->entry[j]);
+        }
+        int n = writer_cellCount(cells);
+        if (n >= 2)
+        {
+            writer_typed(w, bdata(cells->entry[0]), bdata(cells->entry[1]));
+        }
+        bstrListDestroy(cells);
+    }
+    if (w->cpus && w->cpus->qty > 0)
+    {
+        writer_begin(w, "CPU list", 1);
+        for (int i = 0; i < w->cpus->qty; i++)
+        {
+            writer_typed(w, NULL, bdata(w->cpus->entry[i]));
+        }
+        writer_end(w, 1);
+    }
+    writer_end(w, 0);
+}
+
+static void
+writer_listAppend(struct bstrList** list, bstring s)
+{
+    if (!*list)
+    {
+        *list = bstrListCreate();
+    }
+    bstrListAlloc(*list, (*list)->qty + 1);
+    (*list)->entry[(*list)->qty] = bstrcpy(s);
+    (*list)->qty++;
+}
+
+/* TABLE,<name>,<lines> or TABLE,<name>,<group>,<lines> or
+ * TABLE,Region <tag>,<name>,<group>,<lines> */
+static void
+writer_beginTable(LikwidWriter_t w, struct bstrList* cells, int n)
+{
+    bstring region = NULL;
+    bstring tabname = NULL;
+    bstring grp = NULL;
+    if (n == 3)
+    {
+        tabname = cells->entry[1];
+        w->remaining = atoi(bdata(cells->entry[2]));
+    }
+    else if (n == 4)
+    {
+        tabname = cells->entry[1];
+        grp = cells->entry[2];
+        w->remaining = atoi(bdata(cells->entry[3]));
+    }
+    else if (n >= 5)
+    {
+        region = cells->entry[1];
+        tabname = cells->entry[2];
+        grp = cells->entry[3];
+        w->remaining = atoi(bdata(cells->entry[4]));
+    }
+    else
+    {
+        return;
+    }
+    w->state = BLOCK_HEADER;
+    w->tableType = TABLE_GENERIC;
+    if (w->app != WRITER_APP_PERFCTR || !grp)
+    {
+        writer_closeBlocks(w);
+        writer_begin(w, bdata(tabname), 1);
+        return;
+    }
+    /* 'Group <id> <name>' with name Raw, Raw STAT, Metric or Metric STAT.
+     * The results are stored as <group>/<group>/<name> and for MarkerAPI
+     * regions as Region <tag>/<group>/<name>. */
+    char* gname = bdata(tabname);
+    if (strncmp(gname, "Group ", 6) == 0)
+    {
+        gname = strchr(gname + 6, ' ');
+        gname = (gname ? gname + 1 : bdata(tabname));
+    }
+    bstring key = (region ? region : grp);
+    if (!w->block || !biseq(w->block, key))
+    {
+        writer_closeBlocks(w);
+        writer_begin(w, bdata(key), 0);
+        w->block = bstrcpy(key);
+    }
+    if (!w->group || !biseq(w->group, grp))
+    {
+        if (w->group)
+        {
+            writer_end(w, 0);
+            bdestroy(w->group);
+        }
+        writer_begin(w, bdata(grp), 0);
+        w->group = bstrcpy(grp);
+    }
+    if (strstr(gname, "STAT"))
+        w->tableType = TABLE_STAT;
+    else if (strncmp(gname, "Raw", 3) == 0)
+        w->tableType = TABLE_RAW;
+    else if (strncmp(gname, "Metric", 6) == 0)
+        w->tableType = TABLE_METRIC;
+    /* Other tables of a group (e.g. the call-path tree) are lists of rows */
+    writer_begin(w, gname, (w->tableType == TABLE_GENERIC));
+}
+
+static void
+writer_endTable(LikwidWriter_t w)
+{
+    writer_end(w, (w->isArray[w->depth] ? 1 : 0));
+    bstrListDestroy(w->header);
+    w->header = NULL;
+    w->state = BLOCK_NONE;
+}
+
+static void
+writer_row(LikwidWriter_t w, struct bstrList* cells, int n)
+{
+    switch (w->tableType)
+    {
+        case TABLE_RAW:
+            if (n < 2)
+                break;
+            writer_begin(w, bdata(cells->entry[1]), 0);
+            writer_typed(w, "Event", bdata(cells->entry[0]));
+            writer_begin(w, "Values", 1);
+            for (int j = 2; j < n; j++)
+                writer_typed(w, NULL, bdata(cells->entry[j]));
+            writer_end(w, 1);
+            writer_end(w, 0);
+            break;
+        case TABLE_METRIC:
+            if (n < 1)
+                break;
+            writer_begin(w, bdata(cells->entry[0]), 0);
+            writer_begin(w, "Values", 1);
+            for (int j = 1; j < n; j++)
+                writer_typed(w, NULL, bdata(cells->entry[j]));
+            writer_end(w, 1);
+            writer_end(w, 0);
+            break;
+        case TABLE_STAT:
+        {
+            int keycol = 0;
+            if (w->header->qty > 1 && biseqcstr(w->header->entry[1], "Counter"))
+                keycol = 1;
+            if (n <= keycol)
+                break;
+            writer_begin(w, bdata(cells->entry[keycol]), 0);
+            for (int j = 0; j < n && j < w->header->qty; j++)
+            {
+                if (j != keycol)
+                    writer_typed(w, bdata(w->header->entry[j]), bdata(cells->entry[j]));
+            }
+            writer_end(w, 0);
+            break;
+        }
+        default:
+            writer_begin(w, NULL, 0);
+            for (int j = 0; j < n && j < w->header->qty; j++)
+            {
+                if (blength(cells->entry[j]) > 0)
+                    writer_typed(w, bdata(w->header->entry[j]), bdata(cells->entry[j]));
+            }
+            writer_end(w, 0);
+            break;
+    }
+}
+
+static int
+writer_cells(LikwidWriter_t w, struct bstrList* cells)
+{
+    int n = writer_cellCount(cells);
+    switch (w->state)
+    {
+        case BLOCK_NONE:
+            if (n >= 3 && biseqcstr(cells->entry[0], "STRUCT"))
+            {
+                w->remaining = atoi(bdata(cells->entry[n-1]));
+                if (w->app == WRITER_APP_PERFCTR && biseqcstr(cells->entry[1], "Info"))
+                {
+                    /* Printed for every group, keep the first one for the end */
+                    w->state = (w->infoDone ? BLOCK_SKIP : BLOCK_INFO);
+                    w->infoDone = 1;
+                }
+                else
+                {
+                    writer_closeBlocks(w);
+                    writer_begin(w, bdata(cells->entry[1]), 0);
+                    w->state = BLOCK_STRUCT;
+                }
+                if (w->remaining <= 0)
+                {
+                    if (w->state == BLOCK_STRUCT)
+                        writer_end(w, 0);
+                    w->state = BLOCK_NONE;
+                }
+            }
+            else if (n >= 3 && biseqcstr(cells->entry[0], "TABLE"))
+            {
+                writer_beginTable(w, cells, n);
+            }
+            break;
+        case BLOCK_STRUCT:
+            if (n == 2)
+            {
+                writer_typed(w, bdata(cells->entry[0]), bdata(cells->entry[1]));
+            }
+            else if (n > 2)
+            {
+                writer_begin(w, bdata(cells->entry[0]), 1);
+                for (int j = 1; j < n; j++)
+                {
+                    if (blength(cells->entry[j]) > 0)
+                        writer_typed(w, NULL, bdata(cells->entry[j]));
+                }
+                writer_end(w, 1);
+            }
+            if (--w->remaining <= 0)
+            {
+                writer_end(w, 0);
+                w->state = BLOCK_NONE;
+            }
+            break;
+        case BLOCK_INFO:
+        case BLOCK_SKIP:
+            if (w->state == BLOCK_INFO)
+            {
+                bstring line = bjoin(cells, &(struct tagbstring)bsStatic(","));
+                writer_listAppend(&w->info, line);
+                bdestroy(line);
+            }
+            if (--w->remaining <= 0)
+            {
+                w->state = BLOCK_NONE;
+            }
+            break;
+        case BLOCK_HEADER:
+            if (w->app == WRITER_APP_PERFCTR && n > 0 && biseqcstr(cells->entry[0], "Region Info"))
+            {
+                writer_begin(w, "Region Info", 0);
+                w->state = BLOCK_REGIONINFO;
+                break;
+            }
+            w->header = bstrListCreate();
+            bstrListAlloc(w->header, n > 0 ? n : 1);
+            for (int j = 0; j < n; j++)
+            {
+                w->header->entry[j] = bstrcpy(cells->entry[j]);
+                w->header->qty++;
+                if (w->app == WRITER_APP_PERFCTR && !w->cpus &&
+                    bstrncmp(cells->entry[j], &(struct tagbstring)bsStatic("HWThread "), 9) == 0)
+                {
+                    for (int k = j; k < n; k++)
+                    {
+                        bstring id = bmidstr(cells->entry[k], 9, blength(cells->entry[k]));
+                        writer_listAppend(&w->cpus, id);
+                        bdestroy(id);
+                    }
+                }
+            }
+            w->state = BLOCK_ROWS;
+            if (w->remaining <= 0)
+            {
+                writer_endTable(w);
+            }
+            break;
+        case BLOCK_REGIONINFO:
+            if (n > 0)
+            {
+                writer_begin(w, bdata(cells->entry[0]), 0);
+                writer_begin(w, "Values", 1);
+                for (int j = 1; j < n; j++)
+                    writer_typed(w, NULL, bdata(cells->entry[j]));
+                writer_end(w, 1);
+                writer_end(w, 0);
+            }
+            if (n > 0 && biseqcstr(cells->entry[0], "call count"))
+            {
+                writer_end(w, 0);
+                w->state = BLOCK_HEADER;
+            }
+            break;
+        case BLOCK_ROWS:
+            writer_row(w, cells, n);
+            if (--w->remaining <= 0)
+            {
+                writer_endTable(w);
+            }
+            break;
+    }
+    return 0;
+}
+
+static int
+writer_csvRow(LikwidWriter_t w, struct bstrList* cells)
+{
+    for (int j = 0; j < cells->qty; j++)
+    {
+        if (j > 0)
+        {
+            fputc(',', w->fp);
+        }
+        if (bstrchr(cells->entry[j], ',') != BSTR_ERR || bstrchr(cells->entry[j], '"') != BSTR_ERR)
+        {
+            fputc('"', w->fp);
+            for (int k = 0; k < blength(cells->entry[j]); k++)
+            {
+                char c = bchar(cells->entry[j], k);
+                if (c == '"')
+                    fputc('"', w->fp);
+                fputc(c, w->fp);
+            }
+            fputc('"', w->fp);
+        }
+        else
+        {
+            fputs(bdata(cells->entry[j]), w->fp);
+        }
+    }
+    fputc('\n', w->fp);
+    return 0;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+likwid_writerOpen(const char* filename, LikwidWriterFormat format, const char* application, LikwidWriter_t* writer)
+{
+    if (!writer || (format != LIKWID_WRITER_CSV && format != LIKWID_WRITER_JSON))
+    {
+        return -EINVAL;
+    }
+    LikwidWriter_t w = malloc(sizeof(struct LikwidWriter));
+    if (!w)
+    {
+        return -ENOMEM;
+    }
+    memset(w, 0, sizeof(struct LikwidWriter));
+    if (filename)
+    {
+        w->fp = fopen(filename, "w");
+        if (!w->fp)
+        {
+            int err = -errno;
+            ERROR_PRINT(Cannot open output file %s, filename);
+            free(w);
+            return err;
+        }
+    }
+    else
+    {
+        w->fp = stdout;
+    }
+    w->format = format;
+    if (application && strcmp(application, "perfctr") == 0)
+    {
+        w->app = WRITER_APP_PERFCTR;
+    }
+    if (format == LIKWID_WRITER_JSON)
+    {
+        writer_begin(w, NULL, 0);
+    }
+    *writer = w;
+    return 0;
+}
+
+int
+likwid_writerLine(LikwidWriter_t writer, const char* line)
+{
+    if (!writer || !line)
+    {
+        return -EINVAL;
+    }
+    if (writer->format == LIKWID_WRITER_CSV)
+    {
+        fputs(line, writer->fp);
+        fputc('\n', writer->fp);
+        return 0;
+    }
+    bstring bline = bfromcstr(line);
+    struct bstrList* lines = bsplit(bline, '\n');
+    for (int i = 0; i < lines->qty; i++)
+    {
+        struct bstrList* cells = bsplit(lines->entry[i], ',');
+        for (int j = 0; j < cells->qty; j++)
+        {
+            btrimws(cells->entry[j]);
+        }
+        writer_cells(writer, cells);
+        bstrListDestroy(cells);
+    }
+    bstrListDestroy(lines);
+    bdestroy(bline);
+    return 0;
+}
+
+int
+likwid_writerRow(LikwidWriter_t writer, int numCells, const char** cells)
+{
+    int err = 0;
+    if (!writer || numCells < 0 || (numCells > 0 && !cells))
+    {
+        return -EINVAL;
+    }
+    struct bstrList* list = bstrListCreate();
+    bstrListAlloc(list, numCells > 0 ? numCells : 1);
+    for (int i = 0; i < numCells; i++)
+    {
+        list->entry[i] = bfromcstr(cells[i] ? cells[i] : "");
+        list->qty++;
+    }
+    if (writer->format == LIKWID_WRITER_CSV)
+        err = writer_csvRow(writer, list);
+    else
+        err = writer_cells(writer, list);
+    bstrListDestroy(list);
+    return err;
+}
+
+int
+likwid_writerBeginObject(LikwidWriter_t writer, const char* key)
+{
+    if (!writer)
+    {
+        return -EINVAL;
+    }
+    return writer_begin(writer, key, 0);
+}
+
+int
+likwid_writerEndObject(LikwidWriter_t writer)
+{
+    if (!writer)
+    {
+        return -EINVAL;
+    }
+    return writer_end(writer, 0);
+}
+
+int
+likwid_writerBeginArray(LikwidWriter_t writer, const char* key)
+{
+    if (!writer)
+    {
+        return -EINVAL;
+    }
+    return writer_begin(writer, key, 1);
+}
+
+int
+likwid_writerEndArray(LikwidWriter_t writer)
+{
+    if (!writer)
+    {
+        return -EINVAL;
+    }
+    return writer_end(writer, 1);
+}
+
+int
+likwid_writerString(LikwidWriter_t writer, const char* key, const char* value)
+{
+    if (!writer || writer_prefix(writer, key) < 0)
+    {
+        return -EINVAL;
+    }
+    if (value)
+        writer_escape(writer, value);
+    else
+        fputs("null", writer->fp);
+    return 0;
+}
+
+int
+likwid_writerNumber(LikwidWriter_t writer, const char* key, double value)
+{
+    if (!writer || writer_prefix(writer, key) < 0)
+    {
+        return -EINVAL;
+    }
+    writer_double(writer, value);
+    return 0;
+}
+
+int
+likwid_writerClose(LikwidWriter_t writer)
+{
+    int err = 0;
+    if (!writer)
+    {
+        return -EINVAL;
+    }
+    if (writer->format == LIKWID_WRITER_JSON)
+    {
+        if (writer->state == BLOCK_ROWS || writer->state == BLOCK_HEADER)
+        {
+            /* Truncated table, close it anyway to keep the output valid */
+            writer_endTable(writer);
+        }
+        else if (writer->state == BLOCK_STRUCT || writer->state == BLOCK_REGIONINFO)
+        {
+            writer_end(writer, 0);
+        }
+        writer_closeBlocks(writer);
+        writer_emitInfo(writer);
+        while (writer->depth > 0)
+        {
+            writer_end(writer, writer->isArray[writer->depth]);
+        }
+        fputc('\n', writer->fp);
+    }
+    if (writer->fp != stdout)
+    {
+        if (fclose(writer->fp) != 0)
+            err = -errno;
+    }
+    else
+    {
+        fflush(stdout);
+    }
+    bstrListDestroy(writer->header);
+    bstrListDestroy(writer->info);
+    bstrListDestroy(writer->cpus);
+    bdestroy(writer->block);
+    bdestroy(writer->group);
+    free(writer);
+    return err;
+}
@@ -0,0 +1,279 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  overflow_watch.c
+ *
+ *      Description:  Background reads of the performance counters to detect
+ *                    counter overflows in long measurements.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <types.h>
+#include <error.h>
+#include <likwid.h>
+#include <topology.h>
+#include <perfmon.h>
+#include <overflow_watch.h>
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int ovfwatch_active = 0;
+
+extern int perfmon_initialized;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+typedef struct {
+    pthread_t thread;
+    int numberOfThreads;
+    int* threads;
+} OvfWatchSocket;
+
+static OvfWatchSocket* ovfwatch_sockets = NULL;
+static int ovfwatch_numSockets = 0;
+static double ovfwatch_interval = 0.0;
+static int ovfwatch_stop = 0;
+static pthread_mutex_t ovfwatch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ovfwatch_cond = PTHREAD_COND_INITIALIZER;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+#ifndef LIKWID_USE_PERFEVENT
+/* Half of the shortest time any configured counter needs to wrap around at
+ * the maximal event rate */
+static double
+ovfwatch_getInterval(void)
+{
+    double interval = OVFWATCH_MAX_INTERVAL;
+    for (int g = 0; g < groupSet->numberOfActiveGroups; g++)
+    {
+        PerfmonEventSet* eventSet = &groupSet->groups[g];
+        for (int e = 0; e < eventSet->numberOfEvents; e++)
+        {
+            RegisterIndex index = eventSet->events[e].index;
+            RegisterType type = eventSet->events[e].type;
+            double rate = OVFWATCH_MAX_EVENT_RATE;
+            if (type == NOTYPE || type == THERMAL || type == VOLTAGE ||
+                type == MBOX0TMP || type == METRICS)
+            {
+                continue;
+            }
+            if (type == POWER)
+            {
+                double unit = power_getEnergyUnit(getCounterTypeOffset(index));
+                if (unit <= 0)
+                {
+                    continue;
+                }
+                rate = OVFWATCH_MAX_POWER / unit;
+            }
+            interval = MIN(interval, ((double)perfmon_getMaxCounterValue(type)) / rate / 2);
+        }
+    }
+    return MAX(interval, OVFWATCH_MIN_INTERVAL);
+}
+
+static int
+ovfwatch_cpuSocket(int cpu)
+{
+    for (int j = 0; j < (int)cpuid_topology.numHWThreads; j++)
+    {
+        if (cpuid_topology.threadPool[j].apicId == (uint32_t)cpu)
+        {
+            return cpuid_topology.threadPool[j].packageId;
+        }
+    }
+    return 0;
+}
+
+static void*
+ovfwatch_thread(void* arg)
+{
+    OvfWatchSocket* sock = (OvfWatchSocket*)arg;
+    long sec = (long)ovfwatch_interval;
+    long nsec = (long)((ovfwatch_interval - sec) * 1E9);
+
+    pthread_mutex_lock(&ovfwatch_lock);
+    while (!ovfwatch_stop)
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += sec;
+        ts.tv_nsec += nsec;
+        if (ts.tv_nsec >= 1000000000L)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        while (!ovfwatch_stop &&
+               pthread_cond_timedwait(&ovfwatch_cond, &ovfwatch_lock, &ts) != ETIMEDOUT);
+        if (ovfwatch_stop)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&ovfwatch_lock);
+        for (int i = 0; i < sock->numberOfThreads; i++)
+        {
+            perfmon_watchOverflowsThread(sock->threads[i]);
+        }
+        pthread_mutex_lock(&ovfwatch_lock);
+    }
+    pthread_mutex_unlock(&ovfwatch_lock);
+    return NULL;
+}
+
+static void
+ovfwatch_freeSockets(void)
+{
+    for (int s = 0; s < ovfwatch_numSockets; s++)
+    {
+        free(ovfwatch_sockets[s].threads);
+    }
+    free(ovfwatch_sockets);
+    ovfwatch_sockets = NULL;
+    ovfwatch_numSockets = 0;
+}
+#endif
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+perfmon_startOverflowWatch(void)
+{
+    if (perfmon_initialized != 1 || groupSet == NULL)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    if (ovfwatch_active)
+    {
+        return 0;
+    }
+#ifdef LIKWID_USE_PERFEVENT
+    DEBUG_PLAIN_PRINT(DEBUGLEV_INFO, Overflow watch not required with perf_event backend);
+    return 0;
+#else
+    int err = 0;
+    int nthreads = groupSet->numberOfThreads;
+    int* pkgs = malloc(nthreads * sizeof(int));
+    ovfwatch_sockets = malloc(nthreads * sizeof(OvfWatchSocket));
+    if (!pkgs || !ovfwatch_sockets)
+    {
+        free(pkgs);
+        free(ovfwatch_sockets);
+        ovfwatch_sockets = NULL;
+        return -ENOMEM;
+    }
+    memset(ovfwatch_sockets, 0, nthreads * sizeof(OvfWatchSocket));
+    for (int t = 0; t < nthreads; t++)
+    {
+        int pkg = ovfwatch_cpuSocket(groupSet->threads[t].processorId);
+        int s = 0;
+        for (s = 0; s < ovfwatch_numSockets; s++)
+        {
+            if (pkgs[s] == pkg)
+            {
+                break;
+            }
+        }
+        if (s == ovfwatch_numSockets)
+        {
+            pkgs[s] = pkg;
+            ovfwatch_sockets[s].threads = malloc(nthreads * sizeof(int));
+            if (!ovfwatch_sockets[s].threads)
+            {
+                free(pkgs);
+                ovfwatch_freeSockets();
+                return -ENOMEM;
+            }
+            ovfwatch_numSockets++;
+        }
+        ovfwatch_sockets[s].threads[ovfwatch_sockets[s].numberOfThreads++] = t;
+    }
+    free(pkgs);
+
+    err = perfmon_setThreadLocking(1);
+    if (err < 0)
+    {
+        ovfwatch_freeSockets();
+        return err;
+    }
+    ovfwatch_interval = ovfwatch_getInterval();
+    ovfwatch_stop = 0;
+    for (int s = 0; s < ovfwatch_numSockets; s++)
+    {
+        err = pthread_create(&ovfwatch_sockets[s].thread, NULL, ovfwatch_thread, &ovfwatch_sockets[s]);
+        if (err != 0)
+        {
+            ERROR_PRINT(Cannot start overflow watch thread: %s, strerror(err));
+            ovfwatch_numSockets = s;
+            ovfwatch_active = 1;
+            perfmon_stopOverflowWatch();
+            return -err;
+        }
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Overflow watch reads counters of %d sockets every %f seconds,
+                ovfwatch_numSockets, ovfwatch_interval);
+    ovfwatch_active = 1;
+    return 0;
+#endif
+}
+
+void
+perfmon_stopOverflowWatch(void)
+{
+#ifndef LIKWID_USE_PERFEVENT
+    if (!ovfwatch_active)
+    {
+        return;
+    }
+    pthread_mutex_lock(&ovfwatch_lock);
+    ovfwatch_stop = 1;
+    pthread_cond_broadcast(&ovfwatch_cond);
+    pthread_mutex_unlock(&ovfwatch_lock);
+    for (int s = 0; s < ovfwatch_numSockets; s++)
+    {
+        pthread_join(ovfwatch_sockets[s].thread, NULL);
+    }
+    perfmon_setThreadLocking(0);
+    ovfwatch_freeSockets();
+    ovfwatch_interval = 0.0;
+    ovfwatch_active = 0;
+#endif
+}
+
+double
+perfmon_getOverflowWatchInterval(void)
+{
+    return (ovfwatch_active ? ovfwatch_interval : 0.0);
+}
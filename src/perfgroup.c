@@ -48,6 +48,7 @@
 #include <likwid.h>
 
 #include <calculator.h>
+#include <perfgroup_catalogue.h>
 #include <bstrlib.h>
 #include <bstrlib_helper.h>
 
@@ -70,8 +71,147 @@ static inline void *realloc_buffer(void *ptrmem, size_t size) {
     return ptr;
 }
 
+static void
+perfgroup_returnListInfo(char** shortinfo, char** longinfo)
+{
+    if (*shortinfo)
+    {
+        free(*shortinfo);
+        *shortinfo = NULL;
+    }
+    if (*longinfo)
+    {
+        free(*longinfo);
+        *longinfo = NULL;
+    }
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
+int
+perfgroup_addTotalGroups(int groups)
+{
+    totalgroups += groups;
+    return totalgroups;
+}
+
+int
+perfgroup_parseGroupListInfo(
+        const char* filename,
+        char** shortinfo,
+        char** longinfo,
+        int* requireNoHT)
+{
+    int j = 0, s = 0;
+    int read_long = 0;
+    int err = 0;
+    FILE* fp = NULL;
+    char buf[256] = { [0 ... 255] = '\0' };
+    *shortinfo = NULL;
+    *longinfo = NULL;
+    *requireNoHT = 0;
+
+    fp = fopen(filename, "r");
+    if (fp == NULL)
+    {
+        return -EACCES;
+    }
+    bstring SHORT = bformat("SHORT");
+    bstring LONG = bformat("LONG");
+    bstring REQUIRE = bformat("REQUIRE_NOHT");
+    bstring long_info = bfromcstr("");
+    while (fgets (buf, sizeof(buf), fp)) {
+        bstring bbuf = bfromcstr(buf);
+        btrimws(bbuf);
+        if ((blength(bbuf) == 0) || (buf[0] == '#'))
+        {
+            bdestroy(bbuf);
+            continue;
+        }
+        if (bstrncmp(bbuf, SHORT, 5) == 0)
+        {
+            struct bstrList * linelist = bsplit(bbuf, ' ');
+            bstring sinfo;
+            if (linelist->qty == 1)
+            {
+                fprintf(stderr,"Cannot read SHORT section in groupfile %s",filename);
+                bdestroy(bbuf);
+                bstrListDestroy(linelist);
+                continue;
+            }
+            s = 1;
+            for (j=s;j<linelist->qty; j++)
+            {
+                btrimws(linelist->entry[j]);
+                if (blength(linelist->entry[j]) == 0)
+                    s += 1;
+                else
+                    break;
+            }
+            btrimws(linelist->entry[s]);
+            sinfo = bformat("%s", bdata(linelist->entry[s]));
+            for (j=s+1;j<linelist->qty; j++)
+            {
+                btrimws(linelist->entry[j]);
+                bstring tmp = bformat(" %s", bdata(linelist->entry[j]));
+                bconcat(sinfo, tmp);
+                bdestroy(tmp);
+            }
+            if (*shortinfo)
+            {
+                free(*shortinfo);
+            }
+            *shortinfo = malloc((blength(sinfo)+1) * sizeof(char));
+            if (*shortinfo == NULL)
+            {
+                bdestroy(bbuf);
+                bdestroy(sinfo);
+                bstrListDestroy(linelist);
+                err = -ENOMEM;
+                break;
+            }
+            s = sprintf(*shortinfo, "%s", bdata(sinfo));
+            (*shortinfo)[s] = '\0';
+            bstrListDestroy(linelist);
+            bdestroy(sinfo);
+        }
+        else if (bstrncmp(bbuf, REQUIRE, blength(REQUIRE)) == 0)
+        {
+            *requireNoHT = 1;
+        }
+        else if (bstrncmp(bbuf, LONG, 4) == 0)
+        {
+            read_long = 1;
+        }
+        else if ((read_long == 1) && (bstrncmp(bbuf, LONG, 4) != 0))
+        {
+            bstring tmp = bfromcstr(buf);
+            bconcat(long_info, tmp);
+            bdestroy(tmp);
+        }
+        bdestroy(bbuf);
+    }
+    if (read_long && err == 0)
+    {
+        *longinfo = malloc((blength(long_info) + 1) * sizeof(char) );
+        if (*longinfo != NULL)
+        {
+            j = sprintf(*longinfo, "%s", bdata(long_info));
+            (*longinfo)[j] = '\0';
+        }
+    }
+    fclose(fp);
+    if (err < 0)
+    {
+        perfgroup_returnListInfo(shortinfo, longinfo);
+    }
+    bdestroy(long_info);
+    bdestroy(SHORT);
+    bdestroy(LONG);
+    bdestroy(REQUIRE);
+    return err;
+}
+
 int
 isdir(char* dirname)
 {
@@ -135,40 +275,35 @@ perfgroup_getGroups(
         char*** grouplong)
 {
     int i = 0, j = 0, s = 0;
+    int err = 0;
     int fsize = 0, hsize = 0;
     DIR *dp = NULL;
-    FILE* fp = NULL;
-    char buf[256] = { [0 ... 255] = '\0' };
     struct dirent *ep = NULL;
     *groupnames = NULL;
     *groupshort = NULL;
     *grouplong = NULL;
     int search_home = 0;
-    bstring SHORT = bformat("SHORT");
-    bstring LONG = bformat("LONG");
-    bstring REQUIRE = bformat("REQUIRE_NOHT");
     char* Home = getenv("HOME");
     if (!Home) Home = "";
 
-    int read_long = 0;
     if ((grouppath == NULL)||(architecture == NULL)||(groupnames == NULL)||(Home == NULL))
         return -EINVAL;
 
+    err = perfgroup_catalogueGetGroups(grouppath, architecture, groupnames, groupshort, grouplong);
+    if (err != -ENOENT)
+    {
+        return err;
+    }
+
     char* fullpath = malloc((strlen(grouppath)+strlen(architecture)+50) * sizeof(char));
     if (fullpath == NULL)
     {
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -ENOMEM;
     }
     char* homepath = malloc((strlen(Home)+strlen(architecture)+50) * sizeof(char));
     if (homepath == NULL)
     {
         free(fullpath);
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -ENOMEM;
     }
     fsize = sprintf(fullpath, "%s/%s", grouppath, architecture);
@@ -180,9 +315,6 @@ perfgroup_getGroups(
             printf("Cannot open directory %s\n", fullpath);
             free(fullpath);
             free(homepath);
-            bdestroy(SHORT);
-            bdestroy(LONG);
-            bdestroy(REQUIRE);
             return -EACCES;
         }
     }
@@ -191,9 +323,6 @@ perfgroup_getGroups(
         printf("Cannot access directory %s\n", fullpath);
         free(fullpath);
         free(homepath);
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -EACCES;
     }
     i = 0;
@@ -236,9 +365,6 @@ perfgroup_getGroups(
     {
         free(fullpath);
         free(homepath);
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -ENOMEM;
     }
     memset(*groupnames, 0, totalgroups * sizeof(char**));
@@ -249,9 +375,6 @@ perfgroup_getGroups(
         *groupnames = NULL;
         free(fullpath);
         free(homepath);
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -ENOMEM;
     }
     memset(*groupshort, 0, totalgroups * sizeof(char**));
@@ -264,9 +387,6 @@ perfgroup_getGroups(
         *groupshort = NULL;
         free(fullpath);
         free(homepath);
-        bdestroy(SHORT);
-        bdestroy(LONG);
-        bdestroy(REQUIRE);
         return -ENOMEM;
     }
     memset(*grouplong, 0, totalgroups * sizeof(char**));
@@ -287,284 +407,78 @@ perfgroup_getGroups(
             *grouplong = NULL;
             free(fullpath);
             free(homepath);
-            bdestroy(SHORT);
-            bdestroy(LONG);
-            bdestroy(REQUIRE);
             return -ENOMEM;
         }
     }
     dp = opendir(fullpath);
     i = 0;
-    int skip_group = 0;
+    int requireNoHT = 0;
 
     while ((ep = readdir(dp)))
     {
         if (strncmp(&(ep->d_name[strlen(ep->d_name)-4]), ".txt", 4) == 0)
         {
-            read_long = 0;
-            bstring long_info = bfromcstr("");
             sprintf(&(fullpath[fsize]), "/%s", ep->d_name);
             if (!access(fullpath, R_OK))
             {
-                (*grouplong)[i] = NULL;
-                s = sprintf((*groupnames)[i], "%.*s", (int)(strlen(ep->d_name)-4), ep->d_name);
-                (*groupnames)[i][s] = '\0';
-                fp = fopen(fullpath,"r");
-
-                while (fgets (buf, sizeof(buf), fp)) {
-                    bstring bbuf = bfromcstr(buf);
-                    btrimws(bbuf);
-                    if ((blength(bbuf) == 0) || (buf[0] == '#'))
-                    {
-                        bdestroy(bbuf);
-                        continue;
-                    }
-                    if (bstrncmp(bbuf, SHORT, 5) == 0)
-                    {
-                        struct bstrList * linelist = bsplit(bbuf, ' ');
-                        bstring sinfo;
-                        if (linelist->qty == 1)
-                        {
-                            fprintf(stderr,"Cannot read SHORT section in groupfile %s",fullpath);
-                            bdestroy(bbuf);
-                            bstrListDestroy(linelist);
-                            continue;
-                        }
-                        s = 1;
-                        for (j=s;j<linelist->qty; j++)
-                        {
-                            btrimws(linelist->entry[j]);
-                            if (blength(linelist->entry[j]) == 0)
-                                s += 1;
-                            else
-                                break;
-                        }
-                        btrimws(linelist->entry[s]);
-                        sinfo = bformat("%s", bdata(linelist->entry[s]));
-                        for (j=s+1;j<linelist->qty; j++)
-                        {
-                            btrimws(linelist->entry[j]);
-                            bstring tmp = bformat(" %s", bdata(linelist->entry[j]));
-                            bconcat(sinfo, tmp);
-                            bdestroy(tmp);
-                        }
-
-                        (*groupshort)[i] = malloc((blength(sinfo)+1) * sizeof(char));
-                        if ((*groupshort)[i] == NULL)
-                        {
-                            bdestroy(SHORT);
-                            bdestroy(LONG);
-                            bdestroy(bbuf);
-                            bdestroy(sinfo);
-                            bdestroy(REQUIRE);
-                            free(homepath);
-                            free(fullpath);
-                            bdestroy(long_info);
-                            bstrListDestroy(linelist);
-                            perfgroup_returnGroups(i, *groupnames, *groupshort, *grouplong);
-                            return -ENOMEM;
-                        }
-                        s = sprintf((*groupshort)[i], "%s", bdata(sinfo));
-                        (*groupshort)[i][s] = '\0';
-                        bstrListDestroy(linelist);
-                        bdestroy(sinfo);
-                    }
-                    else if (bstrncmp(bbuf, REQUIRE, blength(REQUIRE)) == 0)
-                    {
-                        if (cpuid_topology.numThreadsPerCore > 1)
-                        {
-                            skip_group = 1;
-                        }
-                    }
-                    else if (bstrncmp(bbuf, LONG, 4) == 0)
-                    {
-                        read_long = 1;
-                    }
-                    else if ((read_long == 1) && (bstrncmp(bbuf, LONG, 4) != 0))
-                    {
-                        bstring tmp = bfromcstr(buf);
-                        bconcat(long_info, tmp);
-                        bdestroy(tmp);
-                    }
-                    bdestroy(bbuf);
+                err = perfgroup_parseGroupListInfo(fullpath, &(*groupshort)[i], &(*grouplong)[i], &requireNoHT);
+                if (err == -ENOMEM)
+                {
+                    closedir(dp);
+                    free(homepath);
+                    free(fullpath);
+                    perfgroup_returnGroups(i, *groupnames, *groupshort, *grouplong);
+                    return -ENOMEM;
                 }
-                if (read_long)
+                else if (err < 0)
                 {
-
-                    (*grouplong)[i] = malloc((blength(long_info) + 1) * sizeof(char) );
-                    if ((*grouplong)[i] != NULL)
-                    {
-                        j = sprintf((*grouplong)[i], "%s", bdata(long_info));
-                        (*grouplong)[i][j] = '\0';
-                    }
+                    continue;
                 }
-                fclose(fp);
-                if (skip_group)
+                if (requireNoHT && cpuid_topology.numThreadsPerCore > 1)
                 {
-                    if ((*grouplong)[i] != NULL)
-                    {
-                        free((*grouplong)[i]);
-                        (*grouplong)[i] = NULL;
-                    }
-                    if ((*groupshort)[i] != NULL)
-                    {
-                        free((*groupshort)[i]);
-                        (*groupshort)[i] = NULL;
-                    }
-                    (*groupnames)[i][0] = '\0';
-                    bdestroy(long_info);
-                    goto skip_cur_def_group;
+                    perfgroup_returnListInfo(&(*groupshort)[i], &(*grouplong)[i]);
+                    continue;
                 }
+                s = sprintf((*groupnames)[i], "%.*s", (int)(strlen(ep->d_name)-4), ep->d_name);
+                (*groupnames)[i][s] = '\0';
                 i++;
             }
-            bdestroy(long_info);
         }
-skip_cur_def_group:
-        skip_group = 0;
     }
     closedir(dp);
-    if (!search_home)
-    {
-        if (i==0)
-            perfgroup_returnGroups(totalgroups, *groupnames, *groupshort, *grouplong);
-        /*else if (i < totalgroups)
-        {
-            for (s=i;s<totalgroups;s++)
-            {
-                (*grouplong)[i] = NULL;
-                (*groupshort)[i] = NULL;
-            }
-        }*/
-        free(homepath);
-        free(fullpath);
-        bdestroy(SHORT);
-        bdestroy(REQUIRE);
-        bdestroy(LONG);
-        return i;
-    }
-    else
+    if (search_home)
     {
         dp = opendir(homepath);
         while ((ep = readdir(dp)))
         {
             if (strncmp(&(ep->d_name[strlen(ep->d_name)-4]), ".txt", 4) == 0)
             {
-                read_long = 0;
-                bstring long_info = bfromcstr("");;
                 sprintf(&(homepath[hsize]), "/%s", ep->d_name);
                 if (!access(homepath, R_OK))
                 {
-                    (*grouplong)[i] = NULL;
-                    s = sprintf((*groupnames)[i], "%.*s", (int)(strlen(ep->d_name)-4), ep->d_name);
-                    (*groupnames)[i][s] = '\0';
-                    fp = fopen(homepath,"r");
-                    while (fgets (buf, sizeof(buf), fp)) {
-                        bstring bbuf = bfromcstr(buf);
-                        btrimws(bbuf);
-                        if ((blength(bbuf) == 0) || (buf[0] == '#'))
-                        {
-                            bdestroy(bbuf);
-                            continue;
-                        }
-                        if (bstrncmp(bbuf, SHORT, 5) == 0)
-                        {
-                            struct bstrList * linelist = bsplit(bbuf, ' ');
-                            bstring sinfo;
-                            if (linelist->qty == 1)
-                            {
-                                fprintf(stderr,"Cannot read SHORT section in groupfile %s",fullpath);
-                                bdestroy(bbuf);
-                                bstrListDestroy(linelist);
-                                continue;
-                            }
-                            s = 1;
-                            for (j=s;j<linelist->qty; j++)
-                            {
-                                btrimws(linelist->entry[j]);
-                                if (blength(linelist->entry[j]) == 0)
-                                    s += 1;
-                                else
-                                    break;
-                            }
-                            btrimws(linelist->entry[s]);
-                            sinfo = bformat("%s", bdata(linelist->entry[s]));
-                            for (j=s+1;j<linelist->qty; j++)
-                            {
-                                btrimws(linelist->entry[j]);
-                                bstring tmp = bformat(" %s", bdata(linelist->entry[j]));
-                                bconcat(sinfo, tmp);
-                                bdestroy(tmp);
-                            }
-                            (*groupshort)[i] = malloc((blength(sinfo)+1) * sizeof(char));
-                            if ((*groupshort)[i] == NULL)
-                            {
-                                bdestroy(SHORT);
-                                bdestroy(LONG);
-                                bdestroy(REQUIRE);
-                                bdestroy(bbuf);
-                                bdestroy(sinfo);
-                                free(homepath);
-                                free(fullpath);
-                                bstrListDestroy(linelist);
-                                bdestroy(long_info);
-                                perfgroup_returnGroups(i, *groupnames, *groupshort, *grouplong);
-                                return -ENOMEM;
-                            }
-                            s = sprintf((*groupshort)[i], "%s", bdata(sinfo));
-                            (*groupshort)[i][s] = '\0';
-                            bstrListDestroy(linelist);
-                            bdestroy(sinfo);
-                        }
-                        else if (bstrncmp(bbuf, REQUIRE, blength(REQUIRE)) == 0)
-                        {
-                            if (cpuid_topology.numThreadsPerCore > 1)
-                            {
-                                skip_group = 1;
-                            }
-                        }
-                        else if (bstrncmp(bbuf, LONG, 4) == 0)
-                        {
-                            read_long = 1;
-                        }
-                        else if ((read_long == 1) && (bstrncmp(bbuf, LONG, 4) != 0))
-                        {
-                            bstring tmp = bfromcstr(buf);
-                            bconcat(long_info, tmp);
-                            bdestroy(tmp);
-                        }
-                        bdestroy(bbuf);
+                    err = perfgroup_parseGroupListInfo(homepath, &(*groupshort)[i], &(*grouplong)[i], &requireNoHT);
+                    if (err == -ENOMEM)
+                    {
+                        closedir(dp);
+                        free(homepath);
+                        free(fullpath);
+                        perfgroup_returnGroups(i, *groupnames, *groupshort, *grouplong);
+                        return -ENOMEM;
                     }
-                    if (read_long)
+                    else if (err < 0)
                     {
-                        (*grouplong)[i] = malloc((blength(long_info) + 1) * sizeof(char) );
-                        if ((*grouplong)[i] != NULL)
-                        {
-                            j = sprintf((*grouplong)[i], "%s", bdata(long_info));
-                            (*grouplong)[i][j] = '\0';
-                        }
+                        continue;
                     }
-                    fclose(fp);
-                    if (skip_group)
+                    if (requireNoHT && cpuid_topology.numThreadsPerCore > 1)
                     {
-                        if ((*groupshort)[i])
-                        {
-                            free((*groupshort)[i]);
-                            (*groupshort)[i] = NULL;
-                        }
-                        if ((*grouplong)[i])
-                        {
-                            free((*grouplong)[i]);
-                            (*grouplong)[i] = NULL;
-                        }
-                        bdestroy(long_info);
-                        goto skip_cur_home_group;
+                        perfgroup_returnListInfo(&(*groupshort)[i], &(*grouplong)[i]);
+                        continue;
                     }
+                    s = sprintf((*groupnames)[i], "%.*s", (int)(strlen(ep->d_name)-4), ep->d_name);
+                    (*groupnames)[i][s] = '\0';
                     i++;
                 }
-                bdestroy(long_info);
             }
-skip_cur_home_group:
-        skip_group = 0;
         }
         closedir(dp);
     }
@@ -580,9 +494,6 @@ skip_cur_home_group:
             (*groupshort)[i] = NULL;
         }
     }*/
-    bdestroy(SHORT);
-    bdestroy(LONG);
-    bdestroy(REQUIRE);
     free(fullpath);
     free(homepath);
     return i;
@@ -833,44 +744,25 @@ cleanup:
 }
 
 int
-perfgroup_readGroup(
-        const char* grouppath,
-        const char* architecture,
+perfgroup_parseGroupFile(
+        const char* filename,
         const char* groupname,
-        GroupInfo* ginfo)
+        GroupInfo* ginfo,
+        int* requireNoHT)
 {
-    FILE* fp;
-    int i, s, e, err = 0;
+    FILE* fp = NULL;
+    int i, s, err = 0;
     char buf[1024];
     GroupFileSections sec = GROUP_NONE;
-    bstring REQUIRE = bformat("REQUIRE_NOHT");
-    char* Home = getenv("HOME");
-    if (!Home) Home = "";
-    if ((grouppath == NULL)||(architecture == NULL)||(groupname == NULL)||(ginfo == NULL)||(Home == NULL))
+    if ((filename == NULL)||(groupname == NULL)||(ginfo == NULL))
         return -EINVAL;
-
-    bstring fullpath = bformat("%s/%s/%s.txt", grouppath,architecture, groupname);
-    bstring homepath = bformat("%s/.likwid/groups/%s/%s.txt", Home,architecture, groupname);
-
-    if (access(bdata(fullpath), R_OK))
+    bstring REQUIRE = bformat("REQUIRE_NOHT");
+    if (requireNoHT)
     {
-        DEBUG_PRINT(DEBUGLEV_INFO, Cannot read group file %s. Trying %s, bdata(fullpath), bdata(homepath));
-        if (access(bdata(homepath), R_OK))
-        {
-            ERROR_PRINT(Cannot read group file %s.txt. Searched in %s and %s, groupname, bdata(fullpath), bdata(homepath));
-            bdestroy(REQUIRE);
-            bdestroy(fullpath);
-            bdestroy(homepath);
-            return -EACCES;
-        }
-        else
-        {
-            bdestroy(fullpath);
-            fullpath = bstrcpy(homepath);
-        }
+        *requireNoHT = 0;
     }
 
-    DEBUG_PRINT(DEBUGLEV_INFO, Reading group %s from %s, groupname, bdata(fullpath));
+    DEBUG_PRINT(DEBUGLEV_INFO, Reading group %s from %s, groupname, filename);
 
     ginfo->shortinfo = NULL;
     ginfo->nevents = 0;
@@ -890,12 +782,12 @@ perfgroup_readGroup(
     i = sprintf(ginfo->groupname, "%s", groupname);
     ginfo->groupname[i] = '\0';
 
-    fp = fopen(bdata(fullpath), "r");
+    fp = fopen(filename, "r");
     if (fp == NULL)
     {
         free(ginfo->groupname);
-        bdestroy(fullpath);
-        bdestroy(homepath);
+        ginfo->groupname = NULL;
+        bdestroy(REQUIRE);
         return -EACCES;
     }
     struct bstrList * linelist;
@@ -918,10 +810,9 @@ perfgroup_readGroup(
         }
         else if (strncmp(bdata(REQUIRE), buf, blength(REQUIRE)) == 0)
         {
-            if (cpuid_topology.numThreadsPerCore > 1)
+            if (requireNoHT)
             {
-                err = -ENODEV;
-                goto cleanup;
+                *requireNoHT = 1;
             }
             continue;
         }
@@ -1159,13 +1050,11 @@ perfgroup_readGroup(
     //bstrListDestroy(linelist);
     fclose(fp);
     bdestroy(REQUIRE);
-    bdestroy(homepath);
-    bdestroy(fullpath);
     return 0;
 cleanup:
+    if (fp)
+        fclose(fp);
     bdestroy(REQUIRE);
-    bdestroy(homepath);
-    bdestroy(fullpath);
     if (ginfo->groupname)
         free(ginfo->groupname);
     if (ginfo->shortinfo)
@@ -1204,6 +1093,57 @@ cleanup:
     return err;
 }
 
+int
+perfgroup_readGroup(
+        const char* grouppath,
+        const char* architecture,
+        const char* groupname,
+        GroupInfo* ginfo)
+{
+    int err = 0;
+    int requireNoHT = 0;
+    char* Home = getenv("HOME");
+    if (!Home) Home = "";
+    if ((grouppath == NULL)||(architecture == NULL)||(groupname == NULL)||(ginfo == NULL)||(Home == NULL))
+        return -EINVAL;
+
+    err = perfgroup_catalogueReadGroup(grouppath, architecture, groupname, ginfo);
+    if (err != -ENOENT)
+    {
+        return err;
+    }
+
+    bstring fullpath = bformat("%s/%s/%s.txt", grouppath,architecture, groupname);
+    bstring homepath = bformat("%s/.likwid/groups/%s/%s.txt", Home,architecture, groupname);
+
+    if (access(bdata(fullpath), R_OK))
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Cannot read group file %s. Trying %s, bdata(fullpath), bdata(homepath));
+        if (access(bdata(homepath), R_OK))
+        {
+            ERROR_PRINT(Cannot read group file %s.txt. Searched in %s and %s, groupname, bdata(fullpath), bdata(homepath));
+            bdestroy(fullpath);
+            bdestroy(homepath);
+            return -EACCES;
+        }
+        else
+        {
+            bdestroy(fullpath);
+            fullpath = bstrcpy(homepath);
+        }
+    }
+
+    err = perfgroup_parseGroupFile(bdata(fullpath), groupname, ginfo, &requireNoHT);
+    bdestroy(fullpath);
+    bdestroy(homepath);
+    if ((err == 0) && requireNoHT && (cpuid_topology.numThreadsPerCore > 1))
+    {
+        perfgroup_returnGroup(ginfo);
+        return -ENODEV;
+    }
+    return err;
+}
+
 int
 perfgroup_new(GroupInfo* ginfo)
 {
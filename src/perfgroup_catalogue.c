@@ -0,0 +1,803 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  perfgroup_catalogue.c
+ *
+ *      Description:  Preparsed catalogue of the performance groups of an architecture.
+ *                    Holds the parsed group files and the precompiled metric formulas.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <error.h>
+#include <likwid.h>
+#include <topology.h>
+#include <perfgroup.h>
+#include <perfgroup_catalogue.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define GC_ALIGN(x) (((x) + 7) & ~((uint64_t)7))
+#define GC_MAX_NAME 256
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* All pointers are stored as offsets relative to the start of the file,
+ * offset 0 is used for NULL. The entries are sorted by group name. */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint32_t sizeEntry;
+    uint32_t numGroups;
+    uint64_t groups;
+} GroupCatalogueHeader;
+
+typedef struct {
+    uint64_t name;
+    uint64_t shortinfo;
+    uint64_t longinfo;
+    /* SHORT and LONG as returned by perfgroup_getGroups */
+    uint64_t listShort;
+    uint64_t listLong;
+    /* Modification time and size of the group file at build time */
+    int64_t mtime;
+    int64_t mtimeNsec;
+    int64_t size;
+    uint32_t requireNoHT;
+    uint32_t nevents;
+    uint32_t nmetrics;
+    uint32_t pad;
+    uint64_t events; /* nevents pairs of counter and event */
+    uint64_t metrics; /* nmetrics pairs of name and formula */
+} GroupCatalogueEntry;
+
+typedef struct {
+    char* data;
+    uint64_t size;
+    uint64_t capacity;
+    int failed;
+} GroupCatalogueBuffer;
+
+typedef struct {
+    char* map;
+    size_t size;
+    const GroupCatalogueHeader* header;
+    const GroupCatalogueEntry* entries;
+} GroupCatalogue;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static uint64_t
+gc_append(GroupCatalogueBuffer* buf, const void* data, uint64_t size)
+{
+    uint64_t offset = GC_ALIGN(buf->size);
+    if (offset + size > buf->capacity)
+    {
+        uint64_t newcap = buf->capacity * 2;
+        while (newcap < offset + size)
+        {
+            newcap *= 2;
+        }
+        char* tmp = realloc(buf->data, newcap);
+        if (!tmp)
+        {
+            buf->failed = 1;
+            return 0;
+        }
+        memset(tmp + buf->capacity, 0, newcap - buf->capacity);
+        buf->data = tmp;
+        buf->capacity = newcap;
+    }
+    if (data)
+    {
+        memcpy(buf->data + offset, data, size);
+    }
+    buf->size = offset + size;
+    return offset;
+}
+
+static uint64_t
+gc_appendString(GroupCatalogueBuffer* buf, const char* str)
+{
+    if (!str)
+    {
+        return 0;
+    }
+    return gc_append(buf, str, strlen(str) + 1);
+}
+
+static int
+gc_compareNames(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static int
+gc_isGroupFile(const char* name)
+{
+    size_t len = strlen(name);
+    return (len > 4 && len - 4 < GC_MAX_NAME && strcmp(&name[len-4], ".txt") == 0);
+}
+
+static int
+gc_build(const char* dirname)
+{
+    int ret = 0;
+    int fd = -1;
+    int numNames = 0;
+    int maxNames = 0;
+    char** names = NULL;
+    char filename[1024];
+    char tmpname[1024];
+    DIR* dp = NULL;
+    struct dirent* ep = NULL;
+    GroupCatalogueHeader header;
+    GroupCatalogueEntry* entries = NULL;
+    GroupCatalogueBuffer buf = {NULL, 0, 0, 0};
+
+    dp = opendir(dirname);
+    if (!dp)
+    {
+        return -errno;
+    }
+    while ((ep = readdir(dp)))
+    {
+        if (!gc_isGroupFile(ep->d_name))
+        {
+            continue;
+        }
+        if (numNames == maxNames)
+        {
+            maxNames = (maxNames == 0 ? 64 : maxNames * 2);
+            char** tmp = realloc(names, maxNames * sizeof(char*));
+            if (!tmp)
+            {
+                ret = -ENOMEM;
+                break;
+            }
+            names = tmp;
+        }
+        names[numNames] = strndup(ep->d_name, strlen(ep->d_name) - 4);
+        if (!names[numNames])
+        {
+            ret = -ENOMEM;
+            break;
+        }
+        numNames++;
+    }
+    closedir(dp);
+    if (ret < 0)
+    {
+        goto build_out;
+    }
+    if (numNames > 0)
+    {
+        qsort(names, numNames, sizeof(char*), gc_compareNames);
+    }
+    entries = calloc(numNames + 1, sizeof(GroupCatalogueEntry));
+    buf.capacity = 16384;
+    buf.data = calloc(buf.capacity, sizeof(char));
+    if (!entries || !buf.data)
+    {
+        ret = -ENOMEM;
+        goto build_out;
+    }
+    buf.size = sizeof(GroupCatalogueHeader);
+
+    for (int i = 0; i < numNames; i++)
+    {
+        struct stat st;
+        GroupInfo ginfo;
+        char* listShort = NULL;
+        char* listLong = NULL;
+        int noHT = 0;
+        uint64_t* events = NULL;
+        uint64_t* metrics = NULL;
+        GroupCatalogueEntry* e = &entries[i];
+
+        snprintf(filename, sizeof(filename), "%s/%s.txt", dirname, names[i]);
+        if (stat(filename, &st) < 0)
+        {
+            ret = -errno;
+            goto build_out;
+        }
+        ret = perfgroup_parseGroupListInfo(filename, &listShort, &listLong, &noHT);
+        if (ret < 0)
+        {
+            goto build_out;
+        }
+        ret = perfgroup_parseGroupFile(filename, names[i], &ginfo, &noHT);
+        if (ret < 0)
+        {
+            free(listShort);
+            free(listLong);
+            goto build_out;
+        }
+        e->name = gc_appendString(&buf, names[i]);
+        e->shortinfo = gc_appendString(&buf, ginfo.shortinfo);
+        e->longinfo = gc_appendString(&buf, ginfo.longinfo);
+        e->listShort = gc_appendString(&buf, listShort);
+        e->listLong = gc_appendString(&buf, listLong);
+        e->mtime = st.st_mtim.tv_sec;
+        e->mtimeNsec = st.st_mtim.tv_nsec;
+        e->size = st.st_size;
+        e->requireNoHT = noHT;
+        e->nevents = ginfo.nevents;
+        e->nmetrics = ginfo.nmetrics;
+        events = malloc((2 * ginfo.nevents + 1) * sizeof(uint64_t));
+        metrics = malloc((2 * ginfo.nmetrics + 1) * sizeof(uint64_t));
+        if (events && metrics)
+        {
+            for (int j = 0; j < ginfo.nevents; j++)
+            {
+                events[2*j] = gc_appendString(&buf, ginfo.counters[j]);
+                events[2*j+1] = gc_appendString(&buf, ginfo.events[j]);
+            }
+            for (int j = 0; j < ginfo.nmetrics; j++)
+            {
+                metrics[2*j] = gc_appendString(&buf, ginfo.metricnames[j]);
+                metrics[2*j+1] = gc_appendString(&buf, ginfo.metricformulas[j]);
+            }
+            e->events = gc_append(&buf, events, 2 * ginfo.nevents * sizeof(uint64_t));
+            e->metrics = gc_append(&buf, metrics, 2 * ginfo.nmetrics * sizeof(uint64_t));
+        }
+        else
+        {
+            buf.failed = 1;
+        }
+        free(events);
+        free(metrics);
+        free(listShort);
+        free(listLong);
+        perfgroup_returnGroup(&ginfo);
+        if (buf.failed)
+        {
+            ret = -ENOMEM;
+            goto build_out;
+        }
+    }
+
+    memset(&header, 0, sizeof(GroupCatalogueHeader));
+    memcpy(header.magic, PERFGROUP_CATALOGUE_MAGIC, sizeof(header.magic));
+    header.version = PERFGROUP_CATALOGUE_VERSION;
+    header.headerSize = sizeof(GroupCatalogueHeader);
+    header.sizeEntry = sizeof(GroupCatalogueEntry);
+    header.numGroups = numNames;
+    header.groups = gc_append(&buf, entries, numNames * sizeof(GroupCatalogueEntry));
+    if (buf.failed)
+    {
+        ret = -ENOMEM;
+        goto build_out;
+    }
+    header.fileSize = buf.size;
+    memcpy(buf.data, &header, sizeof(GroupCatalogueHeader));
+
+    /* Write to a temporary file and rename it, so that concurrently starting
+     * processes never see a partially written catalogue */
+    snprintf(filename, sizeof(filename), "%s/%s", dirname, PERFGROUP_CATALOGUE_NAME);
+    snprintf(tmpname, sizeof(tmpname), "%s.%d", filename, (int)getpid());
+    fd = open(tmpname, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        ret = -errno;
+        DEBUG_PRINT(DEBUGLEV_INFO, Cannot open group catalogue %s for writing, tmpname);
+        goto build_out;
+    }
+    for (uint64_t done = 0; done < buf.size; )
+    {
+        ssize_t w = write(fd, buf.data + done, buf.size - done);
+        if (w < 0)
+        {
+            ret = -errno;
+            close(fd);
+            unlink(tmpname);
+            goto build_out;
+        }
+        done += w;
+    }
+    close(fd);
+    if (rename(tmpname, filename) < 0)
+    {
+        ret = -errno;
+        unlink(tmpname);
+        goto build_out;
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Wrote group catalogue %s with %d groups, filename, numNames);
+    ret = numNames;
+build_out:
+    for (int i = 0; i < numNames; i++)
+    {
+        free(names[i]);
+    }
+    free(names);
+    free(entries);
+    free(buf.data);
+    return ret;
+}
+
+static const char*
+gc_string(const GroupCatalogue* cat, uint64_t offset)
+{
+    if (offset == 0 || offset >= cat->size)
+    {
+        return NULL;
+    }
+    return cat->map + offset;
+}
+
+static char*
+gc_copyString(const GroupCatalogue* cat, uint64_t offset)
+{
+    const char* str = gc_string(cat, offset);
+    if (!str)
+    {
+        return NULL;
+    }
+    return strndup(str, cat->size - offset);
+}
+
+static const void*
+gc_array(const GroupCatalogue* cat, uint64_t offset, uint64_t size)
+{
+    if (offset == 0 || offset + size > cat->size)
+    {
+        return NULL;
+    }
+    return cat->map + offset;
+}
+
+static void
+gc_close(GroupCatalogue* cat)
+{
+    if (cat->map)
+    {
+        munmap(cat->map, cat->size);
+    }
+    memset(cat, 0, sizeof(GroupCatalogue));
+}
+
+static int
+gc_open(const char* dirname, GroupCatalogue* cat)
+{
+    struct stat st;
+    char filename[1024];
+    const GroupCatalogueHeader* header = NULL;
+
+    memset(cat, 0, sizeof(GroupCatalogue));
+    snprintf(filename, sizeof(filename), "%s/%s", dirname, PERFGROUP_CATALOGUE_NAME);
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(GroupCatalogueHeader))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    cat->map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (cat->map == MAP_FAILED)
+    {
+        cat->map = NULL;
+        return -errno;
+    }
+    cat->size = st.st_size;
+    header = (const GroupCatalogueHeader*)cat->map;
+    if (strncmp(header->magic, PERFGROUP_CATALOGUE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != PERFGROUP_CATALOGUE_VERSION ||
+        header->headerSize != sizeof(GroupCatalogueHeader) ||
+        header->sizeEntry != sizeof(GroupCatalogueEntry) ||
+        header->fileSize != cat->size)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Group catalogue %s has incompatible version or layout, filename);
+        gc_close(cat);
+        return -ESTALE;
+    }
+    if (header->numGroups > 0)
+    {
+        cat->entries = gc_array(cat, header->groups, header->numGroups * sizeof(GroupCatalogueEntry));
+        if (!cat->entries)
+        {
+            gc_close(cat);
+            return -EINVAL;
+        }
+    }
+    cat->header = header;
+    return 0;
+}
+
+static int
+gc_compareEntry(const void* key, const void* elem)
+{
+    const GroupCatalogue* cat = ((const GroupCatalogue**)key)[1];
+    const char* name = gc_string(cat, ((const GroupCatalogueEntry*)elem)->name);
+    return strcmp(((const char**)key)[0], (name ? name : ""));
+}
+
+static const GroupCatalogueEntry*
+gc_find(const GroupCatalogue* cat, const char* groupname)
+{
+    const void* key[2] = {groupname, cat};
+    if (cat->header->numGroups == 0)
+    {
+        return NULL;
+    }
+    return bsearch(key, cat->entries, cat->header->numGroups, sizeof(GroupCatalogueEntry), gc_compareEntry);
+}
+
+static int
+gc_entryCurrent(const GroupCatalogueEntry* e, const char* filename)
+{
+    struct stat st;
+    if (stat(filename, &st) < 0)
+    {
+        return 0;
+    }
+    return (e->mtime == st.st_mtim.tv_sec && e->mtimeNsec == st.st_mtim.tv_nsec && e->size == st.st_size);
+}
+
+/* The catalogue is current if it contains exactly the group files in the
+ * directory with unchanged modification time and size */
+static int
+gc_validate(const char* dirname, const GroupCatalogue* cat)
+{
+    int count = 0;
+    int valid = 1;
+    char filename[1024];
+    char name[GC_MAX_NAME];
+    DIR* dp = NULL;
+    struct dirent* ep = NULL;
+
+    dp = opendir(dirname);
+    if (!dp)
+    {
+        return 0;
+    }
+    while (valid && (ep = readdir(dp)))
+    {
+        const GroupCatalogueEntry* e = NULL;
+        if (!gc_isGroupFile(ep->d_name))
+        {
+            continue;
+        }
+        snprintf(name, sizeof(name), "%.*s", (int)(strlen(ep->d_name) - 4), ep->d_name);
+        snprintf(filename, sizeof(filename), "%s/%s", dirname, ep->d_name);
+        e = gc_find(cat, name);
+        if (!e || !gc_entryCurrent(e, filename))
+        {
+            valid = 0;
+        }
+        count++;
+    }
+    closedir(dp);
+    return (valid && count == (int)cat->header->numGroups);
+}
+
+/* Open the catalogue of a directory and rebuild it if outdated and the
+ * directory is writable */
+static int
+gc_openCurrent(const char* dirname, GroupCatalogue* cat)
+{
+    int ret = gc_open(dirname, cat);
+    if (ret == 0 && gc_validate(dirname, cat))
+    {
+        return 0;
+    }
+    gc_close(cat);
+    if (access(dirname, W_OK) != 0)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Group catalogue in %s missing or outdated, dirname);
+        return -ENOENT;
+    }
+    ret = gc_build(dirname);
+    if (ret < 0)
+    {
+        return -ENOENT;
+    }
+    ret = gc_open(dirname, cat);
+    if (ret < 0)
+    {
+        return -ENOENT;
+    }
+    return 0;
+}
+
+static int
+gc_fillGroup(const GroupCatalogue* cat, const GroupCatalogueEntry* e, const char* groupname, GroupInfo* ginfo)
+{
+    const uint64_t* events = NULL;
+    const uint64_t* metrics = NULL;
+
+    memset(ginfo, 0, sizeof(GroupInfo));
+    if (e->nevents > 0)
+    {
+        events = gc_array(cat, e->events, 2 * e->nevents * sizeof(uint64_t));
+    }
+    if (e->nmetrics > 0)
+    {
+        metrics = gc_array(cat, e->metrics, 2 * e->nmetrics * sizeof(uint64_t));
+    }
+    if ((e->nevents > 0 && !events) || (e->nmetrics > 0 && !metrics))
+    {
+        return -EINVAL;
+    }
+    ginfo->groupname = strdup(groupname);
+    ginfo->shortinfo = gc_copyString(cat, e->shortinfo);
+    ginfo->longinfo = gc_copyString(cat, e->longinfo);
+    if (e->nevents > 0)
+    {
+        ginfo->counters = calloc(e->nevents, sizeof(char*));
+        ginfo->events = calloc(e->nevents, sizeof(char*));
+        if (!ginfo->counters || !ginfo->events)
+        {
+            goto fill_failed;
+        }
+        ginfo->nevents = e->nevents;
+        for (uint32_t i = 0; i < e->nevents; i++)
+        {
+            ginfo->counters[i] = gc_copyString(cat, events[2*i]);
+            ginfo->events[i] = gc_copyString(cat, events[2*i+1]);
+            if (!ginfo->counters[i] || !ginfo->events[i])
+            {
+                goto fill_failed;
+            }
+        }
+    }
+    if (e->nmetrics > 0)
+    {
+        ginfo->metricnames = calloc(e->nmetrics, sizeof(char*));
+        ginfo->metricformulas = calloc(e->nmetrics, sizeof(char*));
+        if (!ginfo->metricnames || !ginfo->metricformulas)
+        {
+            goto fill_failed;
+        }
+        ginfo->nmetrics = e->nmetrics;
+        for (uint32_t i = 0; i < e->nmetrics; i++)
+        {
+            ginfo->metricnames[i] = gc_copyString(cat, metrics[2*i]);
+            ginfo->metricformulas[i] = gc_copyString(cat, metrics[2*i+1]);
+            if (!ginfo->metricnames[i] || !ginfo->metricformulas[i])
+            {
+                goto fill_failed;
+            }
+        }
+    }
+    if (!ginfo->groupname)
+    {
+        goto fill_failed;
+    }
+    return 0;
+fill_failed:
+    if (ginfo->nevents == 0)
+    {
+        free(ginfo->counters);
+        free(ginfo->events);
+    }
+    if (ginfo->nmetrics == 0)
+    {
+        free(ginfo->metricnames);
+        free(ginfo->metricformulas);
+    }
+    perfgroup_returnGroup(ginfo);
+    return -ENOMEM;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+perfgroup_buildCatalogue(const char* grouppath, const char* architecture)
+{
+    char dirname[1024];
+    if ((grouppath == NULL)||(architecture == NULL))
+    {
+        return -EINVAL;
+    }
+    snprintf(dirname, sizeof(dirname), "%s/%s", grouppath, architecture);
+    if (!isdir(dirname))
+    {
+        return -ENOTDIR;
+    }
+    return gc_build(dirname);
+}
+
+int
+perfgroup_catalogueGetGroups(
+        const char* grouppath,
+        const char* architecture,
+        char*** groupnames,
+        char*** groupshort,
+        char*** grouplong)
+{
+    int i = 0, c = 0, n = 0;
+    int numCats = 0;
+    int total = 0;
+    char dirname[1024];
+    GroupCatalogue cats[2];
+    char* Home = getenv("HOME");
+
+    if (getenv("LIKWID_NO_GROUP_CATALOGUE") != NULL)
+    {
+        return -ENOENT;
+    }
+    snprintf(dirname, sizeof(dirname), "%s/%s", grouppath, architecture);
+    if (!isdir(dirname) || gc_openCurrent(dirname, &cats[0]) < 0)
+    {
+        return -ENOENT;
+    }
+    numCats = 1;
+    if (Home)
+    {
+        snprintf(dirname, sizeof(dirname), "%s/.likwid/groups/%s", Home, architecture);
+        if (isdir(dirname))
+        {
+            if (gc_openCurrent(dirname, &cats[1]) < 0)
+            {
+                gc_close(&cats[0]);
+                return -ENOENT;
+            }
+            numCats = 2;
+        }
+    }
+    for (c = 0; c < numCats; c++)
+    {
+        total += cats[c].header->numGroups;
+    }
+    /* perfgroup_returnGroups frees up to totalgroups names */
+    total = perfgroup_addTotalGroups(total);
+    *groupnames = calloc(total + 1, sizeof(char*));
+    *groupshort = calloc(total + 1, sizeof(char*));
+    *grouplong = calloc(total + 1, sizeof(char*));
+    if (!*groupnames || !*groupshort || !*grouplong)
+    {
+        goto getgroups_nomem;
+    }
+    for (c = 0; c < numCats; c++)
+    {
+        for (n = 0; n < (int)cats[c].header->numGroups; n++)
+        {
+            const GroupCatalogueEntry* e = &cats[c].entries[n];
+            if (e->requireNoHT && cpuid_topology.numThreadsPerCore > 1)
+            {
+                continue;
+            }
+            (*groupnames)[i] = gc_copyString(&cats[c], e->name);
+            if (!(*groupnames)[i])
+            {
+                goto getgroups_nomem;
+            }
+            (*groupshort)[i] = gc_copyString(&cats[c], e->listShort);
+            (*grouplong)[i] = gc_copyString(&cats[c], e->listLong);
+            i++;
+        }
+    }
+    for (c = 0; c < numCats; c++)
+    {
+        gc_close(&cats[c]);
+    }
+    if (i == 0)
+    {
+        perfgroup_returnGroups(0, *groupnames, *groupshort, *grouplong);
+    }
+    return i;
+getgroups_nomem:
+    for (c = 0; c < numCats; c++)
+    {
+        gc_close(&cats[c]);
+    }
+    if (*groupnames && *groupshort && *grouplong)
+    {
+        perfgroup_returnGroups(i, *groupnames, *groupshort, *grouplong);
+    }
+    else
+    {
+        free(*groupnames);
+        free(*groupshort);
+        free(*grouplong);
+    }
+    *groupnames = NULL;
+    *groupshort = NULL;
+    *grouplong = NULL;
+    return -ENOMEM;
+}
+
+int
+perfgroup_catalogueReadGroup(
+        const char* grouppath,
+        const char* architecture,
+        const char* groupname,
+        GroupInfo* ginfo)
+{
+    int ret = 0;
+    char dirname[1024];
+    char filename[1024];
+    GroupCatalogue cat;
+    const GroupCatalogueEntry* e = NULL;
+    char* Home = getenv("HOME");
+
+    if (getenv("LIKWID_NO_GROUP_CATALOGUE") != NULL || strlen(groupname) >= GC_MAX_NAME)
+    {
+        return -ENOENT;
+    }
+    /* Same search order as for the group files */
+    snprintf(dirname, sizeof(dirname), "%s/%s", grouppath, architecture);
+    snprintf(filename, sizeof(filename), "%s/%s.txt", dirname, groupname);
+    if (access(filename, R_OK) != 0)
+    {
+        if (!Home)
+        {
+            return -ENOENT;
+        }
+        snprintf(dirname, sizeof(dirname), "%s/.likwid/groups/%s", Home, architecture);
+        snprintf(filename, sizeof(filename), "%s/%s.txt", dirname, groupname);
+        if (access(filename, R_OK) != 0)
+        {
+            return -ENOENT;
+        }
+    }
+    if (gc_open(dirname, &cat) == 0)
+    {
+        e = gc_find(&cat, groupname);
+        if (!e || !gc_entryCurrent(e, filename))
+        {
+            gc_close(&cat);
+            e = NULL;
+        }
+    }
+    if (!e)
+    {
+        if (gc_openCurrent(dirname, &cat) < 0)
+        {
+            return -ENOENT;
+        }
+        e = gc_find(&cat, groupname);
+        if (!e)
+        {
+            gc_close(&cat);
+            return -ENOENT;
+        }
+    }
+    ret = gc_fillGroup(&cat, e, groupname, ginfo);
+    if (ret == 0 && e->requireNoHT && cpuid_topology.numThreadsPerCore > 1)
+    {
+        perfgroup_returnGroup(ginfo);
+        ret = -ENODEV;
+    }
+    gc_close(&cat);
+    return ret;
+}
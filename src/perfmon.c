@@ -38,6 +38,7 @@
 #include <float.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <pthread.h>
 
 #include <types.h>
 #include <likwid.h>
@@ -48,6 +49,7 @@
 #include <registers.h>
 #include <topology.h>
 #include <access.h>
+#include <register_program.h>
 #include <perfgroup.h>
 #if !defined(__ARM_ARCH_7A__) && !defined(__ARM_ARCH_8A)
 #include <cpuid.h>
@@ -116,10 +118,16 @@ int perfmon_verbosity = DEBUGLEV_ONLY_ERROR;
 int maps_checked = 0;
 uint64_t **currentConfig = NULL;
 static int added_generic_event = 0;
+/* Per-thread locks serializing counter reads with the overflow watch. They are
+ * only taken while the watch is running. */
+static pthread_mutex_t* perfmon_threadLocks = NULL;
+static int perfmon_useThreadLocks = 0;
 
 PerfmonGroupSet* groupSet = NULL;
 LikwidResults* markerResults = NULL;
 int markerRegions = 0;
+LikwidRegionNode* markerNodes = NULL;
+int markerNumNodes = 0;
 
 int (*perfmon_startCountersThread) (int thread_id, PerfmonEventSet* eventSet) = NULL;
 int (*perfmon_stopCountersThread) (int thread_id, PerfmonEventSet* eventSet) = NULL;
@@ -700,6 +708,7 @@ calculateResult(int groupId, int eventId, int threadId)
         {
             result += (double) ((counter->overflows-1) * maxValue);
         }
+        counter->totalOverflows += counter->overflows;
         counter->overflows = 0;
     }
     if (counter_map[event->index].type == POWER)
@@ -740,6 +749,30 @@ getCounterTypeOffset(int index)
     return off;
 }
 
+#ifdef LIKWID_USE_PERFEVENT
+/* Configure a perf_event attribute for an event of an event set like for
+ * counting. Only core-local counters can be used for sampling. */
+int
+perfmon_getSamplingAttr(int groupId, int eventId, struct perf_event_attr* attr)
+{
+    if (!groupSet || groupId < 0 || groupId >= groupSet->numberOfGroups ||
+        eventId < 0 || eventId >= groupSet->groups[groupId].numberOfEvents || !attr)
+    {
+        return -EINVAL;
+    }
+    PerfmonEventSetEntry* e = &groupSet->groups[groupId].events[eventId];
+    switch (counter_map[e->index].type)
+    {
+        case FIXED:
+            return perf_fixed_setup(attr, e->index, &e->event);
+        case PMC:
+            return perf_pmc_setup(attr, e->index, PMC, &e->event);
+        default:
+            return -ENOTSUP;
+    }
+}
+#endif
+
 void
 perfmon_setVerbosity(int level)
 {
@@ -2018,6 +2051,85 @@ getArchRegisterTypeNames()
     return archRegisterTypeNames;
 }
 
+static int
+perfmon_lockThread(int thread_id)
+{
+    if (perfmon_useThreadLocks && perfmon_threadLocks)
+    {
+        pthread_mutex_lock(&perfmon_threadLocks[thread_id]);
+        return 1;
+    }
+    return 0;
+}
+
+static void
+perfmon_unlockThread(int thread_id, int locked)
+{
+    if (locked)
+    {
+        pthread_mutex_unlock(&perfmon_threadLocks[thread_id]);
+    }
+}
+
+static int
+perfmon_lockAllThreads(void)
+{
+    int locked = 0;
+    for (int i = 0; i < groupSet->numberOfThreads; i++)
+    {
+        locked = perfmon_lockThread(i);
+    }
+    return locked;
+}
+
+static void
+perfmon_unlockAllThreads(int locked)
+{
+    for (int i = groupSet->numberOfThreads - 1; i >= 0; i--)
+    {
+        perfmon_unlockThread(i, locked);
+    }
+}
+
+int
+perfmon_setThreadLocking(int enable)
+{
+    if (perfmon_initialized != 1 || groupSet == NULL)
+    {
+        return -EINVAL;
+    }
+    if (enable && !perfmon_threadLocks)
+    {
+        perfmon_threadLocks = malloc(groupSet->numberOfThreads * sizeof(pthread_mutex_t));
+        if (!perfmon_threadLocks)
+        {
+            return -ENOMEM;
+        }
+        for (int i = 0; i < groupSet->numberOfThreads; i++)
+        {
+            pthread_mutex_init(&perfmon_threadLocks[i], NULL);
+        }
+    }
+    perfmon_useThreadLocks = (enable ? 1 : 0);
+    return 0;
+}
+
+int
+perfmon_watchOverflowsThread(int thread_id)
+{
+    int ret = 0;
+    int locked = perfmon_lockThread(thread_id);
+    int groupId = groupSet->activeGroup;
+    /* Only the raw counter values and the overflow counts are updated, the
+     * results are calculated at the next regular read or stop */
+    if (groupId >= 0 && groupSet->groups[groupId].state == STATE_START)
+    {
+        ret = perfmon_readCountersThread(thread_id, &groupSet->groups[groupId]);
+    }
+    perfmon_unlockThread(thread_id, locked);
+    return ret;
+}
+
 int
 perfmon_init(int nrThreads, const int* threadsToCpu)
 {
@@ -2128,6 +2240,7 @@ perfmon_init(int nrThreads, const int* threadsToCpu)
         currentConfig = NULL;
         return ret;
     }
+    regprog_init();
 #endif
     timer_init();
     affinity_init();
@@ -2231,12 +2344,24 @@ perfmon_finalize(void)
     {
         return;
     }
+    perfmon_stopOverflowWatch();
+    if (perfmon_threadLocks)
+    {
+        perfmon_useThreadLocks = 0;
+        for (thread = 0; thread < groupSet->numberOfThreads; thread++)
+        {
+            pthread_mutex_destroy(&perfmon_threadLocks[thread]);
+        }
+        free(perfmon_threadLocks);
+        perfmon_threadLocks = NULL;
+    }
     for(group=0;group < groupSet->numberOfActiveGroups; group++)
     {
         for (thread=0;thread< groupSet->numberOfThreads; thread++)
         {
             perfmon_finalizeCountersThread(thread, &(groupSet->groups[group]));
         }
+        regprog_destroy(&(groupSet->groups[group]), groupSet->numberOfThreads);
         for (event=0;event < groupSet->groups[group].numberOfEvents; event++)
         {
             if (groupSet->groups[group].events[event].threadCounter)
@@ -2279,6 +2404,7 @@ perfmon_finalize(void)
     }
     power_finalize();
 #ifndef LIKWID_USE_PERFEVENT
+    regprog_finalize();
     HPMfinalize();
 #endif
     if (eventHash && added_generic_event)
@@ -2353,6 +2479,7 @@ perfmon_addEventSet(const char* eventCString)
         groupSet->groups[0].rdtscTime = 0;
         groupSet->groups[0].runTime = 0;
         groupSet->groups[0].numberOfEvents = 0;
+        groupSet->groups[0].programs = NULL;
     }
 
     if ((groupSet->numberOfActiveGroups > 0) && (groupSet->numberOfActiveGroups == groupSet->numberOfGroups))
@@ -2367,6 +2494,7 @@ perfmon_addEventSet(const char* eventCString)
         groupSet->groups[groupSet->numberOfActiveGroups].rdtscTime = 0;
         groupSet->groups[groupSet->numberOfActiveGroups].runTime = 0;
         groupSet->groups[groupSet->numberOfActiveGroups].numberOfEvents = 0;
+        groupSet->groups[groupSet->numberOfActiveGroups].programs = NULL;
         DEBUG_PLAIN_PRINT(DEBUGLEV_INFO, Allocating new group structure for group.);
     }
     DEBUG_PRINT(DEBUGLEV_INFO, Currently %d groups of %d active,
@@ -2546,6 +2674,7 @@ past_checks:
                 event->threadCounter[j].fullResult = 0.0;
                 event->threadCounter[j].lastResult = 0.0;
                 event->threadCounter[j].overflows = 0;
+                event->threadCounter[j].totalOverflows = 0;
                 event->threadCounter[j].init = FALSE;
             }
 
@@ -2620,7 +2749,7 @@ __perfmon_setupCountersThread(int thread_id, int groupId)
         return -ENOENT;
     }
 
-    ret = perfmon_setupCountersThread(thread_id, &groupSet->groups[groupId]);
+    ret = regprog_setupThread(thread_id, &groupSet->groups[groupId]);
     if (ret < 0)
     {
         fprintf(stderr, "Setup of counters failed for thread %d\n", (ret+1)*-1);
@@ -2663,6 +2792,7 @@ perfmon_setupCounters(int groupId)
         if (force_setup)
         {
             memset(currentConfig[groupSet->threads[i].processorId], 0, NUM_PMC * sizeof(uint64_t));
+            regprog_invalidate(groupSet->threads[i].processorId);
         }
         ret = __perfmon_setupCountersThread(groupSet->threads[i].thread_id, groupId);
         if (ret != 0)
@@ -2679,6 +2809,7 @@ __perfmon_startCounters(int groupId)
 {
     int i = 0, j = 0;
     int ret = 0;
+    int locked = 0;
     if (groupSet->groups[groupId].state != STATE_SETUP)
     {
         return -EINVAL;
@@ -2688,18 +2819,24 @@ __perfmon_startCounters(int groupId)
         ERROR_PLAIN_PRINT(Access to performance monitoring registers locked);
         return -ENOLCK;
     }
+    locked = perfmon_lockAllThreads();
     for(;i<groupSet->numberOfThreads;i++)
     {
         for (j=0; j<perfmon_getNumberOfEvents(groupId); j++)
+        {
             groupSet->groups[groupId].events[j].threadCounter[i].overflows = 0;
+            groupSet->groups[groupId].events[j].threadCounter[i].totalOverflows = 0;
+        }
         ret = perfmon_startCountersThread(groupSet->threads[i].thread_id, &groupSet->groups[groupId]);
         if (ret)
         {
+            perfmon_unlockAllThreads(locked);
             return -groupSet->threads[i].thread_id-1;
         }
     }
     groupSet->groups[groupId].state = STATE_START;
     timer_start(&groupSet->groups[groupId].timer);
+    perfmon_unlockAllThreads(locked);
     return 0;
 }
 
@@ -2752,6 +2889,7 @@ __perfmon_stopCounters(int groupId)
     int i = 0;
     int j = 0;
     int ret = 0;
+    int locked = 0;
     double result = 0.0;
 
     if (!lock_check())
@@ -2762,11 +2900,13 @@ __perfmon_stopCounters(int groupId)
 
     timer_stop(&groupSet->groups[groupId].timer);
 
+    locked = perfmon_lockAllThreads();
     for (i = 0; i<groupSet->numberOfThreads; i++)
     {
         ret = perfmon_stopCountersThread(groupSet->threads[i].thread_id, &groupSet->groups[groupId]);
         if (ret)
         {
+            perfmon_unlockAllThreads(locked);
             return -groupSet->threads[i].thread_id-1;
         }
     }
@@ -2781,6 +2921,7 @@ __perfmon_stopCounters(int groupId)
         }
     }
     groupSet->groups[groupId].state = STATE_SETUP;
+    perfmon_unlockAllThreads(locked);
     groupSet->groups[groupId].rdtscTime =
                 timer_print(&groupSet->groups[groupId].timer);
     groupSet->groups[groupId].runTime += groupSet->groups[groupId].rdtscTime;
@@ -2843,6 +2984,7 @@ int
 __perfmon_readCounters(int groupId, int threadId)
 {
     int ret = 0;
+    int locked = 0;
     int i = 0, j = 0;
     double result = 0.0;
     if (perfmon_initialized != 1)
@@ -2865,9 +3007,11 @@ __perfmon_readCounters(int groupId, int threadId)
     {
         for (threadId = 0; threadId<groupSet->numberOfThreads; threadId++)
         {
+            locked = perfmon_lockThread(threadId);
             ret = perfmon_readCountersThread(threadId, &groupSet->groups[groupId]);
             if (ret)
             {
+                perfmon_unlockThread(threadId, locked);
                 return -threadId-1;
             }
             for (j=0; j < groupSet->groups[groupId].numberOfEvents; j++)
@@ -2881,13 +3025,16 @@ __perfmon_readCounters(int groupId, int threadId)
                         groupSet->groups[groupId].events[j].threadCounter[threadId].counterData;
                 }
             }
+            perfmon_unlockThread(threadId, locked);
         }
     }
     else if ((threadId >= 0) && (threadId < groupSet->numberOfThreads))
     {
+        locked = perfmon_lockThread(threadId);
         ret = perfmon_readCountersThread(threadId, &groupSet->groups[groupId]);
         if (ret)
         {
+            perfmon_unlockThread(threadId, locked);
             return -threadId-1;
         }
         for (j=0; j < groupSet->groups[groupId].numberOfEvents; j++)
@@ -2898,6 +3045,7 @@ __perfmon_readCounters(int groupId, int threadId)
             groupSet->groups[groupId].events[j].threadCounter[threadId].startData =
                 groupSet->groups[groupId].events[j].threadCounter[threadId].counterData;
         }
+        perfmon_unlockThread(threadId, locked);
 }
     timer_start(&groupSet->groups[groupId].timer);
     return 0;
@@ -3790,6 +3938,29 @@ perfmon_getCountOfRegion(int region, int thread)
     return markerResults[region].count[thread];
 }
 
+double
+perfmon_getCoverageOfRegion(int region, int thread)
+{
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    if (region < 0 || region >= markerRegions)
+    {
+        return -EINVAL;
+    }
+    if (thread < 0 || thread >= groupSet->numberOfThreads)
+    {
+        return -EINVAL;
+    }
+    if (markerResults == NULL || markerResults[region].coverage == NULL)
+    {
+        return -1.0;
+    }
+    return markerResults[region].coverage[thread];
+}
+
 double
 perfmon_getResultOfRegionThread(int region, int event, int thread)
 {
@@ -3915,6 +4086,276 @@ perfmon_getMetricOfRegionThread(int region, int metricId, int threadId)
     return result;
 }
 
+int
+perfmon_getNumberOfRegionNodes(void)
+{
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return -EINVAL;
+    }
+    return markerNumNodes;
+}
+
+char*
+perfmon_getTagOfRegionNode(int node)
+{
+    if (node < 0 || node >= markerNumNodes || markerNodes[node].tag == NULL)
+    {
+        return NULL;
+    }
+    return bdata(markerNodes[node].tag);
+}
+
+int
+perfmon_getParentOfRegionNode(int node)
+{
+    if (node < 0 || node >= markerNumNodes)
+    {
+        return -EINVAL;
+    }
+    return markerNodes[node].parent;
+}
+
+int
+perfmon_getGroupOfRegionNode(int node)
+{
+    if (node < 0 || node >= markerNumNodes)
+    {
+        return -EINVAL;
+    }
+    return markerNodes[node].groupID;
+}
+
+int
+perfmon_getThreadsOfRegionNode(int node)
+{
+    if (node < 0 || node >= markerNumNodes)
+    {
+        return -EINVAL;
+    }
+    return markerNodes[node].threadCount;
+}
+
+int
+perfmon_getCpuOfRegionNode(int node, int thread)
+{
+    if (node < 0 || node >= markerNumNodes || thread < 0 || thread >= markerNodes[node].threadCount)
+    {
+        return -EINVAL;
+    }
+    return markerNodes[node].cpulist[thread];
+}
+
+int
+perfmon_getCountOfRegionNode(int node, int thread)
+{
+    if (node < 0 || node >= markerNumNodes || thread < 0 || thread >= markerNodes[node].threadCount)
+    {
+        return -EINVAL;
+    }
+    return markerNodes[node].count[thread];
+}
+
+double
+perfmon_getTimeOfRegionNode(int node, int thread, int exclusive)
+{
+    if (node < 0 || node >= markerNumNodes || thread < 0 || thread >= markerNodes[node].threadCount)
+    {
+        return NAN;
+    }
+    return (exclusive ? markerNodes[node].exclTime[thread] : markerNodes[node].inclTime[thread]);
+}
+
+double
+perfmon_getResultOfRegionNode(int node, int event, int thread, int exclusive)
+{
+    if (node < 0 || node >= markerNumNodes || thread < 0 || thread >= markerNodes[node].threadCount)
+    {
+        return NAN;
+    }
+    if (event < 0 || event >= markerNodes[node].eventCount)
+    {
+        return NAN;
+    }
+    return (exclusive ? markerNodes[node].exclCounters[thread][event] : markerNodes[node].inclCounters[thread][event]);
+}
+
+double
+perfmon_getMetricOfRegionNode(int node, int metricId, int exclusive)
+{
+    int err = 0;
+    double result = 0.0;
+    double time = 0.0;
+    CounterList clist;
+    if (perfmon_initialized != 1)
+    {
+        ERROR_PLAIN_PRINT(Perfmon module not properly initialized);
+        return NAN;
+    }
+    if (node < 0 || node >= markerNumNodes)
+    {
+        return NAN;
+    }
+    LikwidRegionNode* n = &markerNodes[node];
+    if (n->groupID < 0 || n->groupID >= groupSet->numberOfActiveGroups ||
+        metricId < 0 || metricId >= groupSet->groups[n->groupID].group.nmetrics)
+    {
+        return NAN;
+    }
+    timer_init();
+    init_clist(&clist);
+    /* Counts are summed up over all threads, the runtime is the maximum */
+    for (int e = 0; e < n->eventCount && e < groupSet->groups[n->groupID].group.nevents; e++)
+    {
+        double sum = 0.0;
+        for (int t = 0; t < n->threadCount; t++)
+        {
+            double v = perfmon_getResultOfRegionNode(node, e, t, exclusive);
+            if (v == v)
+            {
+                sum += v;
+            }
+        }
+        err = add_to_clist(&clist, groupSet->groups[n->groupID].group.counters[e], sum);
+        if (err)
+        {
+            destroy_clist(&clist);
+            return NAN;
+        }
+    }
+    for (int t = 0; t < n->threadCount; t++)
+    {
+        time = MAX(time, perfmon_getTimeOfRegionNode(node, t, exclusive));
+    }
+    add_to_clist(&clist, "time", time);
+    add_to_clist(&clist, "inverseClock", 1.0/timer_getCycleClock());
+    add_to_clist(&clist, "true", 1);
+    add_to_clist(&clist, "false", 0);
+    add_to_clist(&clist, "num_numadomains", numa_info.numberOfNodes);
+    add_to_clist(&clist, "num_sockets", cpuid_topology.numSockets);
+    err = calc_metric(groupSet->groups[n->groupID].group.metricformulas[metricId], &clist, &result);
+    if (err < 0)
+    {
+        ERROR_PRINT(Cannot calculate formula %s, groupSet->groups[n->groupID].group.metricformulas[metricId]);
+    }
+    destroy_clist(&clist);
+    return result;
+}
+
+static void
+perfmon_destroyRegionNodes(void)
+{
+    for (int i = 0; markerNodes && i < markerNumNodes; i++)
+    {
+        for (int j = 0; j < markerNodes[i].threadCount; j++)
+        {
+            free(markerNodes[i].inclCounters[j]);
+            free(markerNodes[i].exclCounters[j]);
+        }
+        free(markerNodes[i].cpulist);
+        free(markerNodes[i].count);
+        free(markerNodes[i].inclTime);
+        free(markerNodes[i].exclTime);
+        free(markerNodes[i].inclCounters);
+        free(markerNodes[i].exclCounters);
+        bdestroy(markerNodes[i].tag);
+    }
+    free(markerNodes);
+    markerNodes = NULL;
+    markerNumNodes = 0;
+}
+
+/* Lines of the call-path tree of nested regions:
+ * N nodeID parentID groupID regionTag
+ * P nodeID cpu count inclusiveTime exclusiveTime nevents inclusive counts exclusive counts */
+static void
+perfmon_readRegionNodeLine(char* buf, int cpus)
+{
+    int id = -1, parent = -1, groupid = 0, cpu = 0, count = 0, nevents = 0, off = 0;
+    double inclTime = 0, exclTime = 0;
+    char remain[1536];
+    remain[0] = '\0';
+    if (buf[0] == 'N')
+    {
+        if (sscanf(buf, "N %d %d %d %n", &id, &parent, &groupid, &off) < 3 || id < 0 || id > 100000)
+        {
+            fprintf(stderr, "Line %s not a valid region tree node\n", buf);
+            return;
+        }
+        if (id >= markerNumNodes)
+        {
+            LikwidRegionNode* tmp = realloc(markerNodes, (id + 1) * sizeof(LikwidRegionNode));
+            if (!tmp)
+            {
+                return;
+            }
+            markerNodes = tmp;
+            memset(&markerNodes[markerNumNodes], 0, (id + 1 - markerNumNodes) * sizeof(LikwidRegionNode));
+            markerNumNodes = id + 1;
+        }
+        LikwidRegionNode* n = &markerNodes[id];
+        if (n->tag)
+        {
+            fprintf(stderr, "Region tree node %d defined twice, ignoring line %s\n", id, buf);
+            return;
+        }
+        n->tag = bfromcstr(&buf[off]);
+        btrimws(n->tag);
+        n->parent = parent;
+        n->groupID = groupid;
+        n->threadCount = 0;
+        n->cpulist = malloc(cpus * sizeof(int));
+        n->count = malloc(cpus * sizeof(uint32_t));
+        n->inclTime = malloc(cpus * sizeof(double));
+        n->exclTime = malloc(cpus * sizeof(double));
+        n->inclCounters = malloc(cpus * sizeof(double*));
+        n->exclCounters = malloc(cpus * sizeof(double*));
+        return;
+    }
+    if (sscanf(buf, "P %d %d %d %lf %lf %d %1535[^\n]", &id, &cpu, &count, &inclTime, &exclTime, &nevents, remain) < 6 ||
+        id < 0 || id >= markerNumNodes || nevents < 0)
+    {
+        fprintf(stderr, "Line %s not a valid region tree values line\n", buf);
+        return;
+    }
+    LikwidRegionNode* n = &markerNodes[id];
+    if (!n->cpulist || !n->count || !n->inclTime || !n->exclTime || !n->inclCounters || !n->exclCounters ||
+        n->threadCount >= groupSet->numberOfThreads)
+    {
+        return;
+    }
+    int t = n->threadCount;
+    n->inclCounters[t] = malloc((nevents + 1) * sizeof(double));
+    n->exclCounters[t] = malloc((nevents + 1) * sizeof(double));
+    if (!n->inclCounters[t] || !n->exclCounters[t])
+    {
+        free(n->inclCounters[t]);
+        free(n->exclCounters[t]);
+        return;
+    }
+    n->cpulist[t] = cpu;
+    n->count[t] = count;
+    n->inclTime[t] = inclTime;
+    n->exclTime[t] = exclTime;
+    n->eventCount = nevents;
+    char* ptr = strtok(remain, " ");
+    for (int e = 0; e < 2 * nevents; e++)
+    {
+        double v = NAN;
+        if (ptr != NULL)
+        {
+            sscanf(ptr, "%lf", &v);
+            ptr = strtok(NULL, " ");
+        }
+        if (e < nevents)
+            n->inclCounters[t][e] = v;
+        else
+            n->exclCounters[t][e - nevents] = v;
+    }
+    n->threadCount++;
+}
+
 int
 perfmon_readMarkerFile(const char* filename)
 {
@@ -3974,6 +4415,7 @@ perfmon_readMarkerFile(const char* filename)
     {
         regionCPUs[i] = 0;
         markerResults[i].threadCount = cpus;
+        markerResults[i].coverage = NULL;
         markerResults[i].time = (double*) malloc(cpus * sizeof(double));
         if (!markerResults[i].time)
         {
@@ -4029,9 +4471,14 @@ perfmon_readMarkerFile(const char* filename)
             break;
         }
     }
+    perfmon_destroyRegionNodes();
     while (fgets(buf, sizeof(buf), fp))
     {
-        if (strchr(buf,':'))
+        if (buf[0] == 'N' || buf[0] == 'P')
+        {
+            perfmon_readRegionNodeLine(buf, cpus);
+        }
+        else if (strchr(buf,':'))
         {
             int regionid = 0, groupid = -1;
             char regiontag[140];
@@ -4091,6 +4538,23 @@ perfmon_readMarkerFile(const char* filename)
                     ptr = strtok(NULL, " ");
                     eventidx++;
                 }
+                /* Regions measured with group multiplexing have the coverage
+                 * of the group appended */
+                if (ptr != NULL && eventidx == nevents)
+                {
+                    if (markerResults[regionid].coverage == NULL)
+                    {
+                        markerResults[regionid].coverage = (double*) malloc(cpus * sizeof(double));
+                        for (int j = 0; markerResults[regionid].coverage && j < cpus; j++)
+                        {
+                            markerResults[regionid].coverage[j] = -1.0;
+                        }
+                    }
+                    if (markerResults[regionid].coverage)
+                    {
+                        sscanf(ptr, "%lf", &(markerResults[regionid].coverage[cpuidx]));
+                    }
+                }
                 regionCPUs[regionid]++;
             }
         }
@@ -4120,8 +4584,10 @@ perfmon_destroyMarkerResults()
                 free(markerResults[i].counters[j]);
             }
             free(markerResults[i].counters);
+            free(markerResults[i].coverage);
             bdestroy(markerResults[i].tag);
         }
         free(markerResults);
     }
+    perfmon_destroyRegionNodes();
 }
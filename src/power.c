@@ -33,7 +33,11 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include <types.h>
 #include <power.h>
@@ -48,6 +52,181 @@ PowerInfo power_info;
 
 static int power_initialized = 0;
 
+/* Background energy service */
+typedef struct {
+    int running;
+    int cpuId;
+    int numSockets;
+    int* socketCpus;
+    double interval;
+    int numSamples;
+    int head;
+    int count;
+    double* times;
+    uint64_t* energy;
+    uint64_t* last;
+    int* valid;
+    uint64_t mask;
+    pthread_t thread;
+    pthread_mutex_t lock;
+} PowerService;
+
+static PowerService power_service = { .running = 0, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static inline double
+power_serviceClock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1E-9);
+}
+
+/* Read all domains of all sockets and append a sample to the ring. Must be
+ * called with the service lock held. */
+static void
+power_serviceSample(PowerService* ps)
+{
+    int slot = (ps->head + ps->count) % ps->numSamples;
+    int prev = (ps->count > 0 ? (ps->head + ps->count - 1) % ps->numSamples : -1);
+    uint64_t* cur = &ps->energy[slot * ps->numSockets * NUM_POWER_DOMAINS];
+    uint64_t* old = (prev >= 0 ? &ps->energy[prev * ps->numSockets * NUM_POWER_DOMAINS] : NULL);
+
+    for (int s = 0; s < ps->numSockets; s++)
+    {
+        for (int d = 0; d < NUM_POWER_DOMAINS; d++)
+        {
+            int idx = s * NUM_POWER_DOMAINS + d;
+            uint64_t result = 0x0ULL;
+            uint64_t base = (old ? old[idx] : 0x0ULL);
+            cur[idx] = base;
+            if ((ps->socketCpus[s] < 0) || (d >= power_info.numDomains) ||
+                (!(power_info.domains[d].supportFlags & POWER_DOMAIN_SUPPORT_STATUS)))
+            {
+                continue;
+            }
+            if (HPMread(ps->socketCpus[s], MSR_DEV, power_regs[d], &result) != 0)
+            {
+                continue;
+            }
+            result &= ps->mask;
+            /* The first successful read of a domain only sets the reference
+             * value, it may happen at any sample if earlier reads failed */
+            if (ps->valid[idx])
+            {
+                cur[idx] = base + ((result - ps->last[idx]) & ps->mask);
+            }
+            ps->last[idx] = result;
+            ps->valid[idx] = 1;
+        }
+    }
+    ps->times[slot] = power_serviceClock();
+    if (ps->count < ps->numSamples)
+    {
+        ps->count++;
+    }
+    else
+    {
+        ps->head = (ps->head + 1) % ps->numSamples;
+    }
+}
+
+static void*
+power_serviceThread(void* arg)
+{
+    PowerService* ps = (PowerService*)arg;
+    struct timespec next;
+    long sec = (long)ps->interval;
+    long nsec = (long)((ps->interval - (double)sec) * 1E9);
+
+    if (ps->cpuId >= 0)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(ps->cpuId, &cpuset);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (1)
+    {
+        next.tv_sec += sec;
+        next.tv_nsec += nsec;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        pthread_mutex_lock(&ps->lock);
+        if (!ps->running)
+        {
+            pthread_mutex_unlock(&ps->lock);
+            break;
+        }
+        power_serviceSample(ps);
+        pthread_mutex_unlock(&ps->lock);
+    }
+    return NULL;
+}
+
+/* Interpolate the accumulated energy counter at time t. Must be called with
+ * the service lock held. */
+static int
+power_serviceEnergyAt(PowerService* ps, int socket, PowerType type, double t, double* value)
+{
+    int lo = 0;
+    int hi = ps->count - 1;
+    int idx = socket * NUM_POWER_DOMAINS + type;
+    int stride = ps->numSockets * NUM_POWER_DOMAINS;
+    int a, b;
+    double ta, tb;
+
+    if ((ps->count == 0) || (t < ps->times[ps->head]))
+    {
+        return -ERANGE;
+    }
+    if (t > ps->times[(ps->head + hi) % ps->numSamples])
+    {
+        /* Window ends after the latest sample, take a fresh one */
+        power_serviceSample(ps);
+        hi = ps->count - 1;
+        lo = 0;
+        if (ps->times[ps->head] > t)
+        {
+            return -ERANGE;
+        }
+        if (t > ps->times[(ps->head + hi) % ps->numSamples])
+        {
+            t = ps->times[(ps->head + hi) % ps->numSamples];
+        }
+    }
+    while (hi - lo > 1)
+    {
+        int mid = (lo + hi) / 2;
+        if (ps->times[(ps->head + mid) % ps->numSamples] <= t)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    a = (ps->head + lo) % ps->numSamples;
+    b = (ps->head + hi) % ps->numSamples;
+    ta = ps->times[a];
+    tb = ps->times[b];
+    if (tb > ta)
+    {
+        double ea = (double)ps->energy[a * stride + idx];
+        double eb = (double)ps->energy[b * stride + idx];
+        *value = ea + (eb - ea) * ((t - ta) / (tb - ta));
+    }
+    else
+    {
+        *value = (double)ps->energy[a * stride + idx];
+    }
+    *value *= power_info.domains[type].energyUnit;
+    return 0;
+}
+
 /* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
 
 int
@@ -729,6 +908,185 @@ power_policyGet(int cpuId, PowerType domain, uint32_t* priority)
     return 0;
 }
 
+int
+power_energyServiceStart(int cpuId, double interval, int numSamples)
+{
+    PowerService* ps = &power_service;
+    int err = 0;
+    if ((!power_initialized) || (!power_info.hasRAPL))
+    {
+        return -EIO;
+    }
+    if ((interval < 1E-3) || (numSamples < 2))
+    {
+        return -EINVAL;
+    }
+    if ((cpuId >= (int)cpuid_topology.numHWThreads))
+    {
+        return -ERANGE;
+    }
+    pthread_mutex_lock(&ps->lock);
+    if (ps->running)
+    {
+        pthread_mutex_unlock(&ps->lock);
+        return -EBUSY;
+    }
+    ps->numSockets = cpuid_topology.numSockets;
+    ps->socketCpus = malloc(ps->numSockets * sizeof(int));
+    ps->times = malloc(numSamples * sizeof(double));
+    ps->energy = malloc(numSamples * ps->numSockets * NUM_POWER_DOMAINS * sizeof(uint64_t));
+    ps->last = calloc(ps->numSockets * NUM_POWER_DOMAINS, sizeof(uint64_t));
+    ps->valid = calloc(ps->numSockets * NUM_POWER_DOMAINS, sizeof(int));
+    if ((!ps->socketCpus) || (!ps->times) || (!ps->energy) || (!ps->last) || (!ps->valid))
+    {
+        err = -ENOMEM;
+        goto service_error;
+    }
+    for (int s = 0; s < ps->numSockets; s++)
+    {
+        ps->socketCpus[s] = -1;
+        for (int i = 0; i < (int)cpuid_topology.numHWThreads; i++)
+        {
+            if ((cpuid_topology.threadPool[i].packageId == (uint32_t)s) &&
+                (cpuid_topology.threadPool[i].inCpuSet))
+            {
+                ps->socketCpus[s] = cpuid_topology.threadPool[i].apicId;
+                break;
+            }
+        }
+        if (ps->socketCpus[s] >= 0)
+        {
+            err = HPMaddThread(ps->socketCpus[s]);
+            if (err < 0)
+            {
+                ERROR_PRINT(Cannot get access to RAPL registers of socket %d, s);
+                ps->socketCpus[s] = -1;
+            }
+        }
+    }
+    ps->mask = (power_info.statusRegWidth >= 64 ? ~0x0ULL : ((1ULL << power_info.statusRegWidth) - 1));
+    ps->cpuId = cpuId;
+    ps->interval = interval;
+    ps->numSamples = numSamples;
+    ps->head = 0;
+    ps->count = 0;
+    power_serviceSample(ps);
+    ps->running = 1;
+    err = pthread_create(&ps->thread, NULL, power_serviceThread, ps);
+    if (err != 0)
+    {
+        ps->running = 0;
+        err = -err;
+        goto service_error;
+    }
+    pthread_mutex_unlock(&ps->lock);
+    DEBUG_PRINT(DEBUGLEV_DETAIL, Started energy service with interval %f s and %d samples, interval, numSamples);
+    return 0;
+service_error:
+    free(ps->socketCpus);
+    free(ps->times);
+    free(ps->energy);
+    free(ps->last);
+    free(ps->valid);
+    ps->socketCpus = NULL;
+    ps->times = NULL;
+    ps->energy = NULL;
+    ps->last = NULL;
+    ps->valid = NULL;
+    pthread_mutex_unlock(&ps->lock);
+    return err;
+}
+
+void
+power_energyServiceStop(void)
+{
+    PowerService* ps = &power_service;
+    pthread_mutex_lock(&ps->lock);
+    if (!ps->running)
+    {
+        pthread_mutex_unlock(&ps->lock);
+        return;
+    }
+    ps->running = 0;
+    pthread_mutex_unlock(&ps->lock);
+    pthread_join(ps->thread, NULL);
+    pthread_mutex_lock(&ps->lock);
+    free(ps->socketCpus);
+    free(ps->times);
+    free(ps->energy);
+    free(ps->last);
+    free(ps->valid);
+    ps->socketCpus = NULL;
+    ps->times = NULL;
+    ps->energy = NULL;
+    ps->last = NULL;
+    ps->valid = NULL;
+    ps->count = 0;
+    pthread_mutex_unlock(&ps->lock);
+}
+
+double
+power_energyServiceTime(void)
+{
+    return power_serviceClock();
+}
+
+int
+power_energyServiceEnergy(int socket, PowerType type, double t0, double t1, double* energy)
+{
+    PowerService* ps = &power_service;
+    double e0 = 0.0, e1 = 0.0;
+    int err = 0;
+    if ((type < PKG) || (type >= NUM_POWER_DOMAINS) || (t1 < t0) || (!energy))
+    {
+        return -EINVAL;
+    }
+    pthread_mutex_lock(&ps->lock);
+    if (!ps->running)
+    {
+        pthread_mutex_unlock(&ps->lock);
+        return -ENODEV;
+    }
+    if ((socket < 0) || (socket >= ps->numSockets) || (ps->socketCpus[socket] < 0))
+    {
+        pthread_mutex_unlock(&ps->lock);
+        return -ERANGE;
+    }
+    if (!(power_info.domains[type].supportFlags & POWER_DOMAIN_SUPPORT_STATUS))
+    {
+        pthread_mutex_unlock(&ps->lock);
+        return -EFAULT;
+    }
+    err = power_serviceEnergyAt(ps, socket, type, t0, &e0);
+    if (err == 0)
+    {
+        err = power_serviceEnergyAt(ps, socket, type, t1, &e1);
+    }
+    pthread_mutex_unlock(&ps->lock);
+    if (err == 0)
+    {
+        *energy = e1 - e0;
+    }
+    return err;
+}
+
+int
+power_energyServicePower(int socket, PowerType type, double t0, double t1, double* power)
+{
+    double energy = 0.0;
+    int err = 0;
+    if ((!power) || (t1 <= t0))
+    {
+        return -EINVAL;
+    }
+    err = power_energyServiceEnergy(socket, type, t0, t1, &energy);
+    if (err == 0)
+    {
+        *power = energy / (t1 - t0);
+    }
+    return err;
+}
+
 void
 power_finalize(void)
 {
@@ -736,6 +1094,7 @@ power_finalize(void)
     {
         return;
     }
+    power_energyServiceStop();
     if (power_info.turbo.steps != NULL)
     {
         free(power_info.turbo.steps);
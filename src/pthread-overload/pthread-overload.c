@@ -80,10 +80,96 @@ static char * sosearchpaths[] = {
 
 static int *pin_ids = NULL;
 static int ncpus = 0;
-static uint64_t skipMask = 0x0;
+static uint64_t *skipMask = NULL;
+static int skipWords = 0;
 static int silent = 0;
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static int
+skip_set(int thread)
+{
+    int word = thread / 64;
+    if (word >= skipWords)
+    {
+        uint64_t* tmp = realloc(skipMask, (word+1) * sizeof(uint64_t));
+        if (!tmp)
+        {
+            return -ENOMEM;
+        }
+        memset(&tmp[skipWords], 0, (word+1-skipWords) * sizeof(uint64_t));
+        skipMask = tmp;
+        skipWords = word+1;
+    }
+    skipMask[word] |= 1ULL<<(thread%64);
+    return 0;
+}
+
+static int
+skip_test(int thread)
+{
+    int word = thread / 64;
+    if (word >= skipWords)
+    {
+        return 0;
+    }
+    return (skipMask[word] & (1ULL<<(thread%64))) != 0;
+}
+
+/* The skip mask is a hex string of arbitrary length, bit N skips the N-th
+ * created thread */
+static void
+skip_parse(const char* str)
+{
+    int len = strlen(str);
+    int bit = 0;
+    if (len >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))
+    {
+        str += 2;
+        len -= 2;
+    }
+    for (int i = len-1; i >= 0; i--, bit += 4)
+    {
+        int c = str[i];
+        int v = 0;
+        if (c >= '0' && c <= '9')
+            v = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            v = c - 'A' + 10;
+        else
+        {
+            color_print("[pthread wrapper] ERROR: Invalid character '%c' in skip mask\n", c);
+            break;
+        }
+        for (int j = 0; j < 4; j++)
+        {
+            if (v & (1<<j))
+                skip_set(bit+j);
+        }
+    }
+}
+
+static void
+skip_print(void)
+{
+    int w = skipWords-1;
+    while (w > 0 && skipMask[w] == 0x0ULL)
+    {
+        w--;
+    }
+    if (w < 0)
+    {
+        color_print("0x0");
+        return;
+    }
+    color_print("0x%llX", LLU_CAST skipMask[w]);
+    for (w = w-1; w >= 0; w--)
+    {
+        color_print("%016llX", LLU_CAST skipMask[w]);
+    }
+}
+
 void __attribute__((constructor (103))) init_pthread_overload(void)
 {
     char *str = NULL, *pinstr = NULL;
@@ -119,6 +205,17 @@ void __attribute__((constructor (103))) init_pthread_overload(void)
             token = strtok_r(saveptr, delimiter ,&saveptr);
             if (token)
             {
+                if (i >= avail_cpus)
+                {
+                    /* Oversubscribed pin lists may be longer than the CPU count */
+                    int* tmp = realloc(pin_ids, 2 * avail_cpus * sizeof(int));
+                    if (!tmp)
+                    {
+                        break;
+                    }
+                    pin_ids = tmp;
+                    avail_cpus *= 2;
+                }
                 ncpus++;
                 pin_ids[i++] = strtoul(token, &token, 10);
             }
@@ -128,7 +225,7 @@ void __attribute__((constructor (103))) init_pthread_overload(void)
     str = getenv("LIKWID_SKIP");
     if (str != NULL)
     {
-        skipMask = strtoul(str, &str, 16);
+        skip_parse(str);
     }
 
     if (getenv("LIKWID_SILENT") != NULL)
@@ -193,7 +290,9 @@ pthread_create(pthread_t* thread,
             {
                 color_print("%d->%d  ",i,pin_ids[i]);
             }
-            color_print("\n[pthread wrapper] SKIP MASK: 0x%llX\n",LLU_CAST skipMask);
+            color_print("\n[pthread wrapper] SKIP MASK: ");
+            skip_print();
+            color_print("\n");
         }
 
         overflow = ncpus-1;
@@ -226,7 +325,7 @@ pthread_create(pthread_t* thread,
                 if (tmp != NULL)
                 {
                     shepard = 1;
-                    skipMask |= 1ULL<<(ncalled);
+                    skip_set(ncalled);
                 }
                 fclose(fpipe);
                 snprintf(cmd, 511, "rm -f %s 2>/dev/null", file);
@@ -279,7 +378,7 @@ pthread_create(pthread_t* thread,
     {
         cpu_set_t cpuset;
 
-        if ((ncalled<64) && (skipMask&(1ULL<<(ncalled))))
+        if (skip_test(ncalled))
         {
             CPU_ZERO(&cpuset);
             for (int i=0; i<online_cpus; i++)
@@ -339,5 +438,6 @@ pthread_create(pthread_t* thread,
 void __attribute__((destructor (103))) close_pthread_overload(void)
 {
     free(pin_ids);
+    free(skipMask);
 }
 
@@ -0,0 +1,1005 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  rankrecords.c
+ *
+ *      Description:  Parallel aggregation of the per-rank result records written by
+ *                    likwid-perfctr for likwid-mpirun.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <error.h>
+#include <rankrecords.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define RR_MAX_THREADS 64
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* One line of a record file, see printRecord in likwid.lua:
+ * {"host":"node1","rank":0,"region":"foo","group":1,"name":"FLOPS_DP",
+ *  "cpus":[0,1],"time":[..],"calls":[..],"events":[..],"counters":[..],
+ *  "values":[[..],..],"metrics":[..],"metricvalues":[[..],..]}
+ * region and calls are only present for MarkerAPI measurements. */
+typedef struct {
+    char* host;
+    int rank;
+    char* region;
+    int group;
+    char* name;
+    int ncpus;
+    double* cpus;
+    double* time;
+    int ntime;
+    double* calls;
+    int ncalls;
+    int nevents;
+    char** events;
+    int ncounters;
+    char** counters;
+    int nvalues;
+    double** values;
+    int* nvaluecols;
+    int nmetrics;
+    char** metrics;
+    int nmetricvalues;
+    double** metricvalues;
+    int* nmetriccols;
+} RankRecord;
+
+typedef struct {
+    char** files;
+    int nfiles;
+    RankAggregate* aggregate;
+    RankAggregate* other;
+    int ret;
+} RankWorker;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static void
+rr_skipWs(const char** p)
+{
+    while (**p == ' ' || **p == '\t' || **p == '\r' || **p == '\n')
+    {
+        (*p)++;
+    }
+}
+
+static int
+rr_expect(const char** p, char c)
+{
+    rr_skipWs(p);
+    if (**p != c)
+    {
+        return -EINVAL;
+    }
+    (*p)++;
+    return 0;
+}
+
+static int
+rr_parseString(const char** p, char** out)
+{
+    const char* s = NULL;
+    char* str = NULL;
+    int len = 0;
+    *out = NULL;
+    if (rr_expect(p, '"') < 0)
+    {
+        return -EINVAL;
+    }
+    s = *p;
+    while (*s != '"')
+    {
+        if (*s == '\0')
+        {
+            return -EINVAL;
+        }
+        if (*s == '\\' && s[1] != '\0')
+        {
+            s++;
+        }
+        s++;
+    }
+    str = malloc((s - *p) + 1);
+    if (!str)
+    {
+        return -ENOMEM;
+    }
+    s = *p;
+    while (*s != '"')
+    {
+        if (*s == '\\')
+        {
+            s++;
+            switch (*s)
+            {
+                case 'n':
+                    str[len++] = '\n';
+                    break;
+                case 't':
+                    str[len++] = '\t';
+                    break;
+                case 'r':
+                    str[len++] = '\r';
+                    break;
+                case 'b':
+                case 'f':
+                    str[len++] = ' ';
+                    break;
+                case 'u':
+                    /* Only ASCII is written by likwid-perfctr */
+                    str[len++] = '?';
+                    for (int i = 0; i < 4 && s[1] != '"' && s[1] != '\0'; i++)
+                    {
+                        s++;
+                    }
+                    break;
+                default:
+                    str[len++] = *s;
+                    break;
+            }
+            s++;
+            continue;
+        }
+        str[len++] = *s++;
+    }
+    str[len] = '\0';
+    *p = s + 1;
+    *out = str;
+    return 0;
+}
+
+static int
+rr_parseNumber(const char** p, double* value)
+{
+    char* end = NULL;
+    rr_skipWs(p);
+    if (strncmp(*p, "null", 4) == 0)
+    {
+        *value = NAN;
+        *p += 4;
+        return 0;
+    }
+    *value = strtod(*p, &end);
+    if (end == *p)
+    {
+        return -EINVAL;
+    }
+    *p = end;
+    return 0;
+}
+
+static int
+rr_arrayNext(const char** p, int count)
+{
+    /* Returns 1 if another element follows, 0 at the end of the array */
+    rr_skipWs(p);
+    if (**p == ']')
+    {
+        (*p)++;
+        return 0;
+    }
+    if (count > 0)
+    {
+        if (**p != ',')
+        {
+            return -EINVAL;
+        }
+        (*p)++;
+    }
+    return 1;
+}
+
+static int
+rr_parseNumberArray(const char** p, double** values, int* count)
+{
+    int ret = 0;
+    int max = 0;
+    *values = NULL;
+    *count = 0;
+    if (rr_expect(p, '[') < 0)
+    {
+        return -EINVAL;
+    }
+    while ((ret = rr_arrayNext(p, *count)) > 0)
+    {
+        if (*count == max)
+        {
+            max = (max == 0 ? 16 : 2 * max);
+            double* tmp = realloc(*values, max * sizeof(double));
+            if (!tmp)
+            {
+                return -ENOMEM;
+            }
+            *values = tmp;
+        }
+        ret = rr_parseNumber(p, &(*values)[*count]);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        (*count)++;
+    }
+    return ret;
+}
+
+static int
+rr_parseStringArray(const char** p, char*** strings, int* count)
+{
+    int ret = 0;
+    int max = 0;
+    *strings = NULL;
+    *count = 0;
+    if (rr_expect(p, '[') < 0)
+    {
+        return -EINVAL;
+    }
+    while ((ret = rr_arrayNext(p, *count)) > 0)
+    {
+        if (*count == max)
+        {
+            max = (max == 0 ? 16 : 2 * max);
+            char** tmp = realloc(*strings, max * sizeof(char*));
+            if (!tmp)
+            {
+                return -ENOMEM;
+            }
+            *strings = tmp;
+        }
+        ret = rr_parseString(p, &(*strings)[*count]);
+        if (ret < 0)
+        {
+            return ret;
+        }
+        (*count)++;
+    }
+    return ret;
+}
+
+static int
+rr_parseMatrix(const char** p, double*** rows, int** cols, int* count)
+{
+    int ret = 0;
+    int max = 0;
+    *rows = NULL;
+    *cols = NULL;
+    *count = 0;
+    if (rr_expect(p, '[') < 0)
+    {
+        return -EINVAL;
+    }
+    while ((ret = rr_arrayNext(p, *count)) > 0)
+    {
+        if (*count == max)
+        {
+            max = (max == 0 ? 16 : 2 * max);
+            double** tmp = realloc(*rows, max * sizeof(double*));
+            int* tmpcols = realloc(*cols, max * sizeof(int));
+            if (tmp)
+            {
+                *rows = tmp;
+            }
+            if (tmpcols)
+            {
+                *cols = tmpcols;
+            }
+            if (!tmp || !tmpcols)
+            {
+                return -ENOMEM;
+            }
+        }
+        ret = rr_parseNumberArray(p, &(*rows)[*count], &(*cols)[*count]);
+        (*count)++;
+        if (ret < 0)
+        {
+            return ret;
+        }
+    }
+    return ret;
+}
+
+static int
+rr_skipValue(const char** p)
+{
+    int depth = 0;
+    rr_skipWs(p);
+    do
+    {
+        if (**p == '"')
+        {
+            char* tmp = NULL;
+            int ret = rr_parseString(p, &tmp);
+            free(tmp);
+            if (ret < 0)
+            {
+                return ret;
+            }
+            continue;
+        }
+        if (**p == '\0')
+        {
+            return -EINVAL;
+        }
+        if (**p == '[' || **p == '{')
+        {
+            depth++;
+        }
+        else if (**p == ']' || **p == '}')
+        {
+            if (depth == 0)
+            {
+                return 0;
+            }
+            depth--;
+        }
+        else if (**p == ',' && depth == 0)
+        {
+            return 0;
+        }
+        (*p)++;
+    } while (depth > 0 || (**p != ',' && **p != '}' && **p != ']'));
+    return 0;
+}
+
+static void
+rr_freeStrings(char** strings, int count)
+{
+    if (strings)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            free(strings[i]);
+        }
+        free(strings);
+    }
+}
+
+static void
+rr_freeRecord(RankRecord* r)
+{
+    free(r->host);
+    free(r->region);
+    free(r->name);
+    free(r->cpus);
+    free(r->time);
+    free(r->calls);
+    rr_freeStrings(r->events, r->nevents);
+    rr_freeStrings(r->counters, r->ncounters);
+    rr_freeStrings(r->metrics, r->nmetrics);
+    if (r->values)
+    {
+        for (int i = 0; i < r->nvalues; i++)
+        {
+            free(r->values[i]);
+        }
+        free(r->values);
+    }
+    if (r->metricvalues)
+    {
+        for (int i = 0; i < r->nmetricvalues; i++)
+        {
+            free(r->metricvalues[i]);
+        }
+        free(r->metricvalues);
+    }
+    free(r->nvaluecols);
+    free(r->nmetriccols);
+    memset(r, 0, sizeof(RankRecord));
+}
+
+static int
+rr_parseRecord(const char* line, RankRecord* r)
+{
+    int ret = 0;
+    int first = 1;
+    const char* p = line;
+    memset(r, 0, sizeof(RankRecord));
+    r->rank = -1;
+    if (rr_expect(&p, '{') < 0)
+    {
+        return -EINVAL;
+    }
+    while (ret == 0)
+    {
+        char* key = NULL;
+        double value = 0;
+        rr_skipWs(&p);
+        if (*p == '}')
+        {
+            break;
+        }
+        if (!first && rr_expect(&p, ',') < 0)
+        {
+            return -EINVAL;
+        }
+        first = 0;
+        ret = rr_parseString(&p, &key);
+        if (ret == 0)
+        {
+            ret = rr_expect(&p, ':');
+        }
+        if (ret < 0)
+        {
+            free(key);
+            return ret;
+        }
+        if (strcmp(key, "host") == 0)
+            ret = rr_parseString(&p, &r->host);
+        else if (strcmp(key, "region") == 0)
+            ret = rr_parseString(&p, &r->region);
+        else if (strcmp(key, "name") == 0)
+            ret = rr_parseString(&p, &r->name);
+        else if (strcmp(key, "rank") == 0)
+        {
+            ret = rr_parseNumber(&p, &value);
+            r->rank = (isnan(value) ? -1 : (int)value);
+        }
+        else if (strcmp(key, "group") == 0)
+        {
+            ret = rr_parseNumber(&p, &value);
+            r->group = (isnan(value) ? 0 : (int)value);
+        }
+        else if (strcmp(key, "cpus") == 0)
+            ret = rr_parseNumberArray(&p, &r->cpus, &r->ncpus);
+        else if (strcmp(key, "time") == 0)
+            ret = rr_parseNumberArray(&p, &r->time, &r->ntime);
+        else if (strcmp(key, "calls") == 0)
+            ret = rr_parseNumberArray(&p, &r->calls, &r->ncalls);
+        else if (strcmp(key, "events") == 0)
+            ret = rr_parseStringArray(&p, &r->events, &r->nevents);
+        else if (strcmp(key, "counters") == 0)
+            ret = rr_parseStringArray(&p, &r->counters, &r->ncounters);
+        else if (strcmp(key, "metrics") == 0)
+            ret = rr_parseStringArray(&p, &r->metrics, &r->nmetrics);
+        else if (strcmp(key, "values") == 0)
+            ret = rr_parseMatrix(&p, &r->values, &r->nvaluecols, &r->nvalues);
+        else if (strcmp(key, "metricvalues") == 0)
+            ret = rr_parseMatrix(&p, &r->metricvalues, &r->nmetriccols, &r->nmetricvalues);
+        else
+            ret = rr_skipValue(&p);
+        free(key);
+    }
+    if (ret < 0)
+    {
+        return ret;
+    }
+    /* Check the dimensions once, so that the merge can trust them */
+    if (!r->host || !r->name || r->ncpus == 0 || r->ntime != r->ncpus ||
+        (r->calls && r->ncalls != r->ncpus) ||
+        r->ncounters != r->nevents || r->nvalues != r->nevents ||
+        r->nmetricvalues != r->nmetrics)
+    {
+        return -EINVAL;
+    }
+    for (int i = 0; i < r->nvalues; i++)
+    {
+        if (r->nvaluecols[i] != r->ncpus)
+            return -EINVAL;
+    }
+    for (int i = 0; i < r->nmetricvalues; i++)
+    {
+        if (r->nmetriccols[i] != r->ncpus)
+            return -EINVAL;
+    }
+    return 0;
+}
+
+static int
+rr_sameString(const char* a, const char* b)
+{
+    if (!a || !b)
+    {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static RankGroupResult*
+rr_getGroup(RankAggregate* agg, const char* region, int group)
+{
+    for (int i = 0; i < agg->ngroups; i++)
+    {
+        if (agg->groups[i].group == group && rr_sameString(agg->groups[i].region, region))
+        {
+            return &agg->groups[i];
+        }
+    }
+    if (agg->ngroups == agg->maxGroups)
+    {
+        int max = (agg->maxGroups == 0 ? 8 : 2 * agg->maxGroups);
+        RankGroupResult* tmp = realloc(agg->groups, max * sizeof(RankGroupResult));
+        if (!tmp)
+        {
+            return NULL;
+        }
+        agg->groups = tmp;
+        agg->maxGroups = max;
+    }
+    RankGroupResult* g = &agg->groups[agg->ngroups++];
+    memset(g, 0, sizeof(RankGroupResult));
+    g->group = group;
+    g->nevents = -1;
+    return g;
+}
+
+static int
+rr_addColumns(RankGroupResult* g, int count)
+{
+    if (g->ncolumns + count > g->maxColumns)
+    {
+        int max = (g->maxColumns == 0 ? 64 : 2 * g->maxColumns);
+        while (max < g->ncolumns + count)
+        {
+            max *= 2;
+        }
+        RankColumn* tmp = realloc(g->columns, max * sizeof(RankColumn));
+        if (!tmp)
+        {
+            return -ENOMEM;
+        }
+        g->columns = tmp;
+        g->maxColumns = max;
+    }
+    return 0;
+}
+
+static int
+rr_addRecord(RankAggregate* agg, RankRecord* r, int seq)
+{
+    RankGroupResult* g = rr_getGroup(agg, r->region, r->group);
+    if (!g)
+    {
+        return -ENOMEM;
+    }
+    if (g->nevents < 0)
+    {
+        /* First record of this group, take over the names */
+        g->region = r->region;
+        g->name = r->name;
+        g->nevents = r->nevents;
+        g->events = r->events;
+        g->counters = r->counters;
+        g->nmetrics = r->nmetrics;
+        g->metrics = r->metrics;
+        r->region = NULL;
+        r->name = NULL;
+        r->events = NULL;
+        r->counters = NULL;
+        r->metrics = NULL;
+        r->nevents = 0;
+        r->ncounters = 0;
+        r->nmetrics = 0;
+    }
+    else if (g->nevents != r->nevents || g->nmetrics != r->nmetrics)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Skipping record of rank %d with different layout for group %d, r->rank, r->group);
+        return 0;
+    }
+    if (r->calls)
+    {
+        g->hasCalls = 1;
+    }
+    if (rr_addColumns(g, r->ncpus) < 0)
+    {
+        return -ENOMEM;
+    }
+    for (int c = 0; c < r->ncpus; c++)
+    {
+        RankColumn* col = &g->columns[g->ncolumns];
+        int len = snprintf(NULL, 0, "%s:%d:%d", r->host, r->rank, (int)r->cpus[c]);
+        memset(col, 0, sizeof(RankColumn));
+        col->label = malloc(len + 1);
+        col->values = malloc((g->nevents + 1) * sizeof(double));
+        col->metrics = malloc((g->nmetrics + 1) * sizeof(double));
+        if (!col->label || !col->values || !col->metrics)
+        {
+            free(col->label);
+            free(col->values);
+            free(col->metrics);
+            return -ENOMEM;
+        }
+        snprintf(col->label, len + 1, "%s:%d:%d", r->host, r->rank, (int)r->cpus[c]);
+        col->rank = r->rank;
+        col->seq = seq + c;
+        col->time = r->time[c];
+        col->calls = (r->calls ? r->calls[c] : NAN);
+        for (int e = 0; e < g->nevents; e++)
+        {
+            col->values[e] = r->values[e][c];
+        }
+        for (int m = 0; m < g->nmetrics; m++)
+        {
+            col->metrics[m] = r->metricvalues[m][c];
+        }
+        g->ncolumns++;
+    }
+    return 0;
+}
+
+static int
+rr_readFile(RankAggregate* agg, const char* filename)
+{
+    int ret = 0;
+    int seq = 0;
+    char* line = NULL;
+    size_t len = 0;
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        ERROR_PRINT(Cannot open record file %s, filename);
+        return -errno;
+    }
+    while (getline(&line, &len, fp) > 0)
+    {
+        RankRecord r;
+        const char* p = line;
+        rr_skipWs(&p);
+        if (*p != '{')
+        {
+            /* Empty line or other output of the application */
+            continue;
+        }
+        ret = rr_parseRecord(p, &r);
+        if (ret == 0)
+        {
+            ret = rr_addRecord(agg, &r, seq);
+            seq += r.ncpus;
+        }
+        else if (ret == -EINVAL)
+        {
+            ERROR_PRINT(Invalid record in file %s, filename);
+            ret = 0;
+        }
+        rr_freeRecord(&r);
+        if (ret < 0)
+        {
+            break;
+        }
+    }
+    free(line);
+    fclose(fp);
+    return ret;
+}
+
+static void
+rr_freeGroup(RankGroupResult* g)
+{
+    for (int c = 0; c < g->ncolumns; c++)
+    {
+        free(g->columns[c].label);
+        free(g->columns[c].values);
+        free(g->columns[c].metrics);
+    }
+    free(g->columns);
+    free(g->region);
+    free(g->name);
+    if (g->nevents > 0)
+    {
+        rr_freeStrings(g->events, g->nevents);
+        rr_freeStrings(g->counters, g->nevents);
+    }
+    rr_freeStrings(g->metrics, g->nmetrics);
+    free(g->eventStats);
+    free(g->metricStats);
+}
+
+/* Move all columns of other into agg. Groups unknown to agg are moved as a
+ * whole, so the order of first appearance is kept. */
+static int
+rr_merge(RankAggregate* agg, RankAggregate* other)
+{
+    for (int i = 0; i < other->ngroups; i++)
+    {
+        RankGroupResult* src = &other->groups[i];
+        RankGroupResult* dst = NULL;
+        for (int j = 0; j < agg->ngroups; j++)
+        {
+            if (agg->groups[j].group == src->group && rr_sameString(agg->groups[j].region, src->region))
+            {
+                dst = &agg->groups[j];
+                break;
+            }
+        }
+        if (!dst)
+        {
+            dst = rr_getGroup(agg, src->region, src->group);
+            if (!dst)
+            {
+                return -ENOMEM;
+            }
+            *dst = *src;
+            memset(src, 0, sizeof(RankGroupResult));
+            continue;
+        }
+        if (dst->nevents != src->nevents || dst->nmetrics != src->nmetrics)
+        {
+            continue;
+        }
+        if (rr_addColumns(dst, src->ncolumns) < 0)
+        {
+            return -ENOMEM;
+        }
+        memcpy(&dst->columns[dst->ncolumns], src->columns, src->ncolumns * sizeof(RankColumn));
+        dst->ncolumns += src->ncolumns;
+        dst->hasCalls |= src->hasCalls;
+        src->ncolumns = 0;
+    }
+    return 0;
+}
+
+static int
+rr_compareColumns(const void* a, const void* b)
+{
+    const RankColumn* ca = (const RankColumn*)a;
+    const RankColumn* cb = (const RankColumn*)b;
+    if (ca->rank != cb->rank)
+        return (ca->rank < cb->rank ? -1 : 1);
+    return (ca->seq < cb->seq ? -1 : (ca->seq > cb->seq ? 1 : 0));
+}
+
+static int
+rr_compareDouble(const void* a, const void* b)
+{
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da < db ? -1 : (da > db ? 1 : 0));
+}
+
+/* Same selection as percentile_table in likwid-mpirun: index k/100*n rounded
+ * half up, first element for index 0 */
+static double
+rr_percentile(const double* sorted, int count, int k)
+{
+    double index = (double)k / 100.0 * count;
+    int i = (index - floor(index) >= 0.5 ? (int)ceil(index) : (int)floor(index));
+    if (count == 0)
+    {
+        return NAN;
+    }
+    if (i == 0)
+    {
+        i = 1;
+    }
+    return sorted[i-1];
+}
+
+/* Statistics over all columns, invalid values are skipped but counted for
+ * the average like in likwid.tableToMinMaxAvgSum */
+static void
+rr_statistics(const double* values, int count, double* scratch, int percentiles, RankStatistics* stats)
+{
+    int valid = 0;
+    stats->sum = 0;
+    stats->min = NAN;
+    stats->max = NAN;
+    for (int i = 0; i < count; i++)
+    {
+        if (isnan(values[i]))
+        {
+            continue;
+        }
+        if (valid == 0 || values[i] < stats->min)
+            stats->min = values[i];
+        if (valid == 0 || values[i] > stats->max)
+            stats->max = values[i];
+        stats->sum += values[i];
+        scratch[valid++] = values[i];
+    }
+    stats->avg = (count > 0 ? stats->sum / count : NAN);
+    stats->p25 = NAN;
+    stats->p50 = NAN;
+    stats->p75 = NAN;
+    if (percentiles && valid > 0)
+    {
+        qsort(scratch, valid, sizeof(double), rr_compareDouble);
+        stats->p25 = rr_percentile(scratch, valid, 25);
+        stats->p50 = rr_percentile(scratch, valid, 50);
+        stats->p75 = rr_percentile(scratch, valid, 75);
+    }
+}
+
+static int
+rr_finalizeGroup(RankGroupResult* g)
+{
+    double* values = NULL;
+    double* scratch = NULL;
+    int n = g->ncolumns;
+    qsort(g->columns, n, sizeof(RankColumn), rr_compareColumns);
+    g->eventStats = calloc(g->nevents + 1, sizeof(RankStatistics));
+    g->metricStats = calloc(g->nmetrics + 1, sizeof(RankStatistics));
+    values = malloc((n + 1) * sizeof(double));
+    scratch = malloc((n + 1) * sizeof(double));
+    if (!g->eventStats || !g->metricStats || !values || !scratch)
+    {
+        free(values);
+        free(scratch);
+        return -ENOMEM;
+    }
+    for (int c = 0; c < n; c++)
+        values[c] = g->columns[c].time;
+    rr_statistics(values, n, scratch, 0, &g->timeStats);
+    for (int c = 0; c < n; c++)
+        values[c] = g->columns[c].calls;
+    rr_statistics(values, n, scratch, 0, &g->callStats);
+    for (int e = 0; e < g->nevents; e++)
+    {
+        for (int c = 0; c < n; c++)
+            values[c] = g->columns[c].values[e];
+        rr_statistics(values, n, scratch, 0, &g->eventStats[e]);
+    }
+    for (int m = 0; m < g->nmetrics; m++)
+    {
+        for (int c = 0; c < n; c++)
+            values[c] = g->columns[c].metrics[m];
+        rr_statistics(values, n, scratch, 1, &g->metricStats[m]);
+    }
+    free(values);
+    free(scratch);
+    return 0;
+}
+
+static void*
+rr_readWorker(void* arg)
+{
+    RankWorker* w = (RankWorker*)arg;
+    w->ret = 0;
+    for (int i = 0; i < w->nfiles && w->ret == 0; i++)
+    {
+        w->ret = rr_readFile(w->aggregate, w->files[i]);
+    }
+    return NULL;
+}
+
+static void*
+rr_mergeWorker(void* arg)
+{
+    RankWorker* w = (RankWorker*)arg;
+    w->ret = rr_merge(w->aggregate, w->other);
+    return NULL;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+rankrecords_aggregate(int nfiles, char** files, int nthreads, RankAggregate** aggregate)
+{
+    int ret = 0;
+    int chunk = 0;
+    RankAggregate* parts = NULL;
+    RankWorker workers[RR_MAX_THREADS];
+    pthread_t threads[RR_MAX_THREADS];
+
+    if (nfiles < 0 || (nfiles > 0 && !files) || !aggregate)
+    {
+        return -EINVAL;
+    }
+    *aggregate = NULL;
+    if (nthreads > RR_MAX_THREADS)
+        nthreads = RR_MAX_THREADS;
+    if (nthreads > nfiles)
+        nthreads = nfiles;
+    if (nthreads < 1)
+        nthreads = 1;
+    parts = calloc(nthreads, sizeof(RankAggregate));
+    if (!parts)
+    {
+        return -ENOMEM;
+    }
+
+    /* Each thread reads a contiguous range of files */
+    chunk = (nfiles + nthreads - 1) / nthreads;
+    for (int t = 0; t < nthreads; t++)
+    {
+        int start = t * chunk;
+        workers[t].files = files + start;
+        workers[t].nfiles = (start >= nfiles ? 0 : (nfiles - start < chunk ? nfiles - start : chunk));
+        workers[t].aggregate = &parts[t];
+        workers[t].other = NULL;
+        workers[t].ret = 0;
+        if (t > 0 && pthread_create(&threads[t], NULL, rr_readWorker, &workers[t]) != 0)
+        {
+            rr_readWorker(&workers[t]);
+            threads[t] = 0;
+        }
+    }
+    rr_readWorker(&workers[0]);
+    for (int t = 1; t < nthreads; t++)
+    {
+        if (threads[t])
+            pthread_join(threads[t], NULL);
+    }
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (workers[t].ret < 0)
+            ret = workers[t].ret;
+    }
+
+    /* Merge the partial results pairwise in a binary tree, the left part
+     * always keeps the lower ranks */
+    for (int step = 1; step < nthreads && ret == 0; step *= 2)
+    {
+        int active = 0;
+        for (int t = 0; t + step < nthreads; t += 2 * step)
+        {
+            workers[active].aggregate = &parts[t];
+            workers[active].other = &parts[t + step];
+            workers[active].ret = 0;
+            if (pthread_create(&threads[active], NULL, rr_mergeWorker, &workers[active]) != 0)
+            {
+                rr_mergeWorker(&workers[active]);
+                threads[active] = 0;
+            }
+            active++;
+        }
+        for (int a = 0; a < active; a++)
+        {
+            if (threads[a])
+                pthread_join(threads[a], NULL);
+            if (workers[a].ret < 0)
+                ret = workers[a].ret;
+        }
+    }
+    for (int g = 0; g < parts[0].ngroups && ret == 0; g++)
+    {
+        ret = rr_finalizeGroup(&parts[0].groups[g]);
+    }
+    for (int t = 1; t < nthreads; t++)
+    {
+        rankrecords_free(&parts[t]);
+    }
+    if (ret < 0)
+    {
+        rankrecords_free(&parts[0]);
+        free(parts);
+        return ret;
+    }
+    *aggregate = parts;
+    return 0;
+}
+
+void
+rankrecords_free(RankAggregate* aggregate)
+{
+    if (aggregate)
+    {
+        for (int g = 0; g < aggregate->ngroups; g++)
+        {
+            rr_freeGroup(&aggregate->groups[g]);
+        }
+        free(aggregate->groups);
+        memset(aggregate, 0, sizeof(RankAggregate));
+    }
+}
@@ -0,0 +1,403 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  register_program.c
+ *
+ *      Description:  Pre-encoded register programs of event sets. The setup of an event
+ *                    set is recorded once per thread and replayed as a diff against the
+ *                    currently programmed registers.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <types.h>
+#include <error.h>
+#include <topology.h>
+#include <perfmon.h>
+#include <access.h>
+#include <register_program.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define REGPROG_KEY(dev, reg) ((((uint64_t)(dev) + 1) << 32) | (uint64_t)(reg))
+#define REGPROG_MIN_TABLE 64
+
+/* #####   EXPORTED VARIABLES   ########################################### */
+
+int regprog_tracking = 0;
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* Last value written to each register of a HW thread, open addressing with
+ * linear probing. Key 0 marks an empty slot. */
+typedef struct {
+    uint64_t key;
+    uint64_t value;
+} ShadowEntry;
+
+typedef struct {
+    int size;
+    int used;
+    ShadowEntry* entries;
+} ShadowTable;
+
+static int rp_numCpus = 0;
+static ShadowTable* rp_shadow = NULL;
+static RegisterProgram** rp_recording = NULL;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static inline uint64_t
+regprog_hash(uint64_t key)
+{
+    key ^= key >> 29;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 32;
+    return key;
+}
+
+static ShadowEntry*
+regprog_lookup(ShadowTable* table, uint64_t key)
+{
+    if (table->size == 0)
+    {
+        return NULL;
+    }
+    uint64_t mask = table->size - 1;
+    uint64_t pos = regprog_hash(key) & mask;
+    while (table->entries[pos].key != 0)
+    {
+        if (table->entries[pos].key == key)
+        {
+            return &table->entries[pos];
+        }
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
+
+static int
+regprog_store(ShadowTable* table, uint64_t key, uint64_t value)
+{
+    if (2 * (table->used + 1) > table->size)
+    {
+        int newsize = (table->size > 0 ? 2 * table->size : REGPROG_MIN_TABLE);
+        ShadowEntry* entries = calloc(newsize, sizeof(ShadowEntry));
+        if (!entries)
+        {
+            return -ENOMEM;
+        }
+        for (int i = 0; i < table->size; i++)
+        {
+            if (table->entries[i].key != 0)
+            {
+                uint64_t pos = regprog_hash(table->entries[i].key) & (newsize - 1);
+                while (entries[pos].key != 0)
+                {
+                    pos = (pos + 1) & (newsize - 1);
+                }
+                entries[pos] = table->entries[i];
+            }
+        }
+        free(table->entries);
+        table->entries = entries;
+        table->size = newsize;
+    }
+    uint64_t mask = table->size - 1;
+    uint64_t pos = regprog_hash(key) & mask;
+    while (table->entries[pos].key != 0 && table->entries[pos].key != key)
+    {
+        pos = (pos + 1) & mask;
+    }
+    if (table->entries[pos].key == 0)
+    {
+        table->entries[pos].key = key;
+        table->used++;
+    }
+    table->entries[pos].value = value;
+    return 0;
+}
+
+/* Only event selection and filter registers are pure configuration. All other
+ * registers (counters, global controls, overflow and box resets) may have side
+ * effects on write and are always written. */
+static int
+regprog_isConfig(PciDeviceIndex dev, uint32_t reg)
+{
+    for (int i = 0; i < perfmon_numCounters; i++)
+    {
+        if (counter_map[i].device != dev)
+        {
+            continue;
+        }
+        if (counter_map[i].configRegister == reg)
+        {
+            return 1;
+        }
+        BoxMap* box = &box_map[counter_map[i].type];
+        if ((box->filterRegister1 != 0 && box->filterRegister1 == reg) ||
+            (box->filterRegister2 != 0 && box->filterRegister2 == reg))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int
+regprog_append(RegisterProgram* prog, PciDeviceIndex dev, uint32_t reg, uint64_t data)
+{
+    if (prog->numberOfWrites == prog->size)
+    {
+        int newsize = (prog->size > 0 ? 2 * prog->size : 16);
+        HPMWriteRecord* writes = realloc(prog->writes, newsize * sizeof(HPMWriteRecord));
+        if (!writes)
+        {
+            return -ENOMEM;
+        }
+        prog->writes = writes;
+        uint8_t* config = realloc(prog->config, newsize * sizeof(uint8_t));
+        if (!config)
+        {
+            return -ENOMEM;
+        }
+        prog->config = config;
+        prog->size = newsize;
+    }
+    prog->writes[prog->numberOfWrites].dev = dev;
+    prog->writes[prog->numberOfWrites].reg = reg;
+    prog->writes[prog->numberOfWrites].data = data;
+    prog->config[prog->numberOfWrites] = regprog_isConfig(dev, reg);
+    prog->numberOfWrites++;
+    return 0;
+}
+
+static void
+regprog_clear(RegisterProgram* prog)
+{
+    free(prog->writes);
+    free(prog->config);
+    free(prog->init);
+    memset(prog, 0, sizeof(RegisterProgram));
+}
+
+static int
+regprog_compile(int thread_id, PerfmonEventSet* eventSet, RegisterProgram* prog)
+{
+    int ret = 0;
+    int cpu_id = groupSet->threads[thread_id].processorId;
+
+    regprog_clear(prog);
+    prog->init = malloc(eventSet->numberOfEvents * sizeof(int));
+    if (!prog->init && eventSet->numberOfEvents > 0)
+    {
+        return -ENOMEM;
+    }
+    prog->numberOfEvents = eventSet->numberOfEvents;
+    /* The architecture setup skips registers that already contain the value
+     * in currentConfig. For recording, all writes are required. */
+    memset(currentConfig[cpu_id], 0, NUM_PMC * sizeof(uint64_t));
+    rp_recording[cpu_id] = prog;
+    ret = perfmon_setupCountersThread(thread_id, eventSet);
+    rp_recording[cpu_id] = NULL;
+    if (ret < 0 || prog->compiled < 0)
+    {
+        regprog_clear(prog);
+        return ret;
+    }
+    for (int i = 0; i < eventSet->numberOfEvents; i++)
+    {
+        prog->init[i] = eventSet->events[i].threadCounter[thread_id].init;
+    }
+    prog->compiled = 1;
+    DEBUG_PRINT(DEBUGLEV_DEVELOP, Recorded register program with %d writes for CPU %d,
+                prog->numberOfWrites, cpu_id);
+    return ret;
+}
+
+static int
+regprog_apply(int thread_id, PerfmonEventSet* eventSet, RegisterProgram* prog)
+{
+    int ret = 0;
+    int count = 0;
+    int cpu_id = groupSet->threads[thread_id].processorId;
+    ShadowTable* table = &rp_shadow[cpu_id];
+    HPMWriteRecord* writes = malloc(MAX(prog->numberOfWrites, 1) * sizeof(HPMWriteRecord));
+    if (!writes)
+    {
+        return -ENOMEM;
+    }
+    for (int i = 0; i < prog->numberOfWrites; i++)
+    {
+        HPMWriteRecord* w = &prog->writes[i];
+        if (prog->config[i])
+        {
+            ShadowEntry* e = regprog_lookup(table, REGPROG_KEY(w->dev, w->reg));
+            if (e && e->value == w->data)
+            {
+                continue;
+            }
+        }
+        writes[count++] = *w;
+    }
+    DEBUG_PRINT(DEBUGLEV_DEVELOP, Register program for CPU %d: %d of %d writes,
+                cpu_id, count, prog->numberOfWrites);
+    ret = HPMwriteBatch(cpu_id, count, writes);
+    free(writes);
+    if (ret < 0)
+    {
+        /* Unknown which writes reached the registers */
+        regprog_invalidate(cpu_id);
+        return ret;
+    }
+    for (int i = 0; i < eventSet->numberOfEvents && i < prog->numberOfEvents; i++)
+    {
+        eventSet->events[i].threadCounter[thread_id].init = prog->init[i];
+    }
+    /* The registers do not contain the values of the last architecture setup
+     * anymore */
+    memset(currentConfig[cpu_id], 0, NUM_PMC * sizeof(uint64_t));
+    return 0;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+regprog_init(void)
+{
+    if (rp_shadow != NULL)
+    {
+        return 0;
+    }
+    rp_numCpus = cpuid_topology.numHWThreads;
+    rp_shadow = calloc(rp_numCpus, sizeof(ShadowTable));
+    rp_recording = calloc(rp_numCpus, sizeof(RegisterProgram*));
+    if (!rp_shadow || !rp_recording)
+    {
+        free(rp_shadow);
+        free(rp_recording);
+        rp_shadow = NULL;
+        rp_recording = NULL;
+        return -ENOMEM;
+    }
+    regprog_tracking = 1;
+    return 0;
+}
+
+void
+regprog_finalize(void)
+{
+    regprog_tracking = 0;
+    if (rp_shadow)
+    {
+        for (int i = 0; i < rp_numCpus; i++)
+        {
+            free(rp_shadow[i].entries);
+        }
+        free(rp_shadow);
+        rp_shadow = NULL;
+    }
+    free(rp_recording);
+    rp_recording = NULL;
+    rp_numCpus = 0;
+}
+
+void
+regprog_observe(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t data)
+{
+    if (cpu_id < 0 || cpu_id >= rp_numCpus)
+    {
+        return;
+    }
+    if (regprog_store(&rp_shadow[cpu_id], REGPROG_KEY(dev, reg), data) < 0)
+    {
+        regprog_invalidate(cpu_id);
+    }
+    if (rp_recording[cpu_id] != NULL)
+    {
+        if (regprog_append(rp_recording[cpu_id], dev, reg, data) < 0)
+        {
+            /* Incomplete program, it is recorded again at the next setup */
+            rp_recording[cpu_id]->compiled = -1;
+        }
+    }
+}
+
+void
+regprog_invalidate(int cpu_id)
+{
+    if (cpu_id < 0 || cpu_id >= rp_numCpus || !rp_shadow)
+    {
+        return;
+    }
+    free(rp_shadow[cpu_id].entries);
+    rp_shadow[cpu_id].entries = NULL;
+    rp_shadow[cpu_id].size = 0;
+    rp_shadow[cpu_id].used = 0;
+}
+
+int
+regprog_setupThread(int thread_id, PerfmonEventSet* eventSet)
+{
+    RegisterProgram* prog = NULL;
+    if (!regprog_tracking)
+    {
+        return perfmon_setupCountersThread(thread_id, eventSet);
+    }
+    if (eventSet->programs == NULL)
+    {
+        eventSet->programs = calloc(groupSet->numberOfThreads, sizeof(RegisterProgram));
+        if (eventSet->programs == NULL)
+        {
+            return perfmon_setupCountersThread(thread_id, eventSet);
+        }
+    }
+    prog = &eventSet->programs[thread_id];
+    if (prog->compiled == 1)
+    {
+        return regprog_apply(thread_id, eventSet, prog);
+    }
+    return regprog_compile(thread_id, eventSet, prog);
+}
+
+void
+regprog_destroy(PerfmonEventSet* eventSet, int numberOfThreads)
+{
+    if (eventSet->programs)
+    {
+        for (int i = 0; i < numberOfThreads; i++)
+        {
+            regprog_clear(&eventSet->programs[i]);
+        }
+        free(eventSet->programs);
+        eventSet->programs = NULL;
+    }
+}
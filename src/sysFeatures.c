@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <topology.h>
 #include <access.h>
@@ -21,6 +22,18 @@ int num_local_features = 0;
 
 _SysFeatureList _feature_list = {0, NULL, NULL};
 
+#define SYSFEATURES_SNAPSHOT_MAX_THREADS 64
+
+typedef struct {
+    int num_features;
+    int* indices;
+    int num_devices;
+    LikwidDevice_t* devices;
+    int start;
+    int end;
+    SysFeatureValue* values;
+} _SysFeatureSnapshotWorker;
+
 
 static int get_device_access(LikwidDevice_t device)
 {
@@ -288,6 +301,207 @@ int sysFeatures_modify(SysFeature* feature, LikwidDevice_t device, char* value)
     return sysFeatures_modifyByName(feature->name, device, value);
 }
 
+static void _sysFeatures_convert_value(char* str, SysFeatureValue* v)
+{
+    char* end = NULL;
+    errno = 0;
+    if (strncmp(str, "true", 5) == 0 || strncmp(str, "false", 6) == 0)
+    {
+        v->type = HWFEATURES_TYPE_UINT64;
+        v->value.uint64 = (str[0] == 't');
+        free(str);
+        return;
+    }
+    if (str[0] != '-' && str[0] != '\0')
+    {
+        uint64_t u = strtoull(str, &end, 10);
+        if (errno == 0 && *end == '\0')
+        {
+            v->type = HWFEATURES_TYPE_UINT64;
+            v->value.uint64 = u;
+            free(str);
+            return;
+        }
+    }
+    errno = 0;
+    double d = strtod(str, &end);
+    if (errno == 0 && end != str && *end == '\0')
+    {
+        v->type = HWFEATURES_TYPE_DOUBLE;
+        v->value.dbl = d;
+        free(str);
+        return;
+    }
+    v->type = HWFEATURES_TYPE_STRING;
+    v->value.str = str;
+}
+
+static void* _sysFeatures_snapshot_worker(void* arg)
+{
+    _SysFeatureSnapshotWorker* w = (_SysFeatureSnapshotWorker*)arg;
+    /* Without the cache the values are still read, just not merged */
+    int cached = (_sysFeatures_cache_begin() == 0);
+    for (int d = w->start; d < w->end; d++)
+    {
+        LikwidDevice_t device = w->devices[d];
+        for (int i = 0; i < w->num_features; i++)
+        {
+            _SysFeature* f = &_feature_list.features[w->indices[i]];
+            SysFeatureValue* v = &w->values[i * w->num_devices + d];
+            char* str = NULL;
+            if (v->error < 0)
+            {
+                continue;
+            }
+            v->error = f->getter(device, &str);
+            if (v->error == 0 && !str)
+            {
+                v->error = -ENODATA;
+            }
+            if (v->error > 0)
+            {
+                v->error = -v->error;
+            }
+            if (v->error == 0)
+            {
+                _sysFeatures_convert_value(str, v);
+            }
+            else if (str)
+            {
+                free(str);
+            }
+        }
+    }
+    if (cached)
+    {
+        _sysFeatures_cache_end();
+    }
+    return NULL;
+}
+
+int sysFeatures_snapshot(int num_features, char** names, int num_devices, LikwidDevice_t* devices, SysFeatureSnapshot* snapshot)
+{
+    int err = 0;
+    int nthreads = 1;
+    int* indices = NULL;
+    SysFeatureValue* values = NULL;
+    _SysFeatureSnapshotWorker workers[SYSFEATURES_SNAPSHOT_MAX_THREADS];
+    pthread_t threads[SYSFEATURES_SNAPSHOT_MAX_THREADS];
+    if ((num_features <= 0) || (!names) || (num_devices <= 0) || (!devices) || (!snapshot))
+    {
+        return -EINVAL;
+    }
+    snapshot->num_features = 0;
+    snapshot->num_devices = 0;
+    snapshot->values = NULL;
+
+    indices = malloc(num_features * sizeof(int));
+    values = calloc(num_features * num_devices, sizeof(SysFeatureValue));
+    if (!indices || !values)
+    {
+        free(indices);
+        free(values);
+        return -ENOMEM;
+    }
+    /* Resolve the names once instead of once per device */
+    for (int i = 0; i < num_features; i++)
+    {
+        indices[i] = _sysFeatures_get_feature_index(names[i]);
+        if (indices[i] < 0 || !_feature_list.features[indices[i]].getter)
+        {
+            DEBUG_PRINT(DEBUGLEV_DEVELOP, No readable feature %s, names[i]);
+            free(indices);
+            free(values);
+            return -EINVAL;
+        }
+    }
+    /* Access setup is not thread-safe, so it is done upfront */
+    for (int d = 0; d < num_devices; d++)
+    {
+        int access_err = 0;
+        if (!devices[d] || devices[d]->type == DEVICE_TYPE_INVALID)
+        {
+            access_err = -EINVAL;
+        }
+        else
+        {
+            access_err = get_device_access(devices[d]);
+        }
+        for (int i = 0; i < num_features; i++)
+        {
+            SysFeatureValue* v = &values[i * num_devices + d];
+            v->type = HWFEATURES_TYPE_UINT64;
+            if (access_err < 0)
+            {
+                v->error = access_err;
+            }
+            else if (_feature_list.features[indices[i]].type != devices[d]->type)
+            {
+                v->error = -ENODEV;
+            }
+        }
+    }
+
+    topology_init();
+    nthreads = get_cpuTopology()->activeHWThreads;
+    if (nthreads > SYSFEATURES_SNAPSHOT_MAX_THREADS)
+        nthreads = SYSFEATURES_SNAPSHOT_MAX_THREADS;
+    if (nthreads > num_devices)
+        nthreads = num_devices;
+    if (nthreads < 1)
+        nthreads = 1;
+    for (int t = 0; t < nthreads; t++)
+    {
+        workers[t].num_features = num_features;
+        workers[t].indices = indices;
+        workers[t].num_devices = num_devices;
+        workers[t].devices = devices;
+        workers[t].start = (int)(((long)num_devices * t) / nthreads);
+        workers[t].end = (int)(((long)num_devices * (t + 1)) / nthreads);
+        workers[t].values = values;
+        threads[t] = 0;
+        if (t > 0 && pthread_create(&threads[t], NULL, _sysFeatures_snapshot_worker, &workers[t]) != 0)
+        {
+            threads[t] = 0;
+            _sysFeatures_snapshot_worker(&workers[t]);
+        }
+    }
+    _sysFeatures_snapshot_worker(&workers[0]);
+    for (int t = 1; t < nthreads; t++)
+    {
+        if (threads[t])
+        {
+            pthread_join(threads[t], NULL);
+        }
+    }
+    free(indices);
+
+    snapshot->num_features = num_features;
+    snapshot->num_devices = num_devices;
+    snapshot->values = values;
+    return 0;
+}
+
+void sysFeatures_snapshot_return(SysFeatureSnapshot* snapshot)
+{
+    if (!snapshot || !snapshot->values)
+    {
+        return;
+    }
+    for (int i = 0; i < snapshot->num_features * snapshot->num_devices; i++)
+    {
+        SysFeatureValue* v = &snapshot->values[i];
+        if (v->error == 0 && v->type == HWFEATURES_TYPE_STRING)
+        {
+            free(v->value.str);
+        }
+    }
+    free(snapshot->values);
+    snapshot->values = NULL;
+    snapshot->num_features = 0;
+    snapshot->num_devices = 0;
+}
+
 void sysFeatures_finalize()
 {
     if (local_features != NULL)
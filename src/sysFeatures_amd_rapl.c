@@ -43,7 +43,7 @@ static int amd_rapl_register_test(uint32_t reg)
             HWThread* t = &topo->threadPool[j];
             if (t->packageId == i)
             {
-                err = HPMread(t->apicId, MSR_DEV, reg, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, reg, &data);
                 if (err == 0) valid++;
                 break;
             }
@@ -72,7 +72,7 @@ static int amd_rapl_register_test_bit(uint32_t reg, int bitoffset)
             HWThread* t = &topo->threadPool[j];
             if (t->packageId == i)
             {
-                err = HPMread(t->apicId, MSR_DEV, reg, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, reg, &data);
                 if (err == 0 && (data & (1ULL<<bitoffset))) valid++;
                 break;
             }
@@ -90,7 +90,7 @@ static int sysFeatures_amd_rapl_energy_status_getter(LikwidDevice_t device, char
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -111,7 +111,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_enable_getter(LikwidDevice_t devi
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -135,7 +135,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_enable_setter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -154,7 +154,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_clamp_getter(LikwidDevice_t devic
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -178,7 +178,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_clamp_setter(LikwidDevice_t devic
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -198,7 +198,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_getter(LikwidDevice_t device, cha
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -224,7 +224,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_setter(LikwidDevice_t device, cha
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -250,7 +250,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_time_getter(LikwidDevice_t device
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -281,7 +281,7 @@ static int sysFeatures_amd_rapl_energy_limit_1_time_setter(LikwidDevice_t device
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -309,7 +309,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_getter(LikwidDevice_t device, cha
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -335,7 +335,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_setter(LikwidDevice_t device, cha
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -362,7 +362,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_time_getter(LikwidDevice_t device
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -393,7 +393,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_time_setter(LikwidDevice_t device
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -421,7 +421,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_enable_getter(LikwidDevice_t devi
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -446,7 +446,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_enable_setter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -466,7 +466,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_clamp_getter(LikwidDevice_t devic
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -491,7 +491,7 @@ static int sysFeatures_amd_rapl_energy_limit_2_clamp_setter(LikwidDevice_t devic
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -511,7 +511,7 @@ static int sysFeatures_amd_rapl_info_tdp(LikwidDevice_t device, char** value, ui
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -530,7 +530,7 @@ static int sysFeatures_amd_rapl_info_min_power(LikwidDevice_t device, char** val
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -549,7 +549,7 @@ static int sysFeatures_amd_rapl_info_max_power(LikwidDevice_t device, char** val
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -568,7 +568,7 @@ static int sysFeatures_amd_rapl_info_max_time(LikwidDevice_t device, char** valu
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -587,7 +587,7 @@ static int sysFeatures_amd_rapl_policy_getter(LikwidDevice_t device, char** valu
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -606,7 +606,7 @@ static int sysFeatures_amd_rapl_policy_setter(LikwidDevice_t device, char* value
     {
         return err;
     }
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -646,7 +646,7 @@ int amd_rapl_pkg_test()
             HWThread* t = &topo->threadPool[j];
             if (t->packageId == i)
             {
-                err = HPMread(t->apicId, MSR_DEV, MSR_AMD17_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_AMD17_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (amd_rapl_pkg_info.powerUnit == 0 && amd_rapl_pkg_info.energyUnit == 0 && amd_rapl_pkg_info.timeUnit == 0)
                 {
@@ -799,7 +799,7 @@ int amd_rapl_core_test()
     {
         uint64_t data = 0x0;
         HWThread* t = &topo->threadPool[j];
-        err = HPMread(t->apicId, MSR_DEV, MSR_AMD17_RAPL_POWER_UNIT, &data);
+        err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_AMD17_RAPL_POWER_UNIT, &data);
         if (err == 0) valid++;
         if (amd_rapl_core_info.powerUnit == 0 && amd_rapl_core_info.energyUnit == 0 && amd_rapl_core_info.timeUnit == 0)
         {
@@ -920,7 +920,7 @@ int amd_rapl_l3_test()
                 HWThread* t = &topo->threadPool[j];
                 if (t->packageId == i)
                 {
-                    err = HPMread(t->apicId, MSR_DEV, MSR_AMD19_RAPL_L3_UNIT, &data);
+                    err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_AMD19_RAPL_L3_UNIT, &data);
                     if (err == 0) valid++;
                     if (amd_rapl_l3_info.powerUnit == 0 && amd_rapl_l3_info.energyUnit == 0 && amd_rapl_l3_info.timeUnit == 0)
                     {
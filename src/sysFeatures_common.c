@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <registers.h>
 #include <cpuid.h>
@@ -8,8 +9,21 @@
 #include <sysFeatures_types.h>
 #include <likwid.h>
 #include <error.h>
+#include <access.h>
+#include <ghash.h>
+#include <bstrlib_helper.h>
 #include <sysFeatures_common.h>
 
+typedef struct {
+    int err;
+    uint64_t data;
+} _SysFeatureCachedReg;
+
+/* Per-thread caches, only valid between _sysFeatures_cache_begin and
+ * _sysFeatures_cache_end */
+static __thread GHashTable* _reg_cache = NULL;
+static __thread GHashTable* _file_cache = NULL;
+
 int register_features(_SysFeatureList *features, _SysFeatureList* in)
 {
     int err = 0;
@@ -140,3 +154,87 @@ int _string_to_uint64(char* str, uint64_t* value)
     *value = v;
     return 0;
 }
+
+static void _destroy_cached_file(gpointer data)
+{
+    bdestroy((bstring)data);
+}
+
+int _sysFeatures_cache_begin(void)
+{
+    if (_reg_cache || _file_cache)
+    {
+        return -EBUSY;
+    }
+    _reg_cache = g_hash_table_new_full(g_int64_hash, g_int64_equal, free, free);
+    _file_cache = g_hash_table_new_full(g_str_hash, g_str_equal, free, _destroy_cached_file);
+    if (!_reg_cache || !_file_cache)
+    {
+        _sysFeatures_cache_end();
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+void _sysFeatures_cache_end(void)
+{
+    if (_reg_cache)
+    {
+        g_hash_table_destroy(_reg_cache);
+        _reg_cache = NULL;
+    }
+    if (_file_cache)
+    {
+        g_hash_table_destroy(_file_cache);
+        _file_cache = NULL;
+    }
+}
+
+int _sysFeatures_HPMread(int cpu_id, PciDeviceIndex dev, uint32_t reg, uint64_t* data)
+{
+    /* 16 bits for the device, there are more than 256 PCI device types */
+    uint64_t key = (((uint64_t)cpu_id) << 48) | ((((uint64_t)dev) & 0xFFFF) << 32) | reg;
+    _SysFeatureCachedReg* entry = NULL;
+    if (!_reg_cache)
+    {
+        return HPMread(cpu_id, dev, reg, data);
+    }
+    entry = g_hash_table_lookup(_reg_cache, &key);
+    if (!entry)
+    {
+        uint64_t* k = malloc(sizeof(uint64_t));
+        entry = malloc(sizeof(_SysFeatureCachedReg));
+        if (!k || !entry)
+        {
+            free(k);
+            free(entry);
+            return HPMread(cpu_id, dev, reg, data);
+        }
+        *k = key;
+        entry->err = HPMread(cpu_id, dev, reg, &entry->data);
+        g_hash_table_insert(_reg_cache, k, entry);
+    }
+    *data = entry->data;
+    return entry->err;
+}
+
+bstring _sysFeatures_read_file(char* filename)
+{
+    bstring content = NULL;
+    if (!_file_cache)
+    {
+        return read_file(filename);
+    }
+    content = g_hash_table_lookup(_file_cache, filename);
+    if (!content)
+    {
+        char* k = strdup(filename);
+        content = read_file(filename);
+        if (!k)
+        {
+            return content;
+        }
+        g_hash_table_insert(_file_cache, k, content);
+    }
+    return bstrcpy(content);
+}
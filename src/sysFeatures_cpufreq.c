@@ -23,7 +23,7 @@ static int cpufreq_sysfs_getter(LikwidDevice_t device, char** value, char* sysfs
     bstring filename = bformat("/sys/devices/system/cpu/cpu%d/cpufreq/%s", device->id.simple.id, sysfs_filename);
     if (!access(bdata(filename), R_OK))
     {
-        bstring content = read_file(bdata(filename));
+        bstring content = _sysFeatures_read_file(bdata(filename));
         if (blength(content) > 0)
         {
             btrimws(content);
@@ -102,7 +102,7 @@ static int cpufreq_driver_test(char* testgovernor)
             bstring filename = bformat("/sys/devices/system/cpu/cpu%d/cpufreq/scaling_driver", t->apicId);
             if (!access(bdata(filename), R_OK))
             {
-                bstring content = read_file(bdata(filename));
+                bstring content = _sysFeatures_read_file(bdata(filename));
                 btrimws(content);
                 err = (bstrncmp(content, btest, blength(btest)) == BSTR_OK);
                 bdestroy(content);
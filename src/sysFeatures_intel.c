@@ -53,7 +53,7 @@ int intel_cpu_msr_register_getter(LikwidDevice_t device, uint32_t reg, uint64_t
         return err;
     }
     uint64_t data = 0x0;
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err == 0)
     {
         uint64_t _val = 0x0;
@@ -94,7 +94,7 @@ int intel_cpu_msr_register_setter(LikwidDevice_t device, uint32_t reg, uint64_t
     {
         return err;
     }
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err == 0)
     {
         data &= ~(mask);
@@ -144,7 +144,7 @@ int intel_cpu_turbo_test()
         HWThread* t = &topo->threadPool[j];
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-        err = HPMread(t->apicId, MSR_DEV, MSR_IA32_MISC_ENABLE, &data);
+        err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_IA32_MISC_ENABLE, &data);
         if (err == 0) valid++;
         break;
     }
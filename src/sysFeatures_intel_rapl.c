@@ -52,7 +52,7 @@ static int intel_rapl_register_test(uint32_t reg)
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, reg, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, reg, &data);
                 if (err == 0) valid++;
                 break;
             }
@@ -83,7 +83,7 @@ static int intel_rapl_register_test_bit(uint32_t reg, int bitoffset)
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, reg, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, reg, &data);
                 if (err == 0 && (data & (1ULL<<bitoffset))) valid++;
                 break;
             }
@@ -111,7 +111,7 @@ static int sysFeatures_intel_rapl_energy_status_getter(LikwidDevice_t device, ch
         return err;
     }
     
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -142,7 +142,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_enable_getter(LikwidDevice_t de
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -176,7 +176,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_enable_setter(LikwidDevice_t de
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -205,7 +205,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_clamp_getter(LikwidDevice_t dev
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -239,7 +239,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_clamp_setter(LikwidDevice_t dev
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -269,7 +269,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_getter(LikwidDevice_t device, c
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -295,7 +295,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_setter(LikwidDevice_t device, c
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -331,7 +331,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_time_getter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -372,7 +372,7 @@ static int sysFeatures_intel_rapl_energy_limit_1_time_setter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -400,7 +400,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_getter(LikwidDevice_t device, c
         return -EINVAL;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -436,7 +436,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_setter(LikwidDevice_t device, c
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -473,7 +473,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_time_getter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -514,7 +514,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_time_setter(LikwidDevice_t devi
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -552,7 +552,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_enable_getter(LikwidDevice_t de
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -587,7 +587,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_enable_setter(LikwidDevice_t de
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -617,7 +617,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_clamp_getter(LikwidDevice_t dev
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -652,7 +652,7 @@ static int sysFeatures_intel_rapl_energy_limit_2_clamp_setter(LikwidDevice_t dev
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -682,7 +682,7 @@ static int sysFeatures_intel_rapl_info_tdp(LikwidDevice_t device, char** value,
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -711,7 +711,7 @@ static int sysFeatures_intel_rapl_info_min_power(LikwidDevice_t device, char** v
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -740,7 +740,7 @@ static int sysFeatures_intel_rapl_info_max_power(LikwidDevice_t device, char** v
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -769,7 +769,7 @@ static int sysFeatures_intel_rapl_info_max_time(LikwidDevice_t device, char** va
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -798,7 +798,7 @@ static int sysFeatures_intel_rapl_policy_getter(LikwidDevice_t device, char** va
         return err;
     }
 
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -827,7 +827,7 @@ static int sysFeatures_intel_rapl_policy_setter(LikwidDevice_t device, char* val
     {
         return err;
     }
-    err = HPMread(device->id.simple.id, MSR_DEV, reg, &data);
+    err = _sysFeatures_HPMread(device->id.simple.id, MSR_DEV, reg, &data);
     if (err < 0)
     {
         return err;
@@ -875,7 +875,7 @@ int intel_rapl_pkg_test()
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (intel_rapl_pkg_info.powerUnit == 0 && intel_rapl_pkg_info.energyUnit == 0 && intel_rapl_pkg_info.timeUnit == 0)
                 {
@@ -1039,7 +1039,7 @@ int intel_rapl_dram_test()
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (intel_rapl_dram_info.powerUnit == 0 && intel_rapl_dram_info.energyUnit == 0 && intel_rapl_dram_info.timeUnit == 0)
                 {
@@ -1181,7 +1181,7 @@ int intel_rapl_psys_test()
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (intel_rapl_psys_info.powerUnit == 0 && intel_rapl_psys_info.energyUnit == 0 && intel_rapl_psys_info.timeUnit == 0)
                 {
@@ -1321,7 +1321,7 @@ int intel_rapl_pp0_test()
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (intel_rapl_pp0_info.powerUnit == 0 && intel_rapl_pp0_info.energyUnit == 0 && intel_rapl_pp0_info.timeUnit == 0)
                 {
@@ -1438,7 +1438,7 @@ int intel_rapl_pp1_test()
             {
 		err = HPMaddThread(t->apicId);
 		if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_RAPL_POWER_UNIT, &data);
                 if (err == 0) valid++;
                 if (intel_rapl_pp1_info.powerUnit == 0 && intel_rapl_pp1_info.energyUnit == 0 && intel_rapl_pp1_info.timeUnit == 0)
                 {
@@ -38,10 +38,10 @@ int intel_uncorefreq_test()
                 if (t->packageId != j) continue;
                 err = HPMaddThread(t->apicId);
                 if (err < 0) continue;
-                err = HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
+                err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
                 if (err == 0)
                 {
-                    err = HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ_READ, &tmp);
+                    err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ_READ, &tmp);
                     if (err == 0)
                     {
                         valid++;
@@ -82,7 +82,7 @@ int intel_uncore_cur_freq_getter(LikwidDevice_t device, char** value)
             uint64_t tmp = 0;
             err = HPMaddThread(t->apicId);
             if (err < 0) continue;
-            err = HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ_READ, &tmp);
+            err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ_READ, &tmp);
             if (err == 0)
             {
                 tmp = (tmp & 0xFFULL) * 100;
@@ -120,7 +120,7 @@ int intel_uncore_min_freq_getter(LikwidDevice_t device, char** value)
             uint64_t tmp = 0;
             err = HPMaddThread(t->apicId);
             if (err < 0) continue;
-            err = HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
+            err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
             if (err == 0)
             {
                 tmp = ((tmp>>8) & 0xFFULL) * 100;
@@ -158,7 +158,7 @@ int intel_uncore_max_freq_getter(LikwidDevice_t device, char** value)
             uint64_t tmp = 0;
             err = HPMaddThread(t->apicId);
             if (err < 0) continue;
-            err = HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
+            err = _sysFeatures_HPMread(t->apicId, MSR_DEV, MSR_UNCORE_FREQ, &tmp);
             if (err == 0)
             {
                 tmp = (tmp & 0xFFULL) * 100;;
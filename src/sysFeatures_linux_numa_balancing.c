@@ -23,7 +23,7 @@ int numa_balancing_procfs_getter(LikwidDevice_t device, char** value, char* sysf
     bstring filename = bformat("/proc/sys/kernel/%s", sysfsfile);
     if (!access(bdata(filename), R_OK))
     {
-        bstring content = read_file(bdata(filename));
+        bstring content = _sysFeatures_read_file(bdata(filename));
         if (blength(content) > 0)
         {
             btrimws(content);
@@ -46,6 +46,7 @@
 //#include <strUtil.h>
 #include <configuration.h>
 #include <topology_static.h>
+#include <topology_cache.h>
 
 /* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
 
@@ -1712,8 +1713,16 @@ standard_init:
                 }
             }
         }
-        DEBUG_PRINT(DEBUGLEV_INFO, Reading topology information from %s, config.topologyCfgFileName);
-        ret = readTopologyFile(config.topologyCfgFileName, cpuSet);
+        if (topology_cache_check(config.topologyCfgFileName) == 0)
+        {
+            DEBUG_PRINT(DEBUGLEV_INFO, Reading topology cache from %s, config.topologyCfgFileName);
+            ret = topology_cache_load(config.topologyCfgFileName, cpuSet);
+        }
+        else
+        {
+            DEBUG_PRINT(DEBUGLEV_INFO, Reading topology information from %s, config.topologyCfgFileName);
+            ret = readTopologyFile(config.topologyCfgFileName, cpuSet);
+        }
         if (ret < 0)
             goto standard_init;
         cpuid_topology.activeHWThreads = 0;
@@ -1794,6 +1803,7 @@ topology_finalize(void)
     cpuid_topology.numThreadsPerCore = 0;
     cpuid_topology.numCacheLevels = 0;
 
+    topology_cache_release();
     topology_initialized = 0;
 }
 
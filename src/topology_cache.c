@@ -0,0 +1,651 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  topology_cache.c
+ *
+ *      Description:  Binary snapshot of the CPU, cache, NUMA and affinity topology.
+ *                    The snapshot is written by likwid-genTopoCfg and mapped once at
+ *                    topology_init to avoid probing the system in every process.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+/* #####   HEADER FILE INCLUDES   ######################################### */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <types.h>
+#include <error.h>
+#include <likwid.h>
+#include <cpuid.h>
+#include <affinity.h>
+#include <topology_cache.h>
+
+/* #####   MACROS  -  LOCAL TO THIS SOURCE FILE   ######################### */
+
+#define TC_ALIGN(x) (((x) + 7) & ~((uint64_t)7))
+#define TC_PTR(type, off) ((type)(tc_map + (off)))
+#define TC_NUM_LOOKUPS 5
+
+/* #####   VARIABLES  -  LOCAL TO THIS SOURCE FILE   ###################### */
+
+/* All pointers inside the stored structures are replaced by offsets relative
+ * to the start of the file. */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint32_t sizeCpuInfo;
+    uint32_t sizeCpuTopology;
+    uint32_t sizeHWThread;
+    uint32_t sizeCacheLevel;
+    uint32_t sizeNumaNode;
+    uint32_t sizeAffinityDomain;
+    /* Fingerprint of the machine at generation time */
+    uint32_t cpuSignature;
+    uint32_t numConfCpus;
+    uint64_t cpuOnlineHash;
+    uint64_t nodeOnlineHash;
+    cpu_set_t cpuSet;
+    /* Offsets of the payload */
+    uint64_t cpuInfo;
+    uint64_t cpuTopology;
+    uint64_t numaTopology;
+    uint64_t affinityDomains;
+    uint64_t lookups[TC_NUM_LOOKUPS];
+} TopologyCacheHeader;
+
+typedef struct {
+    char* data;
+    uint64_t size;
+    uint64_t capacity;
+    int failed;
+} TopologyCacheBuffer;
+
+static char* tc_map = NULL;
+static size_t tc_mapSize = 0;
+static int tc_affinityValid = 0;
+
+/* #####   FUNCTION DEFINITIONS  -  LOCAL TO THIS SOURCE FILE   ########### */
+
+static uint32_t
+tc_cpuSignature(void)
+{
+    uint32_t eax = 0x0, ebx = 0x0, ecx = 0x0, edx = 0x0;
+#if !defined(__ARM_ARCH_7A__) && !defined(__ARM_ARCH_8A) && !defined(_ARCH_PPC)
+    eax = 0x01;
+    CPUID(eax, ebx, ecx, edx);
+#endif
+    return eax;
+}
+
+static uint64_t
+tc_hashFile(const char* filename)
+{
+    /* FNV-1a over the file content, 0 if the file does not exist */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    char buf[512];
+    ssize_t len = 0;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    while ((len = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (ssize_t i = 0; i < len; i++)
+        {
+            hash ^= (unsigned char)buf[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    close(fd);
+    return hash;
+}
+
+static void
+tc_fingerprint(TopologyCacheHeader* header)
+{
+    header->cpuSignature = tc_cpuSignature();
+    header->numConfCpus = sysconf(_SC_NPROCESSORS_CONF);
+    header->cpuOnlineHash = tc_hashFile("/sys/devices/system/cpu/online");
+    header->nodeOnlineHash = tc_hashFile("/sys/devices/system/node/online");
+}
+
+static uint64_t
+tc_append(TopologyCacheBuffer* buf, const void* data, uint64_t size)
+{
+    uint64_t offset = TC_ALIGN(buf->size);
+    if (offset + size > buf->capacity)
+    {
+        uint64_t newcap = buf->capacity * 2;
+        while (newcap < offset + size)
+        {
+            newcap *= 2;
+        }
+        char* tmp = realloc(buf->data, newcap);
+        if (!tmp)
+        {
+            buf->failed = 1;
+            return 0;
+        }
+        memset(tmp + buf->capacity, 0, newcap - buf->capacity);
+        buf->data = tmp;
+        buf->capacity = newcap;
+    }
+    if (data)
+    {
+        memcpy(buf->data + offset, data, size);
+    }
+    buf->size = offset + size;
+    return offset;
+}
+
+static uint64_t
+tc_appendString(TopologyCacheBuffer* buf, const char* str)
+{
+    if (!str)
+    {
+        return 0;
+    }
+    return tc_append(buf, str, strlen(str) + 1);
+}
+
+static int
+tc_inMap(uint64_t offset, size_t size)
+{
+    return (offset != 0 && offset <= tc_mapSize && size <= tc_mapSize - offset);
+}
+
+static void*
+tc_copy(uint64_t offset, size_t size)
+{
+    void* ptr = NULL;
+    if (!tc_inMap(offset, size))
+    {
+        return NULL;
+    }
+    ptr = malloc(size);
+    if (ptr)
+    {
+        memcpy(ptr, tc_map + offset, size);
+    }
+    return ptr;
+}
+
+static char*
+tc_copyString(uint64_t offset)
+{
+    if (offset == 0 || offset >= tc_mapSize)
+    {
+        return NULL;
+    }
+    return strndup(tc_map + offset, tc_mapSize - offset);
+}
+
+static int
+tc_map_file(const char* filename)
+{
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(TopologyCacheHeader))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    tc_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (tc_map == MAP_FAILED)
+    {
+        tc_map = NULL;
+        return -errno;
+    }
+    tc_mapSize = st.st_size;
+    return 0;
+}
+
+static int
+tc_validate(const TopologyCacheHeader* header)
+{
+    TopologyCacheHeader current;
+    if (header->version != TOPOLOGY_CACHE_VERSION ||
+        header->headerSize != sizeof(TopologyCacheHeader) ||
+        header->fileSize != tc_mapSize ||
+        header->sizeCpuInfo != sizeof(CpuInfo) ||
+        header->sizeCpuTopology != sizeof(CpuTopology) ||
+        header->sizeHWThread != sizeof(HWThread) ||
+        header->sizeCacheLevel != sizeof(CacheLevel) ||
+        header->sizeNumaNode != sizeof(NumaNode) ||
+        header->sizeAffinityDomain != sizeof(AffinityDomain))
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Topology cache has incompatible version or layout);
+        return -ESTALE;
+    }
+    memset(&current, 0, sizeof(TopologyCacheHeader));
+    tc_fingerprint(&current);
+    if (header->cpuSignature != current.cpuSignature ||
+        header->numConfCpus != current.numConfCpus ||
+        header->cpuOnlineHash != current.cpuOnlineHash ||
+        header->nodeOnlineHash != current.nodeOnlineHash)
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Topology cache was generated on a different system configuration);
+        return -ESTALE;
+    }
+    return 0;
+}
+
+/* #####   FUNCTION DEFINITIONS  -  EXPORTED FUNCTIONS   ################## */
+
+int
+topology_cache_check(const char* filename)
+{
+    char magic[8];
+    int ret = -EINVAL;
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        return -errno;
+    }
+    if (fread(magic, sizeof(magic), 1, fp) == 1 &&
+        strncmp(magic, TOPOLOGY_CACHE_MAGIC, sizeof(magic)) == 0)
+    {
+        ret = 0;
+    }
+    fclose(fp);
+    return ret;
+}
+
+int
+topology_cache_load(const char* filename, cpu_set_t cpuSet)
+{
+    int ret = 0;
+    const TopologyCacheHeader* header = NULL;
+    const CpuInfo* info = NULL;
+    const CpuTopology* topo = NULL;
+    const NumaTopology* numa = NULL;
+    const NumaNode* nodes = NULL;
+
+    topology_cache_release();
+    ret = tc_map_file(filename);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    header = TC_PTR(const TopologyCacheHeader*, 0);
+    if (strncmp(header->magic, TOPOLOGY_CACHE_MAGIC, sizeof(header->magic)) != 0)
+    {
+        topology_cache_release();
+        return -EINVAL;
+    }
+    ret = tc_validate(header);
+    if (ret < 0)
+    {
+        topology_cache_release();
+        return ret;
+    }
+    if (!tc_inMap(header->cpuInfo, sizeof(CpuInfo)) ||
+        !tc_inMap(header->cpuTopology, sizeof(CpuTopology)) ||
+        !tc_inMap(header->numaTopology, sizeof(NumaTopology)))
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Topology cache contains invalid offsets);
+        topology_cache_release();
+        return -EINVAL;
+    }
+    info = TC_PTR(const CpuInfo*, header->cpuInfo);
+    topo = TC_PTR(const CpuTopology*, header->cpuTopology);
+    numa = TC_PTR(const NumaTopology*, header->numaTopology);
+
+    memcpy(&cpuid_info, info, sizeof(CpuInfo));
+    cpuid_info.osname = tc_copyString((uint64_t)(uintptr_t)info->osname);
+    cpuid_info.features = tc_copyString((uint64_t)(uintptr_t)info->features);
+    cpuid_info.name = NULL;
+    cpuid_info.short_name = NULL;
+
+    memcpy(&cpuid_topology, topo, sizeof(CpuTopology));
+    cpuid_topology.topologyTree = NULL;
+    cpuid_topology.activeHWThreads = 0;
+    cpuid_topology.threadPool = tc_copy((uint64_t)(uintptr_t)topo->threadPool,
+                                        topo->numHWThreads * sizeof(HWThread));
+    cpuid_topology.cacheLevels = tc_copy((uint64_t)(uintptr_t)topo->cacheLevels,
+                                         topo->numCacheLevels * sizeof(CacheLevel));
+    if (!cpuid_topology.threadPool || (topo->numCacheLevels > 0 && !cpuid_topology.cacheLevels))
+    {
+        ret = -ENOMEM;
+        goto load_error;
+    }
+    for (int i = 0; i < cpuid_topology.numHWThreads; i++)
+    {
+        cpuid_topology.threadPool[i].inCpuSet = 0;
+    }
+
+    if (numa->numberOfNodes > 0 &&
+        !tc_inMap((uint64_t)(uintptr_t)numa->nodes, numa->numberOfNodes * sizeof(NumaNode)))
+    {
+        DEBUG_PRINT(DEBUGLEV_INFO, Topology cache contains invalid NUMA node offsets);
+        ret = -EINVAL;
+        goto load_error;
+    }
+    nodes = TC_PTR(const NumaNode*, (uint64_t)(uintptr_t)numa->nodes);
+    numa_info.numberOfNodes = numa->numberOfNodes;
+    numa_info.nodes = calloc(numa->numberOfNodes, sizeof(NumaNode));
+    if (!numa_info.nodes)
+    {
+        ret = -ENOMEM;
+        goto load_error;
+    }
+    for (int i = 0; i < numa->numberOfNodes; i++)
+    {
+        NumaNode* node = &numa_info.nodes[i];
+        memcpy(node, &nodes[i], sizeof(NumaNode));
+        node->processors = tc_copy((uint64_t)(uintptr_t)nodes[i].processors,
+                                   nodes[i].numberOfProcessors * sizeof(uint32_t));
+        node->distances = tc_copy((uint64_t)(uintptr_t)nodes[i].distances,
+                                  nodes[i].numberOfDistances * sizeof(uint32_t));
+    }
+
+    /* The affinity domains contain only the HW threads of the cpuset at
+     * generation time, so they can only be reused with the same cpuset */
+    tc_affinityValid = CPU_EQUAL(&cpuSet, &header->cpuSet) && header->affinityDomains != 0;
+    DEBUG_PRINT(DEBUGLEV_INFO, Loaded topology cache %s (affinity domains %s), filename,
+                (tc_affinityValid ? "reused" : "recomputed"));
+    return 0;
+load_error:
+    if (cpuid_info.osname)
+    {
+        free(cpuid_info.osname);
+        cpuid_info.osname = NULL;
+    }
+    if (cpuid_info.features)
+    {
+        free(cpuid_info.features);
+        cpuid_info.features = NULL;
+    }
+    if (cpuid_topology.threadPool)
+    {
+        free(cpuid_topology.threadPool);
+        cpuid_topology.threadPool = NULL;
+    }
+    if (cpuid_topology.cacheLevels)
+    {
+        free(cpuid_topology.cacheLevels);
+        cpuid_topology.cacheLevels = NULL;
+    }
+    topology_cache_release();
+    return ret;
+}
+
+int
+topology_cache_getAffinity(AffinityDomains* affinity, int* lookups[5])
+{
+    const TopologyCacheHeader* header = NULL;
+    const AffinityDomains* cached = NULL;
+    const AffinityDomain* doms = NULL;
+    int numHWThreads = cpuid_topology.numHWThreads;
+    if (!tc_map || !tc_affinityValid)
+    {
+        return -ENOENT;
+    }
+    header = TC_PTR(const TopologyCacheHeader*, 0);
+    if (!tc_inMap(header->affinityDomains, sizeof(AffinityDomains)))
+    {
+        return -EINVAL;
+    }
+    cached = TC_PTR(const AffinityDomains*, header->affinityDomains);
+    if (cached->numberOfAffinityDomains > 0 &&
+        !tc_inMap((uint64_t)(uintptr_t)cached->domains,
+                  cached->numberOfAffinityDomains * sizeof(AffinityDomain)))
+    {
+        return -EINVAL;
+    }
+    doms = TC_PTR(const AffinityDomain*, (uint64_t)(uintptr_t)cached->domains);
+
+    memcpy(affinity, cached, sizeof(AffinityDomains));
+    affinity->domains = calloc(cached->numberOfAffinityDomains, sizeof(AffinityDomain));
+    if (!affinity->domains)
+    {
+        return -ENOMEM;
+    }
+    for (int i = 0; i < cached->numberOfAffinityDomains; i++)
+    {
+        AffinityDomain* d = &affinity->domains[i];
+        d->tag = bfromcstr(TC_PTR(const char*, (uint64_t)(uintptr_t)doms[i].tag));
+        d->numberOfProcessors = doms[i].numberOfProcessors;
+        d->numberOfCores = doms[i].numberOfCores;
+        d->processorList = tc_copy((uint64_t)(uintptr_t)doms[i].processorList,
+                                   doms[i].numberOfProcessors * sizeof(int));
+    }
+    for (int i = 0; i < TC_NUM_LOOKUPS; i++)
+    {
+        lookups[i] = tc_copy(header->lookups[i], numHWThreads * sizeof(int));
+    }
+    return 0;
+}
+
+void
+topology_cache_release(void)
+{
+    if (tc_map)
+    {
+        munmap(tc_map, tc_mapSize);
+        tc_map = NULL;
+        tc_mapSize = 0;
+    }
+    tc_affinityValid = 0;
+}
+
+int
+topology_writeCache(const char* filename)
+{
+    int ret = 0;
+    int fd = -1;
+    char tmpname[1024];
+    TopologyCacheHeader header;
+    TopologyCacheBuffer buf = {NULL, 0, 0, 0};
+    CpuInfo info;
+    CpuTopology topo;
+    NumaTopology numa;
+    AffinityDomains aff;
+    NumaNode* nodes = NULL;
+    AffinityDomain* doms = NULL;
+    int* lookupSrc[TC_NUM_LOOKUPS];
+
+    if (!filename)
+    {
+        return -EINVAL;
+    }
+    ret = topology_init();
+    if (ret != 0)
+    {
+        return -EFAULT;
+    }
+    ret = numa_init();
+    if (ret != 0)
+    {
+        return ret;
+    }
+    ret = affinity_init();
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    buf.capacity = 4096;
+    buf.data = calloc(buf.capacity, sizeof(char));
+    if (!buf.data)
+    {
+        return -ENOMEM;
+    }
+    buf.size = sizeof(TopologyCacheHeader);
+
+    memset(&header, 0, sizeof(TopologyCacheHeader));
+    memcpy(header.magic, TOPOLOGY_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TOPOLOGY_CACHE_VERSION;
+    header.headerSize = sizeof(TopologyCacheHeader);
+    header.sizeCpuInfo = sizeof(CpuInfo);
+    header.sizeCpuTopology = sizeof(CpuTopology);
+    header.sizeHWThread = sizeof(HWThread);
+    header.sizeCacheLevel = sizeof(CacheLevel);
+    header.sizeNumaNode = sizeof(NumaNode);
+    header.sizeAffinityDomain = sizeof(AffinityDomain);
+    tc_fingerprint(&header);
+    CPU_ZERO(&header.cpuSet);
+    for (int i = 0; i < cpuid_topology.numHWThreads; i++)
+    {
+        if (cpuid_topology.threadPool[i].inCpuSet)
+        {
+            CPU_SET(cpuid_topology.threadPool[i].apicId, &header.cpuSet);
+        }
+    }
+
+    /* CPU information */
+    memcpy(&info, &cpuid_info, sizeof(CpuInfo));
+    info.osname = (char*)(uintptr_t)tc_appendString(&buf, cpuid_info.osname);
+    info.features = (char*)(uintptr_t)tc_appendString(&buf, cpuid_info.features);
+    info.name = NULL;
+    info.short_name = NULL;
+    if (info.clock == 0)
+    {
+        timer_init();
+        info.clock = timer_getCpuClock();
+    }
+    header.cpuInfo = tc_append(&buf, &info, sizeof(CpuInfo));
+
+    /* CPU topology */
+    memcpy(&topo, &cpuid_topology, sizeof(CpuTopology));
+    topo.threadPool = (HWThread*)(uintptr_t)tc_append(&buf, cpuid_topology.threadPool,
+                                        cpuid_topology.numHWThreads * sizeof(HWThread));
+    topo.cacheLevels = (CacheLevel*)(uintptr_t)tc_append(&buf, cpuid_topology.cacheLevels,
+                                        cpuid_topology.numCacheLevels * sizeof(CacheLevel));
+    topo.topologyTree = NULL;
+    header.cpuTopology = tc_append(&buf, &topo, sizeof(CpuTopology));
+
+    /* NUMA topology */
+    nodes = malloc(numa_info.numberOfNodes * sizeof(NumaNode));
+    if (!nodes)
+    {
+        ret = -ENOMEM;
+        goto write_out;
+    }
+    for (int i = 0; i < numa_info.numberOfNodes; i++)
+    {
+        memcpy(&nodes[i], &numa_info.nodes[i], sizeof(NumaNode));
+        nodes[i].processors = (uint32_t*)(uintptr_t)tc_append(&buf, numa_info.nodes[i].processors,
+                                        numa_info.nodes[i].numberOfProcessors * sizeof(uint32_t));
+        nodes[i].distances = (uint32_t*)(uintptr_t)tc_append(&buf, numa_info.nodes[i].distances,
+                                        numa_info.nodes[i].numberOfDistances * sizeof(uint32_t));
+    }
+    numa.numberOfNodes = numa_info.numberOfNodes;
+    numa.nodes = (NumaNode*)(uintptr_t)tc_append(&buf, nodes, numa_info.numberOfNodes * sizeof(NumaNode));
+    header.numaTopology = tc_append(&buf, &numa, sizeof(NumaTopology));
+
+    /* Affinity domains and lookup tables */
+    memcpy(&aff, &affinityDomains, sizeof(AffinityDomains));
+    doms = malloc(affinityDomains.numberOfAffinityDomains * sizeof(AffinityDomain));
+    if (!doms)
+    {
+        ret = -ENOMEM;
+        goto write_out;
+    }
+    for (int i = 0; i < affinityDomains.numberOfAffinityDomains; i++)
+    {
+        AffinityDomain* d = &affinityDomains.domains[i];
+        doms[i].tag = (bstring)(uintptr_t)tc_appendString(&buf, bdata(d->tag));
+        doms[i].numberOfProcessors = d->numberOfProcessors;
+        doms[i].numberOfCores = d->numberOfCores;
+        doms[i].processorList = (int*)(uintptr_t)tc_append(&buf, d->processorList,
+                                        d->numberOfProcessors * sizeof(int));
+    }
+    aff.domains = (AffinityDomain*)(uintptr_t)tc_append(&buf, doms,
+                                affinityDomains.numberOfAffinityDomains * sizeof(AffinityDomain));
+    header.affinityDomains = tc_append(&buf, &aff, sizeof(AffinityDomains));
+    lookupSrc[0] = affinity_thread2core_lookup;
+    lookupSrc[1] = affinity_thread2socket_lookup;
+    lookupSrc[2] = affinity_thread2sharedl3_lookup;
+    lookupSrc[3] = affinity_thread2numa_lookup;
+    lookupSrc[4] = affinity_thread2die_lookup;
+    for (int i = 0; i < TC_NUM_LOOKUPS; i++)
+    {
+        header.lookups[i] = tc_append(&buf, lookupSrc[i], cpuid_topology.numHWThreads * sizeof(int));
+    }
+    if (buf.failed)
+    {
+        ret = -ENOMEM;
+        goto write_out;
+    }
+
+    header.fileSize = buf.size;
+    memcpy(buf.data, &header, sizeof(TopologyCacheHeader));
+
+    /* Write to a temporary file and rename it, so that concurrently starting
+     * processes never see a partially written cache */
+    snprintf(tmpname, sizeof(tmpname), "%s.%d", filename, (int)getpid());
+    fd = open(tmpname, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        ret = -errno;
+        ERROR_PRINT(Cannot open topology cache file %s for writing, tmpname);
+        goto write_out;
+    }
+    for (uint64_t done = 0; done < buf.size; )
+    {
+        ssize_t w = write(fd, buf.data + done, buf.size - done);
+        if (w < 0)
+        {
+            ret = -errno;
+            close(fd);
+            unlink(tmpname);
+            goto write_out;
+        }
+        done += w;
+    }
+    close(fd);
+    if (rename(tmpname, filename) < 0)
+    {
+        ret = -errno;
+        unlink(tmpname);
+        goto write_out;
+    }
+    DEBUG_PRINT(DEBUGLEV_INFO, Wrote topology cache %s with %lu bytes, filename, buf.size);
+    ret = 0;
+write_out:
+    if (doms)
+        free(doms);
+    if (nodes)
+        free(nodes);
+    free(buf.data);
+    return ret;
+}
@@ -0,0 +1,351 @@
+/*
+ * =======================================================================================
+ *
+ *      Filename:  marker_overhead.c
+ *
+ *      Description:  Micro-benchmark for the overhead of the MarkerAPI calls. Measures
+ *                    latency and throughput of start/stop, getRegion and resetRegion
+ *                    and prints the results as CSV.
+ *
+ *      Version:   <VERSION>
+ *      Released:  <DATE>
+ *
+ *      Author:   Thomas Gruber (tr), thomas.roehl@googlemail.com
+ *      Project:  likwid
+ *
+ *      Copyright (C) 2016 RRZE, University Erlangen-Nuremberg
+ *
+ *      This program is free software: you can redistribute it and/or modify it under
+ *      the terms of the GNU General Public License as published by the Free Software
+ *      Foundation, either version 3 of the License, or (at your option) any later
+ *      version.
+ *
+ *      This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *      WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *      PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+ *
+ *      You should have received a copy of the GNU General Public License along with
+ *      this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =======================================================================================
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <omp.h>
+
+#include <likwid.h>
+
+#define MAX_REGIONS 1024
+#define DEFAULT_EVENTS "INSTR_RETIRED_ANY:FIXC0"
+
+enum {
+    OP_START_STOP = 0,
+    OP_START,
+    OP_STOP,
+    OP_GET_REGION,
+    OP_RESET_REGION,
+    NUM_OPS
+};
+
+static const char* opNames[NUM_OPS] = {
+    [OP_START_STOP] = "start_stop",
+    [OP_START] = "start",
+    [OP_STOP] = "stop",
+    [OP_GET_REGION] = "get_region",
+    [OP_RESET_REGION] = "reset_region",
+};
+
+static inline double
+nanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1E9 + (double)ts.tv_nsec;
+}
+
+static const char*
+modeName(int mode)
+{
+    switch (mode)
+    {
+        case ACCESSMODE_PERF:
+            return "perf_event";
+        case ACCESSMODE_DIRECT:
+            return "direct";
+        case ACCESSMODE_DAEMON:
+            return "accessdaemon";
+        case ACCESSMODE_SIM:
+            return "sim";
+    }
+    return "unknown";
+}
+
+static int
+countEvents(const char* eventStr)
+{
+    int count = 1;
+    for (const char* c = eventStr; *c != '\0'; c++)
+    {
+        if (*c == ',')
+            count++;
+    }
+    return count;
+}
+
+static void
+usage(const char* exe)
+{
+    printf("Usage: %s [-t threads] [-r regions] [-n iterations] [-g eventset] [-M mode] [-H]\n", exe);
+    printf("-t <threads>\t Number of OpenMP threads (default 1)\n");
+    printf("-r <regions>\t Number of distinct regions per thread (default 1, max %d)\n", MAX_REGIONS);
+    printf("-n <iter>\t Number of calls per region and operation (default 100000)\n");
+    printf("-g <eventset>\t Event set, ignored when started by likwid-perfctr -m (default %s)\n", DEFAULT_EVENTS);
+    printf("-M <mode>\t Access mode, 0=direct, 1=accessDaemon, 2=simulated (default 1)\n");
+    printf("-H\t\t Do not print the CSV header\n");
+    printf("\nWhen started without likwid-perfctr -m, the MarkerAPI environment is set up\n");
+    printf("internally for the first <threads> hardware threads.\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int c = 0;
+    int numThreads = 1;
+    int numRegions = 1;
+    int iterations = 100000;
+    int mode = ACCESSMODE_DAEMON;
+    int printHeader = 1;
+    int ownEnv = 0;
+    char* eventStr = DEFAULT_EVENTS;
+    char filepath[256];
+    char (*tags)[32] = NULL;
+    double opTime[NUM_OPS];
+    double opMaxTime[NUM_OPS];
+
+    while ((c = getopt(argc, argv, "t:r:n:g:M:Hh")) != -1)
+    {
+        switch (c)
+        {
+            case 't':
+                numThreads = atoi(optarg);
+                break;
+            case 'r':
+                numRegions = atoi(optarg);
+                break;
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            case 'g':
+                eventStr = optarg;
+                break;
+            case 'M':
+                mode = atoi(optarg);
+                break;
+            case 'H':
+                printHeader = 0;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (numThreads < 1 || numRegions < 1 || numRegions > MAX_REGIONS || iterations < 1)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (getenv("LIKWID_EVENTS") == NULL)
+    {
+        /* Not started by likwid-perfctr -m, so provide the MarkerAPI setup ourselves */
+        char modeStr[8];
+        char* threadStr = NULL;
+        int len = 0;
+        CpuTopology_t topo = NULL;
+        snprintf(modeStr, sizeof(modeStr), "%d", mode);
+        setenv("LIKWID_MODE", modeStr, 1);
+        if (topology_init() != 0)
+        {
+            fprintf(stderr, "Failed to initialize topology module\n");
+            return 1;
+        }
+        topo = get_cpuTopology();
+        if (numThreads > (int)topo->activeHWThreads)
+        {
+            fprintf(stderr, "Only %d hardware threads available\n", topo->activeHWThreads);
+            return 1;
+        }
+        threadStr = malloc(numThreads * 8 + 1);
+        threadStr[0] = '\0';
+        for (int i = 0, t = 0; i < (int)topo->numHWThreads && t < numThreads; i++)
+        {
+            if (!topo->threadPool[i].inCpuSet)
+                continue;
+            len += sprintf(&threadStr[len], "%s%d", (t > 0 ? "," : ""), topo->threadPool[i].apicId);
+            t++;
+        }
+        snprintf(filepath, sizeof(filepath), "/tmp/likwid_marker_overhead_%d.txt", (int)getpid());
+        setenv("LIKWID_EVENTS", eventStr, 1);
+        setenv("LIKWID_THREADS", threadStr, 1);
+        setenv("LIKWID_FILEPATH", filepath, 1);
+        setenv("LIKWID_PIN", threadStr, 1);
+        free(threadStr);
+        ownEnv = 1;
+    }
+    else
+    {
+        eventStr = getenv("LIKWID_EVENTS");
+        if (getenv("LIKWID_MODE") != NULL)
+        {
+            mode = atoi(getenv("LIKWID_MODE"));
+        }
+    }
+
+    tags = malloc(numRegions * sizeof(*tags));
+    for (int r = 0; r < numRegions; r++)
+    {
+        snprintf(tags[r], sizeof(tags[r]), "region%d", r);
+    }
+    for (int i = 0; i < NUM_OPS; i++)
+    {
+        opTime[i] = 0.0;
+        opMaxTime[i] = 0.0;
+    }
+
+    omp_set_num_threads(numThreads);
+    likwid_markerInit();
+
+#pragma omp parallel
+    {
+        int nevents = 0;
+        int count = 0;
+        double rtime = 0.0;
+        double events[64];
+        double t0, t1, sum;
+        double clockOverhead = 0.0;
+        double myTime[NUM_OPS];
+
+        likwid_markerThreadInit();
+        for (int r = 0; r < numRegions; r++)
+        {
+            likwid_markerRegisterRegion(tags[r]);
+        }
+
+        /* Cost of the timestamps around the single calls */
+        t0 = nanoseconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            t1 = nanoseconds();
+        }
+        clockOverhead = (nanoseconds() - t0) / iterations;
+
+        /* Warmup */
+        for (int r = 0; r < numRegions; r++)
+        {
+            likwid_markerStartRegion(tags[r]);
+            likwid_markerStopRegion(tags[r]);
+        }
+
+#pragma omp barrier
+        t0 = nanoseconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            for (int r = 0; r < numRegions; r++)
+            {
+                likwid_markerStartRegion(tags[r]);
+                likwid_markerStopRegion(tags[r]);
+            }
+        }
+        myTime[OP_START_STOP] = nanoseconds() - t0;
+
+#pragma omp barrier
+        myTime[OP_START] = 0.0;
+        myTime[OP_STOP] = 0.0;
+        for (int i = 0; i < iterations; i++)
+        {
+            for (int r = 0; r < numRegions; r++)
+            {
+                t0 = nanoseconds();
+                likwid_markerStartRegion(tags[r]);
+                t1 = nanoseconds();
+                likwid_markerStopRegion(tags[r]);
+                myTime[OP_START] += t1 - t0;
+                myTime[OP_STOP] += nanoseconds() - t1;
+            }
+        }
+        myTime[OP_START] -= clockOverhead * iterations * numRegions;
+        myTime[OP_STOP] -= clockOverhead * iterations * numRegions;
+
+#pragma omp barrier
+        sum = 0.0;
+        t0 = nanoseconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            for (int r = 0; r < numRegions; r++)
+            {
+                nevents = 64;
+                likwid_markerGetRegion(tags[r], &nevents, events, &rtime, &count);
+                sum += rtime;
+            }
+        }
+        myTime[OP_GET_REGION] = nanoseconds() - t0;
+
+#pragma omp barrier
+        t0 = nanoseconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            for (int r = 0; r < numRegions; r++)
+            {
+                likwid_markerResetRegion(tags[r]);
+            }
+        }
+        myTime[OP_RESET_REGION] = nanoseconds() - t0;
+
+        /* Leave valid results for likwid_markerClose */
+        for (int r = 0; r < numRegions; r++)
+        {
+            likwid_markerStartRegion(tags[r]);
+            likwid_markerStopRegion(tags[r]);
+        }
+
+#pragma omp critical
+        {
+            for (int i = 0; i < NUM_OPS; i++)
+            {
+                opTime[i] += myTime[i];
+                if (myTime[i] > opMaxTime[i])
+                    opMaxTime[i] = myTime[i];
+            }
+        }
+        if (sum < 0)
+            printf("Invalid region time\n");
+    }
+
+    likwid_markerClose();
+    if (ownEnv)
+    {
+        unlink(filepath);
+    }
+
+    if (printHeader)
+    {
+        printf("mode,threads,regions,events,iterations,operation,calls,ns_per_call,mcalls_per_s\n");
+    }
+    for (int i = 0; i < NUM_OPS; i++)
+    {
+        double calls = (double)iterations * numRegions;
+        double nsPerCall = opTime[i] / (numThreads * calls);
+        double throughput = (opMaxTime[i] > 0 ? (numThreads * calls * 1E3) / opMaxTime[i] : 0.0);
+        printf("%s,%d,%d,%d,%d,%s,%.0f,%.2f,%.4f\n", modeName(mode), numThreads, numRegions,
+                countEvents(eventStr), iterations, opNames[i], numThreads * calls, nsPerCall, throughput);
+    }
+    free(tags);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#!/bin/bash
+#
+# Sweep for the MarkerAPI overhead benchmark. All results are written as one
+# CSV table to stdout.
+#
+# Usage: ./marker_overhead.sh [modes] [threads] [regions] [eventsets]
+#   modes     List of access modes (default "1", e.g. "0 1 2")
+#   threads   List of thread counts (default "1 2 4")
+#   regions   List of region counts (default "1 16 128")
+#   eventsets Semicolon separated list of event sets
+#
+# For the simulated access mode (2), set LIKWID_SIM_SCRIPT (see sim-script.txt).
+
+MODES=${1:-"1"}
+THREADS=${2:-"1 2 4"}
+REGIONS=${3:-"1 16 128"}
+EVENTSETS=${4:-"INSTR_RETIRED_ANY:FIXC0;INSTR_RETIRED_ANY:FIXC0,CPU_CLK_UNHALTED_CORE:FIXC1,CPU_CLK_UNHALTED_REF:FIXC2"}
+ITERATIONS=${ITERATIONS:-10000}
+EXE=$(dirname $0)/marker_overhead
+NCPUS=$(nproc)
+
+HEADER=""
+IFS=';' read -ra EVSETS <<< "${EVENTSETS}"
+for M in ${MODES}; do
+    for T in ${THREADS}; do
+        if [ ${T} -gt ${NCPUS} ]; then
+            continue
+        fi
+        for R in ${REGIONS}; do
+            for E in "${EVSETS[@]}"; do
+                ${EXE} ${HEADER} -M ${M} -t ${T} -r ${R} -n ${ITERATIONS} -g "${E}" 2>/dev/null
+                HEADER="-H"
+            done
+        done
+    done
+done
@@ -0,0 +1,143 @@
+/*
+ * Test for pipelined requests to the access daemon (likwid-accessD).
+ *
+ * Starts the daemon like access_client.c does, sends a batch of records in
+ * odd-sized pieces so that reads in the daemon are not aligned to records and
+ * checks that every record gets its reply in order. The daemon has to be
+ * started as root, register accesses may fail, only the replies are checked.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <access_client_types.h>
+
+#ifndef LIKWIDSOCKETBASE
+#define LIKWIDSOCKETBASE /tmp/likwid
+#endif
+#define STRINGIFY(x) #x
+#define TOSTRING(x) STRINGIFY(x)
+
+#define NUM_RECORDS 128
+#define PIECE 7
+
+static int
+transfer(int fd, int write_data, char* buf, size_t len, size_t piece)
+{
+    size_t off = 0;
+    while (off < len)
+    {
+        size_t n = (len - off < piece ? len - off : piece);
+        ssize_t ret = (write_data ? write(fd, buf + off, n) : read(fd, buf + off, n));
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+        else if (ret == 0)
+        {
+            return -EPIPE;
+        }
+        off += ret;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* daemon = (argc > 1 ? argv[1] : "../likwid-accessD");
+    char* newargv[] = { NULL };
+    char* newenv[] = { NULL };
+    struct sockaddr_un addr;
+    AccessDataRecord records[NUM_RECORDS];
+    int failed = 0;
+    int fd = -1;
+    int ret = 0;
+
+    if (access(daemon, X_OK) != 0)
+    {
+        fprintf(stderr, "Cannot execute daemon %s\n", daemon);
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execve(daemon, newargv, newenv);
+        _exit(127);
+    }
+    else if (pid < 0)
+    {
+        perror("fork");
+        return 1;
+    }
+    /* The daemon forks into the background, the socket carries our child PID */
+    waitpid(pid, NULL, 0);
+    memset(&addr, 0, sizeof(struct sockaddr_un));
+    addr.sun_family = AF_LOCAL;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), TOSTRING(LIKWIDSOCKETBASE) "-%d", pid);
+    fd = socket(AF_LOCAL, SOCK_STREAM, 0);
+    for (int i = 0; i < 100; i++)
+    {
+        ret = connect(fd, (struct sockaddr*)&addr, sizeof(struct sockaddr_un));
+        if (ret == 0)
+            break;
+        usleep(10000);
+    }
+    if (ret != 0)
+    {
+        fprintf(stderr, "Cannot connect to daemon socket %s\n", addr.sun_path);
+        return 1;
+    }
+
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < NUM_RECORDS; i++)
+    {
+        records[i].cpu = 0;
+        records[i].reg = 0x186 + (i % 8);
+        records[i].data = i;
+        records[i].device = MSR_DEV;
+        records[i].type = DAEMON_READ;
+        records[i].errorcode = ERR_UNKNOWN;
+    }
+    ret = transfer(fd, 1, (char*)records, sizeof(records), PIECE);
+    if (ret < 0)
+    {
+        fprintf(stderr, "FAILED: sending records: %s\n", strerror(-ret));
+        return 1;
+    }
+    memset(records, 0, sizeof(records));
+    ret = transfer(fd, 0, (char*)records, sizeof(records), sizeof(records));
+    if (ret < 0)
+    {
+        fprintf(stderr, "FAILED: receiving replies: %s\n", strerror(-ret));
+        return 1;
+    }
+    for (int i = 0; i < NUM_RECORDS; i++)
+    {
+        if (records[i].reg != 0x186 + (uint32_t)(i % 8) || records[i].type != DAEMON_READ ||
+            records[i].errorcode == ERR_UNKNOWN)
+        {
+            fprintf(stderr, "FAILED: reply %d for reg 0x%X type %d error %d\n", i,
+                    records[i].reg, records[i].type, records[i].errorcode);
+            failed++;
+        }
+    }
+
+    memset(records, 0, sizeof(AccessDataRecord));
+    records[0].type = DAEMON_EXIT;
+    transfer(fd, 1, (char*)records, sizeof(AccessDataRecord), sizeof(AccessDataRecord));
+    close(fd);
+    if (failed)
+    {
+        fprintf(stderr, "%d replies wrong\n", failed);
+        return 1;
+    }
+    printf("All %d replies received\n", NUM_RECORDS);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Regression test for the simulated access mode (src/access_sim.c).
+ *
+ * The source is included directly because the access layer is not exported
+ * by liblikwid. Checks that an overflowing read is not lost when the register
+ * table grows, that a wrap is detected when the increment is larger than the
+ * counter range and that invalid HW threads are rejected.
+ */
+#include "../src/access_sim.c"
+
+#include <unistd.h>
+
+CpuTopology cpuid_topology;
+int perfmon_verbosity = 0;
+
+/* 126 preset registers plus the two counters fill the initial table up to the
+ * resize threshold, the status registers are the first ones above it */
+#define NUM_PRESET (SIM_INITIAL_SLOTS / 2 - 2)
+
+#define COUNTER_REG 0x1000
+#define COUNTER_STATUS 0x2000
+#define WIDE_REG 0x1001
+#define WIDE_STATUS 0x2001
+
+static int failed = 0;
+
+#define CHECK(cond, ...) \
+    if (!(cond)) \
+    { \
+        fprintf(stderr, "FAILED: " __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+        failed++; \
+    }
+
+int main(int argc, char* argv[])
+{
+    char script[] = "/tmp/test-access-sim-XXXXXX";
+    uint64_t data = 0;
+    int fd = mkstemp(script);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+    FILE* fp = fdopen(fd, "w");
+    for (int i = 0; i < NUM_PRESET; i++)
+    {
+        fprintf(fp, "value MSR 0x%X %d\n", 0x100 + i, i);
+    }
+    /* 8 bit counter, wraps at the second read */
+    fprintf(fp, "counter MSR 0x%X 0x80 8\n", COUNTER_REG);
+    fprintf(fp, "overflow MSR 0x%X 0x%X 0\n", COUNTER_REG, COUNTER_STATUS);
+    /* Increment equal to the counter range, wraps at every read */
+    fprintf(fp, "counter MSR 0x%X 0x100 8\n", WIDE_REG);
+    fprintf(fp, "overflow MSR 0x%X 0x%X 1\n", WIDE_REG, WIDE_STATUS);
+    fclose(fp);
+
+    setenv("LIKWID_SIM_SCRIPT", script, 1);
+    cpuid_topology.numHWThreads = 1;
+    CHECK(access_sim_init(0) == 0, "access_sim_init");
+
+    access_sim_read(MSR_DEV, 0, COUNTER_REG, &data);
+    CHECK(data == 0x80, "first read 0x%lx, expected 0x80", data);
+    access_sim_read(MSR_DEV, 0, COUNTER_REG, &data);
+    CHECK(data == 0x0, "wrapping read 0x%lx, expected 0x0", data);
+    access_sim_read(MSR_DEV, 0, COUNTER_REG, &data);
+    CHECK(data == 0x80, "read after wrap 0x%lx, expected 0x80", data);
+    access_sim_read(MSR_DEV, 0, COUNTER_STATUS, &data);
+    CHECK(data == 0x1, "status 0x%lx, expected 0x1", data);
+
+    access_sim_read(MSR_DEV, 0, WIDE_REG, &data);
+    CHECK(data == 0x0, "wide counter 0x%lx, expected 0x0", data);
+    access_sim_read(MSR_DEV, 0, WIDE_STATUS, &data);
+    CHECK(data == 0x2, "wide status 0x%lx, expected 0x2", data);
+
+    for (int i = 0; i < NUM_PRESET; i++)
+    {
+        access_sim_read(MSR_DEV, 0, 0x100 + i, &data);
+        CHECK(data == (uint64_t)i, "preset 0x%x is 0x%lx", 0x100 + i, data);
+    }
+
+    /* Out of range HW threads are rejected */
+    CHECK(access_sim_read(MSR_DEV, -1, COUNTER_REG, &data) == -ENODEV, "read of HW thread -1");
+    CHECK(access_sim_read(MSR_DEV, 1, COUNTER_REG, &data) == -ENODEV, "read of HW thread 1");
+    CHECK(access_sim_write(MSR_DEV, 1, COUNTER_REG, 0x0ULL) == -ENODEV, "write of HW thread 1");
+
+    access_sim_finalize(0);
+    unlink(script);
+    if (failed)
+    {
+        fprintf(stderr, "%d checks failed\n", failed);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}